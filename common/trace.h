@@ -0,0 +1,273 @@
+/*
+ * trace.h
+ * ---------
+ * Header-only timeline tracing shared by all parts. Writes Chrome trace-event
+ * JSON, which chrome://tracing, Perfetto (ui.perfetto.dev) and speedscope open.
+ *
+ * Usage:
+ *   trace::Session session(std::getenv("TRACE_FILE"));  // in main; no path = tracing off
+ *   TRACE_SCOPE("RTree::bulkLoad");                     // span until the end of the block
+ *   trace::Span span("rangeQuery", "query");            // named span, to attach a number:
+ *   span.setArg("results", results.size());
+ *   span.end();                                         // optional, before the end of the scope
+ *   trace::setThreadName("worker 3");                   // label of the calling thread
+ *
+ * Spans are recorded as complete ("X") events in a buffer owned by the calling
+ * thread, so threads never contend; the buffers are merged and written when the
+ * session ends. Without an active session a span costs one atomic load;
+ * building with -DTRACE_DISABLED turns every call into dead code.
+ *
+ * Span names are expected to be string literals; the std::string overload copies
+ * the name, and only while tracing is on.
+ */
+
+#ifndef COMMON_TRACE_H
+#define COMMON_TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace trace {
+
+namespace detail {
+
+struct Event {
+    const char* name;
+    std::string ownedName;     // set for names built at run time
+    const char* category;
+    int64_t startNs;           // since the session started
+    int64_t durationNs;
+    const char* argKey;        // optional numeric argument
+    int64_t argValue;
+};
+
+struct ThreadBuffer {
+    std::mutex mutex;          // taken by the owning thread and by the writer only
+    std::vector<Event> events;
+    std::string threadName;
+    uint32_t tid = 0;
+};
+
+struct State {
+    std::atomic<bool> active{false};
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers; // every thread that ever traced
+    std::chrono::steady_clock::time_point origin;
+    std::string path;
+    std::string processName;
+};
+
+inline State& state() {
+    static State s;
+    return s;
+}
+
+// The calling thread's buffer, registered on first use; it outlives the thread
+inline ThreadBuffer& localBuffer() {
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+        auto created = std::make_shared<ThreadBuffer>();
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.mutex);
+        created->tid = static_cast<uint32_t>(s.buffers.size() + 1);
+        s.buffers.push_back(created);
+        return created;
+    }();
+    return *buffer;
+}
+
+inline int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - state().origin)
+        .count();
+}
+
+inline void writeEscaped(std::ostream& out, const char* text) {
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out << '\\' << *c;
+        } else if (static_cast<unsigned char>(*c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(*c));
+            out << escaped;
+        } else {
+            out << *c;
+        }
+    }
+}
+
+// Timestamps in microseconds with nanosecond digits
+inline void writeMicros(std::ostream& out, int64_t ns) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%lld.%03lld", static_cast<long long>(ns / 1000),
+                  static_cast<long long>(ns % 1000));
+    out << text;
+}
+
+} // namespace detail
+
+// ---------------- Control ----------------
+inline bool isActive() {
+#ifdef TRACE_DISABLED
+    return false;
+#else
+    return detail::state().active.load(std::memory_order_acquire);
+#endif
+}
+
+// Starts recording (events of an earlier session are dropped); path is written by stop()
+inline void start(const std::string& path, const std::string& processName = "trace") {
+#ifndef TRACE_DISABLED
+    detail::State& s = detail::state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for (auto& buffer : s.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        buffer->events.clear();
+    }
+    s.path = path;
+    s.processName = processName;
+    s.origin = std::chrono::steady_clock::now();
+    s.active.store(true, std::memory_order_release);
+#else
+    (void)path;
+    (void)processName;
+#endif
+}
+
+// Stops recording and writes the trace file; returns the number of events written
+inline size_t stop() {
+    detail::State& s = detail::state();
+    if (!s.active.exchange(false)) return 0;
+    std::lock_guard<std::mutex> lock(s.mutex);
+    std::ofstream out(s.path);
+    if (!out) return 0;
+
+    size_t written = 0;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"";
+    detail::writeEscaped(out, s.processName.c_str());
+    out << "\"}}";
+    for (auto& buffer : s.buffers) {
+        std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+        if (buffer->events.empty()) continue;
+        std::string threadName = buffer->threadName.empty() ? "thread " + std::to_string(buffer->tid)
+                                                            : buffer->threadName;
+        out << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid
+            << ",\"args\":{\"name\":\"";
+        detail::writeEscaped(out, threadName.c_str());
+        out << "\"}}";
+        for (const auto& e : buffer->events) {
+            out << ",\n{\"name\":\"";
+            detail::writeEscaped(out, e.ownedName.empty() ? e.name : e.ownedName.c_str());
+            out << "\",\"cat\":\"";
+            detail::writeEscaped(out, e.category);
+            out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid << ",\"ts\":";
+            detail::writeMicros(out, e.startNs);
+            out << ",\"dur\":";
+            detail::writeMicros(out, e.durationNs);
+            if (e.argKey) {
+                out << ",\"args\":{\"";
+                detail::writeEscaped(out, e.argKey);
+                out << "\":" << e.argValue << "}";
+            }
+            out << "}";
+            ++written;
+        }
+        buffer->events.clear();
+    }
+    out << "\n]}\n";
+    return written;
+}
+
+// Label shown for the calling thread
+inline void setThreadName(const std::string& name) {
+#ifndef TRACE_DISABLED
+    detail::ThreadBuffer& buffer = detail::localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mutex);
+    buffer.threadName = name;
+#else
+    (void)name;
+#endif
+}
+
+// Traces from construction to destruction when path is non-empty (e.g. getenv("TRACE_FILE"))
+class Session {
+private:
+    bool started = false;
+
+public:
+    explicit Session(const char* path, const std::string& processName = "trace") {
+        if (path && *path) {
+            start(path, processName);
+            started = isActive();
+        }
+    }
+    ~Session() {
+        if (started) stop();
+    }
+    Session(const Session&) = delete;
+    Session& operator=(const Session&) = delete;
+};
+
+// ---------------- Spans ----------------
+class Span {
+private:
+    const char* name = nullptr;
+    std::string ownedName;
+    const char* category = nullptr;
+    const char* argKey = nullptr;
+    int64_t argValue = 0;
+    int64_t startNs = 0;
+    bool recording = false;
+
+public:
+    explicit Span(const char* name_, const char* category_ = "default") {
+        if (!isActive()) return;
+        name = name_;
+        category = category_;
+        recording = true;
+        startNs = detail::nowNs();
+    }
+    explicit Span(const std::string& name_, const char* category_ = "default") {
+        if (!isActive()) return;
+        ownedName = name_;
+        name = "";
+        category = category_;
+        recording = true;
+        startNs = detail::nowNs();
+    }
+    ~Span() { end(); }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    // Records the span now instead of at the end of the scope; later calls do nothing
+    void end() {
+        if (!recording) return;
+        recording = false;
+        if (!isActive()) return;
+        int64_t endNs = detail::nowNs();
+        detail::ThreadBuffer& buffer = detail::localBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        buffer.events.push_back({name, std::move(ownedName), category, startNs, endNs - startNs, argKey, argValue});
+    }
+
+    // One numeric argument shown with the span (the last call wins)
+    void setArg(const char* key, int64_t value) {
+        argKey = key;
+        argValue = value;
+    }
+};
+
+} // namespace trace
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) ::trace::Span TRACE_CONCAT(traceSpan_, __LINE__)(name)
+#define TRACE_SCOPE_CAT(category, name) ::trace::Span TRACE_CONCAT(traceSpan_, __LINE__)(name, category)
+
+#endif // COMMON_TRACE_H
@@ -7,11 +7,30 @@
  * - Manages a tree of RTreeNode instances.
  * - Provides insertion, deletion, update, range queries, kNN, and similarity search.
  * - Supports bulk loading, JSON import/export, and statistical queries.
+ * - Reports an estimated memory footprint and per-level fill/overlap statistics.
+ * - Optionally answers range queries from a quantized snapshot (QuantizedRTree).
+ * - Approximate (1+epsilon) kNN with refinement, node and time budgets.
+ * - Parallel similarity joins (self-join and two-tree join).
+ * - Aggregate range queries (count, length, duration, distinct vehicles) from per-node aggregates.
+ * - Point density grids (heatmaps) over a space-time window, computed in parallel tiles.
+ * - Time-slice snapshots: interpolated positions of every trajectory active at t inside an area.
+ * - Continuous kNN along a moving query trajectory, reported as intervals of constant neighbor sets.
+ * - Batched range queries (e.g. one per map tile) answered in a single shared traversal.
+ * - A secondary TemporalIndex over trajectory time spans, kept in sync with the tree, answering
+ *   range queries whose time window is selective (temporalRangeQuery; QueryPlanner picks per query).
+ * - A VehicleIndex (vehicle -> trajectories) with bitmap distinct-vehicle counts and
+ *   per-vehicle grouping of range / similarity results.
+ * - Range and similarity queries that honor a cancellation token and deadline, synchronously or
+ *   as futures on a shared executor, returning partial results when cut off.
  * 
  * Key points:
  * - RTreeNode represents nodes (internal or leaf) storing bounding boxes and trajectories.
  * - RTree delegates recursion and node-level logic to RTreeNode.
  * - This class is the entry point for users interacting with the tree.
+ * - Every modification (insert, remove, update, bulkLoad) refreshes the node MBRs, child boxes and
+ *   aggregates it invalidated before returning, so queries never write to the tree and any number of
+ *   threads may query it concurrently. Modifications still need exclusive access; ConcurrentRTree
+ *   serves queries during modification.
  */ 
 
 #ifndef RTREE_H
@@ -20,23 +39,153 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <functional>
 #include "RTreeNode.h"
 #include "trajectory.h"
 #include "bbox3D.h"
+#include "quantizedRTree.h"
+#include "temporalIndex.h"
+#include "vehicleIndex.h"
+#include "queryControl.h"
+#include "threadPool.h"
+#include <future>
+#include <atomic>
+#include <mutex>
 
-struct TrajectorySummary {
-    std::string id;
-    BoundingBox3D bbox;           // precomputed bounding box
-    float centroidX;              // mean x
-    float centroidY;              // mean y
-    float centroidT;              // mean timestamp in seconds
-    std::shared_ptr<Trajectory> fullTrajectory; // pointer to full trajectory
+// Shape of one tree level (level 0 = root)
+struct LevelStatistics {
+    int level = 0;
+    size_t nodes = 0;
+    size_t entries = 0;           // children (internal) or trajectories (leaf)
+    double fillFactor = 0.0;      // entries / (nodes * maxEntries)
+    double overlapVolume = 0.0;   // summed pairwise overlap of sibling entry boxes
+    double overlapRatio = 0.0;    // overlapVolume / summed entry box volume
+};
+
+// Estimated heap footprint of the tree and the trajectories it owns, in bytes
+struct MemoryReport {
+    size_t nodeCount = 0;
+    size_t trajectoryCount = 0;
+    size_t pointCount = 0;
+
+    size_t nodeBytes = 0;              // RTreeNode objects (without cached MBR)
+    size_t entryVectorBytes = 0;       // leafEntries / childEntries buffers (capacity)
+    size_t controlBlockBytes = 0;      // shared_ptr control blocks of nodes and trajectories
+    size_t trajectoryBytes = 0;        // Trajectory objects (without cached bbox/centroid)
+    size_t pointBytes = 0;             // point buffers (capacity)
+    size_t idStringBytes = 0;          // heap-allocated ID characters (short IDs stay inline)
+    size_t cacheBytes = 0;             // cached node MBRs/aggregates, trajectory bboxes and centroids
+    size_t temporalIndexBytes = 0;     // secondary TemporalIndex
+    size_t vehicleIndexBytes = 0;      // secondary VehicleIndex
+    size_t allocatorOverheadBytes = 0; // malloc chunk headers and rounding (estimate)
+
+    std::vector<LevelStatistics> levels;
+
+    size_t total() const;
+    void print(std::ostream& os) const;
+};
+
+// Knobs of approximate kNN (0 = no limit for the budgets)
+struct ApproximateKNNOptions {
+    float epsilon = 0.0f;         // prune subtrees whose lower bound exceeds kth distance / (1 + epsilon)
+    size_t maxRefinements = 0;    // cap on exact trajectory distance evaluations
+    size_t maxNodes = 0;          // cap on visited nodes
+    double timeBudget = 0.0;      // seconds
+    float timeScale = 1e-5f;      // passed to Trajectory::spatioTemporalDistanceTo
+};
+
+// Approximate kNN answer; distances are squared, as returned by spatioTemporalDistanceTo
+struct ApproximateKNNResult {
+    std::vector<std::shared_ptr<Trajectory>> trajectories; // nearest first
+    std::vector<float> distances;
+    float achievedEpsilon = 0.0f; // every returned distance is <= (1 + achievedEpsilon) x the true one at that rank
+    size_t nodesVisited = 0;
+    size_t refinements = 0;
+    bool budgetExhausted = false; // stopped by a refinement, node or time budget
+};
+
+// Receives each matching pair once; calls are serialized, never concurrent
+using SimilarityJoinCallback = std::function<void(const Trajectory& a, const Trajectory& b, float similarity)>;
+
+// Work done by a similarity join
+struct SimilarityJoinStats {
+    size_t pairs = 0;            // pairs passed to the callback
+    size_t nodePairs = 0;        // node pairs visited
+    size_t refinements = 0;      // exact similarityTo evaluations
+    size_t tasks = 0;            // independent subtree pairs handed to workers
+};
+
+// Aggregate over the trajectories a range query would return
+struct AggregateQueryResult {
+    size_t count = 0;
+    size_t points = 0;
+    double totalLength = 0.0;
+    double totalDuration = 0.0;     // seconds
+    double distinctVehicles = 0.0;  // HyperLogLog estimate
+    size_t nodesVisited = 0;
+    size_t trajectoriesRead = 0;    // boundary trajectories summarized individually
+};
+
+// Point counts of a space-time window on a cellsX x cellsY grid, optionally split into time buckets
+struct DensityGrid {
+    BoundingBox3D box;
+    size_t cellsX = 0;
+    size_t cellsY = 0;
+    size_t buckets = 1;
+    int64_t bucketSeconds = 0;      // 0 = one bucket for the whole window
+    std::vector<uint32_t> counts;   // index (bucket * cellsY + y) * cellsX + x
+    size_t aggregatedNodes = 0;     // subtrees counted from their stored aggregate
+    size_t binnedTrajectories = 0;  // trajectories whose points were binned one by one
+
+    uint32_t at(size_t x, size_t y, size_t bucket = 0) const { return counts[(bucket * cellsY + y) * cellsX + x]; }
+    uint64_t total() const;         // points inside the window
+};
+
+// Interpolated position of one trajectory in a snapshot query
+struct SnapshotPosition {
+    const Trajectory* trajectory;   // owned by the tree; valid until the tree is modified
+    float x;
+    float y;
+
+    const std::string& id() const { return trajectory->getId(); }
+};
+
+// Knobs of continuous kNN
+struct ContinuousKNNOptions {
+    int64_t windowSeconds = 600;  // query time span covered by one candidate search
+    float initialRadius = 0.005f; // starting search radius around the query path (coordinate units)
+};
+
+// The same k neighbors (as a set) for every query timestamp in [start, end]
+struct KNNInterval {
+    int64_t start = 0;
+    int64_t end = 0;
+    std::vector<const Trajectory*> neighbors; // owned by the tree; nearest first at start
+};
+
+struct ContinuousKNNResult {
+    std::vector<KNNInterval> intervals;
+    size_t steps = 0;            // query timestamps evaluated
+    size_t searches = 0;         // tree traversals (initial + safe region exits)
+    size_t candidates = 0;       // candidate trajectories fetched over all searches
+};
+
+// Range query results of one vehicle
+struct VehicleGroup {
+    std::string vehicleId;
+    std::vector<const Trajectory*> trajectories; // owned by the tree; valid until it is modified
 };
 
 class RTree {
 private:
     std::shared_ptr<RTreeNode> root;   // Root node of the tree
     int maxEntries;                    // Maximum entries per node
+    std::shared_ptr<const QuantizedRTree> quantized; // Compact range-query snapshot, dropped on modification
+    TemporalIndex temporal;            // Time spans of the same trajectories, updated with the tree
+    VehicleIndex vehicles;             // Vehicle of every trajectory, updated with the tree
+
+    // STR bulk load; entry boxes from summaries when given, else from each trajectory's cached box
+    void bulkLoadSTR(std::vector<Trajectory>& trajectories, const std::vector<TrajectorySummary>* summaries);
 
     // ---------------- Stats ----------------
     //size_t getTotalEntries() const;  // Count total trajectories
@@ -51,26 +200,103 @@ public:
     bool remove(const std::string& trajId);  // Remove trajectory by ID
     bool update(const Trajectory& traj);     // Update trajectory (delete + insert if needed)
     void bulkLoad(std::vector<Trajectory>& trajectories); // Build tree using STR bulk-loading
+    // Same, with the boxes of computeSummaries/precomputeSummaries(trajectories) instead of recomputing them;
+    // throws std::runtime_error if summaries do not match trajectories
+    void bulkLoad(std::vector<Trajectory>& trajectories, const std::vector<TrajectorySummary>& summaries);
 
     size_t getTotalEntries() const;  // Count total trajectories
 
     // ---------------- Helper for faster queries ----------------
-    std::vector<TrajectorySummary> computeSummaries(const std::vector<Trajectory>& trajectories); // Precompute summaries for trajectories allowing fast pruning
+    // Summaries in input order, computed in parallel (numThreads = 0 uses all hardware threads).
+    // Each refers to its trajectory by index, so they stay valid for copies of the vector.
+    static std::vector<TrajectorySummary> computeSummaries(const std::vector<Trajectory>& trajectories,
+                                                           size_t numThreads = 0);
+    // Same, and caches each trajectory's box and centroid (the parallel form of precomputeCentroidAndBoundingBox)
+    static std::vector<TrajectorySummary> precomputeSummaries(std::vector<Trajectory>& trajectories,
+                                                              size_t numThreads = 0);
 
     // ---------------- Query operations ----------------
     std::vector<Trajectory> rangeQuery(const BoundingBox3D& queryBox) const;  // Spatial range search
+    void rangeQuery(const BoundingBox3D& queryBox, std::vector<const Trajectory*>& results) const; // Same matches, appended without copies
+    // Same matches from the temporal index: trajectories whose time span meets the window, then tested
+    // against the whole box. Cheaper than the traversal when the window is selective and the box is wide.
+    void temporalRangeQuery(const BoundingBox3D& queryBox, std::vector<const Trajectory*>& results) const;
+    // results[i] holds the trajectories intersecting queries[i] (not copied; the quantized index is not used).
+    // Queries are sorted spatially and the tree is walked once per group of neighboring queries.
+    // numThreads = 0 uses all hardware threads.
+    std::vector<std::vector<std::shared_ptr<Trajectory>>> batchRangeQuery(const std::vector<BoundingBox3D>& queries,
+                                                                          size_t numThreads = 1) const;
    // std::vector<Trajectory> kNearestNeighbors(const Trajectory& query, size_t k) const; // k-NN query
     std::vector<Trajectory> kNearestNeighbors(const Trajectory& query, size_t k, float timeScale = 1e-5f) const;
     std::vector<Trajectory> findSimilar(const Trajectory& query, float maxDistance) const; // Similarity search
+    // Pairs whose boxes lie within maxDistance (space and time), with approximateDistance and similarityTo
+    // <= maxDistance; the test depends only on the pair. findSimilar differs: it prunes leaves by box
+    // intersection and has no per-entry box test, so it can miss pairs found here and return matches whose
+    // boxes are farther apart. numThreads = 0 uses all hardware threads.
+    SimilarityJoinStats similarityJoin(float maxDistance, const SimilarityJoinCallback& callback,
+                                       size_t numThreads = 1) const;                       // self-join, a < b
+    SimilarityJoinStats similarityJoin(const RTree& other, float maxDistance, const SimilarityJoinCallback& callback,
+                                       size_t numThreads = 1) const;                       // this x other
+    ApproximateKNNResult approximateKNearestNeighbors(const Trajectory& query, size_t k,
+                                                      const ApproximateKNNOptions& options = {}) const; // (1+eps)-approximate kNN
+    AggregateQueryResult aggregateQuery(const BoundingBox3D& queryBox) const; // Stats of rangeQuery(queryBox) without materializing it
+    // Where every trajectory active at t was, if that position lies in the area (its time bounds are ignored)
+    std::vector<SnapshotPosition> snapshotQuery(const BoundingBox3D& area, int64_t t) const;
+    // One snapshot per timestamp, results[i] for times[i]; each trajectory is visited once for all of them
+    std::vector<std::vector<SnapshotPosition>> snapshotQuery(const BoundingBox3D& area,
+                                                             const std::vector<int64_t>& times) const;
+    // k nearest trajectories (interpolated positions, spatial distance) at every timestamp of query
+    ContinuousKNNResult continuousKNearestNeighbors(const Trajectory& query, size_t k,
+                                                    const ContinuousKNNOptions& options = {}) const;
+    // Points per cell inside box; bucketSeconds > 0 adds time buckets. numThreads = 0 uses all hardware threads.
+    DensityGrid densityGrid(const BoundingBox3D& box, size_t cellsX, size_t cellsY,
+                            int64_t bucketSeconds = 0, size_t numThreads = 0) const;
     std::vector<Trajectory> getAllLeafTrajectories() const; // Retrieve all trajectories in leaves
 
+    // ---------------- Cancellable queries ----------------
+    // Same matches as rangeQuery / findSimilar, checking control.token and control.deadline
+    // between nodes and refinements; on a stop, results holds what was found so far and
+    // complete is false. The quantized snapshot is not used.
+    PartialResult<std::vector<Trajectory>> rangeQuery(const BoundingBox3D& queryBox, const QueryControl& control) const;
+    PartialResult<std::vector<Trajectory>> findSimilar(const Trajectory& query, float maxDistance,
+                                                       const QueryControl& control) const;
+    // The same, run on executor (a process-wide pool by default). The tree must outlive the futures
+    // and must not be modified until they are ready; a query still queued at its deadline returns
+    // at once with no results.
+    std::future<PartialResult<std::vector<Trajectory>>> rangeQueryAsync(const BoundingBox3D& queryBox,
+                                                                        QueryControl control = {},
+                                                                        ThreadPool& executor = sharedExecutor()) const;
+    std::future<PartialResult<std::vector<Trajectory>>> findSimilarAsync(const Trajectory& query, float maxDistance,
+                                                                         QueryControl control = {},
+                                                                         ThreadPool& executor = sharedExecutor()) const;
+    static ThreadPool& sharedExecutor(); // one worker per hardware thread, created on first use
+
     // ---------------- Persistence ----------------
     void exportToJSON(const std::string& filename) const;      // Save to JSON file
     //static std::vector<Trajectory> loadFromJSON(const std::string& filepath); // Load trajectories from JSON
     static std::vector<Trajectory> loadFromParquet(const std::string& filepath); // Load trajectories from Parquet file
 
+    // ---------------- Quantized boxes ----------------
+    void buildQuantizedIndex(int bits = 8); // Snapshot the tree with 8/16-bit child boxes; used by rangeQuery
+    void dropQuantizedIndex();              // Go back to full-precision traversal
+    std::shared_ptr<const QuantizedRTree> getQuantizedIndex() const { return quantized; }
+
+    // ---------------- Temporal index ----------------
+    const TemporalIndex& getTemporalIndex() const { return temporal; }
+
+    // ---------------- Vehicle index ----------------
+    // Distinct vehicles of rangeQuery(queryBox) / findSimilar(query, maxDistance) as a bitmap of
+    // VehicleIndex ordinals; matches (if given) receives the number of matching trajectories
+    VehicleBitmap rangeQueryVehicles(const BoundingBox3D& queryBox, size_t* matches = nullptr) const;
+    VehicleBitmap findSimilarVehicles(const Trajectory& query, float maxDistance, bool excludeQuery = false,
+                                      size_t* matches = nullptr) const;
+    // rangeQuery(queryBox) grouped by vehicle, groups in vehicle ordinal order
+    std::vector<VehicleGroup> rangeQueryByVehicle(const BoundingBox3D& queryBox) const;
+    const VehicleIndex& getVehicleIndex() const { return vehicles; }
+
     // ---------------- Print Statistics ----------------
     void printStatistics() const;    // Print tree stats
+    MemoryReport memoryUsage() const; // Byte breakdown plus per-level fill factor and overlap
 
     // ---------------- Getter ----------------
     std::shared_ptr<RTreeNode> getRoot() const { return root; }
@@ -13,7 +13,8 @@
  *   - Range queries and similarity searches
  *   - Deletion and updates
  *   - k-Nearest Neighbor search
- *   - Lazy MBR caching
+ *   - MBR caching (invalidated on modification; RTree refreshes it before returning)
+ *   - Subtree aggregates (count, length, duration, vehicle sketch), cached like the MBR
  *  -  Tree structure maintenance (condensation, parent-child relationships)
  */
 
@@ -22,10 +23,12 @@
 
 #include "../include/bbox3D.h"
 #include "../include/trajectory.h"
+#include "../include/nodeAggregate.h"
 #include <memory>
 #include <vector>
 #include <utility>
 #include <string>
+#include <functional>
 
 class RTreeNode : public std::enable_shared_from_this<RTreeNode> {
 private:
@@ -33,6 +36,8 @@ private:
     int maxEntries;                     // Maximum entries before splitting
     mutable BoundingBox3D mbr;         // Node's Minimum Bounding Rectangle
     mutable bool mbr_dirty;            // True if MBR needs recomputation
+    mutable NodeAggregate aggregate;   // Summary of every trajectory in the subtree
+    mutable bool aggregate_dirty;      // True if aggregate needs recomputation
 
     std::vector<std::pair<BoundingBox3D, std::shared_ptr<Trajectory>>> leafEntries; // Leaf node trajectories
     std::vector<std::pair<BoundingBox3D, std::shared_ptr<RTreeNode>>> childEntries; // Internal node children
@@ -65,11 +70,16 @@ public:
 
     // ---------------- Insertion ----------------
     std::pair<std::shared_ptr<RTreeNode>, std::shared_ptr<RTreeNode>> insertRecursive(const Trajectory& traj);
+    std::pair<std::shared_ptr<RTreeNode>, std::shared_ptr<RTreeNode>> insertRecursive(const std::shared_ptr<Trajectory>& traj); // Stores traj itself
 
     // ---------------- Queries ----------------
     void rangeQuery(const BoundingBox3D& queryBox, std::vector<Trajectory>& results) const;
     void findSimilar(const Trajectory& query, float threshold, std::vector<Trajectory>& results) const;
+    using TrajectoryVisitor = std::function<void(const std::shared_ptr<Trajectory>&)>;
+    void findSimilar(const Trajectory& query, float threshold, const TrajectoryVisitor& visit) const; // Same matches, no copies
     std::vector<Trajectory> kNearestNeighbors(const Trajectory& query, size_t k, float timeScale, size_t candidateMultiplier = 50) const;
+    // Adds the aggregate of every trajectory intersecting queryBox; fully contained subtrees use their stored aggregate
+    void aggregateQuery(const BoundingBox3D& queryBox, NodeAggregate& result, size_t& nodesVisited, size_t& trajectoriesRead) const;
 
     // ---------------- Modification ----------------
     bool deleteTrajectory(const std::string& trajId);
@@ -83,6 +93,12 @@ public:
     // Update and manage the node's MBR
     void updateMBR() const; // Recompute MBR based on current entries or children
     void recomputeMBRs();  // Recursively recompute MBRs for all descendants
+    // Recompute invalidated MBRs, child boxes and aggregates below this node now, so later reads never write
+    void refreshCaches();
+
+    // Subtree aggregate (invalidated together with the MBR; recomputed on access if not refreshed)
+    const NodeAggregate& getAggregate() const;
+    void updateAggregate() const; // Rebuild from trajectories (leaf) or child aggregates (internal)
 
     // Insert entries into the node
     void insertChild(const BoundingBox3D& bbox, std::shared_ptr<RTreeNode> child); // Add a child node (internal)
@@ -110,8 +126,8 @@ public:
     void removeFromParent();           // Remove this node from its parent
 
     // Recursive insertion helpers
-    std::pair<std::shared_ptr<RTreeNode>, std::shared_ptr<RTreeNode>> insertIntoLeaf(const Trajectory& traj); // Insert into leaf node
-    std::pair<std::shared_ptr<RTreeNode>, std::shared_ptr<RTreeNode>> insertIntoInternal(const Trajectory& traj); // Insert into internal node
+    std::pair<std::shared_ptr<RTreeNode>, std::shared_ptr<RTreeNode>> insertIntoLeaf(const std::shared_ptr<Trajectory>& traj); // Insert into leaf node
+    std::pair<std::shared_ptr<RTreeNode>, std::shared_ptr<RTreeNode>> insertIntoInternal(const std::shared_ptr<Trajectory>& traj); // Insert into internal node
 };
 
 #endif // RTREE_NODE_H
@@ -47,8 +47,10 @@ public:
     // -------------------- Geometric queries --------------------
     bool intersects(const BoundingBox3D& other, float epsilon = 1e-6f) const;
     bool contains(const Point3D& pt, float epsilon = 1e-6f) const;
+    bool contains(const BoundingBox3D& other, float epsilon = 1e-6f) const; // other lies fully inside
 
     float volume() const;  // 2D area * temporal duration
+    float overlapVolume(const BoundingBox3D& other) const; // volume of the intersection (0 if disjoint)
     float spatialDistanceSquared(const BoundingBox3D& other) const; // ignores time
     float distanceSquaredTo(const BoundingBox3D& other) const;      // includes time
     float distanceTo(const BoundingBox3D& other) const;             // Euclidean distance
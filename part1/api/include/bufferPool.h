@@ -0,0 +1,93 @@
+/*
+ * bufferPool.h
+ * --------------
+ * Defines BufferPool, a fixed number of in-memory frames caching the pages of
+ * one file, and PageIOStats, the counters it reports.
+ *
+ * Pages are read with pread, so several threads can fetch at once; the frame
+ * table is guarded by a mutex and the read itself happens outside it (two
+ * threads missing on the same page both read it, the second copy is dropped).
+ *
+ * When every frame is taken a victim is chosen by the eviction policy:
+ *   - LRU:   least recently fetched page
+ *   - Clock: second chance; a hit sets the frame's reference bit and the hand
+ *            clears bits until it finds a frame that was not referenced
+ *
+ * Fetched pages are handed out as shared pointers, so a page a caller still
+ * holds stays valid after its frame is reused.
+ */
+
+#ifndef BUFFER_POOL_H
+#define BUFFER_POOL_H
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+
+enum class EvictionPolicy { LRU, Clock };
+
+// Page traffic of a file, cumulative or for one query
+struct PageIOStats {
+    size_t requests = 0;    // pages fetched through the pool
+    size_t faults = 0;      // fetches that had to read the file
+    size_t bytesRead = 0;   // bytes read from the file
+
+    size_t hits() const { return requests - faults; }
+    double hitRate() const { return requests ? static_cast<double>(hits()) / requests : 0.0; }
+    PageIOStats& operator+=(const PageIOStats& other);
+};
+
+class BufferPool {
+public:
+    using Page = std::shared_ptr<const std::vector<uint8_t>>;
+
+private:
+    struct Frame {
+        uint64_t pageId = 0;
+        Page data;
+        bool referenced = false;             // Clock reference bit
+        std::list<size_t>::iterator lruPos;  // position in lru (LRU only)
+    };
+
+    int fd = -1;
+    size_t pageSize;
+    size_t capacity;
+    EvictionPolicy policy;
+    uint64_t filePages = 0;
+
+    mutable std::mutex mutex;
+    std::vector<Frame> frames;
+    std::unordered_map<uint64_t, size_t> frameOf;  // page -> frame
+    std::list<size_t> lru;                         // frames, most recently used first
+    size_t hand = 0;                               // Clock hand
+    PageIOStats totals;
+
+    size_t victim(); // frame to reuse, caller holds the mutex
+
+public:
+    // ---------------- Constructors ----------------
+    // capacity = number of frames; 0 disables caching (every fetch reads the file)
+    BufferPool(const std::string& path, size_t pageSize, size_t capacity, EvictionPolicy policy = EvictionPolicy::LRU);
+    ~BufferPool();
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // ---------------- Access (thread-safe) ----------------
+    // Page contents (pageSize bytes); the fetch is also counted in *io if given
+    Page fetch(uint64_t pageId, PageIOStats* io = nullptr);
+
+    // ---------------- Info ----------------
+    size_t getPageSize() const { return pageSize; }
+    size_t getCapacity() const { return capacity; }
+    uint64_t pageCount() const { return filePages; }
+    size_t residentPages() const;
+    PageIOStats stats() const;
+    void resetStats();
+    size_t memoryUsage() const; // frame buffers and the frame table (estimate)
+};
+
+#endif // BUFFER_POOL_H
@@ -0,0 +1,71 @@
+/*
+ * columnarScan.h
+ * ----------------
+ * Defines ColumnarScan, a linear-scan baseline over trajectory summaries stored
+ * as contiguous columns (structure of arrays) instead of Trajectory objects.
+ *
+ * Each trajectory contributes:
+ *   - its bounding box (minX, minY, maxX, maxY, minT, maxT)
+ *   - its centroid (cx, cy, ct)
+ *
+ * Provides:
+ *   - Range query:   boxes intersecting a query box
+ *   - kNN query:     k smallest Trajectory::approximateDistance values (bounded heap)
+ *   - Within query:  approximateDistance <= threshold (candidates for similarity)
+ *
+ * The predicates are evaluated in fixed-size blocks with branch-free loops so the
+ * compiler can vectorize them, optionally split across threads. Results are
+ * indices into the vector the scan was built from; no trajectory is copied.
+ */
+
+#ifndef COLUMNAR_SCAN_H
+#define COLUMNAR_SCAN_H
+
+#include "../include/trajectory.h"
+#include "../include/bbox3D.h"
+#include <vector>
+#include <cstddef>
+#include <limits>
+
+class ColumnarScan {
+private:
+    // Bounding box columns (time stored as double: exact for epoch seconds, vectorizable)
+    std::vector<float> minX, minY, maxX, maxY;
+    std::vector<double> minT, maxT;
+
+    // Centroid columns
+    std::vector<float> centroidX, centroidY;
+    std::vector<double> centroidT;
+
+public:
+    struct DistanceQuery; // Query-side constants of approximateDistance
+
+private:
+    void distances(const DistanceQuery& q, size_t base, size_t count, float* out) const;
+
+public:
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    // ---------------- Constructors ----------------
+    ColumnarScan() = default;
+    explicit ColumnarScan(const std::vector<Trajectory>& trajectories); // Columns in input order
+    explicit ColumnarScan(const std::vector<TrajectorySummary>& summaries); // Same, from precomputed summaries
+
+    size_t size() const { return minX.size(); }
+
+    // ---------------- Queries (numThreads = 0 uses all hardware threads) ----------------
+    std::vector<size_t> rangeQuery(const BoundingBox3D& queryBox, size_t numThreads = 1) const;
+
+    std::vector<size_t> kNearest(const Trajectory& query, size_t k, float timeScale,
+                                 size_t exclude = npos, size_t numThreads = 1) const; // Sorted by distance
+
+    std::vector<size_t> withinDistance(const Trajectory& query, float maxDistance, float timeScale,
+                                       size_t exclude = npos, size_t numThreads = 1) const;
+
+    // Same value as query.approximateDistance(trajectory[i], timeScale)
+    float approximateDistance(const Trajectory& query, size_t i, float timeScale) const;
+
+    size_t memoryUsage() const; // Bytes held by the columns
+};
+
+#endif // COLUMNAR_SCAN_H
@@ -0,0 +1,105 @@
+/*
+ * compressedTrajectory.h
+ * ------------------------
+ * Defines CompressedTrajectory, a compact read-only encoding of a Trajectory's
+ * points, and CompressedTrajectoryStore, which keeps cold trajectories
+ * compressed and a bounded set of hot ones decoded.
+ *
+ * Encoding (per block of kBlockSize points):
+ *   - the block header stores the first point in full (fixed-point x/y, t)
+ *   - timestamps: delta-of-delta, zigzag varint (1 Hz sampling -> 1 byte)
+ *   - x / y: delta of fixed-point coordinates (1e-7 degree units), zigzag varint
+ *
+ * Blocks are independent, so any point can be reached by decoding a single
+ * block. Coordinates round-trip exactly for |value| >= 1 degree (float spacing
+ * is coarser than 1e-7 there); smaller values are accurate to 5e-8 degrees.
+ * The bounding box and centroid are kept uncompressed for pruning.
+ */
+
+#ifndef COMPRESSED_TRAJECTORY_H
+#define COMPRESSED_TRAJECTORY_H
+
+#include "../include/trajectory.h"
+#include "../include/bbox3D.h"
+#include "../include/point3D.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <unordered_map>
+
+class CompressedTrajectory {
+public:
+    static constexpr size_t kBlockSize = 128;    // points per independently decodable block
+    static constexpr double kCoordScale = 1e7;   // fixed-point units per degree
+
+private:
+    struct Block {
+        uint32_t byteOffset;   // start of the block's varint stream in data
+        int64_t x0, y0;        // first point, fixed-point
+        int64_t t0;            // first timestamp
+    };
+
+    std::string id;
+    uint32_t pointCount = 0;
+    BoundingBox3D bbox;
+    float centroidX = 0, centroidY = 0;
+    double centroidT = 0;
+    std::vector<Block> blocks;
+    std::vector<uint8_t> data;
+
+public:
+    // ---------------- Constructors ----------------
+    CompressedTrajectory() = default;
+    explicit CompressedTrajectory(const Trajectory& traj); // Encode all points
+
+    // ---------------- Decoding ----------------
+    void decodeBlock(size_t block, std::vector<Point3D>& out) const; // Append the points of one block
+    std::vector<Point3D> decodePoints() const;                        // All points in order
+    Point3D pointAt(size_t index) const;                              // Decodes only the containing block
+    Trajectory decode() const;                                        // Full Trajectory (centroid/bbox precomputed)
+
+    // ---------------- Accessors ----------------
+    const std::string& getId() const { return id; }
+    size_t size() const { return pointCount; }
+    size_t blockCount() const { return blocks.size(); }
+    const BoundingBox3D& getBoundingBox() const { return bbox; }
+    float getCentroidX() const { return centroidX; }
+    float getCentroidY() const { return centroidY; }
+    double getCentroidT() const { return centroidT; }
+
+    size_t memoryUsage() const; // Heap bytes of the encoded points (block headers + varint stream)
+};
+
+class CompressedTrajectoryStore {
+private:
+    std::vector<CompressedTrajectory> compressed;         // every trajectory, encoded
+    std::unordered_map<std::string, size_t> indexById;
+    size_t hotCapacity;                                   // max decoded trajectories kept
+
+    // Decoded hot set, least recently used at the back
+    mutable std::mutex cacheMutex;
+    mutable std::list<size_t> lru;
+    mutable std::unordered_map<size_t, std::pair<std::shared_ptr<const Trajectory>, std::list<size_t>::iterator>> hot;
+    mutable size_t hits = 0, misses = 0;
+
+public:
+    // ---------------- Constructors ----------------
+    explicit CompressedTrajectoryStore(const std::vector<Trajectory>& trajectories, size_t hotCapacity = 1024);
+
+    // ---------------- Access (thread-safe) ----------------
+    std::shared_ptr<const Trajectory> get(size_t index) const;           // Decoded, cached in the hot set
+    std::shared_ptr<const Trajectory> get(const std::string& id) const;  // nullptr if unknown
+    const CompressedTrajectory& getCompressed(size_t index) const { return compressed[index]; }
+    size_t size() const { return compressed.size(); }
+
+    // ---------------- Stats ----------------
+    size_t compressedBytes() const;  // Encoded point storage of all trajectories
+    size_t hotBytes() const;         // Point storage of the decoded hot set
+    size_t hitCount() const;
+    size_t missCount() const;
+};
+
+#endif // COMPRESSED_TRAJECTORY_H
@@ -0,0 +1,99 @@
+/*
+ * concurrentRTree.h
+ * -------------------
+ * Defines ConcurrentRTree, an R-Tree that serves queries while it is being modified.
+ *
+ * Design:
+ *   - Nodes are immutable once published; each stores its MBR computed at construction,
+ *     so the read path never writes, also while a writer modifies the tree
+ *   - Writers are serialized by a mutex and copy only the root-to-leaf path they change
+ *     (path copying); untouched subtrees are shared between versions
+ *   - The new version is published with an atomic shared_ptr store; readers take a
+ *     Snapshot with an atomic load and never wait for a writer
+ *   - Old versions are reclaimed by reference counting once the last Snapshot using
+ *     them is released
+ *
+ * Removal does not reinsert entries of underfull nodes; empty nodes are dropped and a
+ * single-child root is collapsed.
+ */
+
+#ifndef CONCURRENT_RTREE_H
+#define CONCURRENT_RTREE_H
+
+#include "../include/trajectory.h"
+#include "../include/bbox3D.h"
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+class ConcurrentRTree {
+public:
+    struct Node {
+        bool leaf = true;
+        BoundingBox3D mbr;
+        size_t count = 0;   // trajectories in the subtree
+        std::vector<std::pair<BoundingBox3D, std::shared_ptr<const Node>>> children;      // internal
+        std::vector<std::pair<BoundingBox3D, std::shared_ptr<const Trajectory>>> entries; // leaf
+    };
+
+private:
+    // One published version of the tree
+    struct State {
+        std::shared_ptr<const Node> root;
+        uint64_t version = 0;
+    };
+
+public:
+    // Consistent read-only view; stays valid (and unchanged) while later writes are published
+    class Snapshot {
+    private:
+        std::shared_ptr<const State> state;
+
+    public:
+        explicit Snapshot(std::shared_ptr<const State> s) : state(std::move(s)) {}
+
+        std::vector<std::shared_ptr<const Trajectory>> rangeQuery(const BoundingBox3D& queryBox) const;
+        // Exact kNN by spatioTemporalDistanceTo (query ID excluded), nearest first
+        std::vector<std::shared_ptr<const Trajectory>> kNearestNeighbors(const Trajectory& query, size_t k,
+                                                                         float timeScale = 1e-5f) const;
+        size_t size() const { return state->root ? state->root->count : 0; }
+        uint64_t version() const { return state->version; }
+        int height() const;
+        std::shared_ptr<const Node> getRoot() const { return state->root; }
+    };
+
+private:
+    int maxEntries;
+    std::shared_ptr<const State> current;   // accessed only through std::atomic_load / std::atomic_store
+
+    // Writer side, guarded by writeMutex
+    mutable std::mutex writeMutex;
+    std::unordered_map<std::string, BoundingBox3D> boxById; // locates entries for remove/update
+
+    void publish(std::shared_ptr<const Node> root);              // caller holds writeMutex
+    std::shared_ptr<const Node> insertLocked(std::shared_ptr<const Node> root, const Trajectory& traj);
+    std::shared_ptr<const Node> removeLocked(std::shared_ptr<const Node> root, const std::string& trajId, bool& removed);
+
+public:
+    // ---------------- Constructors ----------------
+    explicit ConcurrentRTree(int maxEntries = 8);
+
+    // ---------------- Reads (lock-free with respect to writers) ----------------
+    Snapshot snapshot() const;
+    std::vector<std::shared_ptr<const Trajectory>> rangeQuery(const BoundingBox3D& queryBox) const;
+    std::vector<std::shared_ptr<const Trajectory>> kNearestNeighbors(const Trajectory& query, size_t k,
+                                                                     float timeScale = 1e-5f) const;
+    size_t size() const;
+
+    // ---------------- Writes (serialized, each publishes one new version) ----------------
+    void insert(const Trajectory& traj);                      // replaces an entry with the same ID
+    void insert(const std::vector<Trajectory>& batch);        // one version for the whole batch
+    bool remove(const std::string& trajId);
+    bool update(const Trajectory& traj);                      // replace by ID; false if it was absent (then inserted)
+    void bulkLoad(std::vector<Trajectory> trajectories);      // STR build, replaces the contents
+};
+
+#endif // CONCURRENT_RTREE_H
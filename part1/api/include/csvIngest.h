@@ -0,0 +1,81 @@
+/*
+ * csvIngest.h
+ * -------------
+ * Native CityTrek-14K ingest: builds the grouped trajectory layout straight from
+ * the raw CSV files, replacing preprocessing/preprocess.py.
+ *
+ * Input:
+ *   - summary CSV:      trip_id, driver_id (strings; other columns ignored)
+ *   - trajectories CSV: trip_id, timestamp ("YYYY-MM-DD HH:MM:SS"), latitude, longitude
+ *
+ * Pipeline:
+ *   - Both files are memory-mapped; the trajectories file is cut into chunks at line
+ *     boundaries and parsed in parallel with a hand-written number / timestamp parser.
+ *   - String IDs map to integers as in preprocess.py: sorted unique values numbered from 1.
+ *   - Rows of trips missing from the summary, or with an empty or malformed timestamp,
+ *     latitude or longitude, are dropped (the script's inner merge and dropna).
+ *   - Rows are grouped by a counting sort on (vehicle, trip) and sorted by time in each trip.
+ *
+ * Output is TrajectoryColumns, which converts to Trajectory objects or writes the
+ * same Parquet layout the script produced (vehicle_id, trip_id, x, y, t and the
+ * per-trip x_min, x_max, y_min, y_max, t_start, t_end), readable by RTree::loadFromParquet.
+ */
+
+#ifndef CSV_INGEST_H
+#define CSV_INGEST_H
+
+#include "../include/trajectory.h"
+#include "../include/point3D.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// Rows of all trips, sorted by (vehicleId, tripId, t); trip i owns rows [tripStart[i], tripStart[i + 1])
+struct TrajectoryColumns {
+    std::vector<int32_t> vehicleId;
+    std::vector<int32_t> tripId;
+    std::vector<float> x;             // longitude
+    std::vector<float> y;             // latitude
+    std::vector<int64_t> t;           // seconds since epoch (UTC)
+    std::vector<size_t> tripStart;    // one entry per trip plus rows() at the end
+
+    size_t rows() const { return t.size(); }
+    size_t trips() const { return tripStart.empty() ? 0 : tripStart.size() - 1; }
+
+    // One Trajectory per trip, IDs "vehicle_trip" as loadFromParquet builds them, caches precomputed
+    std::vector<Trajectory> toTrajectories(size_t numThreads = 0) const;
+    // Writes part.<n>.parquet files of about rowsPerFile rows into directory; a trip never spans two files.
+    // Row groups of rowsPerGroup rows keep LazyParquetStore's on-demand reads small.
+    void writeParquet(const std::string& directory, size_t rowsPerFile = 1 << 20, size_t rowsPerGroup = 1 << 16) const;
+};
+
+struct CsvIngestStats {
+    size_t summaryTrips = 0;
+    size_t vehicles = 0;
+    size_t rowsRead = 0;              // data lines of the trajectories file
+    size_t rowsKept = 0;
+    size_t unknownTripRows = 0;       // trip_id not in the summary
+    size_t malformedRows = 0;         // missing or unparsable timestamp / coordinates
+    PointValidationReport validation; // of the kept rows
+    double mapSeconds = 0.0;          // mmap and summary parsing
+    double parseSeconds = 0.0;        // parallel parse of the trajectories file
+    double groupSeconds = 0.0;        // counting sort into trips
+};
+
+namespace csvIngest {
+
+// numThreads = 0 uses all hardware threads; throws std::runtime_error on unreadable files or missing columns
+TrajectoryColumns load(const std::string& summaryPath, const std::string& trajectoriesPath,
+                       size_t numThreads = 0, CsvIngestStats* stats = nullptr);
+
+// ---------------- Parsers (exposed for tests) ----------------
+// Decimal number with optional sign, fraction and exponent; false on anything else.
+// Correctly rounded to double (fast exact path, strtod otherwise).
+bool parseDouble(const char* begin, const char* end, double& out);
+// "YYYY-MM-DD HH:MM:SS" (or 'T' separator) as UTC seconds since epoch; false if malformed
+bool parseTimestamp(const char* begin, const char* end, int64_t& out);
+
+} // namespace csvIngest
+
+#endif // CSV_INGEST_H
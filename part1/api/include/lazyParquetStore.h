@@ -0,0 +1,152 @@
+/*
+ * lazyParquetStore.h
+ * --------------------
+ * Defines LazyParquetStore, a read-only view of a grouped trajectory Parquet
+ * directory (preprocess.py or ./ingest output) that loads points only when a
+ * query needs them.
+ *
+ * Opening reads, per file:
+ *   - the footer: row groups and the min/max statistics of the per-trip box
+ *     columns (x_min, x_max, y_min, y_max, t_start, t_end);
+ *   - the vehicle_id, trip_id and box columns of every row group whose
+ *     statistics intersect the optional region; other row groups are skipped.
+ * Each trip becomes one entry (ID, box, file, row range), indexed by a
+ * ColumnarScan over the boxes. The x, y, t columns are not touched.
+ *
+ * A query finds candidate trips in the index, then decodes the missing ones:
+ * their row ranges select the row groups to read (each needed row group is read
+ * once per query, x, y, t only) and the rows to keep. Decoded trajectories go
+ * to an LRU cache bounded by a point budget, so memory follows the working set.
+ *
+ * Rows of a trip must be contiguous in its file, as both writers produce them;
+ * like RTree::loadFromParquet, a trip split over two files gives two entries.
+ */
+
+#ifndef LAZY_PARQUET_STORE_H
+#define LAZY_PARQUET_STORE_H
+
+#include "../include/columnarScan.h"
+#include "../include/trajectory.h"
+#include "../include/bbox3D.h"
+#include "../include/point3D.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <list>
+#include <optional>
+#include <unordered_map>
+#include <cstdint>
+
+namespace parquet { namespace arrow { class FileReader; } }
+
+struct LazyParquetOptions {
+    size_t cachePoints = 4000000;          // decoded points kept in the cache; 0 disables caching
+    std::optional<BoundingBox3D> region;   // index only trips intersecting it (row groups pruned by statistics)
+};
+
+// Work done since opening (or resetStats), or by one query
+struct LazyStoreStats {
+    size_t rowGroupsRead = 0;       // row groups decoded for point data
+    size_t rowsDecoded = 0;         // rows of those row groups
+    size_t trajectoriesLoaded = 0;  // trips decoded
+    size_t cacheHits = 0;
+    size_t cacheMisses = 0;
+
+    double hitRate() const {
+        size_t n = cacheHits + cacheMisses;
+        return n ? static_cast<double>(cacheHits) / n : 0.0;
+    }
+    LazyStoreStats& operator+=(const LazyStoreStats& other);
+};
+
+class LazyParquetStore {
+public:
+    using TrajectoryPtr = std::shared_ptr<const Trajectory>;
+
+private:
+    struct RowGroupInfo {
+        uint64_t firstRow;
+        uint64_t rows;
+        BoundingBox3D box;          // from the box column statistics
+        bool hasStats;
+    };
+
+    struct File {
+        std::string path;
+        std::unique_ptr<parquet::arrow::FileReader> reader;
+        std::mutex mutex;           // a FileReader serves one read at a time
+        std::vector<RowGroupInfo> rowGroups;
+        std::vector<int> pointColumns; // x, y, t
+    };
+
+    struct TripRef {
+        std::string id;             // "vehicle_trip", as loadFromParquet
+        BoundingBox3D bbox;
+        uint32_t file;
+        uint32_t rows;
+        uint64_t firstRow;
+    };
+
+    struct CacheEntry {
+        TrajectoryPtr trajectory;
+        std::list<size_t>::iterator lruPos;
+    };
+
+    std::vector<std::unique_ptr<File>> files;
+    std::vector<TripRef> trips;
+    ColumnarScan index;
+
+    size_t cacheCapacity;
+    size_t rowGroupsTotal = 0;
+    size_t rowGroupsPruned = 0;
+    double openSeconds = 0.0;
+
+    mutable std::mutex cacheMutex;
+    mutable std::unordered_map<size_t, CacheEntry> cache;   // trip -> decoded trajectory
+    mutable std::list<size_t> lru;                          // trips, most recently used first
+    mutable size_t cachedPointCount = 0;
+    mutable LazyStoreStats totals;
+    mutable PointValidationReport validation;
+
+    void openFile(const std::string& path, const LazyParquetOptions& options);
+    // Decodes the given trips (not cached), reading each needed row group once
+    std::vector<TrajectoryPtr> decode(const std::vector<size_t>& tripIndices, LazyStoreStats& io) const;
+    void remember(size_t trip, const TrajectoryPtr& trajectory) const; // caller holds cacheMutex
+
+public:
+    // ---------------- Constructors ----------------
+    // Opens every .parquet file of directory (or the single file it names); throws std::runtime_error
+    // on unreadable files or missing columns
+    explicit LazyParquetStore(const std::string& path, const LazyParquetOptions& options = {});
+    ~LazyParquetStore();
+    LazyParquetStore(const LazyParquetStore&) = delete;
+    LazyParquetStore& operator=(const LazyParquetStore&) = delete;
+
+    // ---------------- Queries (thread-safe) ----------------
+    // Same matches as RTree::rangeQuery (trajectory box intersects queryBox), points loaded on demand
+    std::vector<TrajectoryPtr> rangeQuery(const BoundingBox3D& queryBox, LazyStoreStats* io = nullptr) const;
+    size_t rangeCount(const BoundingBox3D& queryBox) const;                   // index only, nothing decoded
+    std::vector<size_t> candidates(const BoundingBox3D& queryBox) const;     // trip indices, index only
+    std::vector<TrajectoryPtr> fetch(const std::vector<size_t>& tripIndices, LazyStoreStats* io = nullptr) const;
+    TrajectoryPtr get(size_t trip, LazyStoreStats* io = nullptr) const;
+
+    // ---------------- Info ----------------
+    size_t size() const { return trips.size(); }
+    const std::string& idOf(size_t trip) const { return trips[trip].id; }
+    const BoundingBox3D& boxOf(size_t trip) const { return trips[trip].bbox; }
+    size_t fileCount() const { return files.size(); }
+    size_t rowGroupCount() const { return rowGroupsTotal; }
+    size_t prunedRowGroupCount() const { return rowGroupsPruned; } // skipped at open by their statistics
+    double openTime() const { return openSeconds; }
+
+    LazyStoreStats stats() const;
+    void resetStats();
+    PointValidationReport validationReport() const; // of the points decoded so far
+    size_t cachedPoints() const;
+    size_t cachedTrajectories() const;
+    void clearCache();
+    size_t memoryUsage() const; // index, trip table and cached points (estimate)
+};
+
+#endif // LAZY_PARQUET_STORE_H
@@ -0,0 +1,52 @@
+/*
+ * nodeAggregate.h
+ * -----------------
+ * Defines the per-node summaries used by aggregate range queries:
+ *   - HyperLogLog: fixed-size distinct-count sketch (vehicle IDs)
+ *   - NodeAggregate: trajectory count, point count, total length and duration,
+ *     plus a HyperLogLog of the vehicles in the subtree
+ *
+ * Aggregates of two subtrees are merged by adding the sums and taking the
+ * register-wise maximum of the sketches, so a parent's aggregate is built
+ * from its children's without touching the trajectories.
+ */
+
+#ifndef NODE_AGGREGATE_H
+#define NODE_AGGREGATE_H
+
+#include "../include/trajectory.h"
+#include <array>
+#include <string>
+#include <cstdint>
+
+class HyperLogLog {
+public:
+    static constexpr int kPrecision = 8;                 // 2^8 registers, ~6.5% standard error
+    static constexpr size_t kRegisters = size_t(1) << kPrecision;
+
+private:
+    std::array<uint8_t, kRegisters> registers{};
+
+public:
+    void add(const std::string& key);
+    void merge(const HyperLogLog& other);
+    double estimate() const;
+    void clear() { registers.fill(0); }
+};
+
+struct NodeAggregate {
+    size_t count = 0;           // trajectories
+    size_t points = 0;
+    double totalLength = 0.0;   // sum of Trajectory::length()
+    double totalDuration = 0.0; // seconds, sum of Trajectory::duration()
+    HyperLogLog vehicles;       // distinct vehicle IDs ("vehicle_trip" prefix)
+
+    void add(const Trajectory& traj);
+    void merge(const NodeAggregate& other);
+    void clear() { *this = NodeAggregate(); }
+};
+
+// Vehicle part of a "vehicle_trip" trajectory ID (the whole ID if there is no '_')
+std::string vehicleIdOf(const std::string& trajId);
+
+#endif // NODE_AGGREGATE_H
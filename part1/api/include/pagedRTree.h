@@ -0,0 +1,120 @@
+/*
+ * pagedRTree.h
+ * --------------
+ * Defines PagedRTree, a read-only disk-backed R-Tree for data sets that do not
+ * fit in memory.
+ *
+ * PagedRTree::create writes two files next to each other:
+ *   - <base>.idx:  page 0 is a header, every other page is one node holding as
+ *                  many (box, reference) entries as fit; leaves reference heap
+ *                  records, internal nodes reference child pages. Nodes are
+ *                  packed bottom-up with 3D sort-tile-recursive (x, y, t).
+ *   - <base>.heap: the trajectories (ID and points) in leaf order, so the
+ *                  trajectories of one leaf share heap pages. A record starts
+ *                  on a fresh page when it does not fit in the current one and
+ *                  spans consecutive pages when it is longer than a page.
+ *
+ * An opened tree keeps only the header in memory. Node pages and heap pages go
+ * through two BufferPools of configurable size; trajectory points are read only
+ * when a query needs them (rangeQuery materializes matches, snapshotQuery
+ * interpolates positions), rangeCount never touches the heap.
+ *
+ * Files use the native byte order and are not portable between machines.
+ */
+
+#ifndef PAGED_RTREE_H
+#define PAGED_RTREE_H
+
+#include "../include/bufferPool.h"
+#include "../include/bbox3D.h"
+#include "../include/trajectory.h"
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+
+struct PagedRTreeOptions {
+    size_t indexPoolPages = 256;    // frames caching node pages
+    size_t heapPoolPages = 1024;    // frames caching trajectory heap pages
+    EvictionPolicy policy = EvictionPolicy::LRU;
+};
+
+// Work done by one query
+struct PagedQueryStats {
+    PageIOStats index;              // node pages
+    PageIOStats heap;               // trajectory heap pages
+    size_t nodesVisited = 0;
+    size_t payloadsLoaded = 0;      // trajectories read from the heap
+
+    size_t pageFaults() const { return index.faults + heap.faults; }
+    size_t bytesRead() const { return index.bytesRead + heap.bytesRead; }
+};
+
+// Interpolated position of one trajectory in a paged snapshot query
+struct PagedSnapshotPosition {
+    std::string id;
+    float x;
+    float y;
+};
+
+class PagedRTree {
+public:
+    static constexpr size_t kDefaultPageSize = 4096;
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t pageSize;
+        uint32_t fanout;            // entries per node page
+        uint32_t height;            // levels, 0 for an empty tree
+        uint32_t reserved;
+        uint64_t rootPage;
+        uint64_t nodePages;
+        uint64_t heapPages;
+        uint64_t trajectoryCount;
+        float minX, minY, maxX, maxY;
+        int64_t minT, maxT;
+    };
+
+    Header header;
+    std::unique_ptr<BufferPool> indexPool;
+    std::unique_ptr<BufferPool> heapPool;
+
+    // Heap offsets of the leaf entries intersecting queryBox
+    void search(const BoundingBox3D& queryBox, std::vector<uint64_t>& refs, PagedQueryStats& io) const;
+    Trajectory loadTrajectory(uint64_t ref, PagedQueryStats& io) const;
+
+public:
+    // ---------------- Construction ----------------
+    // Writes <basePath>.idx and <basePath>.heap; throws if the page size cannot hold two entries
+    static void create(const std::string& basePath, const std::vector<Trajectory>& trajectories,
+                       size_t pageSize = kDefaultPageSize);
+
+    // Opens files written by create
+    explicit PagedRTree(const std::string& basePath, const PagedRTreeOptions& options = {});
+
+    // ---------------- Queries (thread-safe) ----------------
+    // Same matches as RTree::rangeQuery (trajectory box intersects queryBox), read from the heap
+    std::vector<Trajectory> rangeQuery(const BoundingBox3D& queryBox, PagedQueryStats* io = nullptr) const;
+    size_t rangeCount(const BoundingBox3D& queryBox, PagedQueryStats* io = nullptr) const; // index pages only
+    // Same positions as RTree::snapshotQuery
+    std::vector<PagedSnapshotPosition> snapshotQuery(const BoundingBox3D& area, int64_t t,
+                                                     PagedQueryStats* io = nullptr) const;
+
+    // ---------------- Info ----------------
+    size_t size() const { return header.trajectoryCount; }
+    size_t getHeight() const { return header.height; }
+    size_t getPageSize() const { return header.pageSize; }
+    size_t getFanout() const { return header.fanout; }
+    size_t nodePageCount() const { return header.nodePages; }
+    size_t heapPageCount() const { return header.heapPages; }
+    BoundingBox3D getRootBox() const;
+
+    // Cumulative traffic since opening or the last resetStats
+    PageIOStats indexStats() const { return indexPool->stats(); }
+    PageIOStats heapStats() const { return heapPool->stats(); }
+    void resetStats();
+    size_t memoryUsage() const; // buffer pools and header
+};
+
+#endif // PAGED_RTREE_H
@@ -0,0 +1,73 @@
+/*
+ * parallel.h
+ * ------------
+ * Minimal helpers for splitting index ranges across std::thread workers.
+ *
+ * Provides:
+ *   - resolveThreadCount: maps 0 to the hardware concurrency
+ *   - parallelFor: runs body(begin, end, threadIndex) on contiguous chunks
+ *   - parallelForDynamic: runs body(i, threadIndex) with workers pulling indices
+ *     from a shared counter (for tasks of uneven cost)
+ *
+ * Header-only; intended for read-only data parallel passes (scans, summaries).
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <atomic>
+
+namespace parallel {
+
+// Number of workers to use (0 = one per hardware thread)
+inline size_t resolveThreadCount(size_t requested) {
+    if (requested > 0) return requested;
+    size_t hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+// Split [0, n) into at most numThreads contiguous chunks and run body on each.
+// The calling thread executes the first chunk itself.
+template <typename Func>
+void parallelFor(size_t n, size_t numThreads, Func&& body) {
+    numThreads = std::min(resolveThreadCount(numThreads), std::max<size_t>(n, 1));
+    if (numThreads <= 1) {
+        body(size_t(0), n, size_t(0));
+        return;
+    }
+
+    size_t chunk = (n + numThreads - 1) / numThreads;
+    std::vector<std::thread> workers;
+    workers.reserve(numThreads - 1);
+    for (size_t t = 1; t < numThreads; ++t) {
+        size_t begin = std::min(n, t * chunk);
+        size_t end = std::min(n, begin + chunk);
+        workers.emplace_back([&body, begin, end, t]() { body(begin, end, t); });
+    }
+    body(size_t(0), std::min(n, chunk), size_t(0));
+    for (auto& w : workers) w.join();
+}
+
+// Run body(i, threadIndex) for every i in [0, n); idle workers take the next index.
+template <typename Func>
+void parallelForDynamic(size_t n, size_t numThreads, Func&& body) {
+    numThreads = std::min(resolveThreadCount(numThreads), std::max<size_t>(n, 1));
+    std::atomic<size_t> next{0};
+    auto worker = [&](size_t t) {
+        for (size_t i = next.fetch_add(1); i < n; i = next.fetch_add(1)) body(i, t);
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(numThreads - 1);
+    for (size_t t = 1; t < numThreads; ++t) workers.emplace_back(worker, t);
+    worker(0);
+    for (auto& w : workers) w.join();
+}
+
+} // namespace parallel
+
+#endif // PARALLEL_H
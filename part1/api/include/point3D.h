@@ -7,10 +7,12 @@
  * - t: timestamp in ISO 8601 format
  *
  * Provides:
- * - Constructors (default, parameterized, copy, move)
- * - Assignment operators (copy and move)
+ * - Constructors (default, parameterized); copy and move are the implicit ones,
+ *   so Point3D is trivially copyable and point vectors copy as raw memory
  * - Accessors for x, y, t
- * - Utilities: printing, JSON conversion, validation
+ * - Utilities: printing, JSON conversion
+ * - Batch validation: constructing a point never checks it; loaders validate
+ *   whole batches and report the anomaly counts once
  * - Comparison operators (==, !=)
  * - Distance calculations (Euclidean distance)
  *
@@ -24,28 +26,35 @@
 #include <iostream>
 #include <cmath>
 #include <cstdint>           
+#include <cstddef>
+#include <vector>
+#include <type_traits>
 #include "../../json.hpp"
 
 using json = nlohmann::json;
 
+// Anomalies found by Point3D::validate over a batch of points
+struct PointValidationReport {
+    size_t points = 0;
+    size_t latitudeOutOfRange = 0;
+    size_t longitudeOutOfRange = 0;
+    size_t zeroTimestamps = 0;
+    size_t invalidPoints = 0;     // points with at least one anomaly
+
+    PointValidationReport& operator+=(const PointValidationReport& other);
+    void print(std::ostream& os, const std::string& source) const; // one warning line with the counts
+};
+
 class Point3D {
 private:
     float x;          // Longitude 
     float y;          // Latitude
     int64_t t;        // Timestamp (as int64_t)
 
-    void validate() const;      // Validates latitude, longitude, timestamp
-
 public:
     // -------------------- Constructors --------------------
     Point3D();                                            // Default constructor (0,0,0)
-    Point3D(float x, float y, int64_t t);                // Parameterized constructor
-    Point3D(const Point3D& other);                       // Copy constructor
-    Point3D(Point3D&& other) noexcept;                   // Move constructor
-
-    // -------------------- Assignment --------------------
-    Point3D& operator=(const Point3D& other);            // Copy assignment
-    Point3D& operator=(Point3D&& other) noexcept;        // Move assignment
+    Point3D(float x, float y, int64_t t);                // Parameterized constructor (not validated)
 
     // -------------------- Accessors --------------------
     float getX() const;
@@ -56,6 +65,11 @@ public:
     void print() const;         // Prints the point to stdout
     json to_json() const;       // Converts point to JSON
 
+    // -------------------- Validation --------------------
+    bool isValid() const;       // Latitude and longitude in range, non-zero timestamp
+    static PointValidationReport validate(const Point3D* points, size_t count);
+    static PointValidationReport validate(const std::vector<Point3D>& points) { return validate(points.data(), points.size()); }
+
     // -------------------- Comparison --------------------
     bool operator==(const Point3D& other) const;
     bool operator!=(const Point3D& other) const;
@@ -65,4 +79,6 @@ public:
     float distanceSquaredTo(const Point3D& other) const;    // Squared distance (faster)
 };
 
+static_assert(std::is_trivially_copyable<Point3D>::value, "Point3D vectors are copied as raw memory");
+
 #endif // POINT3D_H
@@ -0,0 +1,75 @@
+/*
+ * quantizedRTree.h
+ * ------------------
+ * Defines QuantizedRTree, a compact read-only snapshot of an RTree used for
+ * range queries.
+ *
+ * Each node stores its own MBR once (the "frame") and every child box as
+ * 8- or 16-bit integer offsets inside that frame:
+ *   - minimum codes are rounded down, maximum codes up, so a quantized box
+ *     always contains the exact box (no false negatives)
+ *   - the query box is quantized into the same frame and compared in the
+ *     integer domain with a branch-free loop the compiler vectorizes
+ *   - leaf hits are rechecked against the exact trajectory bounding box
+ *
+ * Node entries cost 6 codes + a 32-bit reference instead of a
+ * BoundingBox3D + shared_ptr pair (10 or 16 bytes instead of 48). Nodes are
+ * laid out breadth-first in flat arrays, and the code block of each node is
+ * padded to a multiple of 8 entries (one vector compare).
+ *
+ * The snapshot shares the trajectories with the source tree; it does not see
+ * later modifications and must be rebuilt after the tree changes.
+ */
+
+#ifndef QUANTIZED_RTREE_H
+#define QUANTIZED_RTREE_H
+
+#include "../include/bbox3D.h"
+#include "../include/trajectory.h"
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+class RTreeNode;
+
+class QuantizedRTree {
+private:
+    struct Node {
+        float originX, originY;      // frame minimum (node MBR)
+        int64_t originT;
+        float stepX, stepY, stepT;   // frame extent per code unit
+        uint32_t firstEntry;         // first slot in the entry arrays
+        uint32_t count;              // number of entries
+        bool leaf;
+    };
+
+    int codeBits;                            // 8 or 16
+    std::vector<Node> nodes;                 // breadth-first, nodes[0] is the root
+    std::vector<uint8_t> codes8;             // used when codeBits == 8
+    std::vector<uint16_t> codes16;           // used when codeBits == 16
+    std::vector<uint32_t> refs;              // child node index or trajectory index per slot
+    std::vector<std::shared_ptr<Trajectory>> trajectories;
+    BoundingBox3D rootBox;                   // exact MBR of the whole tree
+
+    template <typename Code>
+    void build(const std::shared_ptr<RTreeNode>& root, std::vector<Code>& codes);
+
+    template <typename Code>
+    void search(const BoundingBox3D& queryBox, const std::vector<Code>& codes,
+                std::vector<std::shared_ptr<Trajectory>>& results) const;
+
+public:
+    // ---------------- Constructors ----------------
+    QuantizedRTree(const std::shared_ptr<RTreeNode>& root, int bits = 8); // bits: 8 or 16
+
+    // ---------------- Queries ----------------
+    std::vector<std::shared_ptr<Trajectory>> rangeQuery(const BoundingBox3D& queryBox) const;
+
+    // ---------------- Info ----------------
+    int bits() const { return codeBits; }
+    size_t nodeCount() const { return nodes.size(); }
+    size_t trajectoryCount() const { return trajectories.size(); }
+    size_t memoryUsage() const; // Bytes held by node frames, codes, references and trajectory handles
+};
+
+#endif // QUANTIZED_RTREE_H
@@ -0,0 +1,71 @@
+/*
+ * queryControl.h
+ * ----------------
+ * Cancellation and deadlines for long-running queries.
+ *
+ *   - CancellationToken: a shared flag; copies refer to the same flag, so the caller
+ *     keeps one copy and cancels it while a query holds another.
+ *   - QueryControl: a token plus an optional deadline, passed to the controlled and
+ *     async query variants of RTree.
+ *   - QueryGuard: used inside a traversal; reads the token on every step and the
+ *     clock every kClockInterval steps, and remembers why it stopped.
+ *   - PartialResult<T>: what a controlled query returns, complete or cut off.
+ */
+
+#ifndef QUERY_CONTROL_H
+#define QUERY_CONTROL_H
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <cstddef>
+
+class CancellationToken {
+private:
+    std::shared_ptr<std::atomic<bool>> flag;
+
+public:
+    CancellationToken() : flag(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() const { flag->store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return flag->load(std::memory_order_relaxed); }
+};
+
+enum class QueryStopReason { None, Cancelled, DeadlineExceeded };
+
+struct QueryControl {
+    using Clock = std::chrono::steady_clock;
+
+    CancellationToken token;
+    Clock::time_point deadline = Clock::time_point::max(); // max = no deadline
+
+    // Deadline `seconds` from now; <= 0 (or -inf) is already expired, +inf, NaN or a span past the clock's range is none
+    static QueryControl withTimeout(double seconds, CancellationToken token = {});
+};
+
+class QueryGuard {
+private:
+    static constexpr size_t kClockInterval = 32;
+
+    const QueryControl& control;
+    size_t steps = 0;
+    QueryStopReason reason = QueryStopReason::None;
+
+public:
+    explicit QueryGuard(const QueryControl& control) : control(control) {}
+
+    // One unit of work (a node or a refinement); true once the query must stop
+    bool stop();
+    QueryStopReason stopReason() const { return reason; }
+};
+
+template <typename T>
+struct PartialResult {
+    T results;                    // everything found before the query stopped
+    bool complete = true;         // false if cancelled or past the deadline
+    QueryStopReason stopReason = QueryStopReason::None;
+    size_t nodesVisited = 0;
+    size_t refinements = 0;       // exact distance evaluations (similarity search)
+};
+
+#endif // QUERY_CONTROL_H
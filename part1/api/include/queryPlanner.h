@@ -0,0 +1,131 @@
+/*
+ * queryPlanner.h
+ * ----------------
+ * Defines a cost-based planner that picks how a range query is executed:
+ *   - IndexTraversal: RTree::rangeQuery
+ *   - ColumnarScan:   vectorized linear scan over trajectory boxes
+ *   - TimeIndex:      RTree::temporalRangeQuery; candidates are the trajectories whose
+ *                     time span meets the window, then tested spatially
+ *
+ * Selectivity is estimated from SelectivityHistograms (spatial grid x time buckets):
+ * one over trajectory boxes (result size, and TimeIndex candidates as the result of the
+ * same window without its spatial bounds) and one over leaf MBRs (leaves an index
+ * traversal reaches).
+ * Costs are per-entry constants that calibrate() fits from measured timings.
+ *
+ * Every execute() appends the estimate, the actual cardinality and the elapsed time
+ * to a calibration log (thread-safe), which can be saved as CSV.
+ *
+ * The planner is a snapshot: rebuild it after the tree is modified.
+ */
+
+#ifndef QUERY_PLANNER_H
+#define QUERY_PLANNER_H
+
+#include "../include/RTree.h"
+#include "../include/columnarScan.h"
+#include <vector>
+#include <string>
+#include <mutex>
+#include <cstdint>
+
+// Box counts on a cellsX x cellsY x buckets grid over the data extent. A box is counted in the
+// cell holding its center; each cell also keeps the mean half-extent of its boxes, so a query
+// is estimated as sum(count * overlap of (query grown by the half-extents) with the cell).
+class SelectivityHistogram {
+private:
+    double minX = 0.0, minY = 0.0, minT = 0.0;
+    double cellW = 0.0, cellH = 0.0, cellT = 0.0;
+    size_t cellsX = 0, cellsY = 0, buckets = 0;
+    size_t total = 0;
+    std::vector<uint32_t> counts;            // index (bucket * cellsY + y) * cellsX + x
+    std::vector<float> halfX, halfY, halfT;  // mean half-extents per cell
+    double maxHalfX = 0.0, maxHalfY = 0.0, maxHalfT = 0.0;
+
+public:
+    SelectivityHistogram() = default;
+    SelectivityHistogram(const std::vector<BoundingBox3D>& boxes, size_t cellsX, size_t cellsY, size_t buckets);
+
+    double estimate(const BoundingBox3D& query) const; // expected number of intersecting boxes
+    size_t size() const { return total; }
+    size_t memoryUsage() const;                        // bytes held by the cells
+};
+
+// Cost per entry examined (seconds once calibrated)
+struct PlannerCosts {
+    double indexEntry = 60e-9;     // box test inside an RTree node (pointer chasing)
+    double scanEntry = 6e-9;       // vectorized box test in the columnar scan
+    double timeCandidate = 20e-9;  // full box test of one time-index candidate
+};
+
+struct PlannerOptions {
+    size_t cellsX = 16;
+    size_t cellsY = 16;
+    size_t timeBuckets = 32;
+    PlannerCosts costs;
+};
+
+class QueryPlanner {
+public:
+    enum class Strategy { IndexTraversal, ColumnarScan, TimeIndex };
+    static constexpr size_t kStrategies = 3;
+
+    struct Plan {
+        Strategy strategy = Strategy::IndexTraversal;
+        double estimatedRows = 0.0;
+        double estimatedLeaves = 0.0;      // leaves an index traversal is expected to reach
+        double timeCandidates = 0.0;       // estimated TimeIndex candidates
+        double entries[kStrategies] = {};  // estimated entries examined by each strategy
+        double cost[kStrategies] = {};     // entries * per-entry cost
+    };
+
+    struct LogEntry {
+        BoundingBox3D query;
+        Strategy strategy;
+        double estimatedRows;
+        size_t actualRows;
+        double estimatedCost;
+        double seconds;
+    };
+
+private:
+    const RTree& tree;
+    const std::vector<Trajectory>& trajectories; // the trajectories indexed by tree
+    PlannerCosts costs;
+
+    SelectivityHistogram rows;         // over trajectory boxes
+    SelectivityHistogram leaves;       // over leaf MBRs
+    double entriesPerLeaf = 0.0;       // box tests per reached leaf, including its share of internal nodes
+
+    ColumnarScan scan;
+
+    mutable std::mutex logMutex;
+    mutable std::vector<LogEntry> planLog;
+
+public:
+    // ---------------- Constructors ----------------
+    // trajectories must be what tree indexes and must outlive the planner
+    QueryPlanner(const RTree& tree, const std::vector<Trajectory>& trajectories, const PlannerOptions& options = {});
+
+    // ---------------- Planning and execution ----------------
+    Plan plan(const BoundingBox3D& query) const;
+    // Runs the planned strategy and logs it; pointers refer to the tree or to trajectories
+    std::vector<const Trajectory*> execute(const BoundingBox3D& query) const;
+    // Runs the given strategy (not logged)
+    std::vector<const Trajectory*> executeWith(Strategy strategy, const BoundingBox3D& query) const;
+
+    // Runs every strategy on the sample and sets each cost constant to measured time / estimated entries
+    void calibrate(const std::vector<BoundingBox3D>& sample);
+    const PlannerCosts& getCosts() const { return costs; }
+
+    // ---------------- Calibration log ----------------
+    std::vector<LogEntry> calibrationLog() const;
+    void clearCalibrationLog();
+    void saveCalibrationLog(const std::string& filename) const; // CSV, one row per execute()
+    double meanQError() const;   // mean of max(est, actual) / min(est, actual), both floored at 1
+
+    static const char* strategyName(Strategy strategy);
+    size_t memoryUsage() const;  // histograms and scan columns
+};
+
+#endif // QUERY_PLANNER_H
@@ -0,0 +1,92 @@
+/*
+ * shardedRTree.h
+ * ----------------
+ * Defines ShardedRTree, a set of independent RTrees (shards) answering one
+ * query together on a ThreadPool.
+ *
+ * Partitioning (chosen at construction):
+ *   - SpatialTiles: 2D sort-tile-recursive tiles over trajectory centroids, so
+ *     narrow queries touch few shards; inserts go to the shard whose box is
+ *     nearest (the smaller shard on ties)
+ *   - VehicleHash: hash of the vehicle ID (see vehicleIdOf), so every shard
+ *     spans the whole map and the load of any query is spread evenly
+ *
+ * Queries (scatter-gather):
+ *   - range / similarity: every shard whose box can hold a match is searched
+ *     as one task; the calling thread runs one of them itself
+ *   - kNN: shards are ordered by the spatial distance of their box to the query;
+ *     they are searched in waves of pool size and a wave only includes shards
+ *     whose bound is below the current global k-th distance, so far shards are
+ *     skipped; results are merged into one top-k
+ *
+ * Each shard is searched by one thread per query. As with RTree, queries must
+ * not overlap modifications.
+ */
+
+#ifndef SHARDED_RTREE_H
+#define SHARDED_RTREE_H
+
+#include "../include/RTree.h"
+#include "../include/threadPool.h"
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+enum class ShardingScheme { SpatialTiles, VehicleHash };
+
+// Global kNN answer; distances are squared, as returned by spatioTemporalDistanceTo
+struct ShardedKNNResult {
+    std::vector<std::shared_ptr<Trajectory>> trajectories; // nearest first
+    std::vector<float> distances;
+    size_t shardsSearched = 0;
+    size_t shardsPruned = 0;    // skipped because their bound exceeded the k-th distance
+};
+
+class ShardedRTree {
+private:
+    ShardingScheme scheme;
+    int maxEntries;
+    std::vector<std::unique_ptr<RTree>> shards;
+    std::vector<size_t> shardSizes;
+    std::vector<BoundingBox3D> boxes;                     // root MBR per shard, refreshed after changes
+    std::unordered_map<std::string, uint32_t> shardOf;   // trajectory ID -> shard
+    mutable ThreadPool pool;
+
+    uint32_t route(const Trajectory& traj) const;          // shard for a new trajectory
+    void refreshBox(size_t shard);
+
+    // Runs task(shard) for every listed shard, one of them on the calling thread
+    template <typename Result, typename Func>
+    std::vector<Result> scatter(const std::vector<size_t>& targets, Func task) const;
+
+public:
+    // ---------------- Constructors ----------------
+    // numThreads = 0 uses all hardware threads
+    explicit ShardedRTree(size_t shardCount, ShardingScheme scheme = ShardingScheme::SpatialTiles,
+                          size_t numThreads = 0, int maxEntries = 8);
+
+    // ---------------- Data modification ----------------
+    void bulkLoad(std::vector<Trajectory>& trajectories); // partitions, then builds the shards in parallel
+    void insert(const Trajectory& traj);
+    bool remove(const std::string& trajId);
+    bool update(const Trajectory& traj);                  // in its current shard; inserted if absent, as RTree::update
+
+    // ---------------- Queries ----------------
+    std::vector<Trajectory> rangeQuery(const BoundingBox3D& queryBox) const;
+    void rangeQuery(const BoundingBox3D& queryBox, std::vector<const Trajectory*>& results) const; // no copies
+    // Exact kNN (query ID excluded) by spatioTemporalDistanceTo, as RTree::approximateKNearestNeighbors
+    // with default options
+    ShardedKNNResult kNearestNeighbors(const Trajectory& query, size_t k, float timeScale = 1e-5f) const;
+    std::vector<Trajectory> findSimilar(const Trajectory& query, float maxDistance) const;
+
+    // ---------------- Info ----------------
+    size_t size() const { return shardOf.size(); }
+    size_t shardCount() const { return shards.size(); }
+    size_t shardSize(size_t shard) const { return shardSizes[shard]; }
+    const RTree& getShard(size_t shard) const { return *shards[shard]; }
+    ShardingScheme getScheme() const { return scheme; }
+    size_t threadCount() const { return pool.size(); }
+};
+
+#endif // SHARDED_RTREE_H
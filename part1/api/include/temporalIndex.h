@@ -0,0 +1,88 @@
+/*
+ * temporalIndex.h
+ * -----------------
+ * Defines TemporalIndex, a secondary index over trajectory time spans [minT, maxT]
+ * kept next to the RTree for predicates that constrain only time.
+ *
+ * Structure:
+ *   - A static centered interval tree, stored in flat arrays: each node holds the
+ *     spans containing its center twice, sorted by minT ascending and by maxT
+ *     descending; spans entirely before / after the center go left / right.
+ *     A window query costs O(log n + k).
+ *   - Entries added since the last build form a delta run that queries scan linearly.
+ *   - Removed entries are tombstoned and skipped.
+ *   - The static part is rebuilt once the delta exceeds ~4 sqrt(n) entries or the
+ *     tombstones exceed a quarter of the live entries.
+ *
+ * Entries share the RTree's Trajectory objects; nothing is copied.
+ */
+
+#ifndef TEMPORAL_INDEX_H
+#define TEMPORAL_INDEX_H
+
+#include "../include/trajectory.h"
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+class TemporalIndex {
+private:
+    struct Entry {
+        int64_t minT;
+        int64_t maxT;
+        std::shared_ptr<Trajectory> traj;
+        bool live;
+    };
+
+    // Centered interval tree node; [begin, end) indexes byLow and byHigh
+    struct Node {
+        int64_t center;
+        uint32_t begin, end;
+        int32_t left, right;   // -1 = none
+    };
+
+    std::vector<Entry> entries;        // slot -> entry; slots >= built form the delta run
+    size_t built = 0;                  // entries covered by the static tree
+    size_t liveCount = 0;
+    size_t tombstones = 0;
+    std::unordered_multimap<std::string, uint32_t> slotsById;
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> byLow;       // per node: slots by minT ascending
+    std::vector<uint32_t> byHigh;      // per node: slots by maxT descending
+
+    int32_t buildNode(std::vector<uint32_t>& slots);
+    void rebuild();                    // compacts tombstones and indexes every live entry statically
+    void maybeRebuild();
+    void kill(uint32_t slot);
+
+public:
+    // ---------------- Construction ----------------
+    TemporalIndex() = default;
+    void build(const std::vector<std::shared_ptr<Trajectory>>& trajectories); // replaces the contents
+    void clear();
+
+    // ---------------- Modification ----------------
+    void insert(const std::shared_ptr<Trajectory>& traj);
+    bool remove(const std::string& trajId);  // one entry with this ID
+    bool refresh(const std::string& trajId); // re-read the time span of a trajectory changed in place
+
+    // ---------------- Queries ----------------
+    // Appends trajectories whose span intersects [t0, t1]. Stops and returns false once more than
+    // limit trajectories were found (out then holds a partial result).
+    bool query(int64_t t0, int64_t t1, std::vector<std::shared_ptr<Trajectory>>& out,
+               size_t limit = SIZE_MAX) const;
+    std::vector<std::shared_ptr<Trajectory>> query(int64_t t0, int64_t t1) const;
+    std::vector<std::shared_ptr<Trajectory>> stabbingQuery(int64_t t) const { return query(t, t); }
+
+    // ---------------- Info ----------------
+    size_t size() const { return liveCount; }
+    size_t deltaSize() const { return entries.size() - built; }
+    size_t tombstoneCount() const { return tombstones; }
+    size_t memoryUsage() const; // bytes held by entries, tree arrays and the ID map (estimate)
+};
+
+#endif // TEMPORAL_INDEX_H
@@ -0,0 +1,95 @@
+/*
+ * threadPool.h
+ * --------------
+ * Fixed set of worker threads that run submitted tasks in FIFO order.
+ *
+ * Unlike the helpers in parallel.h, which start and join threads for every
+ * call, the workers live as long as the pool, so short queries can fan out
+ * without paying thread creation on each one. submit may be called from any
+ * thread; a task must not block waiting on another task of the same pool.
+ *
+ * Header-only.
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include "../include/parallel.h"
+#include "../../../common/trace.h"
+#include <thread>
+#include <string>
+#include <vector>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable ready;
+    bool stopping = false;
+
+    void work() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this]() { return stopping || !tasks.empty(); });
+                if (tasks.empty()) return; // stopping and drained
+                task = std::move(tasks.front());
+                tasks.pop();
+            }
+            task();
+        }
+    }
+
+public:
+    // ---------------- Constructors ----------------
+    explicit ThreadPool(size_t numThreads = 0) { // 0 = one per hardware thread
+        numThreads = parallel::resolveThreadCount(numThreads);
+        workers.reserve(numThreads);
+        for (size_t i = 0; i < numThreads; ++i)
+            workers.emplace_back([this, i]() {
+                trace::setThreadName("pool worker " + std::to_string(i));
+                work();
+            });
+    }
+
+    // Runs the tasks already queued, then joins the workers
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        ready.notify_all();
+        for (auto& w : workers) w.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // ---------------- Tasks ----------------
+    // Queues task(); the future holds its result or rethrows its exception
+    template <typename Func>
+    std::future<std::invoke_result_t<Func>> submit(Func&& task) {
+        using Result = std::invoke_result_t<Func>;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<Func>(task));
+        std::future<Result> result = packaged->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.emplace([packaged]() { (*packaged)(); });
+        }
+        ready.notify_one();
+        return result;
+    }
+
+    size_t size() const { return workers.size(); }
+};
+
+#endif // THREAD_POOL_H
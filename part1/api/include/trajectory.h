@@ -12,6 +12,8 @@
  *   - Bounding box computation (cached & fresh)
  *   - Trajectory similarity (direct comparison or DTW for uneven sizes)
  *   - Distance, length, duration, and average speed
+ *   - Interpolated position at a timestamp
+ *   - TrajectorySummary: box, centroid, length, duration and point count from one pass
  *   - Serialization to JSON
  *   - Equality comparison
  *
@@ -28,6 +30,21 @@
 #include <vector>
 #include <string>
 #include <optional>
+#include <cstdint>
+
+class Trajectory;
+
+// Per-trajectory numbers from one pass over its points (see Trajectory::summarize)
+struct TrajectorySummary {
+    uint32_t index = 0;           // position in the summarized vector (RTree::computeSummaries); 0 from summarize()
+    BoundingBox3D bbox;
+    float centroidX = 0.0f;       // mean x
+    float centroidY = 0.0f;       // mean y
+    double centroidT = 0.0;       // mean timestamp in seconds (timestamps summed exactly as int64)
+    float length = 0.0f;          // spatial path length, as Trajectory::length
+    int64_t duration = 0;         // last - first timestamp
+    uint32_t pointCount = 0;
+};
 
 class Trajectory {
 private:
@@ -40,11 +57,9 @@ private:
     // Recompute the cached bounding box from points
     void updateCachedBBox() const;
 
-     // Compute centroid (x, y, t) as floats
-    void computeCentroid() const;
-
-    // Precomputed centroid
-    mutable float centroidX, centroidY, centroidT;
+    // Precomputed centroid (time as double: a float is only exact to 128 s around 1.5e9)
+    mutable float centroidX, centroidY;
+    mutable double centroidT;
 
 
 public:
@@ -72,10 +87,12 @@ public:
 
 
     // ---------------- Centroid ----------------
-    void precomputeCentroidAndBoundingBox(); // call once after loading
+    TrajectorySummary precomputeCentroidAndBoundingBox(); // call once after loading; caches summarize()
+    void adoptSummary(const TrajectorySummary& s);        // caches box and centroid from a summary of these points
+    TrajectorySummary summarize() const;     // box, centroid, length, duration in one pass; caches untouched
     float getCentroidX() const { return centroidX; }
     float getCentroidY() const { return centroidY; }
-    float getCentroidT() const { return centroidT; }
+    double getCentroidT() const { return centroidT; }
 
 
     // ---------------- Utilities ----------------
@@ -83,6 +100,12 @@ public:
     float averageSpeed() const;    // average speed (length / duration)
     int64_t duration() const;      // total time duration (last - first timestamp)
     bool isEmpty() const;          // check if trajectory is empty
+    // Position at time t, linearly interpolated between the surrounding points (points sorted by t);
+    // empty if t lies outside [first, last] timestamp
+    std::optional<Point3D> positionAt(int64_t t) const;
+    // Same, searching from point index cursor, which is left at the first point with timestamp >= t;
+    // successive calls with non-decreasing t reuse it (a smaller t restarts the search)
+    std::optional<Point3D> positionAt(int64_t t, size_t& cursor) const;
     void clear();                  // remove all points and reset bbox
   //  float approximateDistance(const Trajectory& other) const;   // Compute a cheap approximate distance to another trajectory
 
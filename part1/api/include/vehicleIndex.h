@@ -0,0 +1,81 @@
+/*
+ * vehicleIndex.h
+ * ----------------
+ * Defines the vehicle-level structures kept next to the RTree:
+ *   - VehicleBitmap: one bit per vehicle ordinal; queries set the bit of every matching
+ *     trajectory's vehicle, so distinct vehicles are counted with popcount
+ *   - VehicleIndex: dense vehicle ordinals (vehicle ID = trajectory ID up to '_', see
+ *     vehicleIdOf), the trajectories of each vehicle, and the ordinal of each trajectory
+ *     object so traversals never parse IDs
+ *
+ * Trajectories are shared with the RTree; nothing is copied. Ordinals are never reused,
+ * a vehicle whose trajectories were all removed keeps an empty list.
+ */
+
+#ifndef VEHICLE_INDEX_H
+#define VEHICLE_INDEX_H
+
+#include "../include/trajectory.h"
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+class VehicleBitmap {
+private:
+    std::vector<uint64_t> words;
+
+public:
+    explicit VehicleBitmap(size_t vehicles = 0) : words((vehicles + 63) / 64, 0) {}
+
+    void set(uint32_t vehicle) {
+        if ((vehicle >> 6) >= words.size()) words.resize((vehicle >> 6) + 1, 0);
+        words[vehicle >> 6] |= uint64_t(1) << (vehicle & 63);
+    }
+    bool test(uint32_t vehicle) const {
+        return (vehicle >> 6) < words.size() && (words[vehicle >> 6] >> (vehicle & 63)) & 1;
+    }
+    size_t count() const;                        // distinct vehicles set
+    void merge(const VehicleBitmap& other);      // union
+    void clear() { std::fill(words.begin(), words.end(), 0); }
+    std::vector<uint32_t> ordinals() const;      // set vehicles, ascending
+};
+
+class VehicleIndex {
+public:
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+private:
+    std::vector<std::string> names;                                 // ordinal -> vehicle ID
+    std::unordered_map<std::string, uint32_t> ordinals;             // vehicle ID -> ordinal
+    std::vector<std::vector<std::shared_ptr<Trajectory>>> trips;    // ordinal -> its trajectories
+    std::unordered_map<const Trajectory*, uint32_t> ordinalOf;      // trajectory object -> ordinal
+    size_t trajectoryCount = 0;
+
+public:
+    // ---------------- Construction ----------------
+    void build(const std::vector<std::shared_ptr<Trajectory>>& trajectories); // replaces the contents
+    void clear();
+
+    // ---------------- Modification ----------------
+    void insert(const std::shared_ptr<Trajectory>& traj);
+    bool remove(const std::string& trajId);    // one trajectory with this ID
+
+    // ---------------- Lookup ----------------
+    uint32_t vehicleOf(const Trajectory* traj) const;  // npos if not indexed
+    uint32_t ordinal(const std::string& vehicleId) const; // npos if unknown
+    const std::string& vehicleName(uint32_t ordinal) const { return names[ordinal]; }
+    const std::vector<std::shared_ptr<Trajectory>>& trajectoriesOf(const std::string& vehicleId) const;
+
+    VehicleBitmap makeBitmap() const { return VehicleBitmap(names.size()); }
+    std::vector<std::string> vehicleNames(const VehicleBitmap& bitmap) const;
+
+    size_t vehicleCount() const { return names.size(); }
+    size_t size() const { return trajectoryCount; }
+    size_t memoryUsage() const; // bytes held by the maps and lists (estimate)
+};
+
+#endif // VEHICLE_INDEX_H
@@ -1,9 +1,19 @@
 #include "../include/RTree.h"
+#include "../include/parallel.h"
+#include "../../../common/trace.h"
 #include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <unordered_set>
 #include <queue>
+#include <deque>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <functional>
+#include <mutex>
+#include <tuple>
 #include <arrow/io/file.h>
 #include <arrow/table.h>
 #include <arrow/array.h>
@@ -27,7 +37,11 @@ void RTree::insert(const Trajectory& traj) {
         root = std::make_shared<RTreeNode>(true, maxEntries);
     }
 
-    auto [splitLeft, splitRight] = root->insertRecursive(traj);
+    quantized.reset();
+    auto trajPtr = std::make_shared<Trajectory>(traj);
+    auto [splitLeft, splitRight] = root->insertRecursive(trajPtr);
+    temporal.insert(trajPtr);
+    vehicles.insert(trajPtr);
 
     if (splitLeft && splitRight) {
         auto newRoot = std::make_shared<RTreeNode>(false, maxEntries);
@@ -36,38 +50,930 @@ void RTree::insert(const Trajectory& traj) {
         newRoot->updateMBR();
         root = newRoot;
     }
+    root->refreshCaches();
 }
 
 // ---------------- Deletion & Update ----------------
 bool RTree::remove(const std::string& trajId) {
-    return root ? root->deleteTrajectory(trajId) : false;
+    quantized.reset();
+    if (!root || !root->deleteTrajectory(trajId)) return false;
+    root->refreshCaches();
+    temporal.remove(trajId);
+    vehicles.remove(trajId);
+    return true;
 }
 
 bool RTree::update(const Trajectory& traj) {
     if (!root) return false;
+    quantized.reset();
     if (!root->updateTrajectory(traj)) {
+        temporal.remove(traj.getId()); // moved out of its leaf (or absent); reinserted below
+        vehicles.remove(traj.getId());
         insert(traj);
+    } else {
+        root->refreshCaches();
+        temporal.refresh(traj.getId()); // replaced in place, its time span may differ
     }
     return true;
 }
 
 // ---------------- Queries ----------------
 std::vector<Trajectory> RTree::rangeQuery(const BoundingBox3D& queryBox) const {
+    TRACE_SCOPE_CAT("query", "RTree::rangeQuery");
     std::vector<Trajectory> results;
+    if (quantized) {
+        for (const auto& traj : quantized->rangeQuery(queryBox)) results.push_back(*traj);
+        return results;
+    }
     if (root) root->rangeQuery(queryBox, results);
     return results;
 }
 
+// Trajectories whose entry box intersects box
+static void collectIntersecting(const RTreeNode& node, const BoundingBox3D& box, std::vector<const Trajectory*>& out) {
+    if (node.isLeafNode()) {
+        for (const auto& [entryBox, traj] : node.getLeafEntries())
+            if (box.intersects(entryBox)) out.push_back(traj.get());
+        return;
+    }
+    for (const auto& [childBox, child] : node.getChildEntries())
+        if (box.intersects(childBox)) collectIntersecting(*child, box, out);
+}
+
+void RTree::rangeQuery(const BoundingBox3D& queryBox, std::vector<const Trajectory*>& results) const {
+    TRACE_SCOPE_CAT("query", "RTree::rangeQuery");
+    if (quantized) {
+        for (const auto& traj : quantized->rangeQuery(queryBox)) results.push_back(traj.get());
+        return;
+    }
+    if (root && root->getMBR().intersects(queryBox)) collectIntersecting(*root, queryBox, results);
+}
+
+void RTree::temporalRangeQuery(const BoundingBox3D& queryBox, std::vector<const Trajectory*>& results) const {
+    TRACE_SCOPE_CAT("query", "RTree::temporalRangeQuery");
+    std::vector<std::shared_ptr<Trajectory>> candidates;
+    temporal.query(queryBox.getMinT(), queryBox.getMaxT(), candidates);
+    for (const auto& traj : candidates)
+        if (queryBox.intersects(traj->getBoundingBox())) results.push_back(traj.get());
+}
+
 std::vector<Trajectory> RTree::kNearestNeighbors(const Trajectory& query, size_t k, float timeScale) const {
+    TRACE_SCOPE_CAT("query", "RTree::kNearestNeighbors");
     return root ? root->kNearestNeighbors(query, k, timeScale) : std::vector<Trajectory>{};
 }
 
 std::vector<Trajectory> RTree::findSimilar(const Trajectory& query, float maxDistance) const {
+    TRACE_SCOPE_CAT("query", "RTree::findSimilar");
     std::vector<Trajectory> results;
     if (root) root->findSimilar(query, maxDistance, results);
     return results;
 }
 
+// ---------------- Batch range queries ----------------
+// Query boxes still active at one depth of the traversal, stored as columns so one child box
+// is tested against all of them in a single branch-free (vectorizable) loop
+struct QueryLanes {
+    std::vector<float> minX, minY, maxX, maxY;
+    std::vector<double> minT, maxT;   // exact for epoch seconds, vectorizable
+    std::vector<uint32_t> slot;       // index into the caller's query vector
+
+    size_t size() const { return slot.size(); }
+
+    void clear() {
+        minX.clear(); minY.clear(); maxX.clear(); maxY.clear();
+        minT.clear(); maxT.clear(); slot.clear();
+    }
+
+    void push(const BoundingBox3D& box, uint32_t s) {
+        minX.push_back(box.getMinX()); minY.push_back(box.getMinY());
+        maxX.push_back(box.getMaxX()); maxY.push_back(box.getMaxY());
+        minT.push_back(static_cast<double>(box.getMinT())); maxT.push_back(static_cast<double>(box.getMaxT()));
+        slot.push_back(s);
+    }
+
+    void push(const QueryLanes& from, size_t i) {
+        minX.push_back(from.minX[i]); minY.push_back(from.minY[i]);
+        maxX.push_back(from.maxX[i]); maxY.push_back(from.maxY[i]);
+        minT.push_back(from.minT[i]); maxT.push_back(from.maxT[i]);
+        slot.push_back(from.slot[i]);
+    }
+};
+
+// mask[i] = queries[i].intersects(box), same tolerance as BoundingBox3D::intersects
+static void intersectLanes(const QueryLanes& queries, const BoundingBox3D& box, uint8_t* __restrict mask) {
+    const float eps = 1e-6f;
+    const float bMinX = box.getMinX(), bMaxX = box.getMaxX();
+    const float bMinY = box.getMinY(), bMaxY = box.getMaxY();
+    const double bMinT = static_cast<double>(box.getMinT()), bMaxT = static_cast<double>(box.getMaxT());
+    const float* __restrict x0 = queries.minX.data();
+    const float* __restrict x1 = queries.maxX.data();
+    const float* __restrict y0 = queries.minY.data();
+    const float* __restrict y1 = queries.maxY.data();
+    const double* __restrict t0 = queries.minT.data();
+    const double* __restrict t1 = queries.maxT.data();
+    const size_t n = queries.size();
+    for (size_t i = 0; i < n; ++i)
+        mask[i] = !((x1[i] + eps < bMinX) | (x0[i] > bMaxX + eps) |
+                    (y1[i] + eps < bMinY) | (y0[i] > bMaxY + eps) |
+                    (t1[i] < bMinT) | (t0[i] > bMaxT));
+}
+
+// Walks the tree once for a group of queries, carrying the subset that intersects each node
+struct BatchQueryWorker {
+    std::vector<std::vector<std::shared_ptr<Trajectory>>>* results;
+    std::deque<QueryLanes> levels;    // active queries per depth; a deque keeps references valid as it grows
+    std::vector<uint8_t> mask;
+
+    void visit(const RTreeNode& node, size_t depth) {
+        if (levels.size() < depth + 2) levels.resize(depth + 2);
+        const QueryLanes& active = levels[depth];
+        const size_t n = active.size();
+
+        if (node.isLeafNode()) {
+            for (const auto& [box, traj] : node.getLeafEntries()) {
+                intersectLanes(active, box, mask.data());
+                for (size_t i = 0; i < n; ++i)
+                    if (mask[i]) (*results)[active.slot[i]].push_back(traj);
+            }
+            return;
+        }
+
+        QueryLanes& next = levels[depth + 1];
+        for (const auto& [box, child] : node.getChildEntries()) {
+            intersectLanes(active, box, mask.data());
+            next.clear();
+            for (size_t i = 0; i < n; ++i)
+                if (mask[i]) next.push(active, i);
+            if (next.size() > 0) visit(*child, depth + 1);
+        }
+    }
+};
+
+// Position of a query center on a Z-order (Morton) curve over the batch extent
+static uint32_t mortonKey(float x, float y, float minX, float minY, float scaleX, float scaleY) {
+    auto spread = [](uint32_t v) {
+        v &= 0xFFFF;
+        v = (v | (v << 8)) & 0x00FF00FF;
+        v = (v | (v << 4)) & 0x0F0F0F0F;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    };
+    uint32_t qx = static_cast<uint32_t>(std::clamp((x - minX) * scaleX, 0.0f, 65535.0f));
+    uint32_t qy = static_cast<uint32_t>(std::clamp((y - minY) * scaleY, 0.0f, 65535.0f));
+    return spread(qx) | (spread(qy) << 1);
+}
+
+std::vector<std::vector<std::shared_ptr<Trajectory>>> RTree::batchRangeQuery(const std::vector<BoundingBox3D>& queries,
+                                                                               size_t numThreads) const {
+    trace::Span span("RTree::batchRangeQuery", "query");
+    span.setArg("queries", static_cast<int64_t>(queries.size()));
+    std::vector<std::vector<std::shared_ptr<Trajectory>>> results(queries.size());
+    if (!root || queries.empty()) return results;
+
+    // Spatial order, so each group holds neighboring queries that share most of their paths
+    float minX = std::numeric_limits<float>::max(), minY = minX;
+    float maxX = std::numeric_limits<float>::lowest(), maxY = maxX;
+    for (const auto& q : queries) {
+        float cx = 0.5f * (q.getMinX() + q.getMaxX()), cy = 0.5f * (q.getMinY() + q.getMaxY());
+        minX = std::min(minX, cx); maxX = std::max(maxX, cx);
+        minY = std::min(minY, cy); maxY = std::max(maxY, cy);
+    }
+    float scaleX = maxX > minX ? 65535.0f / (maxX - minX) : 0.0f;
+    float scaleY = maxY > minY ? 65535.0f / (maxY - minY) : 0.0f;
+    std::vector<std::pair<uint32_t, uint32_t>> order(queries.size()); // (Morton key, query index)
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const auto& q = queries[i];
+        order[i] = {mortonKey(0.5f * (q.getMinX() + q.getMaxX()), 0.5f * (q.getMinY() + q.getMaxY()),
+                              minX, minY, scaleX, scaleY), static_cast<uint32_t>(i)};
+    }
+    std::sort(order.begin(), order.end());
+
+    // One group per thread would leave workers idle on uneven regions; a few per thread balance them
+    const BoundingBox3D rootBox = root->getMBR();
+    size_t threads = std::min(parallel::resolveThreadCount(numThreads), queries.size());
+    size_t groups = threads == 1 ? 1 : std::min(queries.size(), threads * 4);
+    std::vector<BatchQueryWorker> workers(threads);
+    for (auto& w : workers) {
+        w.results = &results;
+        w.mask.resize(queries.size());
+        w.levels.resize(1);
+    }
+
+    parallel::parallelForDynamic(groups, threads, [&](size_t g, size_t t) {
+        BatchQueryWorker& w = workers[t];
+        size_t begin = g * order.size() / groups, end = (g + 1) * order.size() / groups;
+        QueryLanes& top = w.levels[0];
+        top.clear();
+        for (size_t i = begin; i < end; ++i)
+            if (queries[order[i].second].intersects(rootBox)) top.push(queries[order[i].second], order[i].second);
+        if (top.size() > 0) w.visit(*root, 0);
+    });
+    return results;
+}
+
+// ---------------- Vehicle queries ----------------
+VehicleBitmap RTree::rangeQueryVehicles(const BoundingBox3D& queryBox, size_t* matches) const {
+    VehicleBitmap bitmap = vehicles.makeBitmap();
+    std::vector<const Trajectory*> found;
+    rangeQuery(queryBox, found);
+    for (const Trajectory* traj : found) {
+        uint32_t v = vehicles.vehicleOf(traj);
+        if (v != VehicleIndex::npos) bitmap.set(v);
+    }
+    if (matches) *matches = found.size();
+    return bitmap;
+}
+
+VehicleBitmap RTree::findSimilarVehicles(const Trajectory& query, float maxDistance, bool excludeQuery,
+                                         size_t* matches) const {
+    VehicleBitmap bitmap = vehicles.makeBitmap();
+    size_t count = 0;
+    if (root) {
+        root->findSimilar(query, maxDistance, [&](const std::shared_ptr<Trajectory>& traj) {
+            if (excludeQuery && traj->getId() == query.getId()) return;
+            uint32_t v = vehicles.vehicleOf(traj.get());
+            if (v != VehicleIndex::npos) bitmap.set(v);
+            ++count;
+        });
+    }
+    if (matches) *matches = count;
+    return bitmap;
+}
+
+std::vector<VehicleGroup> RTree::rangeQueryByVehicle(const BoundingBox3D& queryBox) const {
+    std::vector<const Trajectory*> found;
+    rangeQuery(queryBox, found);
+    std::vector<std::pair<uint32_t, const Trajectory*>> byVehicle;
+    byVehicle.reserve(found.size());
+    for (const Trajectory* traj : found) {
+        uint32_t v = vehicles.vehicleOf(traj);
+        if (v != VehicleIndex::npos) byVehicle.emplace_back(v, traj);
+    }
+    std::stable_sort(byVehicle.begin(), byVehicle.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    std::vector<VehicleGroup> groups;
+    for (size_t i = 0; i < byVehicle.size(); ++i) {
+        if (i == 0 || byVehicle[i].first != byVehicle[i - 1].first)
+            groups.push_back({vehicles.vehicleName(byVehicle[i].first), {}});
+        groups.back().trajectories.push_back(byVehicle[i].second);
+    }
+    return groups;
+}
+
+// ---------------- Aggregate queries ----------------
+AggregateQueryResult RTree::aggregateQuery(const BoundingBox3D& queryBox) const {
+    TRACE_SCOPE_CAT("query", "RTree::aggregateQuery");
+    AggregateQueryResult result;
+    if (!root) return result;
+
+    NodeAggregate aggregate;
+    root->aggregateQuery(queryBox, aggregate, result.nodesVisited, result.trajectoriesRead);
+
+    result.count = aggregate.count;
+    result.points = aggregate.points;
+    result.totalLength = aggregate.totalLength;
+    result.totalDuration = aggregate.totalDuration;
+    result.distinctVehicles = aggregate.count ? aggregate.vehicles.estimate() : 0.0;
+    return result;
+}
+
+// ---------------- Approximate kNN ----------------
+// Best-first search over nodes and trajectories ordered by the spatial box distance,
+// which never exceeds spatioTemporalDistanceTo (every point lies inside its box).
+ApproximateKNNResult RTree::approximateKNearestNeighbors(const Trajectory& query, size_t k,
+                                                         const ApproximateKNNOptions& options) const {
+    TRACE_SCOPE_CAT("query", "RTree::approximateKNearestNeighbors");
+    ApproximateKNNResult result;
+    if (!root || k == 0) return result;
+
+    // Queue item: a node or a trajectory with its lower bound
+    struct Item {
+        float lowerBound;
+        const RTreeNode* node;
+        const std::shared_ptr<Trajectory>* traj;
+        bool operator>(const Item& other) const { return lowerBound > other.lowerBound; }
+    };
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+
+    // Current k best exact distances (max-heap on distance)
+    using Candidate = std::pair<float, std::shared_ptr<Trajectory>>;
+    auto farther = [](const Candidate& a, const Candidate& b) { return a.first < b.first; };
+    std::vector<Candidate> best;
+
+    const BoundingBox3D queryBox = query.getBoundingBox();
+    const float slack = (1.0f + options.epsilon) * (1.0f + options.epsilon); // on squared distances
+    auto kthDistance = [&]() {
+        return best.size() < k ? std::numeric_limits<float>::infinity() : best.front().first;
+    };
+
+    auto startTime = std::chrono::steady_clock::now();
+    auto overBudget = [&]() {
+        if (options.maxRefinements && result.refinements >= options.maxRefinements) return true;
+        if (options.maxNodes && result.nodesVisited >= options.maxNodes) return true;
+        if (options.timeBudget > 0.0 && (result.nodesVisited + result.refinements) % 16 == 0) {
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+            if (elapsed.count() >= options.timeBudget) return true;
+        }
+        return false;
+    };
+
+    // Smallest lower bound among trajectories that were never refined
+    float unexploredBound = std::numeric_limits<float>::infinity();
+
+    queue.push({root->getMBR().spatialDistanceSquared(queryBox), root.get(), nullptr});
+    while (!queue.empty()) {
+        Item item = queue.top();
+        if (item.lowerBound * slack >= kthDistance()) break; // nothing left can improve by more than epsilon
+        if (overBudget()) { result.budgetExhausted = true; break; }
+        queue.pop();
+
+        if (item.traj) {
+            const auto& traj = *item.traj;
+            ++result.refinements;
+            float dist = query.spatioTemporalDistanceTo(*traj, options.timeScale);
+            if (best.size() < k) {
+                best.emplace_back(dist, traj);
+                std::push_heap(best.begin(), best.end(), farther);
+            } else if (dist < best.front().first) {
+                std::pop_heap(best.begin(), best.end(), farther);
+                best.back() = {dist, traj};
+                std::push_heap(best.begin(), best.end(), farther);
+            }
+            continue;
+        }
+
+        ++result.nodesVisited;
+        if (item.node->isLeafNode()) {
+            for (const auto& entry : item.node->getLeafEntries()) {
+                if (!entry.second || entry.second->getId() == query.getId()) continue;
+                float lb = entry.first.spatialDistanceSquared(queryBox);
+                if (lb * slack >= kthDistance()) { unexploredBound = std::min(unexploredBound, lb); continue; }
+                queue.push({lb, nullptr, &entry.second});
+            }
+        } else {
+            for (const auto& [childBox, child] : item.node->getChildEntries()) {
+                float lb = child->getMBR().spatialDistanceSquared(queryBox);
+                if (lb * slack >= kthDistance()) { unexploredBound = std::min(unexploredBound, lb); continue; }
+                queue.push({lb, child.get(), nullptr});
+            }
+        }
+    }
+    if (!queue.empty()) unexploredBound = std::min(unexploredBound, queue.top().lowerBound);
+
+    std::sort_heap(best.begin(), best.end(), farther);
+    for (auto& [dist, traj] : best) {
+        result.distances.push_back(dist);
+        result.trajectories.push_back(std::move(traj));
+    }
+
+    // True distance at each rank is >= min(returned distance, unexploredBound)
+    if (best.size() < k && std::isfinite(unexploredBound)) {
+        result.achievedEpsilon = std::numeric_limits<float>::infinity();
+    } else if (!result.distances.empty() && result.distances.back() > unexploredBound) {
+        result.achievedEpsilon = unexploredBound > 0.0f
+            ? std::sqrt(result.distances.back() / unexploredBound) - 1.0f
+            : std::numeric_limits<float>::infinity();
+    }
+    return result;
+}
+
+// ---------------- Similarity Join ----------------
+
+// A pair of subtrees still to be joined (self: a == b, only pairs a < b wanted)
+struct JoinTask {
+    const RTreeNode* a;
+    const RTreeNode* b;
+    bool self;
+};
+
+// Child node pairs of a task whose boxes are within range; false for a leaf x leaf task
+static bool expandJoinTask(const JoinTask& task, float maxDistSq, std::vector<JoinTask>& out) {
+    bool aLeaf = task.a->isLeafNode(), bLeaf = task.b->isLeafNode();
+    if (aLeaf && bLeaf) return false;
+
+    auto push = [&](const RTreeNode* x, const RTreeNode* y, bool self) {
+        if (self || x->getMBR().distanceSquaredTo(y->getMBR()) <= maxDistSq) out.push_back({x, y, self});
+    };
+
+    if (task.self) {
+        const auto& children = task.a->getChildEntries();
+        for (size_t i = 0; i < children.size(); ++i)
+            for (size_t j = i; j < children.size(); ++j)
+                push(children[i].second.get(), children[j].second.get(), i == j);
+    } else if (aLeaf) {
+        for (const auto& [_, child] : task.b->getChildEntries()) push(task.a, child.get(), false);
+    } else if (bLeaf) {
+        for (const auto& [_, child] : task.a->getChildEntries()) push(child.get(), task.b, false);
+    } else {
+        for (const auto& [_, childA] : task.a->getChildEntries())
+            for (const auto& [_, childB] : task.b->getChildEntries()) push(childA.get(), childB.get(), false);
+    }
+    return true;
+}
+
+// Depth-first join of the tasks handed to one thread; matches are buffered
+// and passed to the shared callback in batches
+class JoinWorker {
+private:
+    float maxDistance, maxDistSq;
+    std::mutex& callbackMutex;
+    const SimilarityJoinCallback& callback;
+    std::vector<std::tuple<const Trajectory*, const Trajectory*, float>> buffer;
+
+    void testPair(const Trajectory& a, const Trajectory& b) {
+        if (a.approximateDistance(b, 1e-5f) > maxDistance) return;
+        ++stats.refinements;
+        float similarity = a.similarityTo(b);
+        if (similarity > maxDistance) return;
+        buffer.emplace_back(&a, &b, similarity);
+        if (buffer.size() >= 256) flush();
+    }
+
+    // Per-entry box prefilter: part of the join predicate (unlike findSimilar), not only pruning
+    void joinLeaves(const JoinTask& task) {
+        const auto& entriesA = task.a->getLeafEntries();
+        const auto& entriesB = task.b->getLeafEntries();
+        for (size_t i = 0; i < entriesA.size(); ++i)
+            for (size_t j = task.self ? i + 1 : 0; j < entriesB.size(); ++j)
+                if (entriesA[i].first.distanceSquaredTo(entriesB[j].first) <= maxDistSq)
+                    testPair(*entriesA[i].second, *entriesB[j].second);
+    }
+
+public:
+    SimilarityJoinStats stats;
+
+    JoinWorker(float maxDistance, std::mutex& callbackMutex, const SimilarityJoinCallback& callback)
+        : maxDistance(maxDistance), maxDistSq(maxDistance * maxDistance),
+          callbackMutex(callbackMutex), callback(callback) {}
+
+    void run(const JoinTask& task) {
+        ++stats.nodePairs;
+        std::vector<JoinTask> children;
+        if (!expandJoinTask(task, maxDistSq, children)) { joinLeaves(task); return; }
+        for (const auto& child : children) run(child);
+    }
+
+    void flush() {
+        if (buffer.empty()) return;
+        std::lock_guard<std::mutex> lock(callbackMutex);
+        for (const auto& [a, b, similarity] : buffer) callback(*a, *b, similarity);
+        stats.pairs += buffer.size();
+        buffer.clear();
+    }
+};
+
+static SimilarityJoinStats runSimilarityJoin(const std::shared_ptr<RTreeNode>& rootA, const std::shared_ptr<RTreeNode>& rootB,
+                                             bool self, float maxDistance, const SimilarityJoinCallback& callback,
+                                             size_t numThreads) {
+    SimilarityJoinStats total;
+    if (!rootA || !rootB) return total;
+
+    // Expand the top of the tree until there are enough independent subtree pairs
+    size_t threads = parallel::resolveThreadCount(numThreads);
+    float maxDistSq = maxDistance * maxDistance;
+    std::vector<JoinTask> tasks;
+    if (self || rootA->getMBR().distanceSquaredTo(rootB->getMBR()) <= maxDistSq)
+        tasks.push_back({rootA.get(), rootB.get(), self});
+
+    while (threads > 1 && tasks.size() < threads * 16) {
+        std::vector<JoinTask> next;
+        bool expanded = false;
+        for (const auto& task : tasks) {
+            if (expandJoinTask(task, maxDistSq, next)) { expanded = true; ++total.nodePairs; }
+            else next.push_back(task);
+        }
+        tasks.swap(next);
+        if (!expanded) break;
+    }
+    total.tasks = tasks.size();
+
+    std::mutex callbackMutex;
+    std::vector<JoinWorker> workers;
+    for (size_t t = 0; t < threads; ++t) workers.emplace_back(maxDistance, callbackMutex, callback);
+
+    parallel::parallelForDynamic(tasks.size(), threads, [&](size_t i, size_t t) { workers[t].run(tasks[i]); });
+
+    for (auto& w : workers) {
+        w.flush();
+        total.pairs += w.stats.pairs;
+        total.nodePairs += w.stats.nodePairs;
+        total.refinements += w.stats.refinements;
+    }
+    return total;
+}
+
+SimilarityJoinStats RTree::similarityJoin(float maxDistance, const SimilarityJoinCallback& callback,
+                                          size_t numThreads) const {
+    TRACE_SCOPE_CAT("query", "RTree::similarityJoin");
+    return runSimilarityJoin(root, root, true, maxDistance, callback, numThreads);
+}
+
+SimilarityJoinStats RTree::similarityJoin(const RTree& other, float maxDistance, const SimilarityJoinCallback& callback,
+                                          size_t numThreads) const {
+    TRACE_SCOPE_CAT("query", "RTree::similarityJoin");
+    return runSimilarityJoin(root, other.root, false, maxDistance, callback, numThreads);
+}
+
+// ---------------- Cancellable Queries ----------------
+// Both walks return false as soon as the guard stops them; out keeps the matches found so far
+static bool controlledRangeQuery(const RTreeNode& node, const BoundingBox3D& queryBox, std::vector<Trajectory>& out,
+                                 QueryGuard& guard, size_t& nodesVisited) {
+    if (guard.stop()) return false;
+    ++nodesVisited;
+    if (node.isLeafNode()) {
+        for (const auto& [entryBox, traj] : node.getLeafEntries())
+            if (queryBox.intersects(entryBox)) out.push_back(*traj);
+        return true;
+    }
+    for (const auto& [childBox, child] : node.getChildEntries())
+        if (queryBox.intersects(childBox) && !controlledRangeQuery(*child, queryBox, out, guard, nodesVisited)) return false;
+    return true;
+}
+
+// Same pruning and refinement as RTreeNode::findSimilar
+static bool controlledFindSimilar(const RTreeNode& node, const Trajectory& query, const BoundingBox3D& queryBox,
+                                  float maxDistance, PartialResult<std::vector<Trajectory>>& result, QueryGuard& guard) {
+    if (node.isLeafNode()) {
+        if (!node.getMBR().intersects(queryBox) && maxDistance > 0.0f) return true;
+    } else if (node.getMBR().distanceSquaredTo(queryBox) > maxDistance * maxDistance) {
+        return true;
+    }
+    if (guard.stop()) return false;
+    ++result.nodesVisited;
+
+    if (node.isLeafNode()) {
+        for (const auto& [_, traj] : node.getLeafEntries()) {
+            if (!traj || query.approximateDistance(*traj, 1e-5f) > maxDistance) continue;
+            if (guard.stop()) return false;
+            ++result.refinements;
+            if (query.similarityTo(*traj) <= maxDistance) result.results.push_back(*traj);
+        }
+        return true;
+    }
+    for (const auto& [childBox, child] : node.getChildEntries()) {
+        if (childBox.distanceSquaredTo(queryBox) > maxDistance * maxDistance) continue;
+        if (!controlledFindSimilar(*child, query, queryBox, maxDistance, result, guard)) return false;
+    }
+    return true;
+}
+
+template <typename T>
+static void finish(PartialResult<T>& result, const QueryGuard& guard) {
+    result.stopReason = guard.stopReason();
+    result.complete = result.stopReason == QueryStopReason::None;
+}
+
+PartialResult<std::vector<Trajectory>> RTree::rangeQuery(const BoundingBox3D& queryBox, const QueryControl& control) const {
+    TRACE_SCOPE_CAT("query", "RTree::rangeQuery (controlled)");
+    PartialResult<std::vector<Trajectory>> result;
+    QueryGuard guard(control);
+    if (!guard.stop() && root && root->getMBR().intersects(queryBox))
+        controlledRangeQuery(*root, queryBox, result.results, guard, result.nodesVisited);
+    finish(result, guard);
+    return result;
+}
+
+PartialResult<std::vector<Trajectory>> RTree::findSimilar(const Trajectory& query, float maxDistance,
+                                                          const QueryControl& control) const {
+    TRACE_SCOPE_CAT("query", "RTree::findSimilar (controlled)");
+    PartialResult<std::vector<Trajectory>> result;
+    QueryGuard guard(control);
+    if (!guard.stop() && root) controlledFindSimilar(*root, query, query.getBoundingBox(), maxDistance, result, guard);
+    finish(result, guard);
+    return result;
+}
+
+ThreadPool& RTree::sharedExecutor() {
+    static ThreadPool pool;
+    return pool;
+}
+
+std::future<PartialResult<std::vector<Trajectory>>> RTree::rangeQueryAsync(const BoundingBox3D& queryBox, QueryControl control,
+                                                                           ThreadPool& executor) const {
+    return executor.submit([this, queryBox, control]() { return rangeQuery(queryBox, control); });
+}
+
+std::future<PartialResult<std::vector<Trajectory>>> RTree::findSimilarAsync(const Trajectory& query, float maxDistance,
+                                                                            QueryControl control, ThreadPool& executor) const {
+    auto ownQuery = std::make_shared<Trajectory>(query); // the caller's query may be gone before the task runs
+    ownQuery->getBoundingBox();
+    return executor.submit([this, ownQuery, maxDistance, control]() { return findSimilar(*ownQuery, maxDistance, control); });
+}
+
+// ---------------- Snapshot Queries ----------------
+// Timestamps of a batch snapshot, sorted, with their position in the caller's list
+struct SnapshotTimes {
+    std::vector<int64_t> sorted;
+    std::vector<size_t> slot;
+
+    // Index range of the timestamps inside [minT, maxT]
+    std::pair<size_t, size_t> within(int64_t minT, int64_t maxT) const {
+        size_t begin = std::lower_bound(sorted.begin(), sorted.end(), minT) - sorted.begin();
+        size_t end = std::upper_bound(sorted.begin() + begin, sorted.end(), maxT) - sorted.begin();
+        return {begin, end};
+    }
+};
+
+static void snapshotVisit(const RTreeNode& node, const BoundingBox3D& area, const SnapshotTimes& times,
+                          std::vector<std::vector<SnapshotPosition>>& results) {
+    auto inArea = [&](float x, float y) {
+        return x >= area.getMinX() && x <= area.getMaxX() && y >= area.getMinY() && y <= area.getMaxY();
+    };
+
+    if (node.isLeafNode()) {
+        for (const auto& [box, traj] : node.getLeafEntries()) {
+            auto [begin, end] = times.within(box.getMinT(), box.getMaxT());
+            if (begin == end || !area.intersects(box)) continue;
+
+            // Timestamps are sorted, so the point cursor only moves forward
+            size_t cursor = 0;
+            for (size_t i = begin; i < end; ++i) {
+                auto p = traj->positionAt(times.sorted[i], cursor);
+                if (p && inArea(p->getX(), p->getY())) results[times.slot[i]].push_back({traj.get(), p->getX(), p->getY()});
+            }
+        }
+        return;
+    }
+
+    for (const auto& [box, child] : node.getChildEntries()) {
+        auto [begin, end] = times.within(box.getMinT(), box.getMaxT());
+        if (begin != end && area.intersects(box)) snapshotVisit(*child, area, times, results);
+    }
+}
+
+std::vector<std::vector<SnapshotPosition>> RTree::snapshotQuery(const BoundingBox3D& area,
+                                                                const std::vector<int64_t>& times) const {
+    TRACE_SCOPE_CAT("query", "RTree::snapshotQuery");
+    std::vector<std::vector<SnapshotPosition>> results(times.size());
+    if (!root || times.empty()) return results;
+
+    SnapshotTimes sortedTimes;
+    sortedTimes.slot.resize(times.size());
+    for (size_t i = 0; i < times.size(); ++i) sortedTimes.slot[i] = i;
+    std::sort(sortedTimes.slot.begin(), sortedTimes.slot.end(), [&](size_t a, size_t b) { return times[a] < times[b]; });
+    for (size_t i : sortedTimes.slot) sortedTimes.sorted.push_back(times[i]);
+
+    // The area's time bounds are replaced by the span of the requested timestamps
+    BoundingBox3D searchBox(area.getMinX(), area.getMinY(), sortedTimes.sorted.front(),
+                            area.getMaxX(), area.getMaxY(), sortedTimes.sorted.back());
+    if (searchBox.intersects(root->getMBR())) snapshotVisit(*root, searchBox, sortedTimes, results);
+    return results;
+}
+
+std::vector<SnapshotPosition> RTree::snapshotQuery(const BoundingBox3D& area, int64_t t) const {
+    return std::move(snapshotQuery(area, std::vector<int64_t>{t}).front());
+}
+
+// ---------------- Continuous kNN ----------------
+// A candidate with a forward-only cursor into its points (query time only increases)
+struct KNNCandidate {
+    const Trajectory* traj;
+    size_t cursor = 0;
+
+    // Interpolated position at t; false if the trajectory is not active at t
+    bool positionAt(int64_t t, float& x, float& y) {
+        auto p = traj->positionAt(t, cursor);
+        if (!p) return false;
+        x = p->getX();
+        y = p->getY();
+        return true;
+    }
+};
+
+// Safe-region scheme: candidates are every trajectory within radius R of the query's path over a
+// time window (box test). Any other trajectory is farther than R at every step of the window, so
+// while the k-th candidate distance stays <= R the candidate answer is exact. When it does not,
+// the safe region is exited: R grows and the candidates are fetched again from that step on.
+ContinuousKNNResult RTree::continuousKNearestNeighbors(const Trajectory& query, size_t k,
+                                                       const ContinuousKNNOptions& options) const {
+    TRACE_SCOPE_CAT("query", "RTree::continuousKNearestNeighbors");
+    ContinuousKNNResult result;
+    const auto& qPoints = query.getPoints();
+    if (!root || k == 0 || qPoints.empty()) return result;
+
+    BoundingBox3D rootBox = root->getMBR();
+    float radius = std::max(options.initialRadius, 1e-6f);
+    std::vector<KNNCandidate> candidates;
+    std::vector<std::pair<float, const Trajectory*>> scored;
+    std::vector<const Trajectory*> previousSet;
+
+    size_t i = 0;
+    while (i < qPoints.size()) {
+        // Query steps covered by this window and the box around their positions
+        size_t windowEnd = i;
+        BoundingBox3D path;
+        while (windowEnd < qPoints.size() &&
+               (windowEnd == i || qPoints[windowEnd].getT() - qPoints[i].getT() <= options.windowSeconds))
+            path.expandToInclude(qPoints[windowEnd++]);
+
+        BoundingBox3D searchBox(path.getMinX() - radius, path.getMinY() - radius, path.getMinT(),
+                                path.getMaxX() + radius, path.getMaxY() + radius, path.getMaxT());
+        bool complete = searchBox.getMinX() <= rootBox.getMinX() && searchBox.getMaxX() >= rootBox.getMaxX() &&
+                        searchBox.getMinY() <= rootBox.getMinY() && searchBox.getMaxY() >= rootBox.getMaxY();
+
+        std::vector<const Trajectory*> found;
+        collectIntersecting(*root, searchBox, found);
+        ++result.searches;
+        result.candidates += found.size();
+        candidates.clear();
+        for (const Trajectory* traj : found)
+            if (traj->getId() != query.getId()) candidates.push_back({traj});
+
+        float kthDistance = 0.0f;
+        size_t j = i;
+        for (; j < windowEnd; ++j) {
+            int64_t t = qPoints[j].getT();
+            float qx = qPoints[j].getX(), qy = qPoints[j].getY();
+
+            scored.clear();
+            for (auto& c : candidates) {
+                float x, y;
+                if (!c.positionAt(t, x, y)) continue;
+                float dx = x - qx, dy = y - qy;
+                scored.emplace_back(dx * dx + dy * dy, c.traj);
+            }
+            size_t kk = std::min(k, scored.size());
+            std::partial_sort(scored.begin(), scored.begin() + kk, scored.end());
+            kthDistance = kk > 0 ? std::sqrt(scored[kk - 1].first) : 0.0f;
+
+            // Safe region exited: an unseen trajectory could be closer than the k-th candidate
+            if (!complete && (kk < k || kthDistance > radius)) break;
+
+            std::vector<const Trajectory*> neighbors;
+            for (size_t n = 0; n < kk; ++n) neighbors.push_back(scored[n].second);
+            std::vector<const Trajectory*> asSet = neighbors;
+            std::sort(asSet.begin(), asSet.end());
+
+            if (!result.intervals.empty() && asSet == previousSet) {
+                result.intervals.back().end = t;
+            } else {
+                result.intervals.push_back({t, t, std::move(neighbors)});
+                previousSet = std::move(asSet);
+            }
+            ++result.steps;
+        }
+
+        if (j < windowEnd) {
+            radius = std::max(radius * 2.0f, kthDistance * 1.25f); // retry from step j with a larger region
+        } else if (kthDistance > 0.0f) {
+            radius = std::max(kthDistance * 1.25f, 1e-6f);          // fit the next window to the current answer
+        }
+        i = j;
+    }
+    return result;
+}
+
+// ---------------- Density Grid ----------------
+static constexpr size_t kDensityTileCells = 64; // tile edge, in cells
+
+// Cell geometry shared by all tiles of one densityGrid call
+struct DensityFrame {
+    float minX, minY, maxX, maxY;
+    int64_t minT, maxT;
+    float cellsPerX, cellsPerY;   // cells per coordinate unit (0 for a degenerate axis)
+    size_t cellsX, cellsY;
+    int64_t bucketSeconds;        // 0 = single bucket
+    BoundingBox3D box;
+
+    size_t cellX(float x) const { return std::min<size_t>(static_cast<size_t>(std::max(0.0f, (x - minX) * cellsPerX)), cellsX - 1); }
+    size_t cellY(float y) const { return std::min<size_t>(static_cast<size_t>(std::max(0.0f, (y - minY) * cellsPerY)), cellsY - 1); }
+    size_t bucket(int64_t t) const { return bucketSeconds > 0 ? static_cast<size_t>((t - minT) / bucketSeconds) : 0; }
+};
+
+// Block of cells [x0, x1) x [y0, y1) owned by one task; only it writes those counts
+struct DensityTile {
+    size_t x0, x1, y0, y1;
+    BoundingBox3D box;
+};
+
+struct DensityWorker {
+    const DensityFrame& frame;
+    uint32_t* counts;
+    std::vector<uint32_t> cellOfPoint;   // scratch, one entry per point of the current trajectory
+    size_t aggregatedNodes = 0;
+    size_t binnedTrajectories = 0;
+
+    static constexpr uint32_t kSkip = std::numeric_limits<uint32_t>::max();
+
+    // Cell index if every point inside box falls into one cell of the tile, kSkip if it
+    // lies in a single cell owned by another tile, npos otherwise
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+    size_t singleCell(const BoundingBox3D& b, const DensityTile& tile) const {
+        if (!frame.box.contains(b, 0.0f)) return npos;
+        size_t cx = frame.cellX(b.getMinX()), cy = frame.cellY(b.getMinY()), bt = frame.bucket(b.getMinT());
+        if (cx != frame.cellX(b.getMaxX()) || cy != frame.cellY(b.getMaxY()) || bt != frame.bucket(b.getMaxT()))
+            return npos;
+        if (cx < tile.x0 || cx >= tile.x1 || cy < tile.y0 || cy >= tile.y1) return kSkip;
+        return (bt * frame.cellsY + cy) * frame.cellsX + cx;
+    }
+
+    void binPoints(const Trajectory& traj, const DensityTile& tile) {
+        const auto& points = traj.getPoints();
+        cellOfPoint.resize(points.size());
+        const DensityFrame f = frame;
+
+        // Pass 1: branch-free cell index per point (kSkip outside the window or tile)
+        for (size_t i = 0; i < points.size(); ++i) {
+            float x = points[i].getX(), y = points[i].getY();
+            int64_t t = points[i].getT();
+            size_t cx = f.cellX(x), cy = f.cellY(y);
+            bool inside = (x >= f.minX) & (x <= f.maxX) & (y >= f.minY) & (y <= f.maxY) &
+                          (t >= f.minT) & (t <= f.maxT) &
+                          (cx >= tile.x0) & (cx < tile.x1) & (cy >= tile.y0) & (cy < tile.y1);
+            size_t cell = (f.bucket(inside ? t : f.minT) * f.cellsY + cy) * f.cellsX + cx;
+            cellOfPoint[i] = inside ? static_cast<uint32_t>(cell) : kSkip;
+        }
+        // Pass 2: scatter
+        for (uint32_t cell : cellOfPoint)
+            if (cell != kSkip) ++counts[cell];
+        ++binnedTrajectories;
+    }
+
+    void visit(const RTreeNode& node, const DensityTile& tile) {
+        BoundingBox3D mbr = node.getMBR();
+        if (!mbr.intersects(tile.box)) return;
+
+        // Whole subtree lands in one cell: its aggregate already holds the point count
+        size_t cell = singleCell(mbr, tile);
+        if (cell != npos) {
+            if (cell != kSkip) { counts[cell] += static_cast<uint32_t>(node.getAggregate().points); ++aggregatedNodes; }
+            return;
+        }
+
+        if (node.isLeafNode()) {
+            for (const auto& [_, traj] : node.getLeafEntries()) {
+                BoundingBox3D tb = traj->getBoundingBox();
+                if (!tb.intersects(tile.box)) continue;
+                size_t trajCell = singleCell(tb, tile);
+                if (trajCell == kSkip) continue;
+                if (trajCell != npos) counts[trajCell] += static_cast<uint32_t>(traj->getPoints().size());
+                else binPoints(*traj, tile);
+            }
+        } else {
+            for (const auto& [_, child] : node.getChildEntries()) visit(*child, tile);
+        }
+    }
+};
+
+uint64_t DensityGrid::total() const {
+    uint64_t sum = 0;
+    for (uint32_t c : counts) sum += c;
+    return sum;
+}
+
+DensityGrid RTree::densityGrid(const BoundingBox3D& box, size_t cellsX, size_t cellsY,
+                               int64_t bucketSeconds, size_t numThreads) const {
+    TRACE_SCOPE_CAT("query", "RTree::densityGrid");
+    if (cellsX == 0 || cellsY == 0) throw std::invalid_argument("densityGrid needs at least one cell per axis");
+    if (bucketSeconds < 0) throw std::invalid_argument("densityGrid bucket width must be >= 0");
+
+    DensityGrid grid;
+    grid.box = box;
+    grid.cellsX = cellsX;
+    grid.cellsY = cellsY;
+    grid.bucketSeconds = bucketSeconds;
+    int64_t span = box.getMaxT() - box.getMinT() + 1;
+    grid.buckets = bucketSeconds > 0 && span > 0 ? static_cast<size_t>((span + bucketSeconds - 1) / bucketSeconds) : 1;
+    if (grid.buckets * cellsY * cellsX >= DensityWorker::kSkip) throw std::invalid_argument("densityGrid has too many cells");
+    grid.counts.assign(grid.buckets * cellsY * cellsX, 0);
+    if (!root || !box.intersects(box)) return grid;
+
+    float width = box.getMaxX() - box.getMinX(), height = box.getMaxY() - box.getMinY();
+    DensityFrame frame{box.getMinX(), box.getMinY(), box.getMaxX(), box.getMaxY(), box.getMinT(), box.getMaxT(),
+                       width > 0.0f ? cellsX / width : 0.0f, height > 0.0f ? cellsY / height : 0.0f,
+                       cellsX, cellsY, bucketSeconds, box};
+
+    // Square tiles of cells; each is an independent task writing only its own cells
+    std::vector<DensityTile> tiles;
+    for (size_t y0 = 0; y0 < cellsY; y0 += kDensityTileCells) {
+        for (size_t x0 = 0; x0 < cellsX; x0 += kDensityTileCells) {
+            size_t x1 = std::min(cellsX, x0 + kDensityTileCells), y1 = std::min(cellsY, y0 + kDensityTileCells);
+            // Padded by one cell: float rounding can move a point across a tile edge,
+            // and the exact owner is decided by cell index, not by this box
+            auto edge = [](float min, float max, size_t i, size_t n) { return i >= n ? max : min + (max - min) * i / n; };
+            BoundingBox3D tileBox(edge(frame.minX, frame.maxX, x0 ? x0 - 1 : 0, cellsX), edge(frame.minY, frame.maxY, y0 ? y0 - 1 : 0, cellsY),
+                                  frame.minT,
+                                  edge(frame.minX, frame.maxX, x1 + 1, cellsX), edge(frame.minY, frame.maxY, y1 + 1, cellsY),
+                                  frame.maxT);
+            tiles.push_back({x0, x1, y0, y1, tileBox});
+        }
+    }
+
+    size_t threads = std::min(parallel::resolveThreadCount(numThreads), tiles.size());
+    std::vector<DensityWorker> workers(threads, DensityWorker{frame, grid.counts.data()});
+    parallel::parallelForDynamic(tiles.size(), threads, [&](size_t i, size_t t) {
+        workers[t].visit(*root, tiles[i]);
+    });
+
+    for (const auto& w : workers) {
+        grid.aggregatedNodes += w.aggregatedNodes;
+        grid.binnedTrajectories += w.binnedTrajectories;
+    }
+    return grid;
+}
+
 std::vector<Trajectory> RTree::getAllLeafTrajectories() const {
     std::vector<Trajectory> results;
     if (!root) return results;
@@ -90,6 +996,15 @@ std::vector<Trajectory> RTree::getAllLeafTrajectories() const {
     return results;
 }
 
+// ---------------- Quantized boxes ----------------
+void RTree::buildQuantizedIndex(int bits) {
+    quantized = std::make_shared<const QuantizedRTree>(root, bits);
+}
+
+void RTree::dropQuantizedIndex() {
+    quantized.reset();
+}
+
 // ---------------- Persistence ----------------
 void RTree::exportToJSON(const std::string& filename) const {
     try {
@@ -144,20 +1059,179 @@ void RTree::printStatistics() const {
     std::cout << "Total entries: " << getTotalEntries() << "\n";
     std::cout << "Tree height: " << getHeight() << "\n";
     std::cout << "Max entries per node: " << maxEntries << "\n";
+    memoryUsage().print(std::cout);
+    if (quantized)
+        std::cout << "Quantized snapshot (" << quantized->bits() << "-bit): "
+                  << quantized->memoryUsage() << " B\n";
+}
+
+// ---------------- Memory ----------------
+
+// make_shared control block: vtable pointer + use/weak counts (libstdc++ layout)
+static constexpr size_t kControlBlockBytes = sizeof(void*) + 2 * sizeof(int);
+
+// Bytes malloc reserves for a request of n bytes (glibc: 8-byte header, 16-byte rounding, 32 minimum)
+static size_t mallocChunkBytes(size_t n) {
+    size_t chunk = (n + sizeof(size_t) + 15) & ~static_cast<size_t>(15);
+    return std::max<size_t>(chunk, 32);
+}
+
+// Heap bytes held by a string (0 when it fits the small-string buffer)
+static size_t heapStringBytes(const std::string& s) {
+    const char* data = s.data();
+    const char* self = reinterpret_cast<const char*>(&s);
+    bool inlineBuffer = data >= self && data < self + sizeof(std::string);
+    return inlineBuffer ? 0 : s.capacity() + 1;
+}
+
+size_t MemoryReport::total() const {
+    return nodeBytes + entryVectorBytes + controlBlockBytes + trajectoryBytes +
+           pointBytes + idStringBytes + cacheBytes + temporalIndexBytes + vehicleIndexBytes + allocatorOverheadBytes;
+}
+
+void MemoryReport::print(std::ostream& os) const {
+    auto mib = [](size_t bytes) { return bytes / (1024.0 * 1024.0); };
+    os << "--------- Memory (estimated) ---------\n";
+    os << "Nodes: " << nodeCount << ", trajectories: " << trajectoryCount << ", points: " << pointCount << "\n";
+    os << "Node objects:        " << nodeBytes << " B\n";
+    os << "Entry vectors:       " << entryVectorBytes << " B\n";
+    os << "Control blocks:      " << controlBlockBytes << " B\n";
+    os << "Trajectory objects:  " << trajectoryBytes << " B\n";
+    os << "Point storage:       " << pointBytes << " B\n";
+    os << "ID strings:          " << idStringBytes << " B\n";
+    os << "Caches (MBR/bbox):   " << cacheBytes << " B\n";
+    os << "Temporal index:      " << temporalIndexBytes << " B\n";
+    os << "Vehicle index:       " << vehicleIndexBytes << " B\n";
+    os << "Allocator overhead:  " << allocatorOverheadBytes << " B\n";
+    os << "Total:               " << total() << " B (" << mib(total()) << " MiB)\n";
+    if (trajectoryCount > 0)
+        os << "Bytes per trajectory: " << total() / trajectoryCount << "\n";
+
+    os << "Level  Nodes  Entries  Fill   OverlapRatio\n";
+    for (const auto& l : levels)
+        os << l.level << "  " << l.nodes << "  " << l.entries << "  "
+           << l.fillFactor << "  " << l.overlapRatio << "\n";
+}
+
+MemoryReport RTree::memoryUsage() const {
+    MemoryReport report;
+    if (!root) return report;
+    report.temporalIndexBytes = temporal.memoryUsage();
+    report.vehicleIndexBytes = vehicles.memoryUsage();
+
+    // Cached state kept alongside the payload of each object
+    const size_t nodeCache = sizeof(BoundingBox3D) + sizeof(NodeAggregate) + 2 * sizeof(bool); // mbr, aggregate, dirty flags
+    const size_t trajCache = sizeof(BoundingBox3D) + sizeof(bool) + 2 * sizeof(float) + sizeof(double); // bbox, dirty flag, centroid x/y/t
+
+    // Pairwise overlap of the boxes stored in one node
+    auto addOverlap = [](const auto& entries, LevelStatistics& level, double& summedVolume) {
+        for (size_t i = 0; i < entries.size(); ++i) {
+            summedVolume += entries[i].first.volume();
+            for (size_t j = i + 1; j < entries.size(); ++j)
+                level.overlapVolume += entries[i].first.overlapVolume(entries[j].first);
+        }
+    };
+
+    std::vector<std::shared_ptr<RTreeNode>> current{root};
+    for (int depth = 0; !current.empty(); ++depth) {
+        LevelStatistics level;
+        level.level = depth;
+        double summedVolume = 0.0;
+        std::vector<std::shared_ptr<RTreeNode>> next;
+
+        for (const auto& node : current) {
+            ++report.nodeCount;
+            ++level.nodes;
+            report.nodeBytes += sizeof(RTreeNode) - nodeCache;
+            report.cacheBytes += nodeCache;
+            report.controlBlockBytes += kControlBlockBytes;
+            report.allocatorOverheadBytes += mallocChunkBytes(sizeof(RTreeNode) + kControlBlockBytes)
+                                             - sizeof(RTreeNode) - kControlBlockBytes;
+
+            const auto& leaves = node->getLeafEntries();
+            const auto& children = node->getChildEntries();
+            size_t leafBuffer = leaves.capacity() * sizeof(leaves[0]);
+            size_t childBuffer = children.capacity() * sizeof(children[0]);
+            report.entryVectorBytes += leafBuffer + childBuffer;
+            if (leafBuffer) report.allocatorOverheadBytes += mallocChunkBytes(leafBuffer) - leafBuffer;
+            if (childBuffer) report.allocatorOverheadBytes += mallocChunkBytes(childBuffer) - childBuffer;
+
+            if (node->isLeafNode()) {
+                level.entries += leaves.size();
+                addOverlap(leaves, level, summedVolume);
+                for (const auto& [_, traj] : leaves) {
+                    ++report.trajectoryCount;
+                    report.trajectoryBytes += sizeof(Trajectory) - trajCache;
+                    report.cacheBytes += trajCache;
+                    report.controlBlockBytes += kControlBlockBytes;
+                    report.allocatorOverheadBytes += mallocChunkBytes(sizeof(Trajectory) + kControlBlockBytes)
+                                                     - sizeof(Trajectory) - kControlBlockBytes;
+
+                    const auto& points = traj->getPoints();
+                    size_t pointBuffer = points.capacity() * sizeof(Point3D);
+                    report.pointCount += points.size();
+                    report.pointBytes += pointBuffer;
+                    if (pointBuffer) report.allocatorOverheadBytes += mallocChunkBytes(pointBuffer) - pointBuffer;
+
+                    size_t idBytes = heapStringBytes(traj->getId());
+                    report.idStringBytes += idBytes;
+                    if (idBytes) report.allocatorOverheadBytes += mallocChunkBytes(idBytes) - idBytes;
+                }
+            } else {
+                level.entries += children.size();
+                addOverlap(children, level, summedVolume);
+                for (const auto& [_, child] : children) next.push_back(child);
+            }
+        }
+
+        level.overlapRatio = summedVolume > 0.0 ? level.overlapVolume / summedVolume : 0.0;
+        level.fillFactor = static_cast<double>(level.entries) / (static_cast<double>(level.nodes) * maxEntries);
+        report.levels.push_back(level);
+        current = std::move(next);
+    }
+    return report;
 }
 
 // ---------------- Bulk Load ----------------
 void RTree::bulkLoad(std::vector<Trajectory>& trajectories) {
+    bulkLoadSTR(trajectories, nullptr);
+}
+
+void RTree::bulkLoad(std::vector<Trajectory>& trajectories, const std::vector<TrajectorySummary>& summaries) {
+    if (summaries.size() != trajectories.size())
+        throw std::runtime_error("bulkLoad: " + std::to_string(summaries.size()) + " summaries for " +
+                                 std::to_string(trajectories.size()) + " trajectories");
+    for (size_t i = 0; i < summaries.size(); ++i)
+        if (summaries[i].index != i)
+            throw std::runtime_error("bulkLoad: summaries are not in trajectory order");
+    bulkLoadSTR(trajectories, &summaries);
+}
+
+void RTree::bulkLoadSTR(std::vector<Trajectory>& trajectories, const std::vector<TrajectorySummary>* summaries) {
+    trace::Span span("RTree::bulkLoad", "build");
+    span.setArg("trajectories", static_cast<int64_t>(trajectories.size()));
+    quantized.reset();
     if (trajectories.empty()) {
         root = nullptr;
+        temporal.clear();
+        vehicles.clear();
         return;
     }
 
     std::vector<std::pair<BoundingBox3D, std::shared_ptr<Trajectory>>> entries;
+    std::vector<std::shared_ptr<Trajectory>> trajPtrs;
     entries.reserve(trajectories.size());
-    for (Trajectory& traj : trajectories) {
-        auto trajPtr = std::make_shared<Trajectory>(std::move(traj));
+    trajPtrs.reserve(trajectories.size());
+    for (size_t i = 0; i < trajectories.size(); ++i) {
+        auto trajPtr = std::make_shared<Trajectory>(std::move(trajectories[i]));
+        if (summaries) trajPtr->adoptSummary((*summaries)[i]); // stored boxes must not be computed on read
         entries.emplace_back(trajPtr->getBoundingBox(), trajPtr);
+        trajPtrs.push_back(trajPtr);
+    }
+    {
+        TRACE_SCOPE_CAT("build", "secondary indexes");
+        temporal.build(trajPtrs);
+        vehicles.build(trajPtrs);
     }
 
     auto sortByAxis = [](std::vector<std::pair<BoundingBox3D, std::shared_ptr<Trajectory>>>& v, int axis) {
@@ -198,39 +1272,41 @@ void RTree::bulkLoad(std::vector<Trajectory>& trajectories) {
         return parent;
     };
 
+    TRACE_SCOPE_CAT("build", "STR packing");
     root = buildSTR(entries, 0);
     root->recomputeMBRs(); 
 }
 
 // ---------------- Helper for faster queries ----------------
-std::vector<TrajectorySummary> RTree::computeSummaries(const std::vector<Trajectory>& trajectories) {
-    std::vector<TrajectorySummary> summaries;
-
-    for (const auto& traj : trajectories) {
-        BoundingBox3D bbox = traj.getBoundingBox();
-
-        float sumX = 0.0f, sumY = 0.0f;
-        int64_t sumT = 0; // <-- store sumT as int64_t
-
-        for (const auto& pt : traj.getPoints()) {
-            sumX += pt.getX();
-            sumY += pt.getY();
-            sumT += pt.getT(); // <-- directly use int64_t
+std::vector<TrajectorySummary> RTree::computeSummaries(const std::vector<Trajectory>& trajectories, size_t numThreads) {
+    TRACE_SCOPE_CAT("build", "RTree::computeSummaries");
+    std::vector<TrajectorySummary> summaries(trajectories.size());
+    parallel::parallelFor(trajectories.size(), numThreads, [&](size_t begin, size_t end, size_t) {
+        TRACE_SCOPE_CAT("build", "summaries chunk");
+        for (size_t i = begin; i < end; ++i) {
+            summaries[i] = trajectories[i].summarize();
+            summaries[i].index = static_cast<uint32_t>(i);
         }
+    });
+    return summaries;
+}
 
-        size_t n = traj.getPoints().size();
-        float centroidX = n > 0 ? sumX / n : 0.0f;
-        float centroidY = n > 0 ? sumY / n : 0.0f;
-        float centroidT = n > 0 ? static_cast<float>(sumT) / n : 0.0f; // convert to float for summary
-
-        summaries.push_back({traj.getId(), bbox, centroidX, centroidY, centroidT, std::make_shared<Trajectory>(traj)});
-    }
-
+std::vector<TrajectorySummary> RTree::precomputeSummaries(std::vector<Trajectory>& trajectories, size_t numThreads) {
+    TRACE_SCOPE_CAT("build", "RTree::precomputeSummaries");
+    std::vector<TrajectorySummary> summaries(trajectories.size());
+    parallel::parallelFor(trajectories.size(), numThreads, [&](size_t begin, size_t end, size_t) {
+        TRACE_SCOPE_CAT("build", "summaries chunk");
+        for (size_t i = begin; i < end; ++i) {
+            summaries[i] = trajectories[i].precomputeCentroidAndBoundingBox();
+            summaries[i].index = static_cast<uint32_t>(i);
+        }
+    });
     return summaries;
 }
 
 // ---------------- Load from Parquet ----------------
 std::vector<Trajectory> RTree::loadFromParquet(const std::string& filepath) {
+    trace::Span span("RTree::loadFromParquet", "load");
     std::unordered_map<std::string, Trajectory> traj_map;
 
     std::shared_ptr<arrow::io::ReadableFile> infile;
@@ -263,17 +1339,24 @@ std::vector<Trajectory> RTree::loadFromParquet(const std::string& filepath) {
         if (!vehicle_col_array || !trip_col_array || !x_col_array || !y_col_array || !t_col_array)
             throw std::runtime_error("Missing columns in batch");
 
+        // Typed views once per batch, not per row
+        const auto& vehicle_col = static_cast<const arrow::Int32Array&>(*vehicle_col_array);
+        const auto& trip_col    = static_cast<const arrow::Int32Array&>(*trip_col_array);
+        const auto& x_col       = static_cast<const arrow::FloatArray&>(*x_col_array);
+        const auto& y_col       = static_cast<const arrow::FloatArray&>(*y_col_array);
+        const auto& t_col       = static_cast<const arrow::Int64Array&>(*t_col_array);
+
         int64_t num_rows = batch->num_rows();
         for (int64_t i = 0; i < num_rows; ++i) {
             if (!vehicle_col_array->IsValid(i) || !trip_col_array->IsValid(i) ||
                 !x_col_array->IsValid(i) || !y_col_array->IsValid(i) || !t_col_array->IsValid(i))
                 continue;
 
-            int vehicle_id = std::static_pointer_cast<arrow::Int32Array>(vehicle_col_array)->Value(i);
-            int trip_id    = std::static_pointer_cast<arrow::Int32Array>(trip_col_array)->Value(i);
-            float x        = std::static_pointer_cast<arrow::FloatArray>(x_col_array)->Value(i);
-            float y        = std::static_pointer_cast<arrow::FloatArray>(y_col_array)->Value(i);
-            int64_t t      = std::static_pointer_cast<arrow::Int64Array>(t_col_array)->Value(i); // <-- int64_t
+            int vehicle_id = vehicle_col.Value(i);
+            int trip_id    = trip_col.Value(i);
+            float x        = x_col.Value(i);
+            float y        = y_col.Value(i);
+            int64_t t      = t_col.Value(i); // <-- int64_t
             //std::cout<< "Debug: Loaded point - vehicle_id: " << vehicle_id << ", trip_id: " << trip_id << ", x: " << x << ", y: " << y << ", t: " << t << std::endl;
 
             std::string traj_id = std::to_string(vehicle_id) + "_" + std::to_string(trip_id);
@@ -290,10 +1373,14 @@ std::vector<Trajectory> RTree::loadFromParquet(const std::string& filepath) {
 
     std::vector<Trajectory> trajectories;
     trajectories.reserve(traj_map.size());
+    PointValidationReport validation;
     for (auto& [_, traj] : traj_map) {
+        validation += Point3D::validate(traj.getPoints());
         trajectories.push_back(std::move(traj));
     }
+    if (validation.invalidPoints > 0) validation.print(std::cerr, filepath);
 
+    span.setArg("trajectories", static_cast<int64_t>(trajectories.size()));
     return trajectories;
 }
 
@@ -30,7 +30,7 @@ struct ResultEntry {
  // Initialize node as leaf/internal with maxEntries
 
 RTreeNode::RTreeNode(bool isLeaf, int maxEntries)
-    : isLeaf(isLeaf), maxEntries(maxEntries), mbr_dirty(true) {
+    : isLeaf(isLeaf), maxEntries(maxEntries), mbr_dirty(true), aggregate_dirty(true) {
 }  
 
 // ---------------- Node Info ----------------
@@ -59,6 +59,7 @@ BoundingBox3D RTreeNode::getMBR() const {
 void RTreeNode::markDirty() {
    
     mbr_dirty = true;
+    aggregate_dirty = true;
     if (auto p = parent.lock()) p->markDirty();
 }
 
@@ -89,6 +90,41 @@ void RTreeNode::recomputeMBRs() {
     }
     // Update this node's MBR after children
     updateMBR();
+    updateAggregate();
+}
+
+// Only invalidated nodes are visited: markDirty flags every ancestor of a change
+void RTreeNode::refreshCaches() {
+    if (!mbr_dirty && !aggregate_dirty) return;
+    if (!isLeaf) {
+        for (auto& [box, child] : childEntries) {
+            child->refreshCaches();
+            box = child->mbr; // stored boxes shrink with deletions too
+        }
+    }
+    updateMBR();
+    updateAggregate();
+}
+
+// ---------------- Aggregate Management ----------------
+const NodeAggregate& RTreeNode::getAggregate() const {
+    if (aggregate_dirty) updateAggregate();
+    return aggregate;
+}
+
+void RTreeNode::updateAggregate() const {
+    aggregate.clear();
+
+    if (isLeaf) {
+        for (const auto& [_, traj] : leafEntries)
+            if (traj) aggregate.add(*traj);
+    } else {
+        // Children refresh their own aggregates on demand
+        for (const auto& [_, child] : childEntries)
+            aggregate.merge(child->getAggregate());
+    }
+
+    aggregate_dirty = false;
 }
 
  // Compute how much current MBR would grow to include 'toInclude'
@@ -126,13 +162,17 @@ int RTreeNode::chooseSubtree(const BoundingBox3D& box) const {
 
 // Recursively insert trajectory into tree
 std::pair<std::shared_ptr<RTreeNode>, std::shared_ptr<RTreeNode>> RTreeNode::insertRecursive(const Trajectory &traj) {
+    return insertRecursive(std::make_shared<Trajectory>(traj));
+}
+
+std::pair<std::shared_ptr<RTreeNode>, std::shared_ptr<RTreeNode>> RTreeNode::insertRecursive(const std::shared_ptr<Trajectory>& traj) {
     return isLeaf ? insertIntoLeaf(traj) : insertIntoInternal(traj);
 }
 
 // Insert trajectory into a leaf node
 std::pair<std::shared_ptr<RTreeNode>, std::shared_ptr<RTreeNode>> 
-RTreeNode::insertIntoLeaf(const Trajectory &traj) {
-    insertLeaf(traj.getBoundingBox(), std::make_shared<Trajectory>(traj));
+RTreeNode::insertIntoLeaf(const std::shared_ptr<Trajectory>& traj) {
+    insertLeaf(traj->getBoundingBox(), traj);
 
     // Split node if overfull
     if ((int)leafEntries.size() > maxEntries) return splitLeaf();
@@ -143,7 +183,7 @@ RTreeNode::insertIntoLeaf(const Trajectory &traj) {
 // Insert trajectory into internal node
 // ---------------- Insert into internal node ----------------
 std::pair<std::shared_ptr<RTreeNode>, std::shared_ptr<RTreeNode>> 
-RTreeNode::insertIntoInternal(const Trajectory &traj) {
+RTreeNode::insertIntoInternal(const std::shared_ptr<Trajectory>& traj) {
     // ---------------- Safety Checks ----------------
     if (childEntries.empty()) {
        // std::cerr << "[insertIntoInternal] ERROR: Internal node has no children!\n";
@@ -151,7 +191,7 @@ RTreeNode::insertIntoInternal(const Trajectory &traj) {
     }
 
     // Choose the best child for insertion
-    int bestChildIndex = chooseSubtree(traj.getBoundingBox());
+    int bestChildIndex = chooseSubtree(traj->getBoundingBox());
     if (bestChildIndex < 0 || bestChildIndex >= static_cast<int>(childEntries.size())) {
     //    std::cerr << "[insertIntoInternal] ERROR: chooseSubtree returned invalid index "
        //           << bestChildIndex << "\n";
@@ -171,7 +211,10 @@ RTreeNode::insertIntoInternal(const Trajectory &traj) {
     auto [splitLeft, splitRight] = childNode->insertRecursive(traj);
 
     // ---------------- Handle Child Split ----------------
-    if (splitLeft && splitRight) {
+    if (!splitLeft || !splitRight) {
+        // Child absorbed the entry; its box in this node must grow with it
+        childEntries[bestChildIndex].first = childNode->getMBR();
+    } else {
        // std::cout << "[insertIntoInternal] Child split detected. Updating internal node.\n";
 
         // Remove old child
@@ -275,8 +318,38 @@ void RTreeNode::rangeQuery(const BoundingBox3D& queryBox, std::vector<Trajectory
     }
 }
 
+// Aggregate over trajectories intersecting queryBox
+void RTreeNode::aggregateQuery(const BoundingBox3D& queryBox, NodeAggregate& result,
+                               size_t& nodesVisited, size_t& trajectoriesRead) const {
+    BoundingBox3D box = getMBR();
+    if (!box.intersects(queryBox)) return;
+    ++nodesVisited;
+
+    // Every entry intersects the query: the stored aggregate is the answer for this subtree
+    if (queryBox.contains(box)) {
+        result.merge(getAggregate());
+        return;
+    }
+
+    if (isLeaf) {
+        // Boundary leaf: only entries that actually intersect are read
+        for (const auto& [entryBox, traj] : leafEntries) {
+            if (!queryBox.intersects(entryBox)) continue;
+            result.add(*traj);
+            ++trajectoriesRead;
+        }
+    } else {
+        for (const auto& [_, child] : childEntries)
+            child->aggregateQuery(queryBox, result, nodesVisited, trajectoriesRead);
+    }
+}
+
 // Find similar trajectories within threshold
 void RTreeNode::findSimilar(const Trajectory& query, float maxDistance, std::vector<Trajectory>& results) const {
+    findSimilar(query, maxDistance, [&](const std::shared_ptr<Trajectory>& traj) { results.push_back(*traj); });
+}
+
+void RTreeNode::findSimilar(const Trajectory& query, float maxDistance, const TrajectoryVisitor& visit) const {
     BoundingBox3D queryBox = query.getBoundingBox(); // use precomputed bounding box
 
     // Prune node if minimum distance to queryBox exceeds threshold
@@ -298,7 +371,7 @@ void RTreeNode::findSimilar(const Trajectory& query, float maxDistance, std::vec
             if (approxDist <= maxDistance) {
                 // Optional: recompute exact spatio-temporal similarity
                 if (query.similarityTo(*trajPtr) <= maxDistance) {
-                    results.push_back(*trajPtr);
+                    visit(trajPtr);
                 }
             }
         }
@@ -307,7 +380,7 @@ void RTreeNode::findSimilar(const Trajectory& query, float maxDistance, std::vec
         for (const auto& [childBox, child] : childEntries) {
             float minDistSq = childBox.distanceSquaredTo(queryBox);
             if (minDistSq <= maxDistance * maxDistance) {
-                child->findSimilar(query, maxDistance, results);
+                child->findSimilar(query, maxDistance, visit);
             }
         }
     }
@@ -413,6 +486,9 @@ bool RTreeNode::deleteTrajectory(const std::string& trajId) {
         }
         return false;
     } else {
+        // condenseTree may detach this node from the tree; keep it alive until we return
+        auto self = shared_from_this();
+
         // Recurse into children
         for (auto& [_, child] : childEntries)
             if (child->deleteTrajectory(trajId)) { markDirty(); return true; }
@@ -424,8 +500,9 @@ bool RTreeNode::deleteTrajectory(const std::string& trajId) {
 bool RTreeNode::updateTrajectory(const Trajectory& traj) {
     if (!isLeaf) {
         // Recurse into children
-        for (auto& [_, child] : childEntries) {
+        for (auto& [box, child] : childEntries) {
             if (child->updateTrajectory(traj)) {
+                box = child->getMBR(); // Child's box may have grown
                 updateMBR(); // Update MBR if child changed
                 return true;
             }
@@ -441,6 +518,7 @@ bool RTreeNode::updateTrajectory(const Trajectory& traj) {
             if (mbr.intersects(newBox)) {
                 // Replace trajectory in place
                 *trajPtr = traj;
+                bbox = newBox;
                 markDirty(); // MBR may still need update
                 return true;
             } else {
@@ -495,12 +573,13 @@ void RTreeNode::condenseTree() {
     }
 
     if (p) {
-        // Recursively condense up the tree
-        p->condenseTree();
-
-        // Reinsert orphaned children into the parent
+        // Reinsert orphaned children into the parent first, so they move up
+        // with its entries if the parent is dissolved as well
         for (auto& child : toReinsert) 
             p->insertChild(child->getMBR(), child);
+
+        // Recursively condense up the tree
+        p->condenseTree();
     }
 }
 
@@ -75,6 +75,12 @@ bool BoundingBox3D::contains(const Point3D& pt, float epsilon) const {
             t >= minT && t <= maxT);
 }
 
+bool BoundingBox3D::contains(const BoundingBox3D& other, float epsilon) const {
+    return other.minX >= minX - epsilon && other.maxX <= maxX + epsilon &&
+           other.minY >= minY - epsilon && other.maxY <= maxY + epsilon &&
+           other.minT >= minT && other.maxT <= maxT;
+}
+
 float BoundingBox3D::volume() const {
     if (!validate()) return 0.0f;
     float dx = maxX - minX;
@@ -83,6 +89,15 @@ float BoundingBox3D::volume() const {
     return std::max(0.0f, dx * dy * dt);
 }
 
+float BoundingBox3D::overlapVolume(const BoundingBox3D& other) const {
+    if (!validate() || !other.validate()) return 0.0f;
+    float dx = std::min(maxX, other.maxX) - std::max(minX, other.minX);
+    float dy = std::min(maxY, other.maxY) - std::max(minY, other.minY);
+    float dt = static_cast<float>(std::min(maxT, other.maxT) - std::max(minT, other.minT));
+    if (dx <= 0.0f || dy <= 0.0f || dt <= 0.0f) return 0.0f;
+    return dx * dy * dt;
+}
+
 float BoundingBox3D::spatialDistanceSquared(const BoundingBox3D& other) const {
     float dx = std::max(0.0f, std::max(other.minX - maxX, minX - other.maxX));
     float dy = std::max(0.0f, std::max(other.minY - maxY, minY - other.maxY));
@@ -0,0 +1,121 @@
+#include "../include/bufferPool.h"
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+PageIOStats& PageIOStats::operator+=(const PageIOStats& other) {
+    requests += other.requests;
+    faults += other.faults;
+    bytesRead += other.bytesRead;
+    return *this;
+}
+
+// ---------------- Constructors ----------------
+BufferPool::BufferPool(const std::string& path, size_t pageSize, size_t capacity, EvictionPolicy policy)
+    : pageSize(pageSize), capacity(capacity), policy(policy) {
+    if (pageSize == 0) throw std::invalid_argument("BufferPool page size must be positive");
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("BufferPool cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("BufferPool cannot stat " + path);
+    }
+    filePages = static_cast<uint64_t>(st.st_size) / pageSize;
+    frames.reserve(capacity);
+}
+
+BufferPool::~BufferPool() {
+    if (fd >= 0) ::close(fd);
+}
+
+// ---------------- Access ----------------
+BufferPool::Page BufferPool::fetch(uint64_t pageId, PageIOStats* io) {
+    if (pageId >= filePages) throw std::out_of_range("BufferPool page " + std::to_string(pageId) + " past end of file");
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++totals.requests;
+        auto it = frameOf.find(pageId);
+        if (it != frameOf.end()) {
+            Frame& frame = frames[it->second];
+            if (policy == EvictionPolicy::LRU) lru.splice(lru.begin(), lru, frame.lruPos);
+            else frame.referenced = true;
+            if (io) ++io->requests;
+            return frame.data;
+        }
+        ++totals.faults;
+        totals.bytesRead += pageSize;
+    }
+    if (io) {
+        ++io->requests;
+        ++io->faults;
+        io->bytesRead += pageSize;
+    }
+
+    // Read outside the lock
+    auto buffer = std::make_shared<std::vector<uint8_t>>(pageSize);
+    size_t done = 0;
+    while (done < pageSize) {
+        ssize_t n = ::pread(fd, buffer->data() + done, pageSize - done, static_cast<off_t>(pageId * pageSize + done));
+        if (n <= 0) throw std::runtime_error("BufferPool short read of page " + std::to_string(pageId));
+        done += static_cast<size_t>(n);
+    }
+    Page page = std::move(buffer);
+    if (capacity == 0) return page;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = frameOf.find(pageId);
+    if (it != frameOf.end()) return frames[it->second].data; // another thread loaded it meanwhile
+
+    size_t f;
+    if (frames.size() < capacity) {
+        f = frames.size();
+        frames.emplace_back();
+        if (policy == EvictionPolicy::LRU) frames[f].lruPos = lru.insert(lru.begin(), f);
+    } else {
+        f = victim();
+        frameOf.erase(frames[f].pageId);
+        if (policy == EvictionPolicy::LRU) lru.splice(lru.begin(), lru, frames[f].lruPos);
+    }
+    frames[f].pageId = pageId;
+    frames[f].data = page;
+    frames[f].referenced = true;
+    frameOf.emplace(pageId, f);
+    return page;
+}
+
+size_t BufferPool::victim() {
+    if (policy == EvictionPolicy::LRU) return lru.back();
+    while (frames[hand].referenced) {
+        frames[hand].referenced = false;
+        hand = (hand + 1) % frames.size();
+    }
+    size_t f = hand;
+    hand = (hand + 1) % frames.size();
+    return f;
+}
+
+// ---------------- Info ----------------
+size_t BufferPool::residentPages() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return frames.size();
+}
+
+PageIOStats BufferPool::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return totals;
+}
+
+void BufferPool::resetStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    totals = PageIOStats();
+}
+
+size_t BufferPool::memoryUsage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Frame buffers, frame table, page map nodes plus buckets, LRU list nodes
+    return frames.size() * pageSize + frames.capacity() * sizeof(Frame) +
+           frameOf.size() * (sizeof(std::pair<const uint64_t, size_t>) + sizeof(void*)) +
+           frameOf.bucket_count() * sizeof(void*) + lru.size() * (sizeof(size_t) + 2 * sizeof(void*));
+}
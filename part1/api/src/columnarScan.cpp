@@ -0,0 +1,234 @@
+#include "../include/columnarScan.h"
+#include "../include/parallel.h"
+#include <algorithm>
+#include <queue>
+#include <cstdint>
+
+// Entries evaluated per kernel call; a fixed trip count lets the compiler vectorize
+static constexpr size_t kBlock = 256;
+
+// Query-side constants of approximateDistance, precomputed once per query
+struct ColumnarScan::DistanceQuery {
+    float cx, cy;
+    double ct;
+    float timeScale;
+    float minX, minY, maxX, maxY;
+    double minT, maxT;
+};
+
+static ColumnarScan::DistanceQuery makeDistanceQuery(const Trajectory& query, float timeScale) {
+    BoundingBox3D box = query.getBoundingBox();
+    return {query.getCentroidX(), query.getCentroidY(), query.getCentroidT(), timeScale,
+            box.getMinX(), box.getMinY(), box.getMaxX(), box.getMaxY(),
+            static_cast<double>(box.getMinT()), static_cast<double>(box.getMaxT())};
+}
+
+// ---------------- Constructor ----------------
+ColumnarScan::ColumnarScan(const std::vector<Trajectory>& trajectories) {
+    size_t n = trajectories.size();
+    minX.resize(n); minY.resize(n); maxX.resize(n); maxY.resize(n);
+    minT.resize(n); maxT.resize(n);
+    centroidX.resize(n); centroidY.resize(n); centroidT.resize(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        BoundingBox3D box = trajectories[i].getBoundingBox();
+        minX[i] = box.getMinX(); minY[i] = box.getMinY();
+        maxX[i] = box.getMaxX(); maxY[i] = box.getMaxY();
+        minT[i] = static_cast<double>(box.getMinT());
+        maxT[i] = static_cast<double>(box.getMaxT());
+        centroidX[i] = trajectories[i].getCentroidX();
+        centroidY[i] = trajectories[i].getCentroidY();
+        centroidT[i] = trajectories[i].getCentroidT();
+    }
+}
+
+ColumnarScan::ColumnarScan(const std::vector<TrajectorySummary>& summaries) {
+    size_t n = summaries.size();
+    minX.resize(n); minY.resize(n); maxX.resize(n); maxY.resize(n);
+    minT.resize(n); maxT.resize(n);
+    centroidX.resize(n); centroidY.resize(n); centroidT.resize(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        const BoundingBox3D& box = summaries[i].bbox;
+        minX[i] = box.getMinX(); minY[i] = box.getMinY();
+        maxX[i] = box.getMaxX(); maxY[i] = box.getMaxY();
+        minT[i] = static_cast<double>(box.getMinT());
+        maxT[i] = static_cast<double>(box.getMaxT());
+        centroidX[i] = summaries[i].centroidX;
+        centroidY[i] = summaries[i].centroidY;
+        centroidT[i] = summaries[i].centroidT;
+    }
+}
+
+// ---------------- Range Query ----------------
+std::vector<size_t> ColumnarScan::rangeQuery(const BoundingBox3D& queryBox, size_t numThreads) const {
+    const float eps = 1e-6f; // same tolerance as BoundingBox3D::intersects
+    const float qMinX = queryBox.getMinX(), qMaxX = queryBox.getMaxX();
+    const float qMinY = queryBox.getMinY(), qMaxY = queryBox.getMaxY();
+    const double qMinT = static_cast<double>(queryBox.getMinT());
+    const double qMaxT = static_cast<double>(queryBox.getMaxT());
+
+    // Evaluate the intersection test for entries [base, base + count) into mask
+    auto kernel = [&](size_t base, size_t count, uint8_t* __restrict mask) {
+        const float* __restrict x0 = minX.data() + base;
+        const float* __restrict x1 = maxX.data() + base;
+        const float* __restrict y0 = minY.data() + base;
+        const float* __restrict y1 = maxY.data() + base;
+        const double* __restrict t0 = minT.data() + base;
+        const double* __restrict t1 = maxT.data() + base;
+        auto test = [&](size_t i) -> uint8_t {
+            return !((x1[i] + eps < qMinX) | (x0[i] > qMaxX + eps) |
+                     (y1[i] + eps < qMinY) | (y0[i] > qMaxY + eps) |
+                     (t1[i] < qMinT) | (t0[i] > qMaxT));
+        };
+        if (count == kBlock) {
+            for (size_t i = 0; i < kBlock; ++i) mask[i] = test(i);
+        } else {
+            for (size_t i = 0; i < count; ++i) mask[i] = test(i);
+        }
+    };
+
+    size_t threads = parallel::resolveThreadCount(numThreads);
+    std::vector<std::vector<size_t>> partial(threads);
+
+    parallel::parallelFor(size(), threads, [&](size_t begin, size_t end, size_t t) {
+        uint8_t mask[kBlock];
+        auto& out = partial[t];
+        for (size_t base = begin; base < end; base += kBlock) {
+            size_t count = std::min(kBlock, end - base);
+            kernel(base, count, mask);
+            for (size_t i = 0; i < count; ++i)
+                if (mask[i]) out.push_back(base + i);
+        }
+    });
+
+    std::vector<size_t> results = std::move(partial[0]);
+    for (size_t t = 1; t < partial.size(); ++t)
+        results.insert(results.end(), partial[t].begin(), partial[t].end());
+    return results;
+}
+
+// ---------------- Distance kernel ----------------
+
+// Branch-free max (std::max returns a reference and blocks if-conversion)
+static inline float maxf(float a, float b) { return a > b ? a : b; }
+
+// Writes approximateDistance for entries [0, n) of the given columns into dist.
+// FullBlock fixes the trip count at kBlock so the loop vectorizes at -O2.
+template <bool FullBlock>
+static void distanceLoop(const ColumnarScan::DistanceQuery& q,
+                         const float* __restrict cx, const float* __restrict cy, const double* __restrict ct,
+                         const float* __restrict x0, const float* __restrict x1,
+                         const float* __restrict y0, const float* __restrict y1,
+                         const double* __restrict t0, const double* __restrict t1,
+                         size_t count, float* __restrict dist) {
+    const size_t n = FullBlock ? kBlock : count;
+    const float qcx = q.cx, qcy = q.cy, scale = q.timeScale;
+    const double qct = q.ct, qMinT = q.minT, qMaxT = q.maxT;
+    const float qMinX = q.minX, qMaxX = q.maxX, qMinY = q.minY, qMaxY = q.maxY;
+
+    for (size_t i = 0; i < n; ++i) {
+        float dx = qcx - cx[i];
+        float dy = qcy - cy[i];
+        float dt = static_cast<float>(qct - ct[i]) * scale;
+        float centroidDistSq = dx * dx + dy * dy + dt * dt;
+
+        float bx = maxf(0.0f, maxf(x0[i] - qMaxX, qMinX - x1[i]));
+        float by = maxf(0.0f, maxf(y0[i] - qMaxY, qMinY - y1[i]));
+        float bt = maxf(0.0f, maxf(static_cast<float>(t0[i] - qMaxT),
+                                   static_cast<float>(qMinT - t1[i])));
+        dist[i] = centroidDistSq + (bx * bx + by * by + bt * bt);
+    }
+}
+
+// Distances for entries [base, base + count) into out
+void ColumnarScan::distances(const DistanceQuery& q, size_t base, size_t count, float* out) const {
+    if (count == kBlock)
+        distanceLoop<true>(q, centroidX.data() + base, centroidY.data() + base, centroidT.data() + base,
+                           minX.data() + base, maxX.data() + base, minY.data() + base, maxY.data() + base,
+                           minT.data() + base, maxT.data() + base, count, out);
+    else
+        distanceLoop<false>(q, centroidX.data() + base, centroidY.data() + base, centroidT.data() + base,
+                            minX.data() + base, maxX.data() + base, minY.data() + base, maxY.data() + base,
+                            minT.data() + base, maxT.data() + base, count, out);
+}
+
+float ColumnarScan::approximateDistance(const Trajectory& query, size_t i, float timeScale) const {
+    DistanceQuery q = makeDistanceQuery(query, timeScale);
+    float d;
+    distances(q, i, 1, &d);
+    return d;
+}
+
+// ---------------- kNN (bounded max-heap per thread) ----------------
+std::vector<size_t> ColumnarScan::kNearest(const Trajectory& query, size_t k, float timeScale,
+                                           size_t exclude, size_t numThreads) const {
+    if (k == 0) return {};
+    using Candidate = std::pair<float, size_t>; // distance, index
+    DistanceQuery q = makeDistanceQuery(query, timeScale);
+
+    size_t threads = parallel::resolveThreadCount(numThreads);
+    std::vector<std::vector<Candidate>> heaps(threads);
+
+    parallel::parallelFor(size(), threads, [&](size_t begin, size_t end, size_t t) {
+        float dist[kBlock];
+        auto& heap = heaps[t]; // max-heap on distance, at most k entries
+        for (size_t base = begin; base < end; base += kBlock) {
+            size_t count = std::min(kBlock, end - base);
+            distances(q, base, count, dist);
+            for (size_t i = 0; i < count; ++i) {
+                if (base + i == exclude) continue;
+                if (heap.size() < k) {
+                    heap.emplace_back(dist[i], base + i);
+                    std::push_heap(heap.begin(), heap.end());
+                } else if (dist[i] < heap.front().first) {
+                    std::pop_heap(heap.begin(), heap.end());
+                    heap.back() = {dist[i], base + i};
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+        }
+    });
+
+    std::vector<Candidate> merged;
+    for (auto& h : heaps) merged.insert(merged.end(), h.begin(), h.end());
+    size_t keep = std::min(k, merged.size());
+    std::partial_sort(merged.begin(), merged.begin() + keep, merged.end());
+
+    std::vector<size_t> results;
+    results.reserve(keep);
+    for (size_t i = 0; i < keep; ++i) results.push_back(merged[i].second);
+    return results;
+}
+
+// ---------------- Distance threshold ----------------
+std::vector<size_t> ColumnarScan::withinDistance(const Trajectory& query, float maxDistance, float timeScale,
+                                                 size_t exclude, size_t numThreads) const {
+    DistanceQuery q = makeDistanceQuery(query, timeScale);
+
+    size_t threads = parallel::resolveThreadCount(numThreads);
+    std::vector<std::vector<size_t>> partial(threads);
+
+    parallel::parallelFor(size(), threads, [&](size_t begin, size_t end, size_t t) {
+        float dist[kBlock];
+        auto& out = partial[t];
+        for (size_t base = begin; base < end; base += kBlock) {
+            size_t count = std::min(kBlock, end - base);
+            distances(q, base, count, dist);
+            for (size_t i = 0; i < count; ++i)
+                if (dist[i] <= maxDistance && base + i != exclude) out.push_back(base + i);
+        }
+    });
+
+    std::vector<size_t> results = std::move(partial[0]);
+    for (size_t t = 1; t < partial.size(); ++t)
+        results.insert(results.end(), partial[t].begin(), partial[t].end());
+    return results;
+}
+
+// ---------------- Memory ----------------
+size_t ColumnarScan::memoryUsage() const {
+    return (minX.capacity() + minY.capacity() + maxX.capacity() + maxY.capacity() +
+            centroidX.capacity() + centroidY.capacity()) * sizeof(float) +
+           (minT.capacity() + maxT.capacity() + centroidT.capacity()) * sizeof(double);
+}
@@ -0,0 +1,170 @@
+#include "../include/compressedTrajectory.h"
+#include <cmath>
+#include <algorithm>
+#include <stdexcept>
+
+// ---------------- Varint helpers ----------------
+
+static inline uint64_t zigzagEncode(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+static inline int64_t zigzagDecode(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+static void putVarint(std::vector<uint8_t>& out, int64_t value) {
+    uint64_t v = zigzagEncode(value);
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+static inline int64_t getVarint(const uint8_t*& p) {
+    uint64_t v = *p++;
+    if (v < 0x80) return zigzagDecode(v); // common case: small deltas
+    v &= 0x7f;
+    for (int shift = 7;; shift += 7) {
+        uint64_t byte = *p++;
+        v |= (byte & 0x7f) << shift;
+        if (byte < 0x80) break;
+    }
+    return zigzagDecode(v);
+}
+
+static inline int64_t toFixed(float v) { return std::llround(static_cast<double>(v) * CompressedTrajectory::kCoordScale); }
+static inline float fromFixed(int64_t q) { return static_cast<float>(q / CompressedTrajectory::kCoordScale); }
+
+// ---------------- Constructor ----------------
+CompressedTrajectory::CompressedTrajectory(const Trajectory& traj)
+    : id(traj.getId()), bbox(traj.getBoundingBox()),
+      centroidX(traj.getCentroidX()), centroidY(traj.getCentroidY()), centroidT(traj.getCentroidT()) {
+    const auto& points = traj.getPoints();
+    pointCount = static_cast<uint32_t>(points.size());
+    blocks.reserve((points.size() + kBlockSize - 1) / kBlockSize);
+    data.reserve(points.size() * 4);
+
+    for (size_t start = 0; start < points.size(); start += kBlockSize) {
+        size_t end = std::min(points.size(), start + kBlockSize);
+        Block block{static_cast<uint32_t>(data.size()), toFixed(points[start].getX()),
+                    toFixed(points[start].getY()), points[start].getT()};
+        blocks.push_back(block);
+
+        int64_t prevX = block.x0, prevY = block.y0, prevT = block.t0, prevDelta = 0;
+        for (size_t i = start + 1; i < end; ++i) {
+            int64_t x = toFixed(points[i].getX());
+            int64_t y = toFixed(points[i].getY());
+            int64_t delta = points[i].getT() - prevT;
+            putVarint(data, delta - prevDelta);
+            putVarint(data, x - prevX);
+            putVarint(data, y - prevY);
+            prevX = x; prevY = y; prevT = points[i].getT(); prevDelta = delta;
+        }
+    }
+    data.shrink_to_fit();
+}
+
+// ---------------- Decoding ----------------
+void CompressedTrajectory::decodeBlock(size_t b, std::vector<Point3D>& out) const {
+    if (b >= blocks.size()) throw std::out_of_range("CompressedTrajectory block index out of range");
+    const Block& block = blocks[b];
+    size_t count = std::min<size_t>(kBlockSize, pointCount - b * kBlockSize);
+
+    const uint8_t* p = data.data() + block.byteOffset;
+    int64_t x = block.x0, y = block.y0, t = block.t0, delta = 0;
+    out.emplace_back(fromFixed(x), fromFixed(y), t);
+    for (size_t i = 1; i < count; ++i) {
+        delta += getVarint(p);
+        t += delta;
+        x += getVarint(p);
+        y += getVarint(p);
+        out.emplace_back(fromFixed(x), fromFixed(y), t);
+    }
+}
+
+std::vector<Point3D> CompressedTrajectory::decodePoints() const {
+    std::vector<Point3D> points;
+    points.reserve(pointCount);
+    for (size_t b = 0; b < blocks.size(); ++b) decodeBlock(b, points);
+    return points;
+}
+
+Point3D CompressedTrajectory::pointAt(size_t index) const {
+    if (index >= pointCount) throw std::out_of_range("CompressedTrajectory point index out of range");
+    std::vector<Point3D> block;
+    block.reserve(kBlockSize);
+    decodeBlock(index / kBlockSize, block);
+    return block[index % kBlockSize];
+}
+
+Trajectory CompressedTrajectory::decode() const {
+    return Trajectory(decodePoints(), id); // constructor precomputes centroid and bbox
+}
+
+size_t CompressedTrajectory::memoryUsage() const {
+    return blocks.capacity() * sizeof(Block) + data.capacity();
+}
+
+// ---------------- Store ----------------
+CompressedTrajectoryStore::CompressedTrajectoryStore(const std::vector<Trajectory>& trajectories, size_t hotCapacity)
+    : hotCapacity(hotCapacity) {
+    compressed.reserve(trajectories.size());
+    for (const auto& traj : trajectories) {
+        indexById.emplace(traj.getId(), compressed.size());
+        compressed.emplace_back(traj);
+    }
+}
+
+std::shared_ptr<const Trajectory> CompressedTrajectoryStore::get(size_t index) const {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        auto it = hot.find(index);
+        if (it != hot.end()) {
+            ++hits;
+            lru.splice(lru.begin(), lru, it->second.second); // mark most recently used
+            return it->second.first;
+        }
+        ++misses;
+    }
+
+    // Decode outside the lock; a concurrent miss on the same index just decodes twice
+    auto decoded = std::make_shared<const Trajectory>(compressed.at(index).decode());
+    if (hotCapacity == 0) return decoded;
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    auto it = hot.find(index);
+    if (it != hot.end()) return it->second.first;
+
+    lru.push_front(index);
+    hot.emplace(index, std::make_pair(decoded, lru.begin()));
+    if (hot.size() > hotCapacity) {
+        hot.erase(lru.back());
+        lru.pop_back();
+    }
+    return decoded;
+}
+
+std::shared_ptr<const Trajectory> CompressedTrajectoryStore::get(const std::string& id) const {
+    auto it = indexById.find(id);
+    return it == indexById.end() ? nullptr : get(it->second);
+}
+
+size_t CompressedTrajectoryStore::compressedBytes() const {
+    size_t total = 0;
+    for (const auto& c : compressed) total += c.memoryUsage();
+    return total;
+}
+
+size_t CompressedTrajectoryStore::hotBytes() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    size_t total = 0;
+    for (const auto& [_, entry] : hot) total += entry.first->getPoints().capacity() * sizeof(Point3D);
+    return total;
+}
+
+size_t CompressedTrajectoryStore::hitCount() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return hits;
+}
+
+size_t CompressedTrajectoryStore::missCount() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return misses;
+}
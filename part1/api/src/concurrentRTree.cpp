@@ -0,0 +1,332 @@
+#include "../include/concurrentRTree.h"
+#include "../include/RTree.h"
+#include <algorithm>
+#include <queue>
+#include <limits>
+#include <functional>
+#include <cmath>
+
+using Node = ConcurrentRTree::Node;
+using NodePtr = std::shared_ptr<const Node>;
+
+// ---------------- Node construction ----------------
+// Every node is built complete (MBR and count included) before anyone can see it
+
+static NodePtr makeLeaf(std::vector<std::pair<BoundingBox3D, std::shared_ptr<const Trajectory>>> entries) {
+    auto node = std::make_shared<Node>();
+    node->leaf = true;
+    for (const auto& [box, _] : entries) node->mbr.expandToInclude(box);
+    node->count = entries.size();
+    node->entries = std::move(entries);
+    return node;
+}
+
+static NodePtr makeInternal(std::vector<std::pair<BoundingBox3D, NodePtr>> children) {
+    auto node = std::make_shared<Node>();
+    node->leaf = false;
+    for (const auto& [box, child] : children) {
+        node->mbr.expandToInclude(box);
+        node->count += child->count;
+    }
+    node->children = std::move(children);
+    return node;
+}
+
+// Copy an RTree subtree into immutable nodes
+static NodePtr freeze(const RTreeNode& node) {
+    if (node.isLeafNode()) {
+        std::vector<std::pair<BoundingBox3D, std::shared_ptr<const Trajectory>>> entries;
+        for (const auto& [_, traj] : node.getLeafEntries()) entries.emplace_back(traj->getBoundingBox(), traj);
+        return makeLeaf(std::move(entries));
+    }
+    std::vector<std::pair<BoundingBox3D, NodePtr>> children;
+    for (const auto& [_, child] : node.getChildEntries()) {
+        NodePtr frozen = freeze(*child);
+        if (frozen->count > 0) children.emplace_back(frozen->mbr, frozen);
+    }
+    return makeInternal(std::move(children));
+}
+
+// ---------------- Quadratic split ----------------
+static float enlargement(const BoundingBox3D& box, const BoundingBox3D& add) {
+    BoundingBox3D combined = box;
+    combined.expandToInclude(add);
+    return combined.volume() - box.volume();
+}
+
+// Guttman's quadratic split on an entry list (leaf or internal), keeping at least minFill per side
+template <typename Entry>
+static std::pair<std::vector<Entry>, std::vector<Entry>> splitEntries(std::vector<Entry> entries, size_t minFill) {
+    size_t seedA = 0, seedB = 1;
+    float worst = -std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < entries.size(); ++i) {
+        for (size_t j = i + 1; j < entries.size(); ++j) {
+            BoundingBox3D combined = entries[i].first;
+            combined.expandToInclude(entries[j].first);
+            float waste = combined.volume() - entries[i].first.volume() - entries[j].first.volume();
+            if (waste > worst) { worst = waste; seedA = i; seedB = j; }
+        }
+    }
+
+    std::vector<Entry> a{entries[seedA]}, b{entries[seedB]};
+    BoundingBox3D boxA = entries[seedA].first, boxB = entries[seedB].first;
+    entries.erase(entries.begin() + seedB);   // seedB > seedA
+    entries.erase(entries.begin() + seedA);
+
+    while (!entries.empty()) {
+        // Force the rest into a side that would otherwise stay below minFill
+        if (a.size() + entries.size() <= minFill) { a.insert(a.end(), entries.begin(), entries.end()); break; }
+        if (b.size() + entries.size() <= minFill) { b.insert(b.end(), entries.begin(), entries.end()); break; }
+
+        // Next: the entry with the strongest preference for one side
+        size_t next = 0;
+        float bestDiff = -1.0f;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            float diff = std::fabs(enlargement(boxA, entries[i].first) - enlargement(boxB, entries[i].first));
+            if (diff > bestDiff) { bestDiff = diff; next = i; }
+        }
+        float growA = enlargement(boxA, entries[next].first), growB = enlargement(boxB, entries[next].first);
+        bool toA = growA < growB || (growA == growB && a.size() <= b.size());
+        (toA ? boxA : boxB).expandToInclude(entries[next].first);
+        (toA ? a : b).push_back(std::move(entries[next]));
+        entries.erase(entries.begin() + next);
+    }
+    return {std::move(a), std::move(b)};
+}
+
+// ---------------- Path-copying insert / remove ----------------
+// Returns the replacement for node: one node, or two if it split
+static std::pair<NodePtr, NodePtr> insertPath(const NodePtr& node, const BoundingBox3D& box,
+                                              const std::shared_ptr<const Trajectory>& traj, size_t maxEntries) {
+    size_t minFill = std::max<size_t>(1, maxEntries / 2);
+
+    if (node->leaf) {
+        auto entries = node->entries;
+        entries.emplace_back(box, traj);
+        if (entries.size() <= maxEntries) return {makeLeaf(std::move(entries)), nullptr};
+        auto [a, b] = splitEntries(std::move(entries), minFill);
+        return {makeLeaf(std::move(a)), makeLeaf(std::move(b))};
+    }
+
+    // Least enlargement, then smallest volume
+    size_t best = 0;
+    float bestGrow = std::numeric_limits<float>::infinity(), bestVolume = bestGrow;
+    for (size_t i = 0; i < node->children.size(); ++i) {
+        const BoundingBox3D& childBox = node->children[i].first;
+        float grow = enlargement(childBox, box), volume = childBox.volume();
+        if (grow < bestGrow || (grow == bestGrow && volume < bestVolume)) {
+            best = i; bestGrow = grow; bestVolume = volume;
+        }
+    }
+
+    auto [left, right] = insertPath(node->children[best].second, box, traj, maxEntries);
+    auto children = node->children;   // shares every other subtree
+    children[best] = {left->mbr, left};
+    if (right) children.emplace_back(right->mbr, right);
+    if (children.size() <= maxEntries) return {makeInternal(std::move(children)), nullptr};
+    auto [a, b] = splitEntries(std::move(children), minFill);
+    return {makeInternal(std::move(a)), makeInternal(std::move(b))};
+}
+
+// Returns the replacement for node (nullptr if it became empty); removed reports success
+static NodePtr removePath(const NodePtr& node, const std::string& trajId, const BoundingBox3D& box, bool& removed) {
+    if (node->leaf) {
+        for (size_t i = 0; i < node->entries.size(); ++i) {
+            if (node->entries[i].second->getId() != trajId) continue;
+            removed = true;
+            auto entries = node->entries;
+            entries.erase(entries.begin() + i);
+            return entries.empty() ? nullptr : makeLeaf(std::move(entries));
+        }
+        return node;
+    }
+
+    for (size_t i = 0; i < node->children.size(); ++i) {
+        if (!node->children[i].first.intersects(box)) continue;
+        NodePtr replacement = removePath(node->children[i].second, trajId, box, removed);
+        if (!removed) continue;
+
+        auto children = node->children;
+        if (replacement) children[i] = {replacement->mbr, replacement};
+        else children.erase(children.begin() + i);
+        return children.empty() ? nullptr : makeInternal(std::move(children));
+    }
+    return node;
+}
+
+// ---------------- Constructor ----------------
+ConcurrentRTree::ConcurrentRTree(int maxEntries)
+    : maxEntries(std::max(maxEntries, 2)), current(std::make_shared<const State>()) {}
+
+// ---------------- Publishing ----------------
+void ConcurrentRTree::publish(std::shared_ptr<const Node> root) {
+    // Collapse single-child internal roots left behind by removals
+    while (root && !root->leaf && root->children.size() == 1) root = root->children.front().second;
+
+    auto previous = std::atomic_load(&current);
+    auto next = std::make_shared<State>();
+    next->root = std::move(root);
+    next->version = previous->version + 1;
+    std::atomic_store(&current, std::shared_ptr<const State>(std::move(next)));
+}
+
+// ---------------- Reads ----------------
+ConcurrentRTree::Snapshot ConcurrentRTree::snapshot() const {
+    return Snapshot(std::atomic_load(&current));
+}
+
+std::vector<std::shared_ptr<const Trajectory>> ConcurrentRTree::rangeQuery(const BoundingBox3D& queryBox) const {
+    return snapshot().rangeQuery(queryBox);
+}
+
+std::vector<std::shared_ptr<const Trajectory>> ConcurrentRTree::kNearestNeighbors(const Trajectory& query, size_t k,
+                                                                                  float timeScale) const {
+    return snapshot().kNearestNeighbors(query, k, timeScale);
+}
+
+size_t ConcurrentRTree::size() const { return snapshot().size(); }
+
+std::vector<std::shared_ptr<const Trajectory>> ConcurrentRTree::Snapshot::rangeQuery(const BoundingBox3D& queryBox) const {
+    std::vector<std::shared_ptr<const Trajectory>> results;
+    if (!state->root || !state->root->mbr.intersects(queryBox)) return results;
+
+    std::vector<const Node*> stack{state->root.get()};
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+        if (node->leaf) {
+            for (const auto& [box, traj] : node->entries)
+                if (queryBox.intersects(box)) results.push_back(traj);
+        } else {
+            for (const auto& [box, child] : node->children)
+                if (queryBox.intersects(box)) stack.push_back(child.get());
+        }
+    }
+    return results;
+}
+
+// Best-first search: the spatial box distance is a lower bound of spatioTemporalDistanceTo,
+// so a trajectory popped with its exact distance is the next nearest
+std::vector<std::shared_ptr<const Trajectory>> ConcurrentRTree::Snapshot::kNearestNeighbors(
+    const Trajectory& query, size_t k, float timeScale) const {
+    std::vector<std::shared_ptr<const Trajectory>> results;
+    if (!state->root || k == 0) return results;
+
+    struct Item {
+        float distance;
+        const Node* node;                                // nullptr for a trajectory
+        const std::shared_ptr<const Trajectory>* traj;
+        bool exact;
+        bool operator>(const Item& other) const { return distance > other.distance; }
+    };
+    std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+    BoundingBox3D queryBox = query.getBoundingBox();
+    queue.push({0.0f, state->root.get(), nullptr, false});
+
+    while (!queue.empty() && results.size() < k) {
+        Item item = queue.top();
+        queue.pop();
+        if (item.node) {
+            if (item.node->leaf) {
+                for (const auto& entry : item.node->entries)
+                    if (entry.second->getId() != query.getId())
+                        queue.push({queryBox.spatialDistanceSquared(entry.first), nullptr, &entry.second, false});
+            } else {
+                for (const auto& [box, child] : item.node->children)
+                    queue.push({queryBox.spatialDistanceSquared(box), child.get(), nullptr, false});
+            }
+        } else if (!item.exact) {
+            queue.push({query.spatioTemporalDistanceTo(**item.traj, timeScale), nullptr, item.traj, true});
+        } else {
+            results.push_back(*item.traj);
+        }
+    }
+    return results;
+}
+
+int ConcurrentRTree::Snapshot::height() const {
+    int h = 0;
+    for (const Node* node = state->root.get(); node; node = node->leaf ? nullptr : node->children.front().second.get()) ++h;
+    return h;
+}
+
+// ---------------- Writes ----------------
+std::shared_ptr<const Node> ConcurrentRTree::insertLocked(std::shared_ptr<const Node> root, const Trajectory& traj) {
+    // Private copy with caches filled, so readers only ever call const, non-mutating accessors
+    auto stored = std::make_shared<Trajectory>(traj);
+    stored->precomputeCentroidAndBoundingBox();
+    BoundingBox3D box = stored->getBoundingBox();
+    boxById[stored->getId()] = box;
+
+    if (!root) return makeLeaf({{box, stored}});
+    auto [left, right] = insertPath(root, box, stored, static_cast<size_t>(maxEntries));
+    if (!right) return left;
+    return makeInternal({{left->mbr, left}, {right->mbr, right}});
+}
+
+std::shared_ptr<const Node> ConcurrentRTree::removeLocked(std::shared_ptr<const Node> root, const std::string& trajId,
+                                                          bool& removed) {
+    removed = false;
+    auto it = boxById.find(trajId);
+    if (it == boxById.end() || !root) return root;
+    NodePtr replacement = removePath(root, trajId, it->second, removed);
+    if (removed) boxById.erase(it);
+    return removed ? replacement : root;
+}
+
+void ConcurrentRTree::insert(const Trajectory& traj) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    NodePtr root = std::atomic_load(&current)->root;
+    bool removed;
+    root = removeLocked(root, traj.getId(), removed);   // IDs stay unique
+    publish(insertLocked(root, traj));
+}
+
+void ConcurrentRTree::insert(const std::vector<Trajectory>& batch) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    NodePtr root = std::atomic_load(&current)->root;
+    bool removed;
+    for (const auto& traj : batch) {
+        root = removeLocked(root, traj.getId(), removed);
+        root = insertLocked(root, traj);
+    }
+    publish(root);
+}
+
+bool ConcurrentRTree::remove(const std::string& trajId) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    bool removed;
+    NodePtr root = removeLocked(std::atomic_load(&current)->root, trajId, removed);
+    if (removed) publish(root);
+    return removed;
+}
+
+bool ConcurrentRTree::update(const Trajectory& traj) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    bool replaced;
+    NodePtr root = removeLocked(std::atomic_load(&current)->root, traj.getId(), replaced);
+    publish(insertLocked(root, traj));
+    return replaced;
+}
+
+void ConcurrentRTree::bulkLoad(std::vector<Trajectory> trajectories) {
+    for (auto& traj : trajectories) traj.precomputeCentroidAndBoundingBox();
+
+    // Reuse RTree's STR packing, then freeze its nodes
+    RTree builder(maxEntries);
+    builder.bulkLoad(trajectories);
+    NodePtr root = builder.getRoot() ? freeze(*builder.getRoot()) : nullptr;
+    if (root && root->count == 0) root = nullptr;
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    boxById.clear();
+    std::vector<const Node*> stack;
+    if (root) stack.push_back(root.get());
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+        for (const auto& [box, traj] : node->entries) boxById[traj->getId()] = box;
+        for (const auto& [_, child] : node->children) stack.push_back(child.get());
+    }
+    publish(root);
+}
@@ -0,0 +1,481 @@
+#include "../include/csvIngest.h"
+#include "../include/parallel.h"
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <string_view>
+#include <stdexcept>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <arrow/builder.h>
+#include <arrow/table.h>
+#include <arrow/io/file.h>
+#include <parquet/arrow/writer.h>
+
+namespace csvIngest {
+
+// ---------------- Memory-mapped file ----------------
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("csvIngest cannot open " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("csvIngest cannot stat " + path);
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length > 0) {
+            void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("csvIngest cannot map " + path);
+            }
+            ::madvise(mapped, length, MADV_SEQUENTIAL);
+            bytes = static_cast<const char*>(mapped);
+        }
+        ::close(fd); // the mapping stays valid
+    }
+
+    ~MappedFile() {
+        if (bytes) ::munmap(const_cast<char*>(bytes), length);
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* begin() const { return bytes; }
+    const char* end() const { return bytes + length; }
+};
+
+// ---------------- Parsers ----------------
+// Powers of ten exactly representable as double
+static const double kPow10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+bool parseDouble(const char* begin, const char* end, double& out) {
+    const char* p = begin;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+    uint64_t mantissa = 0;
+    int digits = 0;          // significant digits in mantissa
+    int exponent = 0;
+    bool any = false, overflow = false;
+    for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+        any = true;
+        if (digits < 19) {
+            mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+            if (mantissa) ++digits;
+        } else {
+            ++exponent;
+            overflow = true;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (++p; p < end && *p >= '0' && *p <= '9'; ++p) {
+            any = true;
+            if (digits < 19) {
+                mantissa = mantissa * 10 + static_cast<uint64_t>(*p - '0');
+                if (mantissa) ++digits;
+                --exponent;
+            } else {
+                overflow = true;
+            }
+        }
+    }
+    if (!any) return false;
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExp = false;
+        if (p < end && (*p == '-' || *p == '+')) negativeExp = *p++ == '-';
+        if (p == end || *p < '0' || *p > '9') return false;
+        int e = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; ++p) e = std::min(e * 10 + (*p - '0'), 100000);
+        exponent += negativeExp ? -e : e;
+    }
+    if (p != end) return false;
+
+    // Exact operands give a correctly rounded result (Clinger's fast path)
+    if (!overflow && digits <= 15 && exponent >= -22 && exponent <= 22) {
+        double value = static_cast<double>(mantissa);
+        value = exponent < 0 ? value / kPow10[-exponent] : value * kPow10[exponent];
+        out = negative ? -value : value;
+        return true;
+    }
+    std::string copy(begin, end);
+    out = std::strtod(copy.c_str(), nullptr);
+    return true;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date
+static int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+bool parseTimestamp(const char* begin, const char* end, int64_t& out) {
+    if (end - begin != 19) return false;
+    const char* s = begin;
+    auto digit = [&](int i) { return static_cast<unsigned>(s[i] - '0'); };
+    for (int i : {0, 1, 2, 3, 5, 6, 8, 9, 11, 12, 14, 15, 17, 18})
+        if (s[i] < '0' || s[i] > '9') return false;
+    if (s[4] != '-' || s[7] != '-' || (s[10] != ' ' && s[10] != 'T') || s[13] != ':' || s[16] != ':') return false;
+
+    unsigned year = digit(0) * 1000 + digit(1) * 100 + digit(2) * 10 + digit(3);
+    unsigned month = digit(5) * 10 + digit(6), day = digit(8) * 10 + digit(9);
+    unsigned hour = digit(11) * 10 + digit(12), minute = digit(14) * 10 + digit(15), second = digit(17) * 10 + digit(18);
+    static const unsigned kDaysInMonth[] = {31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month < 1 || month > 12 || day < 1 || day > kDaysInMonth[month - 1] || hour > 23 || minute > 59 || second > 59)
+        return false;
+    bool leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (month == 2 && day == 29 && !leap) return false;
+
+    out = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    return true;
+}
+
+// ---------------- CSV scanning ----------------
+// Field without surrounding whitespace and quotes
+static std::string_view trimField(const char* begin, const char* end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) --end;
+    if (end - begin >= 2 && *begin == '"' && end[-1] == '"') {
+        ++begin;
+        --end;
+    }
+    return std::string_view(begin, static_cast<size_t>(end - begin));
+}
+
+// Splits the line starting at p into fields; fields[c] is set for the wanted columns
+// (wanted[c] = slot, -1 otherwise). Returns the start of the next line.
+static const char* scanLine(const char* p, const char* end, const std::vector<int>& wanted,
+                            std::string_view* fields) {
+    size_t column = 0;
+    const char* fieldStart = p;
+    bool quoted = false;
+    for (; p < end; ++p) {
+        char c = *p;
+        if (c == '"') {
+            quoted = !quoted;
+        } else if (!quoted && (c == ',' || c == '\n')) {
+            if (column < wanted.size() && wanted[column] >= 0) fields[wanted[column]] = trimField(fieldStart, p);
+            ++column;
+            fieldStart = p + 1;
+            if (c == '\n') return p + 1;
+        }
+    }
+    if (column < wanted.size() && wanted[column] >= 0) fields[wanted[column]] = trimField(fieldStart, end);
+    return end;
+}
+
+// Maps the names of the header line to slots; throws if one is missing
+static const char* readHeader(const char* p, const char* end, const std::vector<std::string>& names,
+                              std::vector<int>& wanted, const std::string& path) {
+    const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+    if (!lineEnd) lineEnd = end;
+    std::vector<bool> found(names.size(), false);
+    const char* fieldStart = p;
+    for (const char* q = p; q <= lineEnd; ++q) {
+        if (q != lineEnd && *q != ',') continue;
+        std::string_view name = trimField(fieldStart, q);
+        int slot = -1;
+        for (size_t i = 0; i < names.size(); ++i)
+            if (name == names[i] && !found[i]) {
+                slot = static_cast<int>(i);
+                found[i] = true;
+            }
+        wanted.push_back(slot);
+        fieldStart = q + 1;
+    }
+    for (size_t i = 0; i < names.size(); ++i)
+        if (!found[i]) throw std::runtime_error("csvIngest: column " + names[i] + " missing in " + path);
+    return lineEnd == end ? end : lineEnd + 1;
+}
+
+// Sorted unique values numbered from 1 (preprocess.py's convert_to_integer_mapping)
+static std::unordered_map<std::string_view, int32_t> integerMapping(std::vector<std::string_view> values) {
+    std::sort(values.begin(), values.end());
+    values.erase(std::unique(values.begin(), values.end()), values.end());
+    std::unordered_map<std::string_view, int32_t> mapping;
+    mapping.reserve(values.size());
+    for (size_t i = 0; i < values.size(); ++i) mapping.emplace(values[i], static_cast<int32_t>(i + 1));
+    return mapping;
+}
+
+// Parsed rows of one chunk, trip ordinal per row
+struct ChunkRows {
+    std::vector<int32_t> trip;
+    std::vector<float> x, y;
+    std::vector<int64_t> t;
+    size_t rowsRead = 0;
+    size_t unknownTrip = 0;
+    size_t malformed = 0;
+    PointValidationReport validation;
+};
+
+// ---------------- Load ----------------
+TrajectoryColumns load(const std::string& summaryPath, const std::string& trajectoriesPath, size_t numThreads,
+                       CsvIngestStats* stats) {
+    using Clock = std::chrono::steady_clock;
+    CsvIngestStats local;
+    CsvIngestStats& s = stats ? *stats : local;
+    s = CsvIngestStats();
+    numThreads = parallel::resolveThreadCount(numThreads);
+
+    // Summary: trip -> driver, both mapped to integers
+    auto start = Clock::now();
+    MappedFile summary(summaryPath);
+    MappedFile points(trajectoriesPath);
+    std::vector<std::string_view> tripNames, driverNames;
+    {
+        std::vector<int> wanted;
+        const char* p = readHeader(summary.begin(), summary.end(), {"trip_id", "driver_id"}, wanted, summaryPath);
+        std::string_view fields[2];
+        while (p < summary.end()) {
+            fields[0] = fields[1] = std::string_view();
+            p = scanLine(p, summary.end(), wanted, fields);
+            if (fields[0].empty() || fields[1].empty()) continue;
+            tripNames.push_back(fields[0]);
+            driverNames.push_back(fields[1]);
+        }
+    }
+    auto tripIds = integerMapping(tripNames);
+    auto driverIds = integerMapping(driverNames);
+    s.summaryTrips = tripIds.size();
+    s.vehicles = driverIds.size();
+
+    // Trip ordinal -> vehicle; the first summary row of a trip wins
+    std::vector<int32_t> vehicleOfTrip(tripIds.size() + 1, 0);
+    for (size_t i = 0; i < tripNames.size(); ++i) {
+        int32_t& v = vehicleOfTrip[tripIds.at(tripNames[i])];
+        if (v == 0) v = driverIds.at(driverNames[i]);
+    }
+    s.mapSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Trajectories: chunks cut at line starts, parsed in parallel
+    start = Clock::now();
+    std::vector<int> wanted;
+    const char* body = readHeader(points.begin(), points.end(), {"trip_id", "timestamp", "latitude", "longitude"},
+                                  wanted, trajectoriesPath);
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(numThreads * 4, static_cast<size_t>(points.end() - body) >> 16));
+    std::vector<const char*> cuts(chunkCount + 1, points.end());
+    cuts[0] = body;
+    size_t chunkBytes = static_cast<size_t>(points.end() - body) / chunkCount;
+    for (size_t c = 1; c < chunkCount; ++c) {
+        const char* guess = std::max(cuts[c - 1], body + c * chunkBytes);
+        const char* nl = static_cast<const char*>(std::memchr(guess, '\n', static_cast<size_t>(points.end() - guess)));
+        cuts[c] = nl ? nl + 1 : points.end();
+    }
+
+    std::vector<ChunkRows> chunks(chunkCount);
+    parallel::parallelForDynamic(chunkCount, numThreads, [&](size_t c, size_t) {
+        ChunkRows& rows = chunks[c];
+        size_t estimate = static_cast<size_t>(cuts[c + 1] - cuts[c]) / 48;
+        rows.trip.reserve(estimate); rows.x.reserve(estimate); rows.y.reserve(estimate); rows.t.reserve(estimate);
+        std::string_view fields[4];
+        for (const char* p = cuts[c]; p < cuts[c + 1];) {
+            for (auto& f : fields) f = std::string_view();
+            p = scanLine(p, cuts[c + 1], wanted, fields);
+            if (fields[0].empty() && fields[1].empty() && fields[2].empty() && fields[3].empty()) continue; // blank line
+            ++rows.rowsRead;
+
+            auto trip = tripIds.find(fields[0]);
+            if (trip == tripIds.end()) {
+                ++rows.unknownTrip;
+                continue;
+            }
+            int64_t t;
+            double lat, lon;
+            if (!parseTimestamp(fields[1].data(), fields[1].data() + fields[1].size(), t) ||
+                !parseDouble(fields[2].data(), fields[2].data() + fields[2].size(), lat) ||
+                !parseDouble(fields[3].data(), fields[3].data() + fields[3].size(), lon)) {
+                ++rows.malformed;
+                continue;
+            }
+            Point3D point(static_cast<float>(lon), static_cast<float>(lat), t);
+            rows.validation += Point3D::validate(&point, 1);
+            rows.trip.push_back(trip->second);
+            rows.x.push_back(point.getX());
+            rows.y.push_back(point.getY());
+            rows.t.push_back(t);
+        }
+    });
+    for (const auto& rows : chunks) {
+        s.rowsRead += rows.rowsRead;
+        s.rowsKept += rows.trip.size();
+        s.unknownTripRows += rows.unknownTrip;
+        s.malformedRows += rows.malformed;
+        s.validation += rows.validation;
+    }
+    s.parseSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Counting sort by (vehicle, trip): group position of every trip ordinal
+    start = Clock::now();
+    const size_t tripCount = tripIds.size();
+    std::vector<int32_t> order(tripCount);
+    std::iota(order.begin(), order.end(), 1);
+    std::sort(order.begin(), order.end(), [&](int32_t a, int32_t b) {
+        return vehicleOfTrip[a] != vehicleOfTrip[b] ? vehicleOfTrip[a] < vehicleOfTrip[b] : a < b;
+    });
+    std::vector<size_t> groupOf(tripCount + 1);
+    for (size_t g = 0; g < tripCount; ++g) groupOf[order[g]] = g;
+
+    // offsets[c * tripCount + g]: where chunk c writes its first row of group g
+    std::vector<size_t> offsets(chunkCount * tripCount, 0);
+    parallel::parallelFor(chunkCount, numThreads, [&](size_t begin, size_t end, size_t) {
+        for (size_t c = begin; c < end; ++c)
+            for (int32_t trip : chunks[c].trip) ++offsets[c * tripCount + groupOf[trip]];
+    });
+    std::vector<size_t> groupStart(tripCount + 1, 0);
+    size_t running = 0;
+    for (size_t g = 0; g < tripCount; ++g) {
+        groupStart[g] = running;
+        for (size_t c = 0; c < chunkCount; ++c) {
+            size_t count = offsets[c * tripCount + g];
+            offsets[c * tripCount + g] = running;
+            running += count;
+        }
+    }
+    groupStart[tripCount] = running;
+
+    TrajectoryColumns columns;
+    columns.vehicleId.resize(running);
+    columns.tripId.resize(running);
+    columns.x.resize(running);
+    columns.y.resize(running);
+    columns.t.resize(running);
+    parallel::parallelFor(chunkCount, numThreads, [&](size_t begin, size_t end, size_t) {
+        for (size_t c = begin; c < end; ++c) {
+            const ChunkRows& rows = chunks[c];
+            for (size_t i = 0; i < rows.trip.size(); ++i) {
+                size_t at = offsets[c * tripCount + groupOf[rows.trip[i]]]++;
+                columns.vehicleId[at] = vehicleOfTrip[rows.trip[i]];
+                columns.tripId[at] = rows.trip[i];
+                columns.x[at] = rows.x[i];
+                columns.y[at] = rows.y[i];
+                columns.t[at] = rows.t[i];
+            }
+        }
+    });
+    chunks.clear();
+
+    // Time order inside each trip (the file is usually already sorted)
+    parallel::parallelForDynamic(tripCount, numThreads, [&](size_t g, size_t) {
+        size_t b = groupStart[g], e = groupStart[g + 1];
+        if (std::is_sorted(columns.t.begin() + b, columns.t.begin() + e)) return;
+        std::vector<size_t> perm(e - b);
+        std::iota(perm.begin(), perm.end(), b);
+        std::stable_sort(perm.begin(), perm.end(), [&](size_t i, size_t j) { return columns.t[i] < columns.t[j]; });
+        std::vector<float> x(perm.size()), y(perm.size());
+        std::vector<int64_t> t(perm.size());
+        for (size_t i = 0; i < perm.size(); ++i) {
+            x[i] = columns.x[perm[i]];
+            y[i] = columns.y[perm[i]];
+            t[i] = columns.t[perm[i]];
+        }
+        std::copy(x.begin(), x.end(), columns.x.begin() + b);
+        std::copy(y.begin(), y.end(), columns.y.begin() + b);
+        std::copy(t.begin(), t.end(), columns.t.begin() + b);
+    });
+
+    // Trips without rows are left out
+    for (size_t g = 0; g < tripCount; ++g)
+        if (groupStart[g + 1] > groupStart[g]) columns.tripStart.push_back(groupStart[g]);
+    columns.tripStart.push_back(running);
+    s.groupSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    if (s.validation.invalidPoints > 0) s.validation.print(std::cerr, trajectoriesPath);
+    return columns;
+}
+
+} // namespace csvIngest
+
+// ---------------- Conversions ----------------
+std::vector<Trajectory> TrajectoryColumns::toTrajectories(size_t numThreads) const {
+    std::vector<Trajectory> trajectories(trips());
+    parallel::parallelFor(trips(), numThreads, [&](size_t begin, size_t end, size_t) {
+        for (size_t i = begin; i < end; ++i) {
+            size_t b = tripStart[i], e = tripStart[i + 1];
+            std::vector<Point3D> pts;
+            pts.reserve(e - b);
+            for (size_t r = b; r < e; ++r) pts.emplace_back(x[r], y[r], t[r]);
+            trajectories[i] = Trajectory(std::move(pts), std::to_string(vehicleId[b]) + "_" + std::to_string(tripId[b]));
+        }
+    });
+    return trajectories;
+}
+
+// Copies values[begin, end) into a finished Arrow array
+template <typename Builder, typename T>
+static std::shared_ptr<arrow::Array> toArrow(const T* values, size_t count) {
+    Builder builder;
+    PARQUET_THROW_NOT_OK(builder.AppendValues(values, static_cast<int64_t>(count)));
+    std::shared_ptr<arrow::Array> array;
+    PARQUET_THROW_NOT_OK(builder.Finish(&array));
+    return array;
+}
+
+void TrajectoryColumns::writeParquet(const std::string& directory, size_t rowsPerFile, size_t rowsPerGroup) const {
+    std::filesystem::create_directories(directory);
+    auto schema = arrow::schema({arrow::field("vehicle_id", arrow::int32()), arrow::field("trip_id", arrow::int32()),
+                                 arrow::field("x", arrow::float32()), arrow::field("y", arrow::float32()),
+                                 arrow::field("t", arrow::int64()),
+                                 arrow::field("x_min", arrow::float32()), arrow::field("x_max", arrow::float32()),
+                                 arrow::field("y_min", arrow::float32()), arrow::field("y_max", arrow::float32()),
+                                 arrow::field("t_start", arrow::int64()), arrow::field("t_end", arrow::int64())});
+    auto properties = parquet::WriterProperties::Builder().compression(parquet::Compression::SNAPPY)->build();
+
+    size_t file = 0;
+    for (size_t first = 0; first < trips(); ++file) {
+        // Whole trips until the file has rowsPerFile rows
+        size_t last = first + 1;
+        while (last < trips() && tripStart[last + 1] - tripStart[first] <= rowsPerFile) ++last;
+        size_t b = tripStart[first], n = tripStart[last] - b;
+
+        // Per-trip box repeated on each of its rows
+        std::vector<float> xMin(n), xMax(n), yMin(n), yMax(n);
+        std::vector<int64_t> tStart(n), tEnd(n);
+        for (size_t trip = first; trip < last; ++trip) {
+            size_t tb = tripStart[trip], te = tripStart[trip + 1];
+            auto [x0, x1] = std::minmax_element(x.begin() + tb, x.begin() + te);
+            auto [y0, y1] = std::minmax_element(y.begin() + tb, y.begin() + te);
+            auto [t0, t1] = std::minmax_element(t.begin() + tb, t.begin() + te);
+            for (size_t r = tb - b; r < te - b; ++r) {
+                xMin[r] = *x0; xMax[r] = *x1; yMin[r] = *y0; yMax[r] = *y1; tStart[r] = *t0; tEnd[r] = *t1;
+            }
+        }
+
+        auto table = arrow::Table::Make(schema, {
+            toArrow<arrow::Int32Builder>(vehicleId.data() + b, n), toArrow<arrow::Int32Builder>(tripId.data() + b, n),
+            toArrow<arrow::FloatBuilder>(x.data() + b, n), toArrow<arrow::FloatBuilder>(y.data() + b, n),
+            toArrow<arrow::Int64Builder>(t.data() + b, n),
+            toArrow<arrow::FloatBuilder>(xMin.data(), n), toArrow<arrow::FloatBuilder>(xMax.data(), n),
+            toArrow<arrow::FloatBuilder>(yMin.data(), n), toArrow<arrow::FloatBuilder>(yMax.data(), n),
+            toArrow<arrow::Int64Builder>(tStart.data(), n), toArrow<arrow::Int64Builder>(tEnd.data(), n)});
+
+        std::shared_ptr<arrow::io::FileOutputStream> out;
+        std::string path = (std::filesystem::path(directory) / ("part." + std::to_string(file) + ".parquet")).string();
+        PARQUET_ASSIGN_OR_THROW(out, arrow::io::FileOutputStream::Open(path));
+        PARQUET_THROW_NOT_OK(parquet::arrow::WriteTable(*table, arrow::default_memory_pool(), out,
+                                                        static_cast<int64_t>(std::max<size_t>(1, rowsPerGroup)), properties));
+        PARQUET_THROW_NOT_OK(out->Close());
+        first = last;
+    }
+}
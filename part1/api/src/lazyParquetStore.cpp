@@ -0,0 +1,377 @@
+#include "../include/lazyParquetStore.h"
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <stdexcept>
+#include <arrow/api.h>
+#include <arrow/io/file.h>
+#include <parquet/arrow/reader.h>
+#include <parquet/metadata.h>
+#include <parquet/statistics.h>
+namespace fs = std::filesystem;
+
+LazyStoreStats& LazyStoreStats::operator+=(const LazyStoreStats& other) {
+    rowGroupsRead += other.rowGroupsRead;
+    rowsDecoded += other.rowsDecoded;
+    trajectoriesLoaded += other.trajectoriesLoaded;
+    cacheHits += other.cacheHits;
+    cacheMisses += other.cacheMisses;
+    return *this;
+}
+
+// ---------------- Column helpers ----------------
+// Appends a column of a row group table; valid[i] is cleared for null rows
+template <typename ArrayType, typename T>
+static void readColumn(const arrow::Table& table, const std::string& name, std::vector<T>& values,
+                       std::vector<uint8_t>& valid) {
+    auto column = table.GetColumnByName(name);
+    if (!column) throw std::runtime_error("Missing column " + name + " in row group");
+    values.clear();
+    values.reserve(valid.size());
+    for (int c = 0; c < column->num_chunks(); ++c) {
+        const auto& chunk = static_cast<const ArrayType&>(*column->chunk(c));
+        for (int64_t i = 0; i < chunk.length(); ++i) {
+            if (!chunk.IsValid(i)) valid[values.size()] = 0;
+            values.push_back(chunk.Value(i));
+        }
+    }
+    if (values.size() != valid.size()) throw std::runtime_error("Column " + name + " has an unexpected length");
+}
+
+// Min (or max) statistic of a column chunk; false if the writer stored none
+template <typename StatsType, typename T>
+static bool columnStat(const parquet::RowGroupMetaData& rowGroup, int column, bool wantMax, T& out) {
+    auto chunk = rowGroup.ColumnChunk(column);
+    if (!chunk->is_stats_set()) return false;
+    auto stats = chunk->statistics();
+    if (!stats || !stats->HasMinMax()) return false;
+    auto typed = std::static_pointer_cast<StatsType>(stats);
+    out = wantMax ? typed->max() : typed->min();
+    return true;
+}
+
+static int columnIndex(const parquet::SchemaDescriptor& schema, const std::string& name, const std::string& path) {
+    int index = schema.ColumnIndex(name);
+    if (index < 0) throw std::runtime_error("LazyParquetStore: column " + name + " missing in " + path);
+    return index;
+}
+
+// ---------------- Constructors ----------------
+LazyParquetStore::LazyParquetStore(const std::string& path, const LazyParquetOptions& options)
+    : cacheCapacity(options.cachePoints) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::string> paths;
+    if (fs::is_directory(path)) {
+        for (const auto& entry : fs::directory_iterator(path))
+            if (entry.is_regular_file() && entry.path().extension() == ".parquet") paths.push_back(entry.path().string());
+        std::sort(paths.begin(), paths.end());
+        if (paths.empty()) throw std::runtime_error("LazyParquetStore: no .parquet files in " + path);
+    } else {
+        paths.push_back(path);
+    }
+    for (const auto& p : paths) openFile(p, options);
+
+    // Box-only summaries: the scan needs boxes, the centroid is the box center
+    std::vector<TrajectorySummary> summaries(trips.size());
+    for (size_t i = 0; i < trips.size(); ++i) {
+        const BoundingBox3D& box = trips[i].bbox;
+        summaries[i].bbox = box;
+        summaries[i].centroidX = 0.5f * (box.getMinX() + box.getMaxX());
+        summaries[i].centroidY = 0.5f * (box.getMinY() + box.getMaxY());
+        summaries[i].centroidT = 0.5 * (static_cast<double>(box.getMinT()) + static_cast<double>(box.getMaxT()));
+        summaries[i].pointCount = trips[i].rows;
+    }
+    index = ColumnarScan(summaries);
+
+    openSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+LazyParquetStore::~LazyParquetStore() = default;
+
+void LazyParquetStore::openFile(const std::string& path, const LazyParquetOptions& options) {
+    auto file = std::make_unique<File>();
+    file->path = path;
+
+    std::shared_ptr<arrow::io::ReadableFile> infile;
+    PARQUET_ASSIGN_OR_THROW(infile, arrow::io::ReadableFile::Open(path));
+    PARQUET_ASSIGN_OR_THROW(file->reader, parquet::arrow::OpenFile(
+        std::static_pointer_cast<arrow::io::RandomAccessFile>(infile), arrow::default_memory_pool()));
+
+    std::shared_ptr<parquet::FileMetaData> metadata = file->reader->parquet_reader()->metadata();
+    const parquet::SchemaDescriptor& schema = *metadata->schema();
+    const int vehicleCol = columnIndex(schema, "vehicle_id", path), tripCol = columnIndex(schema, "trip_id", path);
+    const int xMinCol = columnIndex(schema, "x_min", path), xMaxCol = columnIndex(schema, "x_max", path);
+    const int yMinCol = columnIndex(schema, "y_min", path), yMaxCol = columnIndex(schema, "y_max", path);
+    const int tStartCol = columnIndex(schema, "t_start", path), tEndCol = columnIndex(schema, "t_end", path);
+    file->pointColumns = {columnIndex(schema, "x", path), columnIndex(schema, "y", path), columnIndex(schema, "t", path)};
+    const std::vector<int> boxColumns = {vehicleCol, tripCol, xMinCol, xMaxCol, yMinCol, yMaxCol, tStartCol, tEndCol};
+
+    // Row groups and their box statistics from the footer
+    uint64_t firstRow = 0;
+    for (int g = 0; g < metadata->num_row_groups(); ++g) {
+        auto rowGroup = metadata->RowGroup(g);
+        RowGroupInfo info{firstRow, static_cast<uint64_t>(rowGroup->num_rows()), BoundingBox3D(), false};
+        float x0, x1, y0, y1;
+        int64_t t0, t1;
+        if (columnStat<parquet::FloatStatistics>(*rowGroup, xMinCol, false, x0) &&
+            columnStat<parquet::FloatStatistics>(*rowGroup, xMaxCol, true, x1) &&
+            columnStat<parquet::FloatStatistics>(*rowGroup, yMinCol, false, y0) &&
+            columnStat<parquet::FloatStatistics>(*rowGroup, yMaxCol, true, y1) &&
+            columnStat<parquet::Int64Statistics>(*rowGroup, tStartCol, false, t0) &&
+            columnStat<parquet::Int64Statistics>(*rowGroup, tEndCol, true, t1)) {
+            info.box = BoundingBox3D(x0, y0, t0, x1, y1, t1);
+            info.hasStats = true;
+        }
+        file->rowGroups.push_back(info);
+        firstRow += info.rows;
+    }
+    rowGroupsTotal += file->rowGroups.size();
+
+    // Trips from the ID and box columns of the row groups the region may touch
+    const uint32_t fileIndex = static_cast<uint32_t>(files.size());
+    const size_t firstTrip = trips.size();
+    std::unordered_map<uint64_t, size_t> tripOfKey;   // (vehicle, trip) -> trip index, this file
+    std::vector<uint64_t> tripEnd;                    // one past the last row, per trip of this file
+    uint64_t currentKey = UINT64_MAX;
+    std::vector<int32_t> vehicle, trip;
+    std::vector<float> xMin, xMax, yMin, yMax;
+    std::vector<int64_t> tStart, tEnd;
+    for (size_t g = 0; g < file->rowGroups.size(); ++g) {
+        const RowGroupInfo& info = file->rowGroups[g];
+        if (options.region && info.hasStats && !info.box.intersects(*options.region)) {
+            ++rowGroupsPruned;
+            continue;
+        }
+        std::shared_ptr<arrow::Table> table;
+        PARQUET_THROW_NOT_OK(file->reader->ReadRowGroup(static_cast<int>(g), boxColumns, &table));
+        std::vector<uint8_t> valid(info.rows, 1);
+        readColumn<arrow::Int32Array>(*table, "vehicle_id", vehicle, valid);
+        readColumn<arrow::Int32Array>(*table, "trip_id", trip, valid);
+        readColumn<arrow::FloatArray>(*table, "x_min", xMin, valid);
+        readColumn<arrow::FloatArray>(*table, "x_max", xMax, valid);
+        readColumn<arrow::FloatArray>(*table, "y_min", yMin, valid);
+        readColumn<arrow::FloatArray>(*table, "y_max", yMax, valid);
+        readColumn<arrow::Int64Array>(*table, "t_start", tStart, valid);
+        readColumn<arrow::Int64Array>(*table, "t_end", tEnd, valid);
+
+        for (size_t i = 0; i < info.rows; ++i) {
+            if (!valid[i]) continue;
+            uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(vehicle[i])) << 32) |
+                           static_cast<uint32_t>(trip[i]);
+            uint64_t row = info.firstRow + i;
+            if (key == currentKey) {
+                tripEnd[tripOfKey[key] - firstTrip] = row + 1;
+                continue;
+            }
+            std::string id = std::to_string(vehicle[i]) + "_" + std::to_string(trip[i]);
+            if (tripOfKey.count(key))
+                throw std::runtime_error("LazyParquetStore: rows of trip " + id + " are not contiguous in " + path);
+            tripOfKey.emplace(key, trips.size());
+            tripEnd.push_back(row + 1);
+            trips.push_back({std::move(id), BoundingBox3D(xMin[i], yMin[i], tStart[i], xMax[i], yMax[i], tEnd[i]),
+                             fileIndex, 0, row});
+            currentKey = key;
+        }
+    }
+
+    // Row counts; trips outside the region are dropped
+    size_t kept = firstTrip;
+    for (size_t i = firstTrip; i < trips.size(); ++i) {
+        trips[i].rows = static_cast<uint32_t>(tripEnd[i - firstTrip] - trips[i].firstRow);
+        if (options.region && !trips[i].bbox.intersects(*options.region)) continue;
+        trips[kept++] = std::move(trips[i]);
+    }
+    trips.resize(kept);
+    files.push_back(std::move(file));
+}
+
+// ---------------- Decoding ----------------
+std::vector<LazyParquetStore::TrajectoryPtr> LazyParquetStore::decode(const std::vector<size_t>& tripIndices,
+                                                                      LazyStoreStats& io) const {
+    // Requested trips per file, in row order (rows of different trips never overlap)
+    std::vector<size_t> order(tripIndices.size());
+    for (size_t k = 0; k < order.size(); ++k) order[k] = k;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        const TripRef& ta = trips[tripIndices[a]];
+        const TripRef& tb = trips[tripIndices[b]];
+        return ta.file != tb.file ? ta.file < tb.file : ta.firstRow < tb.firstRow;
+    });
+
+    std::vector<std::vector<Point3D>> points(tripIndices.size());
+    std::vector<float> x, y;
+    std::vector<int64_t> t;
+    for (size_t begin = 0; begin < order.size();) {
+        const uint32_t fileIndex = trips[tripIndices[order[begin]]].file;
+        size_t end = begin;
+        while (end < order.size() && trips[tripIndices[order[end]]].file == fileIndex) ++end;
+        File& file = *files[fileIndex];
+
+        // First row group holding the first requested row
+        const uint64_t firstRow = trips[tripIndices[order[begin]]].firstRow;
+        size_t g = std::partition_point(file.rowGroups.begin(), file.rowGroups.end(), [&](const RowGroupInfo& rg) {
+            return rg.firstRow + rg.rows <= firstRow;
+        }) - file.rowGroups.begin();
+
+        for (size_t next = begin; next < end && g < file.rowGroups.size(); ++g) {
+            const RowGroupInfo& rg = file.rowGroups[g];
+            const uint64_t groupEnd = rg.firstRow + rg.rows;
+            if (trips[tripIndices[order[next]]].firstRow >= groupEnd) continue; // no requested row here
+
+            std::shared_ptr<arrow::Table> table;
+            {
+                std::lock_guard<std::mutex> lock(file.mutex);
+                PARQUET_THROW_NOT_OK(file.reader->ReadRowGroup(static_cast<int>(g), file.pointColumns, &table));
+            }
+            std::vector<uint8_t> valid(rg.rows, 1);
+            readColumn<arrow::FloatArray>(*table, "x", x, valid);
+            readColumn<arrow::FloatArray>(*table, "y", y, valid);
+            readColumn<arrow::Int64Array>(*table, "t", t, valid);
+            ++io.rowGroupsRead;
+            io.rowsDecoded += rg.rows;
+
+            // Row selection: the part of each requested trip inside this row group
+            for (size_t k = next; k < end && trips[tripIndices[order[k]]].firstRow < groupEnd; ++k) {
+                const TripRef& ref = trips[tripIndices[order[k]]];
+                uint64_t from = std::max(ref.firstRow, rg.firstRow) - rg.firstRow;
+                uint64_t to = std::min<uint64_t>(ref.firstRow + ref.rows, groupEnd) - rg.firstRow;
+                auto& out = points[order[k]];
+                for (uint64_t r = from; r < to; ++r)
+                    if (valid[r]) out.emplace_back(x[r], y[r], t[r]);
+            }
+            while (next < end && trips[tripIndices[order[next]]].firstRow + trips[tripIndices[order[next]]].rows <= groupEnd)
+                ++next;
+        }
+        begin = end;
+    }
+
+    std::vector<TrajectoryPtr> decoded(tripIndices.size());
+    PointValidationReport report;
+    for (size_t k = 0; k < tripIndices.size(); ++k) {
+        report += Point3D::validate(points[k]);
+        decoded[k] = std::make_shared<const Trajectory>(std::move(points[k]), trips[tripIndices[k]].id);
+    }
+    io.trajectoriesLoaded += decoded.size();
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    validation += report;
+    return decoded;
+}
+
+// ---------------- Cache ----------------
+void LazyParquetStore::remember(size_t trip, const TrajectoryPtr& trajectory) const {
+    size_t pointCount = trajectory->getPoints().size();
+    if (pointCount > cacheCapacity || cache.count(trip)) return;
+    lru.push_front(trip);
+    cache.emplace(trip, CacheEntry{trajectory, lru.begin()});
+    cachedPointCount += pointCount;
+    while (cachedPointCount > cacheCapacity) {
+        size_t victim = lru.back();
+        lru.pop_back();
+        auto it = cache.find(victim);
+        cachedPointCount -= it->second.trajectory->getPoints().size();
+        cache.erase(it);
+    }
+}
+
+// ---------------- Queries ----------------
+std::vector<LazyParquetStore::TrajectoryPtr> LazyParquetStore::fetch(const std::vector<size_t>& tripIndices,
+                                                                     LazyStoreStats* io) const {
+    LazyStoreStats local;
+    std::vector<TrajectoryPtr> results(tripIndices.size());
+    std::vector<size_t> missing;       // trip indices to decode, each once
+    std::vector<size_t> missingSlots;  // result slots waiting for them
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        for (size_t k = 0; k < tripIndices.size(); ++k) {
+            size_t trip = tripIndices[k];
+            if (trip >= trips.size()) throw std::out_of_range("LazyParquetStore: trip index out of range");
+            auto it = cache.find(trip);
+            if (it != cache.end()) {
+                lru.splice(lru.begin(), lru, it->second.lruPos);
+                results[k] = it->second.trajectory;
+                ++local.cacheHits;
+            } else {
+                ++local.cacheMisses;
+                missingSlots.push_back(k);
+            }
+        }
+    }
+
+    if (!missingSlots.empty()) {
+        for (size_t k : missingSlots) missing.push_back(tripIndices[k]);
+        std::sort(missing.begin(), missing.end());
+        missing.erase(std::unique(missing.begin(), missing.end()), missing.end());
+        std::vector<TrajectoryPtr> decoded = decode(missing, local);
+
+        std::lock_guard<std::mutex> lock(cacheMutex);
+        for (size_t k : missingSlots) {
+            size_t m = std::lower_bound(missing.begin(), missing.end(), tripIndices[k]) - missing.begin();
+            results[k] = decoded[m];
+        }
+        for (size_t m = 0; m < missing.size(); ++m) remember(missing[m], decoded[m]);
+    }
+
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    totals += local;
+    if (io) *io += local;
+    return results;
+}
+
+LazyParquetStore::TrajectoryPtr LazyParquetStore::get(size_t trip, LazyStoreStats* io) const {
+    return fetch({trip}, io).front();
+}
+
+std::vector<size_t> LazyParquetStore::candidates(const BoundingBox3D& queryBox) const {
+    return index.rangeQuery(queryBox);
+}
+
+size_t LazyParquetStore::rangeCount(const BoundingBox3D& queryBox) const {
+    return index.rangeQuery(queryBox).size();
+}
+
+std::vector<LazyParquetStore::TrajectoryPtr> LazyParquetStore::rangeQuery(const BoundingBox3D& queryBox,
+                                                                          LazyStoreStats* io) const {
+    return fetch(candidates(queryBox), io);
+}
+
+// ---------------- Info ----------------
+LazyStoreStats LazyParquetStore::stats() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return totals;
+}
+
+void LazyParquetStore::resetStats() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    totals = LazyStoreStats();
+}
+
+PointValidationReport LazyParquetStore::validationReport() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return validation;
+}
+
+size_t LazyParquetStore::cachedPoints() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return cachedPointCount;
+}
+
+size_t LazyParquetStore::cachedTrajectories() const {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    return cache.size();
+}
+
+void LazyParquetStore::clearCache() {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    cache.clear();
+    lru.clear();
+    cachedPointCount = 0;
+}
+
+size_t LazyParquetStore::memoryUsage() const {
+    size_t bytes = index.memoryUsage() + trips.capacity() * sizeof(TripRef);
+    for (const auto& trip : trips) bytes += trip.id.capacity();
+    for (const auto& file : files) bytes += file->rowGroups.capacity() * sizeof(RowGroupInfo);
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    bytes += cachedPointCount * sizeof(Point3D) + cache.size() * (sizeof(Trajectory) + sizeof(CacheEntry) + 32);
+    return bytes;
+}
@@ -0,0 +1,67 @@
+#include "../include/nodeAggregate.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+// ---------------- HyperLogLog ----------------
+
+// 64-bit finalizer (splitmix64) so every hash bit is well mixed
+static uint64_t mixHash(uint64_t h) {
+    h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 27; h *= 0x94d049bb133111ebULL;
+    h ^= h >> 31;
+    return h;
+}
+
+void HyperLogLog::add(const std::string& key) {
+    uint64_t h = mixHash(std::hash<std::string>{}(key));
+    size_t index = h >> (64 - kPrecision);
+    uint64_t rest = h << kPrecision;
+    uint8_t rank = rest == 0 ? 64 - kPrecision + 1 : static_cast<uint8_t>(__builtin_clzll(rest) + 1);
+    registers[index] = std::max(registers[index], rank);
+}
+
+void HyperLogLog::merge(const HyperLogLog& other) {
+    for (size_t i = 0; i < kRegisters; ++i)
+        registers[i] = std::max(registers[i], other.registers[i]);
+}
+
+double HyperLogLog::estimate() const {
+    const double m = static_cast<double>(kRegisters);
+    const double alpha = 0.7213 / (1.0 + 1.079 / m);
+
+    double sum = 0.0;
+    size_t zeros = 0;
+    for (uint8_t r : registers) {
+        sum += std::ldexp(1.0, -r);
+        zeros += (r == 0);
+    }
+    double raw = alpha * m * m / sum;
+
+    // Small range correction (linear counting)
+    if (raw <= 2.5 * m && zeros > 0) return m * std::log(m / zeros);
+    return raw;
+}
+
+// ---------------- NodeAggregate ----------------
+
+std::string vehicleIdOf(const std::string& trajId) {
+    size_t sep = trajId.find('_');
+    return sep == std::string::npos ? trajId : trajId.substr(0, sep);
+}
+
+void NodeAggregate::add(const Trajectory& traj) {
+    ++count;
+    points += traj.getPoints().size();
+    totalLength += traj.length();
+    totalDuration += static_cast<double>(traj.duration());
+    vehicles.add(vehicleIdOf(traj.getId()));
+}
+
+void NodeAggregate::merge(const NodeAggregate& other) {
+    count += other.count;
+    points += other.points;
+    totalLength += other.totalLength;
+    totalDuration += other.totalDuration;
+    vehicles.merge(other.vehicles);
+}
@@ -0,0 +1,300 @@
+#include "../include/pagedRTree.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static const char kMagic[8] = {'P', 'R', 'T', 'R', 'E', 'E', '1', '\0'};
+
+// ---------------- Page layout ----------------
+struct NodeHeader {
+    uint32_t leaf;
+    uint32_t count;
+};
+
+// One node entry; ref is a heap byte offset in leaves and a node page in internal nodes
+struct PageEntry {
+    float minX, minY, maxX, maxY;
+    int64_t minT, maxT;
+    uint64_t ref;
+
+    BoundingBox3D box() const { return BoundingBox3D(minX, minY, minT, maxX, maxY, maxT); }
+};
+
+static PageEntry makeEntry(const BoundingBox3D& box, uint64_t ref) {
+    return {box.getMinX(), box.getMinY(), box.getMaxX(), box.getMaxY(), box.getMinT(), box.getMaxT(), ref};
+}
+
+static size_t nodeFanout(size_t pageSize) {
+    return pageSize < sizeof(NodeHeader) ? 0 : (pageSize - sizeof(NodeHeader)) / sizeof(PageEntry);
+}
+
+// Sort-tile-recursive order in 3D: x slabs, y runs inside each slab, t inside each run.
+// Consecutive groups of fanout entries then form the nodes of one level.
+static void strOrder(std::vector<PageEntry>& entries, size_t fanout) {
+    const size_t pages = (entries.size() + fanout - 1) / fanout;
+    const size_t slices = static_cast<size_t>(std::ceil(std::cbrt(static_cast<double>(pages))));
+    auto byCenter = [](auto key) {
+        return [key](const PageEntry& a, const PageEntry& b) { return key(a) < key(b); };
+    };
+    auto x = [](const PageEntry& e) { return 0.5 * (static_cast<double>(e.minX) + e.maxX); };
+    auto y = [](const PageEntry& e) { return 0.5 * (static_cast<double>(e.minY) + e.maxY); };
+    auto t = [](const PageEntry& e) { return 0.5 * static_cast<double>(e.minT) + 0.5 * static_cast<double>(e.maxT); };
+
+    std::sort(entries.begin(), entries.end(), byCenter(x));
+    const size_t slabSize = ((pages + slices - 1) / slices) * fanout;
+    const size_t runSize = ((pages + slices * slices - 1) / (slices * slices)) * fanout;
+    for (size_t s = 0; s < entries.size(); s += slabSize) {
+        auto slabEnd = entries.begin() + std::min(s + slabSize, entries.size());
+        std::sort(entries.begin() + s, slabEnd, byCenter(y));
+        for (auto run = entries.begin() + s; run < slabEnd; run += std::min<ptrdiff_t>(runSize, slabEnd - run))
+            std::sort(run, run + std::min<ptrdiff_t>(runSize, slabEnd - run), byCenter(t));
+    }
+}
+
+// ---------------- Heap records ----------------
+// uint32 ID length, uint32 point count, ID bytes, then per point float x, float y, int64 t
+static void appendRecord(const Trajectory& traj, std::vector<uint8_t>& out) {
+    auto put = [&](const void* p, size_t n) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(p);
+        out.insert(out.end(), bytes, bytes + n);
+    };
+    uint32_t idLength = static_cast<uint32_t>(traj.getId().size());
+    uint32_t pointCount = static_cast<uint32_t>(traj.getPoints().size());
+    put(&idLength, sizeof(idLength));
+    put(&pointCount, sizeof(pointCount));
+    put(traj.getId().data(), idLength);
+    for (const auto& p : traj.getPoints()) {
+        float x = p.getX(), y = p.getY();
+        int64_t t = p.getT();
+        put(&x, sizeof(x));
+        put(&y, sizeof(y));
+        put(&t, sizeof(t));
+    }
+}
+
+// ---------------- Construction ----------------
+void PagedRTree::create(const std::string& basePath, const std::vector<Trajectory>& trajectories, size_t pageSize) {
+    const size_t fanout = nodeFanout(pageSize);
+    if (fanout < 2 || pageSize < sizeof(Header))
+        throw std::invalid_argument("PagedRTree page size " + std::to_string(pageSize) + " is too small");
+
+    std::ofstream heapOut(basePath + ".heap", std::ios::binary | std::ios::trunc);
+    std::ofstream indexOut(basePath + ".idx", std::ios::binary | std::ios::trunc);
+    if (!heapOut || !indexOut) throw std::runtime_error("PagedRTree cannot create files at " + basePath);
+
+    Header header{};
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.pageSize = static_cast<uint32_t>(pageSize);
+    header.fanout = static_cast<uint32_t>(fanout);
+    header.trajectoryCount = trajectories.size();
+    BoundingBox3D rootBox;
+
+    // Leaf order first, so the heap can follow it
+    std::vector<PageEntry> level;
+    level.reserve(trajectories.size());
+    for (size_t i = 0; i < trajectories.size(); ++i) {
+        level.push_back(makeEntry(trajectories[i].getBoundingBox(), i));
+        rootBox.expandToInclude(trajectories[i].getBoundingBox());
+    }
+    strOrder(level, fanout);
+
+    // Heap: records in leaf order; ref becomes the record's byte offset
+    std::vector<uint8_t> record;
+    uint64_t offset = 0;
+    for (auto& entry : level) {
+        record.clear();
+        appendRecord(trajectories[entry.ref], record);
+        uint64_t used = offset % pageSize;
+        if (used != 0 && used + record.size() > pageSize) {
+            std::vector<uint8_t> padding(pageSize - used, 0);
+            heapOut.write(reinterpret_cast<const char*>(padding.data()), padding.size());
+            offset += padding.size();
+        }
+        entry.ref = offset;
+        heapOut.write(reinterpret_cast<const char*>(record.data()), record.size());
+        offset += record.size();
+    }
+    if (offset % pageSize != 0) {
+        std::vector<uint8_t> padding(pageSize - offset % pageSize, 0);
+        heapOut.write(reinterpret_cast<const char*>(padding.data()), padding.size());
+        offset += padding.size();
+    }
+    header.heapPages = offset / pageSize;
+
+    // Nodes bottom-up; page 0 is reserved for the header, the root is written last
+    std::vector<uint8_t> page(pageSize);
+    indexOut.write(reinterpret_cast<const char*>(page.data()), pageSize);
+    uint64_t nextPage = 1;
+    bool leaf = true;
+    while (!level.empty()) {
+        std::vector<PageEntry> parents;
+        for (size_t i = 0; i < level.size(); i += fanout) {
+            size_t count = std::min(fanout, level.size() - i);
+            std::fill(page.begin(), page.end(), 0);
+            NodeHeader node{leaf ? 1u : 0u, static_cast<uint32_t>(count)};
+            std::memcpy(page.data(), &node, sizeof(node));
+            std::memcpy(page.data() + sizeof(node), &level[i], count * sizeof(PageEntry));
+            indexOut.write(reinterpret_cast<const char*>(page.data()), pageSize);
+
+            BoundingBox3D box;
+            for (size_t j = i; j < i + count; ++j) box.expandToInclude(level[j].box());
+            parents.push_back(makeEntry(box, nextPage++));
+        }
+        ++header.height;
+        leaf = false;
+        if (parents.size() == 1) {
+            header.rootPage = parents.front().ref;
+            break;
+        }
+        strOrder(parents, fanout);
+        level = std::move(parents);
+    }
+    header.nodePages = nextPage - 1;
+    header.minX = rootBox.getMinX();
+    header.minY = rootBox.getMinY();
+    header.maxX = rootBox.getMaxX();
+    header.maxY = rootBox.getMaxY();
+    header.minT = rootBox.getMinT();
+    header.maxT = rootBox.getMaxT();
+
+    std::fill(page.begin(), page.end(), 0);
+    std::memcpy(page.data(), &header, sizeof(header));
+    indexOut.seekp(0);
+    indexOut.write(reinterpret_cast<const char*>(page.data()), pageSize);
+    if (!heapOut.flush() || !indexOut.flush()) throw std::runtime_error("PagedRTree failed writing " + basePath);
+}
+
+PagedRTree::PagedRTree(const std::string& basePath, const PagedRTreeOptions& options) {
+    std::ifstream in(basePath + ".idx", std::ios::binary);
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+        throw std::runtime_error("PagedRTree: " + basePath + ".idx is not a paged R-Tree");
+
+    indexPool = std::make_unique<BufferPool>(basePath + ".idx", header.pageSize, options.indexPoolPages, options.policy);
+    heapPool = std::make_unique<BufferPool>(basePath + ".heap", header.pageSize, options.heapPoolPages, options.policy);
+}
+
+// ---------------- Traversal ----------------
+void PagedRTree::search(const BoundingBox3D& queryBox, std::vector<uint64_t>& refs, PagedQueryStats& io) const {
+    if (header.height == 0 || !queryBox.intersects(getRootBox())) return;
+
+    std::vector<uint64_t> stack{header.rootPage};
+    PageEntry entry;
+    while (!stack.empty()) {
+        BufferPool::Page page = indexPool->fetch(stack.back(), &io.index);
+        stack.pop_back();
+        ++io.nodesVisited;
+
+        NodeHeader node;
+        std::memcpy(&node, page->data(), sizeof(node));
+        const uint8_t* entries = page->data() + sizeof(node);
+        for (uint32_t i = 0; i < node.count; ++i) {
+            std::memcpy(&entry, entries + i * sizeof(PageEntry), sizeof(PageEntry));
+            if (!queryBox.intersects(entry.box())) continue;
+            if (node.leaf) refs.push_back(entry.ref);
+            else stack.push_back(entry.ref);
+        }
+    }
+}
+
+Trajectory PagedRTree::loadTrajectory(uint64_t ref, PagedQueryStats& io) const {
+    const size_t pageSize = header.pageSize;
+    uint64_t pageId = ref / pageSize;
+    size_t pos = ref % pageSize;
+    BufferPool::Page page = heapPool->fetch(pageId, &io.heap);
+
+    // Copies n bytes of the record, moving to the next page at page ends
+    auto read = [&](void* dst, size_t n) {
+        uint8_t* out = static_cast<uint8_t*>(dst);
+        while (n > 0) {
+            if (pos == pageSize) {
+                page = heapPool->fetch(++pageId, &io.heap);
+                pos = 0;
+            }
+            size_t chunk = std::min(n, pageSize - pos);
+            std::memcpy(out, page->data() + pos, chunk);
+            out += chunk;
+            pos += chunk;
+            n -= chunk;
+        }
+    };
+
+    uint32_t idLength, pointCount;
+    read(&idLength, sizeof(idLength));
+    read(&pointCount, sizeof(pointCount));
+    std::string id(idLength, '\0');
+    read(id.data(), idLength);
+
+    Trajectory traj(id);
+    traj.reservePoints(pointCount);
+    for (uint32_t i = 0; i < pointCount; ++i) {
+        float x, y;
+        int64_t t;
+        read(&x, sizeof(x));
+        read(&y, sizeof(y));
+        read(&t, sizeof(t));
+        traj.addPoint(Point3D(x, y, t));
+    }
+    traj.precomputeCentroidAndBoundingBox();
+    ++io.payloadsLoaded;
+    return traj;
+}
+
+// ---------------- Queries ----------------
+std::vector<Trajectory> PagedRTree::rangeQuery(const BoundingBox3D& queryBox, PagedQueryStats* io) const {
+    PagedQueryStats local;
+    std::vector<uint64_t> refs;
+    search(queryBox, refs, local);
+
+    // Heap order, so each heap page is fetched in one run
+    std::sort(refs.begin(), refs.end());
+    std::vector<Trajectory> results;
+    results.reserve(refs.size());
+    for (uint64_t ref : refs) results.push_back(loadTrajectory(ref, local));
+    if (io) *io = local;
+    return results;
+}
+
+size_t PagedRTree::rangeCount(const BoundingBox3D& queryBox, PagedQueryStats* io) const {
+    PagedQueryStats local;
+    std::vector<uint64_t> refs;
+    search(queryBox, refs, local);
+    if (io) *io = local;
+    return refs.size();
+}
+
+std::vector<PagedSnapshotPosition> PagedRTree::snapshotQuery(const BoundingBox3D& area, int64_t t,
+                                                             PagedQueryStats* io) const {
+    PagedQueryStats local;
+    std::vector<uint64_t> refs;
+    // The area's time bounds are replaced by t, as in RTree::snapshotQuery
+    search(BoundingBox3D(area.getMinX(), area.getMinY(), t, area.getMaxX(), area.getMaxY(), t), refs, local);
+    std::sort(refs.begin(), refs.end());
+
+    std::vector<PagedSnapshotPosition> results;
+    for (uint64_t ref : refs) {
+        Trajectory traj = loadTrajectory(ref, local);
+        auto p = traj.positionAt(t);
+        if (p && p->getX() >= area.getMinX() && p->getX() <= area.getMaxX() &&
+            p->getY() >= area.getMinY() && p->getY() <= area.getMaxY())
+            results.push_back({traj.getId(), p->getX(), p->getY()});
+    }
+    if (io) *io = local;
+    return results;
+}
+
+// ---------------- Info ----------------
+BoundingBox3D PagedRTree::getRootBox() const {
+    return BoundingBox3D(header.minX, header.minY, header.minT, header.maxX, header.maxY, header.maxT);
+}
+
+void PagedRTree::resetStats() {
+    indexPool->resetStats();
+    heapPool->resetStats();
+}
+
+size_t PagedRTree::memoryUsage() const {
+    return sizeof(*this) + indexPool->memoryUsage() + heapPool->memoryUsage();
+}
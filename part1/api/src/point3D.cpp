@@ -7,45 +7,8 @@
 // Default constructor: initializes to (0, 0, 0)
 Point3D::Point3D() : x(0.0f), y(0.0f), t(0) {}
 
-// Parameterized constructor: initializes with given values and validates
-Point3D::Point3D(float x, float y, int64_t t) : x(x), y(y), t(t) {
-    validate();
-}
-
-// Copy constructor: creates a copy of another Point3D
-Point3D::Point3D(const Point3D& other) : x(other.x), y(other.y), t(other.t) {}
-
-// Move constructor: transfers ownership and resets source
-Point3D::Point3D(Point3D&& other) noexcept : x(other.x), y(other.y), t(other.t) {
-    other.x = 0.0f;
-    other.y = 0.0f;
-    other.t = 0;
-}
-
-// -------------------- Assignment Operators --------------------
-
-// Copy assignment: assigns values from another Point3D
-Point3D& Point3D::operator=(const Point3D& other) {
-    if (this != &other) {
-        x = other.x;
-        y = other.y;
-        t = other.t;
-    }
-    return *this;
-}
-
-// Move assignment: transfers ownership from another Point3D
-Point3D& Point3D::operator=(Point3D&& other) noexcept {
-    if (this != &other) {
-        x = other.x;
-        y = other.y;
-        t = other.t;
-        other.x = 0.0f;
-        other.y = 0.0f;
-        other.t = 0;
-    }
-    return *this;
-}
+// Parameterized constructor: initializes with given values (see validate for checks)
+Point3D::Point3D(float x, float y, int64_t t) : x(x), y(y), t(t) {}
 
 // -------------------- Accessors --------------------
 float Point3D::getX() const { return x; }
@@ -64,14 +27,41 @@ json Point3D::to_json() const {
     return json{{"x", x}, {"y", y}, {"t", t}};
 }
 
-// Validate the coordinates and timestamp
-void Point3D::validate() const {
-    if (y < -90.0f || y > 90.0f)
-        std::cerr << "[Warning] Latitude out of range: " << y << "\n";
-    if (x < -180.0f || x > 180.0f)
-        std::cerr << "[Warning] Longitude out of range: " << x << "\n";
-    if (t == 0)
-        std::cerr << "[Warning] Timestamp is zero\n";
+// -------------------- Validation --------------------
+bool Point3D::isValid() const {
+    return y >= -90.0f && y <= 90.0f && x >= -180.0f && x <= 180.0f && t != 0;
+}
+
+// Count out-of-range coordinates and zero timestamps in one pass
+PointValidationReport Point3D::validate(const Point3D* points, size_t count) {
+    PointValidationReport report;
+    report.points = count;
+    for (size_t i = 0; i < count; ++i) {
+        const Point3D& p = points[i];
+        bool badLat = p.y < -90.0f || p.y > 90.0f;
+        bool badLon = p.x < -180.0f || p.x > 180.0f;
+        bool zeroT = p.t == 0;
+        report.latitudeOutOfRange += badLat;
+        report.longitudeOutOfRange += badLon;
+        report.zeroTimestamps += zeroT;
+        report.invalidPoints += badLat || badLon || zeroT;
+    }
+    return report;
+}
+
+PointValidationReport& PointValidationReport::operator+=(const PointValidationReport& other) {
+    points += other.points;
+    latitudeOutOfRange += other.latitudeOutOfRange;
+    longitudeOutOfRange += other.longitudeOutOfRange;
+    zeroTimestamps += other.zeroTimestamps;
+    invalidPoints += other.invalidPoints;
+    return *this;
+}
+
+void PointValidationReport::print(std::ostream& os, const std::string& source) const {
+    os << "[Warning] " << source << ": " << invalidPoints << " of " << points << " points invalid ("
+       << latitudeOutOfRange << " latitude out of range, " << longitudeOutOfRange << " longitude out of range, "
+       << zeroTimestamps << " zero timestamps)\n";
 }
 
 // -------------------- Comparison Operators --------------------
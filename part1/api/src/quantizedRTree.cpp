@@ -0,0 +1,211 @@
+#include "../include/quantizedRTree.h"
+#include "../include/RTreeNode.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+// Entries compared per kernel call (8 codes = one 8- or 16-byte vector)
+template <typename Code>
+static constexpr size_t kLanes = 8;
+
+template <typename Code>
+static size_t paddedCount(size_t count) {
+    return (count + kLanes<Code> - 1) / kLanes<Code> * kLanes<Code>;
+}
+
+// ---------------- Quantization helpers ----------------
+
+// Distance from the frame origin in code units. Monotonic in v, so rounding the
+// box outward and the query outward can never turn an overlap into a miss.
+static double toCodeSpace(double v, double origin, double step) { return (v - origin) / step; }
+
+template <typename Code>
+static Code codeFloor(double u) {
+    const double maxCode = std::numeric_limits<Code>::max();
+    return static_cast<Code>(std::clamp(std::floor(u), 0.0, maxCode));
+}
+
+template <typename Code>
+static Code codeCeil(double u) {
+    const double maxCode = std::numeric_limits<Code>::max();
+    return static_cast<Code>(std::clamp(std::ceil(u), 0.0, maxCode));
+}
+
+// Frame extent per code unit (any positive value works for a flat frame)
+template <typename Code>
+static float frameStep(double extent) {
+    float step = static_cast<float>(extent / std::numeric_limits<Code>::max());
+    return step > 0.0f ? step : 1.0f;
+}
+
+// ---------------- Constructor ----------------
+QuantizedRTree::QuantizedRTree(const std::shared_ptr<RTreeNode>& root, int bits)
+    : codeBits(bits) {
+    if (bits == 8) build(root, codes8);
+    else if (bits == 16) build(root, codes16);
+    else throw std::invalid_argument("QuantizedRTree supports 8 or 16 bit codes");
+}
+
+template <typename Code>
+void QuantizedRTree::build(const std::shared_ptr<RTreeNode>& root, std::vector<Code>& codes) {
+    if (!root) return;
+
+    // Breadth-first order so the children of a node get consecutive indices
+    std::vector<std::shared_ptr<RTreeNode>> order{root};
+    for (size_t i = 0; i < order.size(); ++i)
+        if (!order[i]->isLeafNode())
+            for (const auto& [_, child] : order[i]->getChildEntries()) order.push_back(child);
+
+    // Exact frames bottom-up (children always come later in BFS order)
+    std::vector<BoundingBox3D> frames(order.size());
+    std::vector<uint32_t> firstChild(order.size(), 0);
+    uint32_t nextChild = 1;
+    for (size_t i = 0; i < order.size(); ++i) {
+        firstChild[i] = nextChild;
+        if (!order[i]->isLeafNode()) nextChild += static_cast<uint32_t>(order[i]->getChildEntries().size());
+    }
+    for (size_t i = order.size(); i-- > 0;) {
+        if (order[i]->isLeafNode()) {
+            for (const auto& [_, traj] : order[i]->getLeafEntries())
+                frames[i].expandToInclude(traj->getBoundingBox());
+        } else {
+            for (size_t c = 0; c < order[i]->getChildEntries().size(); ++c)
+                frames[i].expandToInclude(frames[firstChild[i] + c]);
+        }
+    }
+    rootBox = frames[0];
+
+    // Quantize every entry box into its parent's frame
+    nodes.reserve(order.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        const BoundingBox3D& frame = frames[i];
+        Node node;
+        node.originX = frame.getMinX();
+        node.originY = frame.getMinY();
+        node.originT = frame.getMinT();
+        node.stepX = frameStep<Code>(static_cast<double>(frame.getMaxX()) - frame.getMinX());
+        node.stepY = frameStep<Code>(static_cast<double>(frame.getMaxY()) - frame.getMinY());
+        node.stepT = frameStep<Code>(static_cast<double>(frame.getMaxT() - frame.getMinT()));
+        node.firstEntry = static_cast<uint32_t>(refs.size());
+        node.leaf = order[i]->isLeafNode();
+
+        // Entry boxes and references of this node (empty boxes can never match and are skipped)
+        auto isEmpty = [](const BoundingBox3D& b) { return !b.intersects(b); };
+        std::vector<BoundingBox3D> boxes;
+        std::vector<uint32_t> entryRefs;
+        if (node.leaf) {
+            for (const auto& [_, traj] : order[i]->getLeafEntries()) {
+                BoundingBox3D box = traj->getBoundingBox();
+                if (isEmpty(box)) continue;
+                boxes.push_back(box);
+                entryRefs.push_back(static_cast<uint32_t>(trajectories.size()));
+                trajectories.push_back(traj);
+            }
+        } else {
+            for (size_t c = 0; c < order[i]->getChildEntries().size(); ++c) {
+                if (isEmpty(frames[firstChild[i] + c])) continue;
+                boxes.push_back(frames[firstChild[i] + c]);
+                entryRefs.push_back(firstChild[i] + static_cast<uint32_t>(c));
+            }
+        }
+        node.count = static_cast<uint32_t>(boxes.size());
+
+        // Code block layout: [minX | maxX | minY | maxY | minT | maxT], each padded
+        size_t padded = paddedCount<Code>(boxes.size());
+        size_t base = codes.size();
+        codes.resize(base + 6 * padded, 0);
+        refs.resize(refs.size() + padded, 0);
+        for (size_t e = 0; e < boxes.size(); ++e) {
+            const BoundingBox3D& b = boxes[e];
+            codes[base + 0 * padded + e] = codeFloor<Code>(toCodeSpace(b.getMinX(), node.originX, node.stepX));
+            codes[base + 1 * padded + e] = codeCeil<Code>(toCodeSpace(b.getMaxX(), node.originX, node.stepX));
+            codes[base + 2 * padded + e] = codeFloor<Code>(toCodeSpace(b.getMinY(), node.originY, node.stepY));
+            codes[base + 3 * padded + e] = codeCeil<Code>(toCodeSpace(b.getMaxY(), node.originY, node.stepY));
+            codes[base + 4 * padded + e] = codeFloor<Code>(static_cast<double>(b.getMinT() - node.originT) / node.stepT);
+            codes[base + 5 * padded + e] = codeCeil<Code>(static_cast<double>(b.getMaxT() - node.originT) / node.stepT);
+            refs[node.firstEntry + e] = entryRefs[e];
+        }
+        nodes.push_back(node);
+    }
+}
+
+// ---------------- Range Query ----------------
+
+// Intersection mask for kLanes entries of a node's code block
+template <typename Code>
+static void testLanes(const Code* __restrict block, size_t padded, size_t offset,
+                      const Code q[6], uint8_t* __restrict mask) {
+    const Code* __restrict x0 = block + offset;
+    const Code* __restrict x1 = block + padded + offset;
+    const Code* __restrict y0 = block + 2 * padded + offset;
+    const Code* __restrict y1 = block + 3 * padded + offset;
+    const Code* __restrict t0 = block + 4 * padded + offset;
+    const Code* __restrict t1 = block + 5 * padded + offset;
+    const Code qx0 = q[0], qx1 = q[1], qy0 = q[2], qy1 = q[3], qt0 = q[4], qt1 = q[5];
+    for (size_t i = 0; i < kLanes<Code>; ++i)
+        mask[i] = !((x1[i] < qx0) | (x0[i] > qx1) | (y1[i] < qy0) | (y0[i] > qy1) |
+                    (t1[i] < qt0) | (t0[i] > qt1));
+}
+
+template <typename Code>
+void QuantizedRTree::search(const BoundingBox3D& queryBox, const std::vector<Code>& codes,
+                            std::vector<std::shared_ptr<Trajectory>>& results) const {
+    if (nodes.empty() || !rootBox.intersects(queryBox)) return;
+
+    // Widen the spatial query by the intersects() tolerance plus one float ulp;
+    // leaf hits are rechecked exactly, so this only affects pruning
+    const double eps = 1e-6;
+    auto widen = [&](float v) { return 2 * eps + std::abs(v) * std::numeric_limits<float>::epsilon(); };
+    const double qMinX = queryBox.getMinX() - widen(queryBox.getMinX());
+    const double qMaxX = queryBox.getMaxX() + widen(queryBox.getMaxX());
+    const double qMinY = queryBox.getMinY() - widen(queryBox.getMinY());
+    const double qMaxY = queryBox.getMaxY() + widen(queryBox.getMaxY());
+
+    std::vector<uint32_t> stack{0};
+    uint8_t mask[kLanes<Code>];
+    Code q[6];
+
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+
+        q[0] = codeFloor<Code>(toCodeSpace(qMinX, node.originX, node.stepX));
+        q[1] = codeCeil<Code>(toCodeSpace(qMaxX, node.originX, node.stepX));
+        q[2] = codeFloor<Code>(toCodeSpace(qMinY, node.originY, node.stepY));
+        q[3] = codeCeil<Code>(toCodeSpace(qMaxY, node.originY, node.stepY));
+        q[4] = codeFloor<Code>(static_cast<double>(queryBox.getMinT() - node.originT) / node.stepT);
+        q[5] = codeCeil<Code>(static_cast<double>(queryBox.getMaxT() - node.originT) / node.stepT);
+
+        size_t padded = paddedCount<Code>(node.count);
+        const Code* block = codes.data() + 6 * static_cast<size_t>(node.firstEntry);
+        for (size_t offset = 0; offset < padded; offset += kLanes<Code>) {
+            testLanes<Code>(block, padded, offset, q, mask);
+            size_t lanes = std::min<size_t>(kLanes<Code>, node.count - offset);
+            for (size_t i = 0; i < lanes; ++i) {
+                if (!mask[i]) continue;
+                uint32_t ref = refs[node.firstEntry + offset + i];
+                if (!node.leaf) {
+                    stack.push_back(ref);
+                } else if (queryBox.intersects(trajectories[ref]->getBoundingBox())) {
+                    results.push_back(trajectories[ref]);
+                }
+            }
+        }
+    }
+}
+
+std::vector<std::shared_ptr<Trajectory>> QuantizedRTree::rangeQuery(const BoundingBox3D& queryBox) const {
+    std::vector<std::shared_ptr<Trajectory>> results;
+    if (codeBits == 8) search(queryBox, codes8, results);
+    else search(queryBox, codes16, results);
+    return results;
+}
+
+// ---------------- Memory ----------------
+size_t QuantizedRTree::memoryUsage() const {
+    return nodes.capacity() * sizeof(Node) +
+           codes8.capacity() * sizeof(uint8_t) + codes16.capacity() * sizeof(uint16_t) +
+           refs.capacity() * sizeof(uint32_t) +
+           trajectories.capacity() * sizeof(std::shared_ptr<Trajectory>);
+}
@@ -0,0 +1,26 @@
+#include "../include/queryControl.h"
+#include <utility>
+#include <chrono>
+
+QueryControl QueryControl::withTimeout(double seconds, CancellationToken token) {
+    QueryControl control;
+    control.token = std::move(token);
+    const Clock::time_point now = Clock::now();
+    // Durations near the clock's range (including +inf and NaN) would overflow: no deadline.
+    // Half the remaining range leaves room for rounding in the conversion.
+    const double limit = 0.5 * std::chrono::duration<double>(Clock::time_point::max() - now).count();
+    if (!(seconds < limit)) return control;
+    control.deadline = seconds <= 0.0 ? now : now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds));
+    return control;
+}
+
+bool QueryGuard::stop() {
+    if (reason != QueryStopReason::None) return true;
+    if (control.token.isCancelled()) {
+        reason = QueryStopReason::Cancelled;
+    } else if (control.deadline != QueryControl::Clock::time_point::max() && steps++ % kClockInterval == 0 &&
+               QueryControl::Clock::now() >= control.deadline) {
+        reason = QueryStopReason::DeadlineExceeded;
+    }
+    return reason != QueryStopReason::None;
+}
@@ -0,0 +1,261 @@
+#include "../include/queryPlanner.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+// ---------------- Selectivity Histogram ----------------
+
+// Share of the cell [c0, c0 + w] covered by [a0, a1]; a zero-width axis is a single point
+static double coveredFraction(double a0, double a1, double c0, double w) {
+    if (w <= 0.0) return (a0 <= c0 && c0 <= a1) ? 1.0 : 0.0;
+    double overlap = std::min(a1, c0 + w) - std::max(a0, c0);
+    return overlap <= 0.0 ? 0.0 : std::min(1.0, overlap / w);
+}
+
+// Cell index of v on an axis starting at min with the given cell width
+static size_t cellOf(double v, double min, double width, size_t cells) {
+    if (width <= 0.0 || v <= min) return 0;
+    double cell = (v - min) / width; // compared before the cast: unbounded queries reach past the last cell
+    return cell >= static_cast<double>(cells - 1) ? cells - 1 : static_cast<size_t>(cell);
+}
+
+SelectivityHistogram::SelectivityHistogram(const std::vector<BoundingBox3D>& boxes, size_t cellsX, size_t cellsY,
+                                           size_t buckets)
+    : cellsX(cellsX), cellsY(cellsY), buckets(buckets), total(boxes.size()) {
+    if (cellsX == 0 || cellsY == 0 || buckets == 0) throw std::invalid_argument("SelectivityHistogram needs at least one cell per axis");
+
+    auto center = [](double a, double b) { return 0.5 * (a + b); };
+    double maxX = std::numeric_limits<double>::lowest(), maxY = maxX, maxT = maxX;
+    minX = minY = minT = std::numeric_limits<double>::max();
+    for (const auto& b : boxes) {
+        double cx = center(b.getMinX(), b.getMaxX()), cy = center(b.getMinY(), b.getMaxY());
+        double ct = center(static_cast<double>(b.getMinT()), static_cast<double>(b.getMaxT()));
+        minX = std::min(minX, cx); maxX = std::max(maxX, cx);
+        minY = std::min(minY, cy); maxY = std::max(maxY, cy);
+        minT = std::min(minT, ct); maxT = std::max(maxT, ct);
+    }
+    if (boxes.empty()) minX = minY = minT = maxX = maxY = maxT = 0.0;
+
+    // An axis without spread collapses to one cell
+    if (maxX <= minX) this->cellsX = cellsX = 1;
+    if (maxY <= minY) this->cellsY = cellsY = 1;
+    if (maxT <= minT) this->buckets = buckets = 1;
+    cellW = (maxX - minX) / cellsX;
+    cellH = (maxY - minY) / cellsY;
+    cellT = (maxT - minT) / buckets;
+
+    size_t cells = cellsX * cellsY * buckets;
+    counts.assign(cells, 0);
+    std::vector<double> sumX(cells, 0.0), sumY(cells, 0.0), sumT(cells, 0.0);
+    for (const auto& b : boxes) {
+        double hx = 0.5 * (b.getMaxX() - b.getMinX()), hy = 0.5 * (b.getMaxY() - b.getMinY());
+        double ht = 0.5 * static_cast<double>(b.getMaxT() - b.getMinT());
+        size_t x = cellOf(b.getMinX() + hx, minX, cellW, cellsX);
+        size_t y = cellOf(b.getMinY() + hy, minY, cellH, cellsY);
+        size_t t = cellOf(static_cast<double>(b.getMinT()) + ht, minT, cellT, buckets);
+        size_t i = (t * cellsY + y) * cellsX + x;
+        ++counts[i];
+        sumX[i] += hx; sumY[i] += hy; sumT[i] += ht;
+    }
+
+    halfX.assign(cells, 0.0f); halfY.assign(cells, 0.0f); halfT.assign(cells, 0.0f);
+    for (size_t i = 0; i < cells; ++i) {
+        if (counts[i] == 0) continue;
+        halfX[i] = static_cast<float>(sumX[i] / counts[i]);
+        halfY[i] = static_cast<float>(sumY[i] / counts[i]);
+        halfT[i] = static_cast<float>(sumT[i] / counts[i]);
+        maxHalfX = std::max(maxHalfX, static_cast<double>(halfX[i]));
+        maxHalfY = std::max(maxHalfY, static_cast<double>(halfY[i]));
+        maxHalfT = std::max(maxHalfT, static_cast<double>(halfT[i]));
+    }
+}
+
+double SelectivityHistogram::estimate(const BoundingBox3D& query) const {
+    if (total == 0) return 0.0;
+    const double qx0 = query.getMinX(), qx1 = query.getMaxX();
+    const double qy0 = query.getMinY(), qy1 = query.getMaxY();
+    const double qt0 = static_cast<double>(query.getMinT()), qt1 = static_cast<double>(query.getMaxT());
+
+    // Only cells whose centers can be reached by the query grown by the largest half-extent
+    auto range = [](double a0, double a1, double grow, double min, double width, size_t cells, size_t& lo, size_t& hi) {
+        double limit = min + width * cells;
+        if (a1 + grow < min || a0 - grow > limit) return false;
+        lo = cellOf(a0 - grow, min, width, cells);
+        hi = cellOf(a1 + grow, min, width, cells);
+        return true;
+    };
+    size_t x0, x1, y0, y1, t0, t1;
+    if (!range(qx0, qx1, maxHalfX, minX, cellW, cellsX, x0, x1) ||
+        !range(qy0, qy1, maxHalfY, minY, cellH, cellsY, y0, y1) ||
+        !range(qt0, qt1, maxHalfT, minT, cellT, buckets, t0, t1))
+        return 0.0;
+
+    double estimate = 0.0;
+    for (size_t t = t0; t <= t1; ++t) {
+        for (size_t y = y0; y <= y1; ++y) {
+            for (size_t x = x0; x <= x1; ++x) {
+                size_t i = (t * cellsY + y) * cellsX + x;
+                if (counts[i] == 0) continue;
+                double f = coveredFraction(qt0 - halfT[i], qt1 + halfT[i], minT + t * cellT, cellT);
+                if (f == 0.0) continue;
+                f *= coveredFraction(qy0 - halfY[i], qy1 + halfY[i], minY + y * cellH, cellH);
+                if (f == 0.0) continue;
+                f *= coveredFraction(qx0 - halfX[i], qx1 + halfX[i], minX + x * cellW, cellW);
+                estimate += f * counts[i];
+            }
+        }
+    }
+    return std::min(estimate, static_cast<double>(total));
+}
+
+size_t SelectivityHistogram::memoryUsage() const {
+    return counts.capacity() * sizeof(uint32_t) + (halfX.capacity() + halfY.capacity() + halfT.capacity()) * sizeof(float);
+}
+
+// ---------------- Constructor ----------------
+QueryPlanner::QueryPlanner(const RTree& tree, const std::vector<Trajectory>& trajectories, const PlannerOptions& options)
+    : tree(tree), trajectories(trajectories), costs(options.costs), scan(trajectories) {
+    std::vector<BoundingBox3D> boxes;
+    boxes.reserve(trajectories.size());
+    for (const auto& traj : trajectories) boxes.push_back(traj.getBoundingBox());
+    rows = SelectivityHistogram(boxes, options.cellsX, options.cellsY, options.timeBuckets);
+
+    // Leaf MBRs, and how many box tests a traversal spends per leaf it reaches
+    std::vector<BoundingBox3D> leafBoxes;
+    size_t tested = 0;
+    std::vector<std::shared_ptr<RTreeNode>> stack;
+    if (tree.getRoot()) stack.push_back(tree.getRoot());
+    while (!stack.empty()) {
+        auto node = stack.back();
+        stack.pop_back();
+        if (node->isLeafNode()) {
+            leafBoxes.push_back(node->getMBR());
+            tested += node->getLeafEntries().size();
+        } else {
+            tested += node->getChildEntries().size();
+            for (const auto& [_, child] : node->getChildEntries()) stack.push_back(child);
+        }
+    }
+    leaves = SelectivityHistogram(leafBoxes, options.cellsX, options.cellsY, options.timeBuckets);
+    entriesPerLeaf = leafBoxes.empty() ? 0.0 : static_cast<double>(tested) / leafBoxes.size();
+}
+
+// ---------------- Planning ----------------
+QueryPlanner::Plan QueryPlanner::plan(const BoundingBox3D& query) const {
+    Plan p;
+    p.estimatedRows = rows.estimate(query);
+    p.estimatedLeaves = leaves.estimate(query);
+    // The temporal index yields every trajectory whose time span meets the window
+    const float inf = std::numeric_limits<float>::infinity();
+    p.timeCandidates = rows.estimate(BoundingBox3D(-inf, -inf, query.getMinT(), inf, inf, query.getMaxT()));
+
+    const size_t index = static_cast<size_t>(Strategy::IndexTraversal);
+    const size_t linear = static_cast<size_t>(Strategy::ColumnarScan);
+    const size_t time = static_cast<size_t>(Strategy::TimeIndex);
+    p.entries[index] = std::max(p.estimatedLeaves, 1.0) * entriesPerLeaf;
+    p.entries[linear] = static_cast<double>(trajectories.size());
+    p.entries[time] = p.timeCandidates;
+    p.cost[index] = p.entries[index] * costs.indexEntry;
+    p.cost[linear] = p.entries[linear] * costs.scanEntry;
+    p.cost[time] = p.entries[time] * costs.timeCandidate;
+
+    size_t best = std::min_element(p.cost, p.cost + kStrategies) - p.cost;
+    p.strategy = static_cast<Strategy>(best);
+    return p;
+}
+
+// ---------------- Execution ----------------
+std::vector<const Trajectory*> QueryPlanner::executeWith(Strategy strategy, const BoundingBox3D& query) const {
+    std::vector<const Trajectory*> results;
+    switch (strategy) {
+    case Strategy::IndexTraversal:
+        tree.rangeQuery(query, results);
+        break;
+    case Strategy::ColumnarScan:
+        for (size_t i : scan.rangeQuery(query)) results.push_back(&trajectories[i]);
+        break;
+    case Strategy::TimeIndex:
+        tree.temporalRangeQuery(query, results);
+        break;
+    }
+    return results;
+}
+
+std::vector<const Trajectory*> QueryPlanner::execute(const BoundingBox3D& query) const {
+    auto start = std::chrono::steady_clock::now();
+    Plan p = plan(query);
+    auto results = executeWith(p.strategy, query);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::lock_guard<std::mutex> lock(logMutex);
+    planLog.push_back({query, p.strategy, p.estimatedRows, results.size(),
+                   p.cost[static_cast<size_t>(p.strategy)], seconds});
+    return results;
+}
+
+// ---------------- Calibration ----------------
+void QueryPlanner::calibrate(const std::vector<BoundingBox3D>& sample) {
+    double seconds[kStrategies] = {}, entries[kStrategies] = {};
+    for (const auto& query : sample) {
+        Plan p = plan(query);
+        for (size_t s = 0; s < kStrategies; ++s) {
+            auto start = std::chrono::steady_clock::now();
+            executeWith(static_cast<Strategy>(s), query);
+            seconds[s] += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            entries[s] += p.entries[s];
+        }
+    }
+    double* perEntry[kStrategies] = {&costs.indexEntry, &costs.scanEntry, &costs.timeCandidate};
+    for (size_t s = 0; s < kStrategies; ++s)
+        if (entries[s] > 0.0 && seconds[s] > 0.0) *perEntry[s] = seconds[s] / entries[s];
+}
+
+std::vector<QueryPlanner::LogEntry> QueryPlanner::calibrationLog() const {
+    std::lock_guard<std::mutex> lock(logMutex);
+    return planLog;
+}
+
+void QueryPlanner::clearCalibrationLog() {
+    std::lock_guard<std::mutex> lock(logMutex);
+    planLog.clear();
+}
+
+void QueryPlanner::saveCalibrationLog(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out) throw std::runtime_error("Cannot open file for writing: " + filename);
+    out << "Strategy,MinX,MinY,MinT,MaxX,MaxY,MaxT,EstimatedRows,ActualRows,EstimatedCost(s),Time(s)\n";
+    for (const auto& e : calibrationLog()) {
+        out << strategyName(e.strategy) << "," << std::setprecision(9)
+            << e.query.getMinX() << "," << e.query.getMinY() << "," << e.query.getMinT() << ","
+            << e.query.getMaxX() << "," << e.query.getMaxY() << "," << e.query.getMaxT() << ","
+            << e.estimatedRows << "," << e.actualRows << "," << e.estimatedCost << "," << e.seconds << "\n";
+    }
+}
+
+double QueryPlanner::meanQError() const {
+    auto entries = calibrationLog();
+    if (entries.empty()) return 0.0;
+    double sum = 0.0;
+    for (const auto& e : entries) {
+        double est = std::max(e.estimatedRows, 1.0), actual = std::max(static_cast<double>(e.actualRows), 1.0);
+        sum += std::max(est, actual) / std::min(est, actual);
+    }
+    return sum / entries.size();
+}
+
+const char* QueryPlanner::strategyName(Strategy strategy) {
+    switch (strategy) {
+    case Strategy::IndexTraversal: return "IndexTraversal";
+    case Strategy::ColumnarScan: return "ColumnarScan";
+    case Strategy::TimeIndex: return "TimeIndex";
+    }
+    return "Unknown";
+}
+
+size_t QueryPlanner::memoryUsage() const {
+    return rows.memoryUsage() + leaves.memoryUsage() + scan.memoryUsage();
+}
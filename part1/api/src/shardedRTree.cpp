@@ -0,0 +1,230 @@
+#include "../include/shardedRTree.h"
+#include "../include/RTreeNode.h"
+#include "../include/nodeAggregate.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <future>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+// ---------------- Constructors ----------------
+ShardedRTree::ShardedRTree(size_t shardCount, ShardingScheme scheme, size_t numThreads, int maxEntries)
+    : scheme(scheme), maxEntries(maxEntries), shardSizes(shardCount, 0), boxes(shardCount), pool(numThreads) {
+    if (shardCount == 0) throw std::invalid_argument("ShardedRTree needs at least one shard");
+    for (size_t s = 0; s < shardCount; ++s) shards.push_back(std::make_unique<RTree>(maxEntries));
+}
+
+// ---------------- Helpers ----------------
+template <typename Result, typename Func>
+std::vector<Result> ShardedRTree::scatter(const std::vector<size_t>& targets, Func task) const {
+    std::vector<Result> results(targets.size());
+    if (targets.empty()) return results;
+
+    std::vector<std::future<void>> pending;
+    pending.reserve(targets.size() - 1);
+    for (size_t i = 1; i < targets.size(); ++i)
+        pending.push_back(pool.submit([&, i]() { results[i] = task(targets[i]); }));
+    results[0] = task(targets[0]);
+    for (auto& f : pending) f.get();
+    return results;
+}
+
+void ShardedRTree::refreshBox(size_t shard) {
+    auto root = shards[shard]->getRoot();
+    boxes[shard] = root && shardSizes[shard] > 0 ? root->getMBR() : BoundingBox3D();
+}
+
+uint32_t ShardedRTree::route(const Trajectory& traj) const {
+    if (scheme == ShardingScheme::VehicleHash)
+        return static_cast<uint32_t>(std::hash<std::string>{}(vehicleIdOf(traj.getId())) % shards.size());
+
+    // Nearest shard box; empty shards count as distance 0, so they fill up first
+    const BoundingBox3D box = traj.getBoundingBox();
+    uint32_t best = 0;
+    float bestDistance = std::numeric_limits<float>::infinity();
+    for (uint32_t s = 0; s < shards.size(); ++s) {
+        float d = shardSizes[s] ? boxes[s].spatialDistanceSquared(box) : 0.0f;
+        if (d < bestDistance || (d == bestDistance && shardSizes[s] < shardSizes[best])) {
+            best = s;
+            bestDistance = d;
+        }
+    }
+    return best;
+}
+
+// ---------------- Data modification ----------------
+void ShardedRTree::bulkLoad(std::vector<Trajectory>& trajectories) {
+    const size_t n = trajectories.size(), shardCount = shards.size();
+    std::vector<uint32_t> assignment(n);
+
+    if (scheme == ShardingScheme::VehicleHash) {
+        for (size_t i = 0; i < n; ++i)
+            assignment[i] = static_cast<uint32_t>(std::hash<std::string>{}(vehicleIdOf(trajectories[i].getId())) % shardCount);
+    } else {
+        // 2D STR over box centers: x slabs, each cut along y into its share of the shards.
+        // Shard s receives the entries [n*s/S, n*(s+1)/S) of the final order.
+        std::vector<float> cx(n), cy(n);
+        for (size_t i = 0; i < n; ++i) {
+            BoundingBox3D box = trajectories[i].getBoundingBox();
+            cx[i] = 0.5f * (box.getMinX() + box.getMaxX());
+            cy[i] = 0.5f * (box.getMinY() + box.getMaxY());
+        }
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return cx[a] < cx[b]; });
+
+        auto boundary = [&](size_t s) { return n * s / shardCount; };
+        const size_t slabs = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(shardCount))));
+        size_t first = 0;
+        for (size_t slab = 0; slab < slabs; ++slab) {
+            size_t count = shardCount / slabs + (slab < shardCount % slabs ? 1 : 0);
+            std::sort(order.begin() + boundary(first), order.begin() + boundary(first + count),
+                      [&](size_t a, size_t b) { return cy[a] < cy[b]; });
+            for (size_t s = first; s < first + count; ++s)
+                for (size_t i = boundary(s); i < boundary(s + 1); ++i) assignment[order[i]] = static_cast<uint32_t>(s);
+            first += count;
+        }
+    }
+
+    std::vector<std::vector<Trajectory>> parts(shardCount);
+    shardOf.clear();
+    shardOf.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        shardOf[trajectories[i].getId()] = assignment[i];
+        parts[assignment[i]].push_back(std::move(trajectories[i]));
+    }
+    trajectories.clear();
+
+    // Shards are independent, so they are built on the pool
+    std::vector<std::future<void>> builds;
+    for (size_t s = 0; s < shardCount; ++s) {
+        shards[s] = std::make_unique<RTree>(maxEntries);
+        shardSizes[s] = parts[s].size();
+        builds.push_back(pool.submit([this, &parts, s]() {
+            shards[s]->bulkLoad(parts[s]);
+            refreshBox(s);
+        }));
+    }
+    for (auto& b : builds) b.get();
+}
+
+void ShardedRTree::insert(const Trajectory& traj) {
+    uint32_t s = route(traj);
+    shards[s]->insert(traj);
+    shardOf[traj.getId()] = s;
+    ++shardSizes[s];
+    refreshBox(s);
+}
+
+bool ShardedRTree::remove(const std::string& trajId) {
+    auto it = shardOf.find(trajId);
+    if (it == shardOf.end()) return false;
+    uint32_t s = it->second;
+    if (!shards[s]->remove(trajId)) return false;
+    shardOf.erase(it);
+    --shardSizes[s];
+    refreshBox(s);
+    return true;
+}
+
+bool ShardedRTree::update(const Trajectory& traj) {
+    auto it = shardOf.find(traj.getId());
+    if (it == shardOf.end()) {
+        insert(traj);
+        return true;
+    }
+    bool updated = shards[it->second]->update(traj);
+    refreshBox(it->second);
+    return updated;
+}
+
+// ---------------- Queries ----------------
+void ShardedRTree::rangeQuery(const BoundingBox3D& queryBox, std::vector<const Trajectory*>& results) const {
+    std::vector<size_t> targets;
+    for (size_t s = 0; s < shards.size(); ++s)
+        if (shardSizes[s] && queryBox.intersects(boxes[s])) targets.push_back(s);
+
+    auto parts = scatter<std::vector<const Trajectory*>>(targets, [&](size_t s) {
+        std::vector<const Trajectory*> part;
+        shards[s]->rangeQuery(queryBox, part);
+        return part;
+    });
+    for (const auto& part : parts) results.insert(results.end(), part.begin(), part.end());
+}
+
+std::vector<Trajectory> ShardedRTree::rangeQuery(const BoundingBox3D& queryBox) const {
+    std::vector<size_t> targets;
+    for (size_t s = 0; s < shards.size(); ++s)
+        if (shardSizes[s] && queryBox.intersects(boxes[s])) targets.push_back(s);
+
+    // Copies are made inside the shard tasks, so they are parallel too
+    auto parts = scatter<std::vector<Trajectory>>(targets, [&](size_t s) { return shards[s]->rangeQuery(queryBox); });
+    size_t total = 0;
+    for (const auto& part : parts) total += part.size();
+    std::vector<Trajectory> results;
+    results.reserve(total);
+    for (auto& part : parts) std::move(part.begin(), part.end(), std::back_inserter(results));
+    return results;
+}
+
+ShardedKNNResult ShardedRTree::kNearestNeighbors(const Trajectory& query, size_t k, float timeScale) const {
+    ShardedKNNResult result;
+    if (k == 0) return result;
+
+    // Shards nearest first by the spatial box distance, a lower bound of spatioTemporalDistanceTo
+    const BoundingBox3D queryBox = query.getBoundingBox();
+    std::vector<std::pair<float, size_t>> order;
+    for (size_t s = 0; s < shards.size(); ++s)
+        if (shardSizes[s]) order.emplace_back(boxes[s].spatialDistanceSquared(queryBox), s);
+    std::sort(order.begin(), order.end());
+
+    ApproximateKNNOptions options;
+    options.timeScale = timeScale;
+    std::vector<std::pair<float, std::shared_ptr<Trajectory>>> best; // sorted, at most k
+    auto kthDistance = [&]() {
+        return best.size() < k ? std::numeric_limits<float>::infinity() : best.back().first;
+    };
+
+    const size_t waveSize = pool.size() + 1; // the calling thread takes one shard
+    size_t next = 0;
+    while (next < order.size() && order[next].first < kthDistance()) {
+        std::vector<size_t> wave;
+        for (; next < order.size() && wave.size() < waveSize && order[next].first < kthDistance(); ++next)
+            wave.push_back(order[next].second);
+
+        auto answers = scatter<ApproximateKNNResult>(wave, [&](size_t s) {
+            return shards[s]->approximateKNearestNeighbors(query, k, options);
+        });
+        for (auto& answer : answers)
+            for (size_t i = 0; i < answer.trajectories.size(); ++i)
+                best.emplace_back(answer.distances[i], std::move(answer.trajectories[i]));
+        std::stable_sort(best.begin(), best.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+        if (best.size() > k) best.resize(k);
+        result.shardsSearched += wave.size();
+    }
+    result.shardsPruned = order.size() - next;
+
+    for (auto& [distance, traj] : best) {
+        result.distances.push_back(distance);
+        result.trajectories.push_back(std::move(traj));
+    }
+    return result;
+}
+
+std::vector<Trajectory> ShardedRTree::findSimilar(const Trajectory& query, float maxDistance) const {
+    // Same pruning test RTreeNode::findSimilar applies to child boxes
+    const BoundingBox3D queryBox = query.getBoundingBox();
+    std::vector<size_t> targets;
+    for (size_t s = 0; s < shards.size(); ++s)
+        if (shardSizes[s] && boxes[s].distanceSquaredTo(queryBox) <= maxDistance * maxDistance) targets.push_back(s);
+
+    auto parts = scatter<std::vector<Trajectory>>(targets, [&](size_t s) {
+        return shards[s]->findSimilar(query, maxDistance);
+    });
+    std::vector<Trajectory> results;
+    for (auto& part : parts) std::move(part.begin(), part.end(), std::back_inserter(results));
+    return results;
+}
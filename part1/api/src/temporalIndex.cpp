@@ -0,0 +1,175 @@
+#include "../include/temporalIndex.h"
+#include <algorithm>
+#include <cmath>
+
+// ---------------- Construction ----------------
+void TemporalIndex::build(const std::vector<std::shared_ptr<Trajectory>>& trajectories) {
+    clear();
+    entries.reserve(trajectories.size());
+    for (const auto& traj : trajectories) {
+        const BoundingBox3D& box = traj->getBoundingBox();
+        slotsById.emplace(traj->getId(), static_cast<uint32_t>(entries.size()));
+        entries.push_back({box.getMinT(), box.getMaxT(), traj, true});
+    }
+    liveCount = entries.size();
+    rebuild();
+}
+
+void TemporalIndex::clear() {
+    entries.clear();
+    slotsById.clear();
+    nodes.clear();
+    byLow.clear();
+    byHigh.clear();
+    built = liveCount = tombstones = 0;
+}
+
+// Median minT as the center: the span it starts contains it, so every node is non-empty,
+// and at most half of the spans lie entirely on either side
+int32_t TemporalIndex::buildNode(std::vector<uint32_t>& slots) {
+    if (slots.empty()) return -1;
+
+    auto mid = slots.begin() + slots.size() / 2;
+    std::nth_element(slots.begin(), mid, slots.end(),
+                     [&](uint32_t a, uint32_t b) { return entries[a].minT < entries[b].minT; });
+    const int64_t center = entries[*mid].minT;
+
+    std::vector<uint32_t> before, after, here;
+    for (uint32_t s : slots) {
+        if (entries[s].maxT < center) before.push_back(s);
+        else if (entries[s].minT > center) after.push_back(s);
+        else here.push_back(s);
+    }
+    slots.clear();
+    slots.shrink_to_fit();
+
+    const uint32_t begin = static_cast<uint32_t>(byLow.size());
+    std::sort(here.begin(), here.end(), [&](uint32_t a, uint32_t b) { return entries[a].minT < entries[b].minT; });
+    byLow.insert(byLow.end(), here.begin(), here.end());
+    std::sort(here.begin(), here.end(), [&](uint32_t a, uint32_t b) { return entries[a].maxT > entries[b].maxT; });
+    byHigh.insert(byHigh.end(), here.begin(), here.end());
+
+    const int32_t index = static_cast<int32_t>(nodes.size());
+    nodes.push_back({center, begin, static_cast<uint32_t>(byLow.size()), -1, -1});
+    int32_t left = buildNode(before);
+    int32_t right = buildNode(after);
+    nodes[index].left = left;
+    nodes[index].right = right;
+    return index;
+}
+
+void TemporalIndex::rebuild() {
+    // Drop tombstones; slots are renumbered
+    std::vector<Entry> kept;
+    kept.reserve(liveCount);
+    for (auto& e : entries)
+        if (e.live) kept.push_back(std::move(e));
+    entries = std::move(kept);
+    slotsById.clear();
+    for (size_t i = 0; i < entries.size(); ++i)
+        slotsById.emplace(entries[i].traj->getId(), static_cast<uint32_t>(i));
+    tombstones = 0;
+    built = entries.size();
+
+    nodes.clear();
+    byLow.clear();
+    byHigh.clear();
+    byLow.reserve(built);
+    byHigh.reserve(built);
+    std::vector<uint32_t> slots(built);
+    for (size_t i = 0; i < built; ++i) slots[i] = static_cast<uint32_t>(i);
+    buildNode(slots);
+}
+
+void TemporalIndex::maybeRebuild() {
+    size_t maxDelta = std::max<size_t>(64, static_cast<size_t>(4.0 * std::sqrt(static_cast<double>(liveCount))));
+    size_t maxTombstones = std::max<size_t>(64, liveCount / 4);
+    if (deltaSize() > maxDelta || tombstones > maxTombstones) rebuild();
+}
+
+// ---------------- Modification ----------------
+void TemporalIndex::insert(const std::shared_ptr<Trajectory>& traj) {
+    const BoundingBox3D& box = traj->getBoundingBox();
+    slotsById.emplace(traj->getId(), static_cast<uint32_t>(entries.size()));
+    entries.push_back({box.getMinT(), box.getMaxT(), traj, true});
+    ++liveCount;
+    maybeRebuild();
+}
+
+void TemporalIndex::kill(uint32_t slot) {
+    entries[slot].live = false;
+    entries[slot].traj.reset();
+    --liveCount;
+    ++tombstones;
+}
+
+bool TemporalIndex::remove(const std::string& trajId) {
+    auto it = slotsById.find(trajId);
+    if (it == slotsById.end()) return false;
+    kill(it->second);
+    slotsById.erase(it);
+    maybeRebuild();
+    return true;
+}
+
+bool TemporalIndex::refresh(const std::string& trajId) {
+    auto it = slotsById.find(trajId);
+    if (it == slotsById.end()) return false;
+    std::shared_ptr<Trajectory> traj = entries[it->second].traj;
+    kill(it->second);
+    slotsById.erase(it);
+    insert(traj);
+    return true;
+}
+
+// ---------------- Queries ----------------
+bool TemporalIndex::query(int64_t t0, int64_t t1, std::vector<std::shared_ptr<Trajectory>>& out, size_t limit) const {
+    size_t found = 0;
+    auto emit = [&](uint32_t slot) {
+        if (!entries[slot].live) return true;
+        out.push_back(entries[slot].traj);
+        return ++found <= limit;
+    };
+
+    // Static part: a node's spans all contain its center, so one sorted prefix of them overlaps the window
+    std::vector<int32_t> stack;
+    if (!nodes.empty()) stack.push_back(0);
+    while (!stack.empty()) {
+        const Node& node = nodes[stack.back()];
+        stack.pop_back();
+        if (t1 < node.center) {
+            for (uint32_t i = node.begin; i < node.end && entries[byLow[i]].minT <= t1; ++i)
+                if (!emit(byLow[i])) return false;
+            if (node.left >= 0) stack.push_back(node.left);
+        } else if (t0 > node.center) {
+            for (uint32_t i = node.begin; i < node.end && entries[byHigh[i]].maxT >= t0; ++i)
+                if (!emit(byHigh[i])) return false;
+            if (node.right >= 0) stack.push_back(node.right);
+        } else {
+            for (uint32_t i = node.begin; i < node.end; ++i)
+                if (!emit(byLow[i])) return false;
+            if (node.left >= 0) stack.push_back(node.left);
+            if (node.right >= 0) stack.push_back(node.right);
+        }
+    }
+
+    // Delta run
+    for (size_t s = built; s < entries.size(); ++s)
+        if (entries[s].minT <= t1 && entries[s].maxT >= t0 && !emit(static_cast<uint32_t>(s))) return false;
+    return true;
+}
+
+std::vector<std::shared_ptr<Trajectory>> TemporalIndex::query(int64_t t0, int64_t t1) const {
+    std::vector<std::shared_ptr<Trajectory>> out;
+    query(t0, t1, out);
+    return out;
+}
+
+// ---------------- Info ----------------
+size_t TemporalIndex::memoryUsage() const {
+    // Multimap node: key, value and next pointer, plus one bucket pointer
+    size_t idMap = slotsById.size() * (sizeof(std::pair<const std::string, uint32_t>) + sizeof(void*)) +
+                   slotsById.bucket_count() * sizeof(void*);
+    return entries.capacity() * sizeof(Entry) + nodes.capacity() * sizeof(Node) +
+           (byLow.capacity() + byHigh.capacity()) * sizeof(uint32_t) + idMap;
+}
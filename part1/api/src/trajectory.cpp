@@ -156,6 +156,28 @@ float Trajectory::averageSpeed() const {
     return length() / static_cast<float>(dur);
 }
 
+std::optional<Point3D> Trajectory::positionAt(int64_t t) const {
+    size_t cursor = 0;
+    return positionAt(t, cursor);
+}
+
+// Binary search from cursor for the first point at or after t, then interpolate from its predecessor.
+// Shared by snapshot and continuous kNN queries, which sweep timestamps in order.
+std::optional<Point3D> Trajectory::positionAt(int64_t t, size_t& cursor) const {
+    if (points.empty() || t < points.front().getT() || t > points.back().getT()) return std::nullopt;
+    if (cursor > points.size() || (cursor > 0 && points[cursor - 1].getT() >= t)) cursor = 0;
+
+    auto it = std::lower_bound(points.begin() + cursor, points.end(), t,
+                               [](const Point3D& p, int64_t value) { return p.getT() < value; });
+    cursor = static_cast<size_t>(it - points.begin());
+    if (it->getT() == t) return *it;
+
+    const Point3D& a = *(it - 1);
+    const Point3D& b = *it;
+    float f = static_cast<float>(static_cast<double>(t - a.getT()) / static_cast<double>(b.getT() - a.getT()));
+    return Point3D(a.getX() + (b.getX() - a.getX()) * f, a.getY() + (b.getY() - a.getY()) * f, t);
+}
+
 // Check if trajectory contains no points
 bool Trajectory::isEmpty() const {
     return points.empty();
@@ -169,36 +191,57 @@ void Trajectory::clear() {
 }
 
 
-void Trajectory::computeCentroid() const {
-    if (points.empty()) {
-        centroidX = centroidY = centroidT = 0;
-        return;
-    }
-    float x = 0, y = 0;
-    float t = 0;
-    for (auto& pt : points) {
-        x += pt.getX();
-        y += pt.getY();
-        t += static_cast<float>(pt.getT());
+// ---------------- Precompute ----------------
+
+// One branch-free pass: min/max, exact integer time sum, and the path length in the same
+// summation order as length()
+TrajectorySummary Trajectory::summarize() const {
+    TrajectorySummary s;
+    const size_t n = points.size();
+    s.pointCount = static_cast<uint32_t>(n);
+    if (n == 0) return s;
+
+    const Point3D* p = points.data();
+    float minX = p[0].getX(), maxX = minX, minY = p[0].getY(), maxY = minY;
+    int64_t minT = p[0].getT(), maxT = minT, sumT = 0;
+    double sumX = 0.0, sumY = 0.0;
+    float length = 0.0f;
+    size_t zeroTimestamps = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const float x = p[i].getX(), y = p[i].getY();
+        const int64_t t = p[i].getT();
+        minX = std::min(minX, x); maxX = std::max(maxX, x);
+        minY = std::min(minY, y); maxY = std::max(maxY, y);
+        minT = std::min(minT, t); maxT = std::max(maxT, t);
+        sumX += x;
+        sumY += y;
+        sumT += t;
+        zeroTimestamps += t == 0;
+        if (i > 0) length += p[i - 1].distanceTo(p[i]);
     }
-    size_t n = points.size();
-    centroidX = x / n;
-    centroidY = y / n;
-    centroidT = t / n;
-}
 
+    // BoundingBox3D treats t = 0 as "empty"; keep its expansion rules for such points
+    s.bbox = zeroTimestamps ? computeBoundingBox() : BoundingBox3D(minX, minY, minT, maxX, maxY, maxT);
+    s.centroidX = static_cast<float>(sumX / n);
+    s.centroidY = static_cast<float>(sumY / n);
+    s.centroidT = static_cast<double>(sumT) / static_cast<double>(n);
+    s.length = length;
+    s.duration = p[n - 1].getT() - p[0].getT();
+    return s;
+}
 
-// ---------------- Precompute ----------------
+TrajectorySummary Trajectory::precomputeCentroidAndBoundingBox() {
+    TrajectorySummary s = summarize();
+    adoptSummary(s);
+    return s;
+}
 
-void Trajectory::precomputeCentroidAndBoundingBox() {
-    if (points.empty()) {
-        cached_bbox = BoundingBox3D();
-        bbox_dirty = false;
-        centroidX = centroidY = centroidT = 0;
-        return;
-    }
-    updateCachedBBox();
-    computeCentroid();
+void Trajectory::adoptSummary(const TrajectorySummary& s) {
+    cached_bbox = s.bbox;
+    bbox_dirty = false;
+    centroidX = s.centroidX;
+    centroidY = s.centroidY;
+    centroidT = s.centroidT;
 }
 
 
@@ -206,7 +249,7 @@ void Trajectory::precomputeCentroidAndBoundingBox() {
 float Trajectory::approximateDistance(const Trajectory& other, float timeScale) const {
     float dx = centroidX - other.centroidX;
     float dy = centroidY - other.centroidY;
-    float dt = (centroidT - other.centroidT) * timeScale;
+    float dt = static_cast<float>(centroidT - other.centroidT) * timeScale;
     float centroidDistSq = dx*dx + dy*dy + dt*dt;
 
     float bboxDistSq = getBoundingBox().distanceSquaredTo(other.getBoundingBox());
@@ -0,0 +1,101 @@
+#include "../include/vehicleIndex.h"
+#include "../include/nodeAggregate.h"
+#include <algorithm>
+
+// ---------------- VehicleBitmap ----------------
+size_t VehicleBitmap::count() const {
+    size_t n = 0;
+    for (uint64_t w : words) n += static_cast<size_t>(__builtin_popcountll(w));
+    return n;
+}
+
+void VehicleBitmap::merge(const VehicleBitmap& other) {
+    if (other.words.size() > words.size()) words.resize(other.words.size(), 0);
+    for (size_t i = 0; i < other.words.size(); ++i) words[i] |= other.words[i];
+}
+
+std::vector<uint32_t> VehicleBitmap::ordinals() const {
+    std::vector<uint32_t> out;
+    for (size_t i = 0; i < words.size(); ++i) {
+        for (uint64_t w = words[i]; w; w &= w - 1)
+            out.push_back(static_cast<uint32_t>(i * 64 + __builtin_ctzll(w)));
+    }
+    return out;
+}
+
+// ---------------- Construction ----------------
+void VehicleIndex::build(const std::vector<std::shared_ptr<Trajectory>>& trajectories) {
+    clear();
+    ordinalOf.reserve(trajectories.size());
+    for (const auto& traj : trajectories) insert(traj);
+}
+
+void VehicleIndex::clear() {
+    names.clear();
+    ordinals.clear();
+    trips.clear();
+    ordinalOf.clear();
+    trajectoryCount = 0;
+}
+
+// ---------------- Modification ----------------
+void VehicleIndex::insert(const std::shared_ptr<Trajectory>& traj) {
+    std::string vehicle = vehicleIdOf(traj->getId());
+    auto [it, added] = ordinals.emplace(vehicle, static_cast<uint32_t>(names.size()));
+    if (added) {
+        names.push_back(std::move(vehicle));
+        trips.emplace_back();
+    }
+    trips[it->second].push_back(traj);
+    ordinalOf[traj.get()] = it->second;
+    ++trajectoryCount;
+}
+
+bool VehicleIndex::remove(const std::string& trajId) {
+    auto it = ordinals.find(vehicleIdOf(trajId));
+    if (it == ordinals.end()) return false;
+    auto& list = trips[it->second];
+    auto pos = std::find_if(list.begin(), list.end(), [&](const auto& t) { return t->getId() == trajId; });
+    if (pos == list.end()) return false;
+    ordinalOf.erase(pos->get());
+    *pos = std::move(list.back());
+    list.pop_back();
+    --trajectoryCount;
+    return true;
+}
+
+// ---------------- Lookup ----------------
+uint32_t VehicleIndex::vehicleOf(const Trajectory* traj) const {
+    auto it = ordinalOf.find(traj);
+    return it == ordinalOf.end() ? npos : it->second;
+}
+
+uint32_t VehicleIndex::ordinal(const std::string& vehicleId) const {
+    auto it = ordinals.find(vehicleId);
+    return it == ordinals.end() ? npos : it->second;
+}
+
+const std::vector<std::shared_ptr<Trajectory>>& VehicleIndex::trajectoriesOf(const std::string& vehicleId) const {
+    static const std::vector<std::shared_ptr<Trajectory>> none;
+    uint32_t v = ordinal(vehicleId);
+    return v == npos ? none : trips[v];
+}
+
+std::vector<std::string> VehicleIndex::vehicleNames(const VehicleBitmap& bitmap) const {
+    std::vector<std::string> out;
+    for (uint32_t v : bitmap.ordinals())
+        if (v < names.size()) out.push_back(names[v]);
+    return out;
+}
+
+size_t VehicleIndex::memoryUsage() const {
+    // Hash map nodes: key, value and next pointer, plus one bucket pointer per bucket
+    size_t bytes = ordinals.size() * (sizeof(std::pair<const std::string, uint32_t>) + sizeof(void*)) +
+                   ordinals.bucket_count() * sizeof(void*) +
+                   ordinalOf.size() * (sizeof(std::pair<const Trajectory* const, uint32_t>) + sizeof(void*)) +
+                   ordinalOf.bucket_count() * sizeof(void*);
+    bytes += names.capacity() * sizeof(std::string) + trips.capacity() * sizeof(trips[0]);
+    for (const auto& name : names) bytes += name.capacity() > 15 ? name.capacity() + 1 : 0;
+    for (const auto& list : trips) bytes += list.capacity() * sizeof(std::shared_ptr<Trajectory>);
+    return bytes;
+}
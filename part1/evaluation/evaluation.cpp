@@ -6,17 +6,54 @@
 #include <unordered_set>
 #include <functional>
 #include <filesystem>
+#include <sstream>
+#include <map>
+#include <unordered_map>
+#include <numeric>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include <limits>
+#include <optional>
 
 namespace timeUtil { int parseTimestampToSeconds(const std::string& timestamp); }
 
+// ---------------- CSV output ----------------
+// Result file: the header when opened, then one line of comma-separated fields per row().
+// Floating-point fields are written in fixed notation; nothing is written if the file cannot be opened.
+class CsvWriter {
+private:
+    std::ofstream out;
+
+public:
+    CsvWriter(const std::string& path, const char* header, int precision = 6) : out(path) {
+        if (out) out << header << "\n" << std::fixed << std::setprecision(precision);
+    }
+
+    template <typename... Fields>
+    void row(const Fields&... fields) {
+        if (!out) return;
+        const char* separator = "";
+        ((out << separator << fields, separator = ","), ...);
+        out << "\n";
+    }
+};
+
 // ---------------- Constructor ----------------
 Evaluation::Evaluation(RTree& tree,
                        const std::vector<Trajectory> trajs,
                        const std::vector<Trajectory> trajsCopy,
-                       const std::string& resultFolder)
-    : rtree(tree), trajectories(trajs), trajectoriesCopy(trajsCopy), folder(resultFolder) 
+                       const std::string& resultFolder,
+                       std::vector<TrajectorySummary> copySummaries)
+    : rtree(tree), trajectories(trajs), trajectoriesCopy(trajsCopy), folder(resultFolder),
+      summaries(copySummaries.empty() ? RTree::computeSummaries(trajectoriesCopy) : std::move(copySummaries)),
+      scan(summaries)
 {
+    if (summaries.size() != trajectoriesCopy.size())
+        throw std::runtime_error("Evaluation: summaries do not match the trajectories");
     std::filesystem::create_directories(folder);
+    for (size_t i = 0; i < trajectoriesCopy.size(); ++i)
+        copyIndexById.emplace(trajectoriesCopy[i].getId(), i);
 }
 
 // ---------------- Find trajectory by ID ----------------
@@ -26,6 +63,43 @@ const Trajectory* Evaluation::findTrajectoryById(const std::string& trajId) {
     return nullptr;
 }
 
+// ---------------- City query box ----------------
+BoundingBox3D Evaluation::cityQueryBox(const std::string& city,
+                                       const std::string& startTime,
+                                       const std::string& endTime) {
+    float minX, minY, maxX, maxY;
+    if (city == "Philadelphia") { minX=-75.28; maxX=-75.16; minY=39.87; maxY=40.00; }
+    else if (city == "Atlanta") { minX=-84.45; maxX=-84.35; minY=33.70; maxY=33.85; }
+    else if (city == "Memphis") { minX=-90.10; maxX=-89.90; minY=35.05; maxY=35.20; }
+    else if (city == "All") { minX=-1000; maxX=1000; minY=-1000; maxY=1000; } // time-only window
+    else { minX=-75.28; maxX=-75.16; minY=39.87; maxY=40.00; }
+
+    int64_t tStart = static_cast<int64_t>(timeUtil::parseTimestampToSeconds(startTime));
+    int64_t tEnd   = static_cast<int64_t>(timeUtil::parseTimestampToSeconds(endTime));
+
+    return BoundingBox3D(minX, minY, tStart, maxX, maxY, tEnd);
+}
+
+// ---------------- Map tiles ----------------
+std::vector<BoundingBox3D> Evaluation::makeTiles(const BoundingBox3D& box, size_t tilesPerSide) {
+    tilesPerSide = std::max<size_t>(tilesPerSide, 1);
+    float tileW = (box.getMaxX() - box.getMinX()) / tilesPerSide, tileH = (box.getMaxY() - box.getMinY()) / tilesPerSide;
+    std::vector<BoundingBox3D> tiles;
+    tiles.reserve(tilesPerSide * tilesPerSide);
+    for (size_t y = 0; y < tilesPerSide; ++y)
+        for (size_t x = 0; x < tilesPerSide; ++x)
+            tiles.emplace_back(box.getMinX() + tileW * x, box.getMinY() + tileH * y, box.getMinT(),
+                               box.getMinX() + tileW * (x + 1), box.getMinY() + tileH * (y + 1), box.getMaxT());
+    return tiles;
+}
+
+// ---------------- Distinct vehicles ----------------
+size_t Evaluation::distinctVehicles(const std::vector<size_t>& copyIndices) const {
+    std::unordered_set<std::string> vehicles;
+    for (size_t i : copyIndices) vehicles.insert(vehicleIdOf(trajectoriesCopy[i].getId()));
+    return vehicles.size();
+}
+
 // ---------------- Filter duplicates ----------------
 std::vector<Trajectory> Evaluation::filterUniqueTrajectories(
     const std::vector<Trajectory>& input,
@@ -45,37 +119,10 @@ std::vector<Trajectory> Evaluation::filterUniqueTrajectories(
     return results;
 }
 
-// ---------------- Linear scan ----------------
-std::vector<Trajectory> Evaluation::linearScan(
-    const std::function<bool(const Trajectory&)>& predicate,
-    const Trajectory* exclude,
-    size_t& outCount,
-    size_t& outUnique,
-    size_t maxCount,
-    const std::function<float(const Trajectory&)>& distanceFunc
-) {
-    std::vector<std::pair<float, Trajectory>> candidates;
-
-    for (auto& t : trajectoriesCopy) {
-        if ((exclude && t.getId() == exclude->getId()) || !predicate(t)) continue;
-        float dist = distanceFunc ? distanceFunc(t) : 0.0f;
-        candidates.emplace_back(dist, t);
-    }
-
-    outCount = candidates.size();
-
-    if (distanceFunc) {
-        std::sort(candidates.begin(), candidates.end(),
-                  [](const auto& a, const auto& b){ return a.first < b.first; });
-    }
-
-    std::vector<Trajectory> candidateTrajs;
-    for (auto& [_, traj] : candidates) candidateTrajs.push_back(traj);
-
-    auto uniqueTrajs = filterUniqueTrajectories(candidateTrajs, exclude, maxCount);
-    outUnique = uniqueTrajs.size();
-
-    return uniqueTrajs;
+// ---------------- Index of a trajectory in the linear-scan copy ----------------
+size_t Evaluation::copyIndexOf(const std::string& trajId) const {
+    auto it = copyIndexById.find(trajId);
+    return it == copyIndexById.end() ? ColumnarScan::npos : it->second;
 }
 
 // ---------------- Run Range Query ----------------
@@ -91,16 +138,7 @@ QueryStats Evaluation::runRangeQuery(
     qs.startTime = startTime;
     qs.endTime = endTime;
 
-    float minX, minY, maxX, maxY;
-    if (city == "Philadelphia") { minX=-75.28; maxX=-75.16; minY=39.87; maxY=40.00; }
-    else if (city == "Atlanta") { minX=-84.45; maxX=-84.35; minY=33.70; maxY=33.85; }
-    else if (city == "Memphis") { minX=-90.10; maxX=-89.90; minY=35.05; maxY=35.20; }
-    else { minX=-75.28; maxX=-75.16; minY=39.87; maxY=40.00; }
-
-    int64_t tStart = static_cast<int64_t>(timeUtil::parseTimestampToSeconds(startTime));
-    int64_t tEnd   = static_cast<int64_t>(timeUtil::parseTimestampToSeconds(endTime));
-
-    BoundingBox3D queryBox(minX, minY, tStart, maxX, maxY, tEnd);
+    BoundingBox3D queryBox = cityQueryBox(city, startTime, endTime);
 
     auto start = std::chrono::high_resolution_clock::now();
     auto rtreeResultsRaw = rtree.rangeQuery(queryBox);
@@ -109,23 +147,22 @@ QueryStats Evaluation::runRangeQuery(
 
     auto rtreeResults = filterUniqueTrajectories(rtreeResultsRaw);
     qs.rtreeCount = rtreeResults.size();
-    qs.rtreeUniqueVehicles = rtreeResults.size();
+    qs.rtreeUniqueVehicles = rtree.rangeQueryVehicles(queryBox).count();
 
     start = std::chrono::high_resolution_clock::now();
-    size_t linearCount, linearUnique;
-    auto linearResultsRaw = linearScan(
-        [&](const Trajectory& t){ return t.getBoundingBox().intersects(queryBox); },
-        nullptr, linearCount, linearUnique
-    );
+    auto linearResults = scan.rangeQuery(queryBox, scanThreads);
     end = std::chrono::high_resolution_clock::now();
     qs.linearTime = std::chrono::duration<double>(end - start).count();
-    qs.linearCount = linearCount;
-    qs.linearUniqueVehicles = linearResultsRaw.size();
+    qs.linearCount = linearResults.size();
+    qs.linearUniqueVehicles = distinctVehicles(linearResults);
 
     // Convert to QueryResult for distance CSV
     std::vector<QueryResult> rtreeQR, linearQR;
     for (auto& t : rtreeResults) rtreeQR.push_back({t.getId(),0.0f,0.0f,t.getPoints().size()});
-    for (auto& t : linearResultsRaw) linearQR.push_back({t.getId(),0.0f,0.0f,t.getPoints().size()});
+    for (size_t i : linearResults) {
+        const Trajectory& t = trajectoriesCopy[i];
+        linearQR.push_back({t.getId(),0.0f,0.0f,t.getPoints().size()});
+    }
 
     saveQueryResults(queryIndex, "rangeQuery", rtreeQR, linearQR);
     saveQueryTrajectoriesForPlot(queryIndex, "rangeQuery", nullptr, rtreeResults);
@@ -153,26 +190,24 @@ QueryStats Evaluation::runKNNQuery(
     qs.rtreeTime = std::chrono::duration<double>(end - start).count();
     rtreeResults = filterUniqueTrajectories(rtreeResults, target, k);
     qs.rtreeCount = rtreeResults.size();
-    qs.rtreeUniqueVehicles = rtreeResults.size();
+    std::unordered_set<std::string> knnVehicles;
+    for (const auto& t : rtreeResults) knnVehicles.insert(vehicleIdOf(t.getId()));
+    qs.rtreeUniqueVehicles = knnVehicles.size();
 
+    size_t exclude = copyIndexOf(trajId);
     start = std::chrono::high_resolution_clock::now();
-    size_t linearCount, linearUnique;
-    auto linearResults = linearScan(
-        [&](const Trajectory&){ return true; },
-        target,
-        linearCount,
-        linearUnique,
-        k,
-        [&](const Trajectory& t){ return target->approximateDistance(t, 1e-5f); }
-    );
+    auto linearResults = scan.kNearest(*target, k, 1e-5f, exclude, scanThreads);
     end = std::chrono::high_resolution_clock::now();
     qs.linearTime = std::chrono::duration<double>(end - start).count();
-    qs.linearCount = linearCount;
-    qs.linearUniqueVehicles = linearResults.size();
+    qs.linearCount = scan.size() - (exclude == ColumnarScan::npos ? 0 : 1);
+    qs.linearUniqueVehicles = distinctVehicles(linearResults);
 
     std::vector<QueryResult> rtreeQR, linearQR;
     for (auto& t : rtreeResults) rtreeQR.push_back({t.getId(), target->approximateDistance(t, 1e-5f), 0.0f, t.getPoints().size()});
-    for (auto& t : linearResults) linearQR.push_back({t.getId(), target->approximateDistance(t, 1e-5f), 0.0f, t.getPoints().size()});
+    for (size_t i : linearResults) {
+        const Trajectory& t = trajectoriesCopy[i];
+        linearQR.push_back({t.getId(), scan.approximateDistance(*target, i, 1e-5f), 0.0f, t.getPoints().size()});
+    }
 
     saveQueryResults(queryIndex, "kNN", rtreeQR, linearQR);
     saveQueryTrajectoriesForPlot(queryIndex, "kNN", target, rtreeResults);
@@ -200,29 +235,24 @@ QueryStats Evaluation::runSimilarityQuery(
     qs.rtreeTime = std::chrono::duration<double>(end - start).count();
     rtreeResults = filterUniqueTrajectories(rtreeResults, target);
     qs.rtreeCount = rtreeResults.size();
-    qs.rtreeUniqueVehicles = rtreeResults.size();
+    qs.rtreeUniqueVehicles = rtree.findSimilarVehicles(*target, threshold, true).count();
 
     start = std::chrono::high_resolution_clock::now();
-    size_t linearCount, linearUnique;
-    auto linearResults = linearScan(
-        [&](const Trajectory& t){ return target->approximateDistance(t, 1e-5f) <= threshold; },
-        target,
-        linearCount,
-        linearUnique
-    );
-    linearResults.erase(
-        std::remove_if(linearResults.begin(), linearResults.end(),
-                       [&](const Trajectory& t){ return target->similarityTo(t) > threshold; }),
-        linearResults.end()
-    );
+    auto candidates = scan.withinDistance(*target, threshold, 1e-5f, copyIndexOf(trajId), scanThreads);
+    std::vector<size_t> linearResults;
+    for (size_t i : candidates)
+        if (target->similarityTo(trajectoriesCopy[i]) <= threshold) linearResults.push_back(i);
     end = std::chrono::high_resolution_clock::now();
     qs.linearTime = std::chrono::duration<double>(end - start).count();
-    qs.linearCount = linearCount;
-    qs.linearUniqueVehicles = linearResults.size();
+    qs.linearCount = candidates.size();
+    qs.linearUniqueVehicles = distinctVehicles(linearResults);
 
     std::vector<QueryResult> rtreeQR, linearQR;
     for (auto& t : rtreeResults) rtreeQR.push_back({t.getId(), target->approximateDistance(t, 1e-5f), target->similarityTo(t), t.getPoints().size()});
-    for (auto& t : linearResults) linearQR.push_back({t.getId(), target->approximateDistance(t, 1e-5f), target->similarityTo(t), t.getPoints().size()});
+    for (size_t i : linearResults) {
+        const Trajectory& t = trajectoriesCopy[i];
+        linearQR.push_back({t.getId(), scan.approximateDistance(*target, i, 1e-5f), target->similarityTo(t), t.getPoints().size()});
+    }
 
     saveQueryResults(queryIndex, "findSimilar", rtreeQR, linearQR);
     saveQueryTrajectoriesForPlot(queryIndex, "findSimilar", target, rtreeResults);
@@ -275,18 +305,846 @@ void Evaluation::saveQueryTrajectoriesForPlot(int queryIndex,
 
 // ---------------- Save summary of all queries ----------------
 void Evaluation::saveSummary(const std::vector<QueryStats>& statsList) {
-    std::ofstream summaryOut(folder + "/query_summary.csv");
-    if (!summaryOut) return;
-    summaryOut << "QueryType,City,TrajectoryID,StartTime,EndTime,k,Threshold,"
-                  "RTreeCount,RTreeUnique,RTreeTime(s),LinearCount,LinearUnique,LinearTime(s)\n";
+    CsvWriter summaryOut(folder + "/query_summary.csv",
+                         "QueryType,City,TrajectoryID,StartTime,EndTime,k,Threshold,"
+                         "RTreeCount,RTreeUnique,RTreeTime(s),LinearCount,LinearUnique,LinearTime(s)");
+    for (auto& s : statsList)
+        summaryOut.row(s.type, s.city, s.trajId, s.startTime, s.endTime, s.k, s.threshold, s.rtreeCount,
+                       s.rtreeUniqueVehicles, s.rtreeTime, s.linearCount, s.linearUniqueVehicles, s.linearTime);
+}
 
-    for (auto& s : statsList) {
-        summaryOut << std::fixed << std::setprecision(6)
-                   << s.type << "," << s.city << "," << s.trajId << "," << s.startTime << ","
-                   << s.endTime << "," << s.k << "," << s.threshold << ","
-                   << s.rtreeCount << "," << s.rtreeUniqueVehicles << "," << s.rtreeTime << ","
-                   << s.linearCount << "," << s.linearUniqueVehicles << "," << s.linearTime << "\n";
+// ---------------- Load workload file ----------------
+std::vector<WorkloadQuery> Evaluation::loadWorkload(const std::string& filepath) {
+    std::ifstream in(filepath);
+    if (!in) throw std::runtime_error("Failed to open workload file: " + filepath);
+
+    std::vector<WorkloadQuery> workload;
+
+    if (std::filesystem::path(filepath).extension() == ".json") {
+        json j = json::parse(in);
+        for (const auto& q : j) {
+            WorkloadQuery wq;
+            wq.type      = q.value("type", "");
+            wq.city      = q.value("city", "");
+            wq.startTime = q.value("startTime", "");
+            wq.endTime   = q.value("endTime", "");
+            wq.trajId    = q.value("trajId", "");
+            wq.k         = q.value("k", static_cast<size_t>(0));
+            wq.threshold = q.value("threshold", 0.0f);
+            workload.push_back(wq);
+        }
+        return workload;
+    }
+
+    // CSV: type,city,startTime,endTime,trajId,k,threshold (header line required)
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) fields.push_back(field);
+        fields.resize(7);
+
+        WorkloadQuery wq;
+        wq.type      = fields[0];
+        wq.city      = fields[1];
+        wq.startTime = fields[2];
+        wq.endTime   = fields[3];
+        wq.trajId    = fields[4];
+        wq.k         = fields[5].empty() ? 0 : std::stoul(fields[5]);
+        wq.threshold = fields[6].empty() ? 0.0f : std::stof(fields[6]);
+        workload.push_back(wq);
+    }
+    return workload;
+}
+
+// ---------------- Replay workload ----------------
+std::vector<WorkloadStats> Evaluation::runWorkload(const std::vector<WorkloadQuery>& workload,
+                                                   size_t numThreads,
+                                                   bool savePerQuery)
+{
+    struct Prepared {
+        const WorkloadQuery* query;
+        BoundingBox3D box;               // rangeQuery only
+        const Trajectory* target;        // kNN / findSimilar only
+    };
+    struct Timing {
+        double latency = 0.0;
+        size_t results = 0;
+    };
+
+    // Resolve boxes and target trajectories up front so workers only run queries
+    std::unordered_map<std::string, const Trajectory*> byId;
+    for (const auto& t : trajectories) byId.emplace(t.getId(), &t);
+
+    std::vector<Prepared> prepared;
+    prepared.reserve(workload.size());
+    for (const auto& q : workload) {
+        Prepared p{&q, BoundingBox3D(), nullptr};
+        if (q.type == "rangeQuery") {
+            p.box = cityQueryBox(q.city, q.startTime, q.endTime);
+        } else if (q.type == "kNearestNeighbors" || q.type == "findSimilar") {
+            auto it = byId.find(q.trajId);
+            if (it == byId.end()) {
+                std::cerr << "[Warning] Workload trajectory not found: " << q.trajId << "\n";
+                continue;
+            }
+            p.target = it->second;
+            p.target->getBoundingBox();  // fill the lazy cache before sharing across threads
+        } else {
+            std::cerr << "[Warning] Unknown workload query type: " << q.type << "\n";
+            continue;
+        }
+        prepared.push_back(p);
+    }
+
+    std::vector<Timing> timings(prepared.size());
+    std::atomic<size_t> next{0};
+    numThreads = std::max<size_t>(1, numThreads);
+
+    auto worker = [&]() {
+        for (size_t i = next++; i < prepared.size(); i = next++) {
+            const Prepared& p = prepared[i];
+            auto start = std::chrono::steady_clock::now();
+            size_t resultCount = 0;
+            if (p.query->type == "rangeQuery")
+                resultCount = rtree.rangeQuery(p.box).size();
+            else if (p.query->type == "kNearestNeighbors")
+                resultCount = rtree.kNearestNeighbors(*p.target, p.query->k, 1e-5f).size();
+            else
+                resultCount = rtree.findSimilar(*p.target, p.query->threshold).size();
+            auto end = std::chrono::steady_clock::now();
+            timings[i] = {std::chrono::duration<double>(end - start).count(), resultCount};
+        }
+    };
+
+    auto wallStart = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < numThreads; ++t) workers.emplace_back(worker);
+    for (auto& w : workers) w.join();
+    double wallTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+
+    // Group latencies by query type ("all" aggregates every query)
+    std::map<std::string, std::vector<double>> latencies;
+    std::map<std::string, size_t> resultTotals;
+    for (size_t i = 0; i < prepared.size(); ++i) {
+        for (const std::string& key : {prepared[i].query->type, std::string("all")}) {
+            latencies[key].push_back(timings[i].latency);
+            resultTotals[key] += timings[i].results;
+        }
+    }
+
+    // Nearest-rank percentile on a sorted sample
+    auto percentile = [](const std::vector<double>& sorted, double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+        return sorted[std::min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+    };
+
+    std::vector<WorkloadStats> statsList;
+    for (auto& [type, values] : latencies) {
+        std::sort(values.begin(), values.end());
+        WorkloadStats ws;
+        ws.type = type;
+        ws.count = values.size();
+        ws.totalResults = resultTotals[type];
+        ws.throughput = wallTime > 0.0 ? values.size() / wallTime : 0.0;
+        ws.meanLatency = std::accumulate(values.begin(), values.end(), 0.0) / values.size();
+        ws.p50Latency = percentile(values, 0.50);
+        ws.p95Latency = percentile(values, 0.95);
+        ws.p99Latency = percentile(values, 0.99);
+        ws.maxLatency = values.back();
+        statsList.push_back(ws);
+    }
+
+    CsvWriter summaryOut(folder + "/workload_summary.csv",
+                         "QueryType,Count,Threads,WallTime(s),Throughput(q/s),TotalResults,"
+                         "MeanLatency(s),P50(s),P95(s),P99(s),Max(s)");
+    for (auto& ws : statsList)
+        summaryOut.row(ws.type, ws.count, numThreads, wallTime, ws.throughput, ws.totalResults, ws.meanLatency,
+                       ws.p50Latency, ws.p95Latency, ws.p99Latency, ws.maxLatency);
+
+    if (savePerQuery) {
+        CsvWriter queryOut(folder + "/workload_queries.csv",
+                           "Index,QueryType,City,TrajectoryID,StartTime,EndTime,k,Threshold,Results,Latency(s)");
+        for (size_t i = 0; i < prepared.size(); ++i) {
+            const WorkloadQuery& q = *prepared[i].query;
+            queryOut.row(i, q.type, q.city, q.trajId, q.startTime, q.endTime, q.k, q.threshold,
+                         timings[i].results, timings[i].latency);
+        }
+    }
+
+    return statsList;
+}
+
+// ---------------- Approximate kNN recall / latency ----------------
+std::vector<ApproximateKNNStats> Evaluation::runApproximateKNNCurve(const std::vector<std::string>& trajIds, size_t k,
+                                                                    const std::vector<ApproximateKNNOptions>& settings) {
+    using Clock = std::chrono::high_resolution_clock;
+
+    // Exact answers first
+    std::vector<const Trajectory*> targets;
+    std::vector<std::unordered_set<std::string>> exactIds;
+    double exactTotal = 0.0;
+    for (const auto& id : trajIds) {
+        const Trajectory* target = findTrajectoryById(id);
+        if (!target) continue;
+        auto start = Clock::now();
+        auto exact = rtree.approximateKNearestNeighbors(*target, k, ApproximateKNNOptions{});
+        exactTotal += std::chrono::duration<double>(Clock::now() - start).count();
+
+        std::unordered_set<std::string> ids;
+        for (const auto& t : exact.trajectories) ids.insert(t->getId());
+        targets.push_back(target);
+        exactIds.push_back(std::move(ids));
+    }
+
+    std::vector<ApproximateKNNStats> curve;
+    for (const auto& options : settings) {
+        ApproximateKNNStats s;
+        s.options = options;
+        s.queries = targets.size();
+        s.exactMeanLatency = targets.empty() ? 0.0 : exactTotal / targets.size();
+
+        std::vector<double> latencies;
+        size_t boundedQueries = 0;
+        for (size_t q = 0; q < targets.size(); ++q) {
+            auto start = Clock::now();
+            auto approx = rtree.approximateKNearestNeighbors(*targets[q], k, options);
+            double latency = std::chrono::duration<double>(Clock::now() - start).count();
+            latencies.push_back(latency);
+
+            size_t found = 0;
+            for (const auto& t : approx.trajectories) found += exactIds[q].count(t->getId());
+            s.meanRecall += exactIds[q].empty() ? 1.0 : static_cast<double>(found) / exactIds[q].size();
+            s.meanLatency += latency;
+            s.meanRefinements += approx.refinements;
+            s.meanNodesVisited += approx.nodesVisited;
+            if (std::isfinite(approx.achievedEpsilon)) {
+                s.meanAchievedEpsilon += approx.achievedEpsilon;
+                ++boundedQueries;
+            }
+        }
+
+        if (!latencies.empty()) {
+            double n = static_cast<double>(latencies.size());
+            s.meanRecall /= n;
+            s.meanLatency /= n;
+            s.meanRefinements /= n;
+            s.meanNodesVisited /= n;
+            std::sort(latencies.begin(), latencies.end());
+            size_t rank = static_cast<size_t>(std::ceil(0.95 * latencies.size()));
+            s.p95Latency = latencies[std::max<size_t>(rank, 1) - 1];
+        }
+        s.meanAchievedEpsilon = boundedQueries ? s.meanAchievedEpsilon / boundedQueries
+                                               : std::numeric_limits<double>::infinity();
+        curve.push_back(s);
+    }
+
+    CsvWriter out(folder + "/approx_knn_curve.csv",
+                  "k,Epsilon,MaxRefinements,MaxNodes,TimeBudget(s),Queries,MeanRecall,MeanLatency(s),"
+                  "P95Latency(s),ExactMeanLatency(s),MeanAchievedEpsilon,MeanRefinements,MeanNodesVisited");
+    for (const auto& s : curve)
+        out.row(k, s.options.epsilon, s.options.maxRefinements, s.options.maxNodes, s.options.timeBudget, s.queries,
+                s.meanRecall, s.meanLatency, s.p95Latency, s.exactMeanLatency, s.meanAchievedEpsilon,
+                s.meanRefinements, s.meanNodesVisited);
+    return curve;
+}
+
+// ---------------- Similarity join ----------------
+SimilarityJoinReport Evaluation::runSimilarityJoin(float threshold, size_t numThreads, bool savePairs) {
+    using Clock = std::chrono::high_resolution_clock;
+    SimilarityJoinReport report;
+    report.threshold = threshold;
+    report.threads = numThreads;
+
+    std::optional<CsvWriter> pairsOut;
+    if (savePairs) pairsOut.emplace(folder + "/similarity_join_pairs.csv", "TrajectoryA,TrajectoryB,Similarity");
+
+    auto start = Clock::now();
+    report.join = rtree.similarityJoin(threshold, [&](const Trajectory& a, const Trajectory& b, float similarity) {
+        if (pairsOut) pairsOut->row(a.getId(), b.getId(), similarity);
+    }, numThreads);
+    report.joinTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Reference 1: bulk loading the same data
+    std::vector<Trajectory> copy = trajectoriesCopy;
+    RTree reference;
+    start = Clock::now();
+    reference.bulkLoad(copy);
+    report.bulkLoadTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Reference 2: one findSimilar per trajectory, timed on a sample
+    size_t sample = std::min<size_t>(50, trajectoriesCopy.size());
+    if (sample > 0) {
+        size_t stride = trajectoriesCopy.size() / sample;
+        start = Clock::now();
+        for (size_t i = 0; i < sample; ++i) rtree.findSimilar(trajectoriesCopy[i * stride], threshold);
+        double sampleTime = std::chrono::duration<double>(Clock::now() - start).count();
+        report.perQueryEstimate = sampleTime / sample * trajectoriesCopy.size();
+    }
+
+    CsvWriter out(folder + "/similarity_join_summary.csv",
+                  "Threshold,Threads,Pairs,NodePairs,Refinements,Tasks,JoinTime(s),BulkLoadTime(s),"
+                  "JoinToBulkLoad,PerQueryEstimate(s)");
+    out.row(threshold, numThreads, report.join.pairs, report.join.nodePairs, report.join.refinements,
+            report.join.tasks, report.joinTime, report.bulkLoadTime,
+            report.bulkLoadTime > 0.0 ? report.joinTime / report.bulkLoadTime : 0.0, report.perQueryEstimate);
+    return report;
+}
+
+// ---------------- Aggregate queries ----------------
+std::vector<AggregateQueryStats> Evaluation::runAggregateQueries(const std::vector<WorkloadQuery>& windows) {
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<AggregateQueryStats> statsList;
+
+    for (const auto& w : windows) {
+        if (w.type != "rangeQuery") continue;
+        AggregateQueryStats s;
+        s.city = w.city;
+        s.startTime = w.startTime;
+        s.endTime = w.endTime;
+        BoundingBox3D queryBox = cityQueryBox(w.city, w.startTime, w.endTime);
+
+        auto start = Clock::now();
+        s.aggregate = rtree.aggregateQuery(queryBox);
+        s.aggregateTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+        // Same numbers the slow way
+        start = Clock::now();
+        auto results = rtree.rangeQuery(queryBox);
+        double totalLength = 0.0;
+        std::unordered_set<std::string> vehicles;
+        for (const auto& traj : results) {
+            totalLength += traj.length();
+            vehicles.insert(vehicleIdOf(traj.getId()));
+        }
+        s.rangeTime = std::chrono::duration<double>(Clock::now() - start).count();
+        s.rangeCount = results.size();
+        s.exactVehicles = vehicles.size();
+
+        if (s.rangeCount != s.aggregate.count ||
+            std::fabs(totalLength - s.aggregate.totalLength) > 1e-6 * std::max(1.0, totalLength))
+            std::cerr << "[AggregateQuery] Mismatch for " << w.city << " [" << w.startTime << " - " << w.endTime << "]\n";
+        statsList.push_back(s);
+    }
+
+    CsvWriter out(folder + "/aggregate_query_summary.csv",
+                  "City,StartTime,EndTime,Count,Points,TotalLength,TotalDuration(s),VehiclesEstimate,VehiclesExact,"
+                  "NodesVisited,BoundaryTrajectories,AggregateTime(s),RangeQueryTime(s)");
+    for (const auto& s : statsList)
+        out.row(s.city, s.startTime, s.endTime, s.aggregate.count, s.aggregate.points, s.aggregate.totalLength,
+                s.aggregate.totalDuration, s.aggregate.distinctVehicles, s.exactVehicles, s.aggregate.nodesVisited,
+                s.aggregate.trajectoriesRead, s.aggregateTime, s.rangeTime);
+    return statsList;
+}
+
+// ---------------- Density grid ----------------
+DensityGridStats Evaluation::runDensityGrid(const std::string& city, const std::string& startTime,
+                                            const std::string& endTime, size_t cells, int64_t bucketSeconds,
+                                            size_t numThreads, bool saveGrid) {
+    using Clock = std::chrono::high_resolution_clock;
+    DensityGridStats s;
+    s.city = city;
+    s.startTime = startTime;
+    s.endTime = endTime;
+    s.cellsX = s.cellsY = cells;
+    s.threads = numThreads;
+    BoundingBox3D box = cityQueryBox(city, startTime, endTime);
+
+    auto start = Clock::now();
+    DensityGrid grid = rtree.densityGrid(box, cells, cells, bucketSeconds, numThreads);
+    s.gridTime = std::chrono::duration<double>(Clock::now() - start).count();
+    s.buckets = grid.buckets;
+    s.points = grid.total();
+    s.aggregatedNodes = grid.aggregatedNodes;
+    s.binnedTrajectories = grid.binnedTrajectories;
+
+    // Baseline: what the dashboard did before, rangeQuery then bin every point
+    start = Clock::now();
+    std::vector<uint32_t> counts(grid.counts.size(), 0);
+    float perX = cells / (box.getMaxX() - box.getMinX()), perY = cells / (box.getMaxY() - box.getMinY());
+    for (const auto& traj : rtree.rangeQuery(box)) {
+        for (const auto& p : traj.getPoints()) {
+            if (!box.contains(p, 0.0f)) continue;
+            size_t cx = std::min<size_t>(static_cast<size_t>(std::max(0.0f, (p.getX() - box.getMinX()) * perX)), cells - 1);
+            size_t cy = std::min<size_t>(static_cast<size_t>(std::max(0.0f, (p.getY() - box.getMinY()) * perY)), cells - 1);
+            size_t b = bucketSeconds > 0 ? static_cast<size_t>((p.getT() - box.getMinT()) / bucketSeconds) : 0;
+            ++counts[(b * cells + cy) * cells + cx];
+        }
+    }
+    s.baselineTime = std::chrono::duration<double>(Clock::now() - start).count();
+    s.matchesBaseline = counts == grid.counts;
+    if (!s.matchesBaseline) std::cerr << "[DensityGrid] Counts differ from the rangeQuery baseline for " << city << "\n";
+
+    CsvWriter out(folder + "/density_grid_summary.csv",
+                  "City,StartTime,EndTime,Cells,Buckets,Threads,Points,AggregatedNodes,BinnedTrajectories,"
+                  "GridTime(s),BaselineTime(s),Matches");
+    out.row(city, startTime, endTime, cells, s.buckets, numThreads, s.points, s.aggregatedNodes,
+            s.binnedTrajectories, s.gridTime, s.baselineTime, s.matchesBaseline ? 1 : 0);
+
+    if (saveGrid) {
+        CsvWriter cellsOut(folder + "/density_grid_" + city + ".csv", "Bucket,X,Y,Count");
+        for (size_t b = 0; b < grid.buckets; ++b)
+            for (size_t y = 0; y < cells; ++y)
+                for (size_t x = 0; x < cells; ++x)
+                    if (grid.at(x, y, b)) cellsOut.row(b, x, y, grid.at(x, y, b));
+    }
+    return s;
+}
+
+// ---------------- Batch range queries ----------------
+BatchRangeQueryStats Evaluation::runBatchRangeQuery(const std::string& city, const std::string& startTime,
+                                                    const std::string& endTime, size_t tilesPerSide, size_t numThreads) {
+    using Clock = std::chrono::high_resolution_clock;
+    BatchRangeQueryStats s;
+    s.city = city;
+    s.startTime = startTime;
+    s.endTime = endTime;
+    s.threads = numThreads;
+    std::vector<BoundingBox3D> tiles = makeTiles(cityQueryBox(city, startTime, endTime), tilesPerSide);
+    s.tiles = tiles.size();
+
+    auto start = Clock::now();
+    auto batch = rtree.batchRangeQuery(tiles, numThreads);
+    s.batchTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    std::vector<size_t> loopSizes;
+    for (const auto& tile : tiles) loopSizes.push_back(rtree.rangeQuery(tile).size());
+    s.loopTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    s.matchesLoop = true;
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        s.results += batch[i].size();
+        s.matchesLoop = s.matchesLoop && batch[i].size() == loopSizes[i];
+    }
+    if (!s.matchesLoop) std::cerr << "[BatchRangeQuery] Result sizes differ from the rangeQuery loop for " << city << "\n";
+
+    CsvWriter out(folder + "/batch_range_query_summary.csv",
+                  "City,StartTime,EndTime,Tiles,Threads,Results,BatchTime(s),LoopTime(s),Speedup,Matches");
+    out.row(city, startTime, endTime, s.tiles, numThreads, s.results, s.batchTime, s.loopTime,
+            s.batchTime > 0.0 ? s.loopTime / s.batchTime : 0.0, s.matchesLoop ? 1 : 0);
+    return s;
+}
+
+// ---------------- Query planner ----------------
+std::vector<QueryPlanStats> Evaluation::runQueryPlanner(const std::vector<WorkloadQuery>& windows) {
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<QueryPlanStats> statsList;
+    std::vector<BoundingBox3D> boxes;
+    for (const auto& w : windows)
+        if (w.type == "rangeQuery") boxes.push_back(cityQueryBox(w.city, w.startTime, w.endTime));
+
+    QueryPlanner planner(rtree, trajectoriesCopy);
+    planner.calibrate(boxes);
+
+    size_t b = 0;
+    for (const auto& w : windows) {
+        if (w.type != "rangeQuery") continue;
+        const BoundingBox3D& box = boxes[b++];
+        QueryPlanStats s;
+        s.city = w.city;
+        s.startTime = w.startTime;
+        s.endTime = w.endTime;
+        s.plan = planner.plan(box);
+        s.actualRows = planner.execute(box).size();
+        for (size_t k = 0; k < QueryPlanner::kStrategies; ++k) {
+            auto start = Clock::now();
+            size_t rows = planner.executeWith(static_cast<QueryPlanner::Strategy>(k), box).size();
+            s.seconds[k] = std::chrono::duration<double>(Clock::now() - start).count();
+            if (rows != s.actualRows)
+                std::cerr << "[QueryPlanner] " << QueryPlanner::strategyName(static_cast<QueryPlanner::Strategy>(k))
+                          << " returned " << rows << " rows instead of " << s.actualRows << "\n";
+        }
+        size_t fastest = std::min_element(s.seconds, s.seconds + QueryPlanner::kStrategies) - s.seconds;
+        s.choseFastest = static_cast<size_t>(s.plan.strategy) == fastest;
+        statsList.push_back(s);
+    }
+
+    CsvWriter out(folder + "/query_planner_summary.csv",
+                  "City,StartTime,EndTime,Chosen,EstimatedRows,ActualRows,EstimatedLeaves,EstimatedTimeCandidates,"
+                  "IndexTime(s),ScanTime(s),TimeIndexTime(s),ChoseFastest");
+    for (const auto& s : statsList)
+        out.row(s.city, s.startTime, s.endTime, QueryPlanner::strategyName(s.plan.strategy), s.plan.estimatedRows,
+                s.actualRows, s.plan.estimatedLeaves, s.plan.timeCandidates, s.seconds[0], s.seconds[1], s.seconds[2],
+                s.choseFastest ? 1 : 0);
+    planner.saveCalibrationLog(folder + "/query_plan_log.csv");
+    return statsList;
+}
+
+// ---------------- Concurrent ingest ----------------
+ConcurrentIngestStats Evaluation::runConcurrentIngest(size_t readers, double updatesPerSecond, double seconds) {
+    using Clock = std::chrono::steady_clock;
+    ConcurrentIngestStats s;
+    s.readers = readers = std::max<size_t>(readers, 1);
+    s.updatesPerSecond = updatesPerSecond;
+    s.seconds = seconds;
+    if (trajectoriesCopy.empty()) return s;
+
+    ConcurrentRTree tree;
+    tree.bulkLoad(trajectoriesCopy);
+    std::vector<BoundingBox3D> boxes;
+    for (const std::string city : {"Philadelphia", "Atlanta", "Memphis"})
+        boxes.push_back(cityQueryBox(city, "2017-01-01T00:00:00Z", "2018-01-01T00:00:00Z"));
+
+    // Readers run until stop is set, counting completed queries
+    auto runReaders = [&](std::atomic<bool>& stop, std::atomic<size_t>& completed) {
+        std::vector<std::thread> pool;
+        for (size_t r = 0; r < readers; ++r) {
+            pool.emplace_back([&, r]() {
+                for (size_t q = r; !stop.load(std::memory_order_relaxed); ++q) {
+                    tree.rangeQuery(boxes[q % boxes.size()]);
+                    completed.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+        return pool;
+    };
+
+    // Phase 1: readers alone
+    {
+        std::atomic<bool> stop{false};
+        std::atomic<size_t> completed{0};
+        auto pool = runReaders(stop, completed);
+        std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+        stop = true;
+        for (auto& t : pool) t.join();
+        s.idleQueries = completed.load();
+    }
+
+    // Phase 2: readers plus a paced writer extending trajectories round-robin
+    {
+        std::vector<Trajectory> live = trajectoriesCopy;
+        std::atomic<bool> stop{false};
+        std::atomic<size_t> completed{0};
+        auto pool = runReaders(stop, completed);
+
+        auto start = Clock::now();
+        double updateTime = 0.0;
+        for (size_t i = 0;; ++i) {
+            auto due = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(i / updatesPerSecond));
+            if (std::chrono::duration<double>(due - start).count() >= seconds) break;
+            std::this_thread::sleep_until(due);
+
+            Trajectory& traj = live[i % live.size()];
+            if (traj.isEmpty()) continue;
+            const Point3D& last = traj.getPoints().back();
+            traj.addPoint(Point3D(last.getX() + 1e-5f, last.getY(), last.getT() + 1));
+            auto updateStart = Clock::now();
+            tree.update(traj);
+            updateTime += std::chrono::duration<double>(Clock::now() - updateStart).count();
+            ++s.updates;
+        }
+        stop = true;
+        for (auto& t : pool) t.join();
+        s.ingestQueries = completed.load();
+        s.meanUpdateLatency = s.updates ? updateTime / s.updates : 0.0;
+    }
+
+    s.idleQps = seconds > 0.0 ? s.idleQueries / seconds : 0.0;
+    s.ingestQps = seconds > 0.0 ? s.ingestQueries / seconds : 0.0;
+
+    CsvWriter out(folder + "/concurrent_ingest_summary.csv",
+                  "Readers,UpdatesPerSecond,Seconds,IdleQueries,IngestQueries,Updates,IdleQPS,IngestQPS,MeanUpdateLatency(s)");
+    out.row(readers, updatesPerSecond, seconds, s.idleQueries, s.ingestQueries, s.updates, s.idleQps, s.ingestQps,
+            s.meanUpdateLatency);
+    return s;
+}
+
+// ---------------- Paged R-Tree ----------------
+std::vector<PagedRTreeStats> Evaluation::runPagedRTree(const std::string& city, const std::string& startTime,
+                                                       const std::string& endTime, size_t tilesPerSide,
+                                                       const std::vector<size_t>& poolSizes) {
+    using Clock = std::chrono::high_resolution_clock;
+    const std::string base = folder + "/paged_rtree";
+    PagedRTree::create(base, trajectoriesCopy);
+
+    std::vector<BoundingBox3D> tiles = makeTiles(cityQueryBox(city, startTime, endTime), tilesPerSide);
+    std::vector<size_t> expected;
+    for (const auto& tile : tiles) expected.push_back(rtree.rangeQuery(tile).size());
+
+    std::vector<PagedRTreeStats> statsList;
+    for (EvictionPolicy policy : {EvictionPolicy::LRU, EvictionPolicy::Clock}) {
+        for (size_t poolPages : poolSizes) {
+            PagedRTree paged(base, {poolPages, poolPages, policy});
+            PagedRTreeStats s;
+            s.policy = policy;
+            s.poolPages = poolPages;
+            s.matchesRTree = true;
+
+            // Two passes, so larger pools show their reuse
+            auto start = Clock::now();
+            for (int pass = 0; pass < 2; ++pass) {
+                for (size_t i = 0; i < tiles.size(); ++i) {
+                    size_t rows = paged.rangeQuery(tiles[i]).size();
+                    s.results += rows;
+                    s.matchesRTree = s.matchesRTree && rows == expected[i];
+                    ++s.queries;
+                }
+            }
+            s.meanLatency = std::chrono::duration<double>(Clock::now() - start).count() / s.queries;
+
+            PageIOStats index = paged.indexStats(), heap = paged.heapStats();
+            s.faultsPerQuery = static_cast<double>(index.faults + heap.faults) / s.queries;
+            s.bytesPerQuery = static_cast<double>(index.bytesRead + heap.bytesRead) / s.queries;
+            s.indexHitRate = index.hitRate();
+            s.heapHitRate = heap.hitRate();
+            if (!s.matchesRTree) std::cerr << "[PagedRTree] Result sizes differ from the RTree for " << city << "\n";
+            statsList.push_back(s);
+        }
+    }
+
+    CsvWriter out(folder + "/paged_rtree_summary.csv",
+                  "City,StartTime,EndTime,Policy,PoolPages,Queries,Results,FaultsPerQuery,BytesPerQuery,"
+                  "IndexHitRate,HeapHitRate,MeanLatency(s),Matches");
+    for (const auto& s : statsList)
+        out.row(city, startTime, endTime, s.policy == EvictionPolicy::LRU ? "LRU" : "Clock", s.poolPages, s.queries,
+                s.results, s.faultsPerQuery, s.bytesPerQuery, s.indexHitRate, s.heapHitRate, s.meanLatency,
+                s.matchesRTree ? 1 : 0);
+    std::filesystem::remove(base + ".idx");
+    std::filesystem::remove(base + ".heap");
+    return statsList;
+}
+
+// ---------------- Sharded R-Tree ----------------
+std::vector<ShardedRTreeStats> Evaluation::runShardedRTree(const std::string& city, const std::string& startTime,
+                                                           const std::string& endTime,
+                                                           const std::vector<std::string>& knnIds, size_t k,
+                                                           const std::vector<size_t>& shardCounts, size_t numThreads) {
+    using Clock = std::chrono::high_resolution_clock;
+    const int repeats = 5;
+    BoundingBox3D box = cityQueryBox(city, startTime, endTime);
+    std::vector<const Trajectory*> queries;
+    for (const auto& id : knnIds)
+        if (const Trajectory* q = findTrajectoryById(id)) queries.push_back(q);
+
+    // Single-tree reference
+    auto start = Clock::now();
+    size_t expectedRows = 0;
+    for (int r = 0; r < repeats; ++r) expectedRows = rtree.rangeQuery(box).size();
+    double singleRange = std::chrono::duration<double>(Clock::now() - start).count() / repeats;
+    std::vector<std::vector<float>> expectedDistances;
+    start = Clock::now();
+    for (const Trajectory* q : queries) expectedDistances.push_back(rtree.approximateKNearestNeighbors(*q, k).distances);
+    double singleKnn = queries.empty() ? 0.0 : std::chrono::duration<double>(Clock::now() - start).count() / queries.size();
+
+    std::vector<ShardedRTreeStats> statsList;
+    for (ShardingScheme scheme : {ShardingScheme::SpatialTiles, ShardingScheme::VehicleHash}) {
+        for (size_t shardCount : shardCounts) {
+            ShardedRTreeStats s;
+            s.scheme = scheme;
+            s.shards = shardCount;
+            s.singleRangeLatency = singleRange;
+            s.singleKnnLatency = singleKnn;
+
+            std::vector<Trajectory> copy = trajectoriesCopy;
+            ShardedRTree sharded(shardCount, scheme, numThreads);
+            s.threads = sharded.threadCount();
+            start = Clock::now();
+            sharded.bulkLoad(copy);
+            s.buildTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+            start = Clock::now();
+            for (int r = 0; r < repeats; ++r) s.rangeResults = sharded.rangeQuery(box).size();
+            s.rangeLatency = std::chrono::duration<double>(Clock::now() - start).count() / repeats;
+            s.matchesRTree = s.rangeResults == expectedRows;
+
+            start = Clock::now();
+            size_t searched = 0;
+            for (size_t i = 0; i < queries.size(); ++i) {
+                auto result = sharded.kNearestNeighbors(*queries[i], k);
+                searched += result.shardsSearched;
+                s.matchesRTree = s.matchesRTree && result.distances == expectedDistances[i];
+            }
+            if (!queries.empty()) {
+                s.knnLatency = std::chrono::duration<double>(Clock::now() - start).count() / queries.size();
+                s.shardsSearchedPerKnn = static_cast<double>(searched) / queries.size();
+            }
+            if (!s.matchesRTree) std::cerr << "[ShardedRTree] Results differ from the RTree with " << shardCount << " shards\n";
+            statsList.push_back(s);
+        }
+    }
+
+    CsvWriter out(folder + "/sharded_rtree_summary.csv",
+                  "City,StartTime,EndTime,Scheme,Shards,Threads,BuildTime(s),RangeResults,RangeLatency(s),"
+                  "SingleRangeLatency(s),KnnLatency(s),SingleKnnLatency(s),ShardsSearchedPerKnn,Matches");
+    for (const auto& s : statsList)
+        out.row(city, startTime, endTime, s.scheme == ShardingScheme::SpatialTiles ? "SpatialTiles" : "VehicleHash",
+                s.shards, s.threads, s.buildTime, s.rangeResults, s.rangeLatency, s.singleRangeLatency, s.knnLatency,
+                s.singleKnnLatency, s.shardsSearchedPerKnn, s.matchesRTree ? 1 : 0);
+    return statsList;
+}
+
+// ---------------- Query deadlines ----------------
+std::vector<QueryDeadlineStats> Evaluation::runQueryDeadlines(const std::string& city, const std::string& startTime,
+                                                              const std::string& endTime, size_t rangeRepeats,
+                                                              const std::vector<std::string>& similarIds, float threshold,
+                                                              const std::vector<double>& deadlines) {
+    using Clock = std::chrono::steady_clock;
+    BoundingBox3D box = cityQueryBox(city, startTime, endTime);
+    std::vector<const Trajectory*> queries;
+    for (const auto& id : similarIds)
+        if (const Trajectory* q = findTrajectoryById(id)) queries.push_back(q);
+
+    // Result counts without a deadline
+    size_t fullResults = rangeRepeats * rtree.rangeQuery(box).size();
+    for (const Trajectory* q : queries) fullResults += rtree.findSimilar(*q, threshold).size();
+
+    std::vector<QueryDeadlineStats> statsList;
+    for (double deadline : deadlines) {
+        QueryDeadlineStats s;
+        s.deadline = deadline;
+        auto start = Clock::now();
+        QueryControl control = deadline > 0.0 ? QueryControl::withTimeout(deadline) : QueryControl{};
+        std::vector<std::future<PartialResult<std::vector<Trajectory>>>> pending;
+        for (size_t r = 0; r < rangeRepeats; ++r) pending.push_back(rtree.rangeQueryAsync(box, control));
+        for (const Trajectory* q : queries) pending.push_back(rtree.findSimilarAsync(*q, threshold, control));
+
+        // Futures are waited in submission order, so a latency is when the result was seen ready
+        std::vector<double> latencies;
+        size_t returned = 0;
+        for (auto& f : pending) {
+            auto result = f.get();
+            latencies.push_back(std::chrono::duration<double>(Clock::now() - start).count());
+            returned += result.results.size();
+            if (result.complete) ++s.completed;
+        }
+        s.queries = pending.size();
+        s.resultFraction = fullResults ? static_cast<double>(returned) / fullResults : 1.0;
+        if (!latencies.empty()) {
+            std::sort(latencies.begin(), latencies.end());
+            s.p99Latency = latencies[std::min(latencies.size() - 1, latencies.size() * 99 / 100)];
+            s.maxLatency = latencies.back();
+        }
+        statsList.push_back(s);
+    }
+
+    CsvWriter out(folder + "/query_deadline_summary.csv",
+                  "City,StartTime,EndTime,Deadline(s),Queries,Completed,ResultFraction,P99Latency(s),MaxLatency(s)");
+    for (const auto& s : statsList)
+        out.row(city, startTime, endTime, s.deadline, s.queries, s.completed, s.resultFraction, s.p99Latency,
+                s.maxLatency);
+    return statsList;
+}
+
+// ---------------- Lazy Parquet store ----------------
+std::vector<LazyStoreEvalStats> Evaluation::runLazyParquetStore(const std::string& parquetPath, const std::string& city,
+                                                                const std::string& startTime, const std::string& endTime,
+                                                                size_t tilesPerSide,
+                                                                const std::vector<size_t>& cacheBudgets) {
+    using Clock = std::chrono::high_resolution_clock;
+    std::vector<BoundingBox3D> tiles = makeTiles(cityQueryBox(city, startTime, endTime), tilesPerSide);
+    std::vector<size_t> expected;
+    for (const auto& tile : tiles) expected.push_back(rtree.rangeQuery(tile).size());
+
+    std::vector<LazyStoreEvalStats> statsList;
+    for (size_t budget : cacheBudgets) {
+        LazyParquetOptions options;
+        options.cachePoints = budget;
+        LazyParquetStore store(parquetPath, options);
+        LazyStoreEvalStats s;
+        s.cachePoints = budget;
+        s.openTime = store.openTime();
+        s.matchesRTree = true;
+
+        // Two passes, so larger caches show their reuse
+        auto start = Clock::now();
+        for (int pass = 0; pass < 2; ++pass) {
+            for (size_t i = 0; i < tiles.size(); ++i) {
+                size_t rows = store.rangeQuery(tiles[i]).size();
+                s.results += rows;
+                s.matchesRTree = s.matchesRTree && rows == expected[i];
+                ++s.queries;
+            }
+        }
+        s.meanLatency = std::chrono::duration<double>(Clock::now() - start).count() / s.queries;
+
+        LazyStoreStats io = store.stats();
+        s.rowGroupsPerQuery = static_cast<double>(io.rowGroupsRead) / s.queries;
+        s.hitRate = io.hitRate();
+        s.memoryBytes = store.memoryUsage();
+        if (!s.matchesRTree) std::cerr << "[LazyParquetStore] Result sizes differ from the RTree for " << city << "\n";
+        statsList.push_back(s);
+    }
+
+    CsvWriter out(folder + "/lazy_store_summary.csv",
+                  "City,StartTime,EndTime,CachePoints,OpenTime(s),MemoryBytes,Queries,Results,RowGroupsPerQuery,"
+                  "HitRate,MeanLatency(s),Matches");
+    for (const auto& s : statsList)
+        out.row(city, startTime, endTime, s.cachePoints, s.openTime, s.memoryBytes, s.queries, s.results,
+                s.rowGroupsPerQuery, s.hitRate, s.meanLatency, s.matchesRTree ? 1 : 0);
+    return statsList;
+}
+
+// ---------------- Compression benchmark ----------------
+CompressionStats Evaluation::runCompressionBenchmark() {
+    CompressionStats cs;
+    cs.trajectories = trajectoriesCopy.size();
+
+    auto encodeStart = std::chrono::high_resolution_clock::now();
+    std::vector<CompressedTrajectory> encoded;
+    encoded.reserve(trajectoriesCopy.size());
+    for (const auto& traj : trajectoriesCopy) encoded.emplace_back(traj);
+    auto encodeEnd = std::chrono::high_resolution_clock::now();
+    cs.encodeTime = std::chrono::duration<double>(encodeEnd - encodeStart).count();
+
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        cs.points += encoded[i].size();
+        cs.rawPointBytes += trajectoriesCopy[i].getPoints().size() * sizeof(Point3D);
+        cs.compressedBytes += encoded[i].memoryUsage();
+    }
+
+    // Sequential decode of everything into one reused buffer
+    std::vector<Point3D> buffer;
+    size_t decodedPoints = 0;
+    auto decodeStart = std::chrono::high_resolution_clock::now();
+    for (const auto& c : encoded) {
+        buffer.clear();
+        for (size_t b = 0; b < c.blockCount(); ++b) c.decodeBlock(b, buffer);
+        decodedPoints += buffer.size();
+    }
+    auto decodeEnd = std::chrono::high_resolution_clock::now();
+    double decodeTime = std::chrono::duration<double>(decodeEnd - decodeStart).count();
+    cs.decodeThroughput = decodeTime > 0.0 ? decodedPoints / decodeTime : 0.0;
+
+    // Round-trip check (not timed)
+    for (size_t i = 0; i < encoded.size(); ++i) {
+        auto decoded = encoded[i].decodePoints();
+        const auto& original = trajectoriesCopy[i].getPoints();
+        for (size_t p = 0; p < original.size(); ++p) {
+            cs.maxCoordError = std::max({cs.maxCoordError,
+                                         std::fabs(decoded[p].getX() - original[p].getX()),
+                                         std::fabs(decoded[p].getY() - original[p].getY())});
+            if (decoded[p].getT() != original[p].getT())
+                std::cerr << "[Compression] Timestamp mismatch in " << encoded[i].getId() << "\n";
+        }
+    }
+
+    // Random point lookups (one block decode each)
+    size_t lookups = 0;
+    float checksum = 0.0f;
+    auto lookupStart = std::chrono::high_resolution_clock::now();
+    for (size_t q = 0, i = 0; q < 10000 && !encoded.empty(); ++q, i = (i + 7919) % encoded.size()) {
+        if (encoded[i].size() == 0) continue;
+        checksum += encoded[i].pointAt((q * 31) % encoded[i].size()).getX();
+        ++lookups;
     }
+    auto lookupEnd = std::chrono::high_resolution_clock::now();
+    if (lookups > 0)
+        cs.blockAccessLatency = std::chrono::duration<double>(lookupEnd - lookupStart).count() / lookups;
+
+    cs.ratio = cs.compressedBytes > 0 ? static_cast<double>(cs.rawPointBytes) / cs.compressedBytes : 0.0;
+    cs.bytesPerPoint = cs.points > 0 ? static_cast<double>(cs.compressedBytes) / cs.points : 0.0;
+
+    // 9 decimals: the coordinate error is below 1e-6
+    CsvWriter out(folder + "/compression_summary.csv",
+                  "Trajectories,Points,RawPointBytes,CompressedBytes,Ratio,BytesPerPoint,"
+                  "EncodeTime(s),DecodeThroughput(points/s),BlockAccessLatency(s),MaxCoordError,LookupChecksum", 9);
+    out.row(cs.trajectories, cs.points, cs.rawPointBytes, cs.compressedBytes, cs.ratio, cs.bytesPerPoint,
+            cs.encodeTime, cs.decodeThroughput, cs.blockAccessLatency, cs.maxCoordError, checksum);
+    return cs;
 }
 
 /*
@@ -4,7 +4,16 @@
 // Provides tools to evaluate RTree performance against linear scan for trajectory queries.
 // - Supports range queries, k-nearest neighbors (kNN), and similarity queries.
 // - Measures query time, result count, and uniqueness.
+// - The linear baseline scans columnar boxes/centroids (ColumnarScan) and returns indices.
 // - Saves individual query results and overall summaries to CSV files.
+// - Replays workload files across worker threads and reports latency percentiles.
+// - Reports compressed point storage size and decode throughput.
+// - Measures recall vs latency of approximate kNN against the exact answer.
+// - Times the similarity self-join against bulk loading and per-trajectory searches.
+// - Reports page faults, hit rate and I/O bytes per query of the disk-backed PagedRTree.
+// - Times scatter-gather range and kNN queries of a ShardedRTree against the single tree.
+// - Measures how async queries with deadlines trade completeness for bounded latency.
+// - Compares startup, memory and cache behaviour of the lazy Parquet store against the loaded RTree.
 // ============================================================================
 #ifndef EVALUATION_H
 #define EVALUATION_H
@@ -13,9 +22,17 @@
 #include <string>
 #include <unordered_set>
 #include <functional>
+#include <unordered_map>
 #include "../api/include/trajectory.h"
 #include "../api/include/RTree.h"
 #include "../api/include/bbox3D.h"
+#include "../api/include/columnarScan.h"
+#include "../api/include/compressedTrajectory.h"
+#include "../api/include/concurrentRTree.h"
+#include "../api/include/queryPlanner.h"
+#include "../api/include/pagedRTree.h"
+#include "../api/include/shardedRTree.h"
+#include "../api/include/lazyParquetStore.h"
 
 // Structure to store query statistics
 struct QueryStats {
@@ -42,12 +59,195 @@ struct QueryResult {
     size_t numPoints = 0;
 };
 
+// One entry of a workload file (fields not used by the query type are ignored)
+struct WorkloadQuery {
+    std::string type;            // rangeQuery, kNearestNeighbors or findSimilar
+    std::string city;            // rangeQuery
+    std::string startTime;       // rangeQuery (ISO 8601)
+    std::string endTime;         // rangeQuery (ISO 8601)
+    std::string trajId;          // kNearestNeighbors / findSimilar
+    size_t k = 0;                // kNearestNeighbors
+    float threshold = 0.0f;      // findSimilar
+};
+
+// Latency / throughput summary of one query type during a workload replay
+struct WorkloadStats {
+    std::string type;
+    size_t count = 0;
+    size_t totalResults = 0;
+    double throughput = 0.0;     // queries per second over the whole replay
+    double meanLatency = 0.0;    // seconds
+    double p50Latency = 0.0;
+    double p95Latency = 0.0;
+    double p99Latency = 0.0;
+    double maxLatency = 0.0;
+};
+
+// Point storage and decode speed of CompressedTrajectory over the dataset
+struct CompressionStats {
+    size_t trajectories = 0;
+    size_t points = 0;
+    size_t rawPointBytes = 0;        // Point3D storage (size * sizeof(Point3D))
+    size_t compressedBytes = 0;      // block headers + varint streams
+    double ratio = 0.0;              // rawPointBytes / compressedBytes
+    double bytesPerPoint = 0.0;      // compressed
+    double encodeTime = 0.0;         // seconds
+    double decodeThroughput = 0.0;   // points per second (full sequential decode)
+    double blockAccessLatency = 0.0; // seconds per random pointAt() lookup
+    float maxCoordError = 0.0f;      // largest |decoded - original| coordinate
+};
+
+// One point of the approximate kNN recall / latency curve
+struct ApproximateKNNStats {
+    ApproximateKNNOptions options;
+    size_t queries = 0;
+    double meanRecall = 0.0;          // |approximate ∩ exact| / |exact|, averaged over queries
+    double meanLatency = 0.0;         // seconds
+    double p95Latency = 0.0;
+    double meanAchievedEpsilon = 0.0; // over queries with a finite bound
+    double meanRefinements = 0.0;
+    double meanNodesVisited = 0.0;
+    double exactMeanLatency = 0.0;    // epsilon = 0, no budgets
+};
+
+// Similarity self-join timing compared with one bulk load and n findSimilar calls
+struct SimilarityJoinReport {
+    float threshold = 0.0f;
+    size_t threads = 1;
+    SimilarityJoinStats join;
+    double joinTime = 0.0;            // seconds
+    double bulkLoadTime = 0.0;        // seconds, STR bulk load of the same trajectories
+    double perQueryEstimate = 0.0;    // seconds, findSimilar for every trajectory (extrapolated from a sample)
+};
+
+// Aggregate range query compared with materializing the same range query
+struct AggregateQueryStats {
+    std::string city;
+    std::string startTime;
+    std::string endTime;
+    AggregateQueryResult aggregate;
+    double aggregateTime = 0.0;       // seconds, RTree::aggregateQuery
+    size_t rangeCount = 0;            // rangeQuery result size
+    size_t exactVehicles = 0;         // distinct vehicles in the rangeQuery result
+    double rangeTime = 0.0;           // seconds, rangeQuery plus summing its result
+};
+
+// Density grid over a city window compared with rangeQuery + client-side binning
+struct DensityGridStats {
+    std::string city;
+    std::string startTime;
+    std::string endTime;
+    size_t cellsX = 0;
+    size_t cellsY = 0;
+    size_t buckets = 1;
+    size_t threads = 1;
+    uint64_t points = 0;              // points inside the window
+    size_t aggregatedNodes = 0;
+    size_t binnedTrajectories = 0;
+    double gridTime = 0.0;            // seconds, RTree::densityGrid
+    double baselineTime = 0.0;        // seconds, rangeQuery plus binning every returned point
+    bool matchesBaseline = false;
+};
+
+// One batchRangeQuery over a grid of map tiles compared with a rangeQuery per tile
+struct BatchRangeQueryStats {
+    std::string city;
+    std::string startTime;
+    std::string endTime;
+    size_t tiles = 0;                 // tilesPerSide^2 queries
+    size_t threads = 1;
+    size_t results = 0;               // sum of the per-tile result sizes
+    double batchTime = 0.0;           // seconds, RTree::batchRangeQuery
+    double loopTime = 0.0;            // seconds, RTree::rangeQuery for every tile
+    bool matchesLoop = false;
+};
+
+// Planner decision for one range query, with every strategy timed for comparison
+struct QueryPlanStats {
+    std::string city;
+    std::string startTime;
+    std::string endTime;
+    QueryPlanner::Plan plan;
+    size_t actualRows = 0;
+    double seconds[QueryPlanner::kStrategies] = {}; // per strategy, in Strategy order
+    bool choseFastest = false;
+};
+
+// Range query throughput on a ConcurrentRTree with and without a concurrent update stream
+struct ConcurrentIngestStats {
+    size_t readers = 0;
+    double updatesPerSecond = 0.0;    // requested ingest rate (position reports per second)
+    double seconds = 0.0;             // duration of each phase
+    size_t idleQueries = 0;           // queries completed without ingest
+    size_t ingestQueries = 0;         // queries completed during ingest
+    size_t updates = 0;               // updates applied during ingest
+    double idleQps = 0.0;
+    double ingestQps = 0.0;
+    double meanUpdateLatency = 0.0;   // seconds per ConcurrentRTree::update
+};
+
+// Disk-backed range queries with one buffer pool configuration
+struct PagedRTreeStats {
+    EvictionPolicy policy = EvictionPolicy::LRU;
+    size_t poolPages = 0;             // frames of each pool (node pages and heap pages)
+    size_t queries = 0;
+    size_t results = 0;
+    double faultsPerQuery = 0.0;
+    double bytesPerQuery = 0.0;
+    double indexHitRate = 0.0;
+    double heapHitRate = 0.0;
+    double meanLatency = 0.0;         // seconds per query
+    bool matchesRTree = false;
+};
+
+// Latency of one city window and of kNN on a ShardedRTree, next to the single RTree
+struct ShardedRTreeStats {
+    ShardingScheme scheme = ShardingScheme::SpatialTiles;
+    size_t shards = 0;
+    size_t threads = 0;
+    double buildTime = 0.0;           // seconds, partitioning plus parallel shard builds
+    size_t rangeResults = 0;
+    double rangeLatency = 0.0;        // seconds per range query
+    double singleRangeLatency = 0.0;  // seconds per range query on the RTree
+    double knnLatency = 0.0;          // seconds per kNN query
+    double singleKnnLatency = 0.0;
+    double shardsSearchedPerKnn = 0.0;
+    bool matchesRTree = false;
+};
+
+// A burst of async queries submitted together with the same deadline (0 = none)
+struct QueryDeadlineStats {
+    double deadline = 0.0;            // seconds
+    size_t queries = 0;
+    size_t completed = 0;             // finished before the deadline
+    double resultFraction = 0.0;      // results returned / results without a deadline
+    double p99Latency = 0.0;          // seconds from submission to a ready result
+    double maxLatency = 0.0;
+};
+
+// City window tiles replayed on a LazyParquetStore with one cache budget
+struct LazyStoreEvalStats {
+    size_t cachePoints = 0;           // cache budget in points
+    double openTime = 0.0;            // seconds to open the store (footers, ID and box columns)
+    size_t memoryBytes = 0;           // store memory after the replay
+    size_t queries = 0;
+    size_t results = 0;
+    double rowGroupsPerQuery = 0.0;   // row groups decoded for point data
+    double hitRate = 0.0;             // decoded-trajectory cache
+    double meanLatency = 0.0;         // seconds per query
+    bool matchesRTree = false;
+};
+
 class Evaluation {
 private:
     RTree& rtree;                              
     const std::vector<Trajectory> trajectories;     
     const std::vector<Trajectory> trajectoriesCopy; 
     std::string folder;                         
+    std::vector<TrajectorySummary> summaries;    // of trajectoriesCopy, one parallel pass
+    ColumnarScan scan;                           // Columnar baseline over trajectoriesCopy
+    std::unordered_map<std::string, size_t> copyIndexById; // trajectoriesCopy position by ID
+    size_t scanThreads = 1;                      // Threads used by the linear baseline
 
     void saveQueryResults(int queryIndex, const std::string& queryType,
                           const std::vector<QueryResult>& rtreeResults,
@@ -58,26 +258,29 @@ private:
                                       const Trajectory* queryTraj,
                                       const std::vector<Trajectory>& results);
 
-    std::vector<Trajectory> linearScan(
-        const std::function<bool(const Trajectory&)>& predicate,
-        const Trajectory* exclude,
-        size_t& outCount,
-        size_t& outUnique,
-        size_t maxCount = 0,
-        const std::function<float(const Trajectory&)>& distanceFunc = nullptr
-    );
-
     std::vector<Trajectory> filterUniqueTrajectories(const std::vector<Trajectory>& input,
                                                      const Trajectory* exclude = nullptr,
                                                      size_t maxCount = 0);
 
     const Trajectory* findTrajectoryById(const std::string& trajId);                                                 
+    size_t copyIndexOf(const std::string& trajId) const; // ColumnarScan::npos if absent
+    size_t distinctVehicles(const std::vector<size_t>& copyIndices) const; // vehicles of trajectoriesCopy entries
+
+    static BoundingBox3D cityQueryBox(const std::string& city,
+                                      const std::string& startTime,
+                                      const std::string& endTime);
+    // tilesPerSide x tilesPerSide map tiles covering box row by row, each over its whole time range
+    // (at least one tile)
+    static std::vector<BoundingBox3D> makeTiles(const BoundingBox3D& box, size_t tilesPerSide);
 
 public:
+    // copySummaries: RTree::computeSummaries of trajsCopy (or of the vector it copies) if already
+    // computed; computed here when empty
     Evaluation(RTree& tree,
                const std::vector<Trajectory> trajs,
                const std::vector<Trajectory> trajsCopy,
-               const std::string& resultFolder = "results");
+               const std::string& resultFolder = "results",
+               std::vector<TrajectorySummary> copySummaries = {});
 
     QueryStats runRangeQuery(const std::string& city,
                              const std::string& startTime,
@@ -90,6 +293,93 @@ public:
 
     void saveSummary(const std::vector<QueryStats>& statsList);
 
+    // Threads used by the linear-scan baseline (0 = all hardware threads)
+    void setScanThreads(size_t numThreads) { scanThreads = numThreads; }
+
+    // ---------------- Workload replay ----------------
+    // Reads a .json array of query objects or a .csv file with the header
+    // type,city,startTime,endTime,trajId,k,threshold
+    static std::vector<WorkloadQuery> loadWorkload(const std::string& filepath);
+
+    // Replays the workload against the (read-only) RTree on numThreads workers.
+    // Writes workload_summary.csv and, if savePerQuery is set, workload_queries.csv.
+    std::vector<WorkloadStats> runWorkload(const std::vector<WorkloadQuery>& workload,
+                                           size_t numThreads,
+                                           bool savePerQuery = false);
+
+    // ---------------- Approximate kNN ----------------
+    // Runs every option set for each query trajectory, compares with the exact answer
+    // (epsilon = 0, no budgets) and writes approx_knn_curve.csv
+    std::vector<ApproximateKNNStats> runApproximateKNNCurve(const std::vector<std::string>& trajIds, size_t k,
+                                                            const std::vector<ApproximateKNNOptions>& settings);
+
+    // ---------------- Similarity join ----------------
+    // Self-joins the RTree; writes similarity_join_summary.csv and, if savePairs, similarity_join_pairs.csv
+    SimilarityJoinReport runSimilarityJoin(float threshold, size_t numThreads, bool savePairs = false);
+
+    // ---------------- Aggregate queries ----------------
+    // Runs the rangeQuery entries of windows as aggregate queries, checks them against
+    // a materialized rangeQuery and writes aggregate_query_summary.csv
+    std::vector<AggregateQueryStats> runAggregateQueries(const std::vector<WorkloadQuery>& windows);
+
+    // ---------------- Density grid ----------------
+    // Heatmap of a city window; writes density_grid_summary.csv and, if saveGrid,
+    // the non-empty cells to density_grid_<city>.csv
+    DensityGridStats runDensityGrid(const std::string& city, const std::string& startTime, const std::string& endTime,
+                                    size_t cells, int64_t bucketSeconds, size_t numThreads, bool saveGrid = false);
+
+    // ---------------- Batch range queries ----------------
+    // Splits a city window into tilesPerSide x tilesPerSide tiles, answers them with one
+    // batchRangeQuery and with a rangeQuery loop; writes batch_range_query_summary.csv
+    BatchRangeQueryStats runBatchRangeQuery(const std::string& city, const std::string& startTime,
+                                            const std::string& endTime, size_t tilesPerSide, size_t numThreads);
+
+    // ---------------- Query planner ----------------
+    // Calibrates a QueryPlanner on the rangeQuery entries of windows, then plans and times every
+    // strategy on each; writes query_planner_summary.csv and the calibration log query_plan_log.csv
+    std::vector<QueryPlanStats> runQueryPlanner(const std::vector<WorkloadQuery>& windows);
+
+    // ---------------- Concurrent ingest ----------------
+    // Readers replay city range queries on a ConcurrentRTree, first alone and then while a writer
+    // appends one point per update (a 1 Hz position report) at updatesPerSecond; writes
+    // concurrent_ingest_summary.csv
+    ConcurrentIngestStats runConcurrentIngest(size_t readers, double updatesPerSecond, double seconds);
+
+    // ---------------- Paged R-Tree ----------------
+    // Writes trajectoriesCopy to a PagedRTree under the result folder, then replays the tiles of a
+    // city window (tilesPerSide x tilesPerSide, twice) for every pool size and eviction policy;
+    // writes paged_rtree_summary.csv
+    std::vector<PagedRTreeStats> runPagedRTree(const std::string& city, const std::string& startTime,
+                                               const std::string& endTime, size_t tilesPerSide,
+                                               const std::vector<size_t>& poolSizes);
+
+    // ---------------- Sharded R-Tree ----------------
+    // Builds a ShardedRTree over trajectoriesCopy for every shard count and both schemes, times the city
+    // window and kNN for the given trajectories against the RTree; writes sharded_rtree_summary.csv
+    std::vector<ShardedRTreeStats> runShardedRTree(const std::string& city, const std::string& startTime,
+                                                   const std::string& endTime, const std::vector<std::string>& knnIds,
+                                                   size_t k, const std::vector<size_t>& shardCounts, size_t numThreads);
+
+    // ---------------- Query deadlines ----------------
+    // Submits the city window (rangeRepeats times) and findSimilar for the given trajectories at once
+    // on the RTree's shared executor, for every deadline; writes query_deadline_summary.csv
+    std::vector<QueryDeadlineStats> runQueryDeadlines(const std::string& city, const std::string& startTime,
+                                                      const std::string& endTime, size_t rangeRepeats,
+                                                      const std::vector<std::string>& similarIds, float threshold,
+                                                      const std::vector<double>& deadlines);
+
+    // ---------------- Lazy Parquet store ----------------
+    // Opens parquetPath as a LazyParquetStore for every cache budget and replays the tiles of a city
+    // window (tilesPerSide x tilesPerSide, twice), checking result sizes against the RTree;
+    // writes lazy_store_summary.csv
+    std::vector<LazyStoreEvalStats> runLazyParquetStore(const std::string& parquetPath, const std::string& city,
+                                                        const std::string& startTime, const std::string& endTime,
+                                                        size_t tilesPerSide, const std::vector<size_t>& cacheBudgets);
+
+    // ---------------- Compression ----------------
+    // Encodes every trajectory, verifies the round trip and writes compression_summary.csv
+    CompressionStats runCompressionBenchmark();
+
     const std::vector<Trajectory>& getTrajectories() const { return trajectories; }
 };
 
@@ -0,0 +1,35 @@
+#include "api/include/csvIngest.h"
+#include <iostream>
+#include <chrono>
+#include <exception>
+
+// Usage:
+//   ./ingest [summary.csv] [trajectories.csv] [outputDir] [threads]
+// Reads the raw CityTrek-14K CSV files and writes the grouped Parquet files main and
+// server load, without the Python preprocessing step.
+int main(int argc, char* argv[]) {
+    std::string summaryPath = argc > 1 ? argv[1] : "../summary_to_publish.csv";
+    std::string trajectoriesPath = argc > 2 ? argv[2] : "../trajectories_to_publish.csv";
+    std::string outputDir = argc > 3 ? argv[3] : "../preprocessing/trajectories_grouped.parquet";
+    size_t numThreads = argc > 4 ? std::stoul(argv[4]) : 0;
+
+    try {
+        CsvIngestStats stats;
+        TrajectoryColumns columns = csvIngest::load(summaryPath, trajectoriesPath, numThreads, &stats);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        columns.writeParquet(outputDir);
+        std::chrono::duration<double> writeTime = std::chrono::high_resolution_clock::now() - start;
+
+        std::cout << "Summary: " << stats.summaryTrips << " trips, " << stats.vehicles << " vehicles\n"
+                  << "Rows: " << stats.rowsRead << " read, " << stats.rowsKept << " kept, "
+                  << stats.unknownTripRows << " unknown trip, " << stats.malformedRows << " malformed\n"
+                  << "Trips written: " << columns.trips() << " to " << outputDir << "\n"
+                  << "Time (s): map " << stats.mapSeconds << ", parse " << stats.parseSeconds
+                  << ", group " << stats.groupSeconds << ", write " << writeTime.count() << "\n";
+    } catch (const std::exception& e) {
+        std::cerr << "Ingest failed: " << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -1,10 +1,27 @@
 #include <iostream>
 #include "api/include/RTree.h"
 #include "evaluation/evaluation.h"
+#include "../common/trace.h"
 #include <filesystem>
+#include <thread>
+#include <cstdlib>
 namespace fs = std::filesystem;
 
-int main() {
+// Usage:
+//   ./main                                   interactive queries from stdin
+//   ./main <workload.json|.csv> [threads] [--per-query]   replay a workload file
+// --compression anywhere also runs the compressed point storage benchmark after loading.
+// With TRACE_FILE=<path> set, a Chrome trace of the run is written to path on exit.
+int main(int argc, char* argv[]) {
+    std::vector<std::string> args;
+    bool compressionBenchmark = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--compression") compressionBenchmark = true;
+        else args.push_back(argv[i]);
+    }
+
+    trace::Session session(std::getenv("TRACE_FILE"), "part1 main");
+    trace::setThreadName("main");
     RTree rtree(8);
 
     // -----------------------------
@@ -14,10 +31,13 @@ int main() {
     std::string parquetDir = "../preprocessing/trajectories_grouped.parquet";
 
     auto start = std::chrono::high_resolution_clock::now();
-    for (const auto& entry : fs::directory_iterator(parquetDir)) {
-        if (entry.is_regular_file() && entry.path().extension() == ".parquet") {
-            auto partial = rtree.loadFromParquet(entry.path().string());
-            trajectories.insert(trajectories.end(), partial.begin(), partial.end());
+    {
+        TRACE_SCOPE_CAT("pipeline", "load Parquet");
+        for (const auto& entry : fs::directory_iterator(parquetDir)) {
+            if (entry.is_regular_file() && entry.path().extension() == ".parquet") {
+                auto partial = rtree.loadFromParquet(entry.path().string());
+                trajectories.insert(trajectories.end(), partial.begin(), partial.end());
+            }
         }
     }
     auto end = std::chrono::high_resolution_clock::now();
@@ -27,11 +47,9 @@ int main() {
 
 
     // -----------------------------
-    // Step 2: Precompute centroids & bounding boxes
+    // Step 2: Precompute centroids & bounding boxes (parallel), reused by bulkLoad and Evaluation
     // -----------------------------
-    for (auto& traj : trajectories) {
-    traj.precomputeCentroidAndBoundingBox();
-    }
+    std::vector<TrajectorySummary> summaries = RTree::precomputeSummaries(trajectories);
 
     // -----------------------------
     // Step 3: Keep a copy for linear scan
@@ -42,7 +60,7 @@ int main() {
     // Step 4: Bulk-load into RTree
     // -----------------------------
     auto buildStart = std::chrono::high_resolution_clock::now();
-    rtree.bulkLoad(trajectories);   // consumes trajectories
+    rtree.bulkLoad(trajectories, summaries);   // consumes trajectories
     auto buildEnd = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> buildTime = buildEnd - buildStart;
     std::cout << "Bulk-load completed in " << buildTime.count() << " seconds.\n";
@@ -50,13 +68,42 @@ int main() {
     // -----------------------------
     // Step 5: Initialize Evaluation AFTER bulkLoad
     // -----------------------------
-    Evaluation eval(rtree, trajectoriesCopy, trajectoriesCopy, "results");
+    trace::Span setupSpan("evaluation setup", "pipeline");
+    Evaluation eval(rtree, trajectoriesCopy, trajectoriesCopy, "results", summaries);
 
     // Export RTree to JSON (optional)
     rtree.exportToJSON("results/bulkloaded_tree.json");
 
     // Print statistics
     rtree.printStatistics();
+    setupSpan.end();
+
+    // Compressed point storage (re-encodes the whole dataset, so only on request)
+    if (compressionBenchmark) {
+        CompressionStats cs = eval.runCompressionBenchmark();
+        std::cout << "Compressed points: " << cs.rawPointBytes << " B -> " << cs.compressedBytes << " B ("
+                  << cs.ratio << "x, " << cs.bytesPerPoint << " B/point), decode "
+                  << cs.decodeThroughput / 1e6 << " M points/s\n";
+    }
+
+    // -----------------------------
+    // Workload replay mode
+    // -----------------------------
+    if (!args.empty()) {
+        std::string workloadFile = args[0];
+        size_t numThreads = args.size() > 1 ? std::stoul(args[1]) : std::thread::hardware_concurrency();
+        bool perQuery = args.size() > 2 && args[2] == "--per-query";
+
+        auto workload = Evaluation::loadWorkload(workloadFile);
+        std::cout << "Replaying " << workload.size() << " queries on " << numThreads << " threads\n";
+        auto workloadStats = eval.runWorkload(workload, numThreads, perQuery);
+        for (const auto& ws : workloadStats) {
+            std::cout << ws.type << ": " << ws.count << " queries, "
+                      << ws.throughput << " q/s, p50=" << ws.p50Latency
+                      << "s p95=" << ws.p95Latency << "s p99=" << ws.p99Latency << "s\n";
+        }
+        return 0;
+    }
 
     // -----------------------------
     // Step 6: Query loop
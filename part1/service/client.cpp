@@ -0,0 +1,136 @@
+#include "client.h"
+#include <stdexcept>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using protocol::MessageType;
+using protocol::ReplyMode;
+
+// ---------------- Constructors ----------------
+QueryClient::QueryClient(const std::string& socketPath) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) throw std::invalid_argument("QueryClient socket path too long");
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) throw std::runtime_error("QueryClient cannot create a socket");
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(fd);
+        throw std::runtime_error("QueryClient cannot connect to " + socketPath);
+    }
+}
+
+QueryClient::~QueryClient() {
+    if (fd >= 0) ::close(fd);
+}
+
+// ---------------- Helpers ----------------
+// Sends one request and reads the first reply frame into payload
+MessageType QueryClient::request(MessageType type, const std::vector<uint8_t>& body) {
+    protocol::sendFrame(fd, type, body);
+    MessageType reply;
+    if (!protocol::receiveFrame(fd, reply, payload)) throw std::runtime_error("QueryClient: server closed the connection");
+    if (reply == MessageType::Error) throw std::runtime_error("QueryClient: " + protocol::Reader(payload).getString());
+    return reply;
+}
+
+std::vector<ResultHandle> QueryClient::readHandles(MessageType type, const std::vector<uint8_t>& body) {
+    if (request(type, body) != MessageType::Handles) throw std::runtime_error("QueryClient: unexpected reply");
+    protocol::Reader in(payload);
+    std::vector<ResultHandle> results(in.get<uint32_t>());
+    for (auto& r : results) {
+        r.handle = in.get<uint32_t>();
+        r.trajId = in.getString();
+        r.distance = in.get<float>();
+    }
+    return results;
+}
+
+size_t QueryClient::readStream(MessageType type, const std::vector<uint8_t>& body, const StreamVisitor& visit) {
+    size_t received = 0;
+    for (MessageType reply = request(type, body); reply != MessageType::End; ++received) {
+        if (reply != MessageType::Trajectory) throw std::runtime_error("QueryClient: unexpected reply");
+        protocol::Reader in(payload);
+        ResultHandle match;
+        match.handle = in.get<uint32_t>();
+        match.distance = in.get<float>();
+        match.trajId = in.getString();
+        Trajectory traj(match.trajId);
+        uint32_t n = in.get<uint32_t>();
+        traj.reservePoints(n);
+        for (uint32_t i = 0; i < n; ++i) {
+            float x = in.get<float>(), y = in.get<float>();
+            traj.addPoint(Point3D(x, y, in.get<int64_t>()));
+        }
+        traj.precomputeCentroidAndBoundingBox();
+        visit(match, std::move(traj));
+
+        if (!protocol::receiveFrame(fd, reply, payload)) throw std::runtime_error("QueryClient: server closed the connection");
+        if (reply == MessageType::Error) throw std::runtime_error("QueryClient: " + protocol::Reader(payload).getString());
+    }
+    return received;
+}
+
+// ---------------- Queries ----------------
+std::vector<ResultHandle> QueryClient::rangeQuery(const BoundingBox3D& queryBox) {
+    protocol::Writer body;
+    body.putBox(queryBox).put(static_cast<uint8_t>(ReplyMode::Handles));
+    return readHandles(MessageType::Range, body.data());
+}
+
+std::vector<ResultHandle> QueryClient::kNearestNeighbors(const std::string& trajId, uint32_t k) {
+    protocol::Writer body;
+    body.putString(trajId).put(k).put(static_cast<uint8_t>(ReplyMode::Handles));
+    return readHandles(MessageType::KNN, body.data());
+}
+
+std::vector<ResultHandle> QueryClient::findSimilar(const std::string& trajId, float threshold) {
+    protocol::Writer body;
+    body.putString(trajId).put(threshold).put(static_cast<uint8_t>(ReplyMode::Handles));
+    return readHandles(MessageType::Similar, body.data());
+}
+
+size_t QueryClient::rangeQuery(const BoundingBox3D& queryBox, const StreamVisitor& visit) {
+    protocol::Writer body;
+    body.putBox(queryBox).put(static_cast<uint8_t>(ReplyMode::Points));
+    return readStream(MessageType::Range, body.data(), visit);
+}
+
+size_t QueryClient::kNearestNeighbors(const std::string& trajId, uint32_t k, const StreamVisitor& visit) {
+    protocol::Writer body;
+    body.putString(trajId).put(k).put(static_cast<uint8_t>(ReplyMode::Points));
+    return readStream(MessageType::KNN, body.data(), visit);
+}
+
+size_t QueryClient::findSimilar(const std::string& trajId, float threshold, const StreamVisitor& visit) {
+    protocol::Writer body;
+    body.putString(trajId).put(threshold).put(static_cast<uint8_t>(ReplyMode::Points));
+    return readStream(MessageType::Similar, body.data(), visit);
+}
+
+// ---------------- Handles and server ----------------
+std::vector<Trajectory> QueryClient::fetch(const std::vector<uint32_t>& handles) {
+    protocol::Writer body;
+    body.put(static_cast<uint32_t>(handles.size()));
+    for (uint32_t h : handles) body.put(h);
+    std::vector<Trajectory> results;
+    results.reserve(handles.size());
+    readStream(MessageType::Fetch, body.data(), [&](const ResultHandle&, Trajectory&& t) { results.push_back(std::move(t)); });
+    return results;
+}
+
+ServerStats QueryClient::stats() {
+    if (request(MessageType::Stats, {}) != MessageType::StatsReply) throw std::runtime_error("QueryClient: unexpected reply");
+    protocol::Reader in(payload);
+    ServerStats s;
+    s.trajectories = in.get<uint64_t>();
+    s.requests = in.get<uint64_t>();
+    s.connections = in.get<uint64_t>();
+    return s;
+}
+
+void QueryClient::shutdownServer() {
+    request(MessageType::Shutdown, {});
+}
@@ -0,0 +1,71 @@
+/*
+ * client.h
+ * ----------
+ * Defines QueryClient, a blocking connection to a QueryServer (see protocol.h).
+ *
+ * One client is one connection and must not be shared between threads; open
+ * one per thread instead. Error replies are thrown as std::runtime_error and
+ * leave the connection usable.
+ */
+
+#ifndef SERVICE_CLIENT_H
+#define SERVICE_CLIENT_H
+
+#include "protocol.h"
+#include "../api/include/trajectory.h"
+#include "../api/include/bbox3D.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+
+// A match as returned by the server; the handle can be fetched later
+struct ResultHandle {
+    uint32_t handle;
+    std::string trajId;
+    float distance;   // kNN distance (squared, as spatioTemporalDistanceTo), 0 otherwise
+};
+
+struct ServerStats {
+    uint64_t trajectories = 0;
+    uint64_t requests = 0;
+    uint64_t connections = 0;
+};
+
+// Receives each streamed match as soon as its frame arrives
+using StreamVisitor = std::function<void(const ResultHandle& match, Trajectory&& trajectory)>;
+
+class QueryClient {
+private:
+    int fd = -1;
+    std::vector<uint8_t> payload;   // last received frame
+
+    protocol::MessageType request(protocol::MessageType type, const std::vector<uint8_t>& body);
+    std::vector<ResultHandle> readHandles(protocol::MessageType type, const std::vector<uint8_t>& body);
+    size_t readStream(protocol::MessageType type, const std::vector<uint8_t>& body, const StreamVisitor& visit);
+
+public:
+    // ---------------- Constructors ----------------
+    explicit QueryClient(const std::string& socketPath);   // throws if the server is not reachable
+    ~QueryClient();
+    QueryClient(const QueryClient&) = delete;
+    QueryClient& operator=(const QueryClient&) = delete;
+
+    // ---------------- Queries returning handles ----------------
+    std::vector<ResultHandle> rangeQuery(const BoundingBox3D& queryBox);
+    std::vector<ResultHandle> kNearestNeighbors(const std::string& trajId, uint32_t k); // nearest first
+    std::vector<ResultHandle> findSimilar(const std::string& trajId, float threshold);
+
+    // ---------------- Queries streaming points ----------------
+    // Return the number of matches passed to visit
+    size_t rangeQuery(const BoundingBox3D& queryBox, const StreamVisitor& visit);
+    size_t kNearestNeighbors(const std::string& trajId, uint32_t k, const StreamVisitor& visit);
+    size_t findSimilar(const std::string& trajId, float threshold, const StreamVisitor& visit);
+
+    // ---------------- Handles and server ----------------
+    std::vector<Trajectory> fetch(const std::vector<uint32_t>& handles); // in request order
+    ServerStats stats();
+    void shutdownServer();   // the server stops after answering
+};
+
+#endif // SERVICE_CLIENT_H
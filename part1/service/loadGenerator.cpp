@@ -0,0 +1,110 @@
+#include "client.h"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+// Usage:
+//   ./loadgen [socketPath] [clients] [seconds] [--points] [--mix range,knn,similar]
+// Each client thread opens its own connection and sends queries back to back for the given time.
+// Queries are built from a sample of the served trajectories: range boxes around their bounding
+// boxes, kNN (k = 10) and findSimilar (threshold 0.01) on their IDs. --points streams the matching
+// points instead of returning handles. Prints throughput and latency percentiles per query type.
+int main(int argc, char* argv[]) {
+    std::string socketPath = argc > 1 ? argv[1] : "/tmp/rtree.sock";
+    size_t clients = argc > 2 ? std::stoul(argv[2]) : 4;
+    double seconds = argc > 3 ? std::stod(argv[3]) : 10.0;
+    bool points = false;
+    double mix[3] = {8.0, 1.0, 1.0};
+    for (int i = 4; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--points") points = true;
+        else if (arg == "--mix" && i + 1 < argc && std::sscanf(argv[++i], "%lf,%lf,%lf", &mix[0], &mix[1], &mix[2]) != 3) {
+            std::cerr << "--mix expects three comma-separated weights\n";
+            return 1;
+        }
+    }
+
+    // Sample of query trajectories: every handle is valid, so pick them uniformly
+    std::vector<Trajectory> sample;
+    {
+        QueryClient client(socketPath);
+        ServerStats s = client.stats();
+        if (s.trajectories == 0) {
+            std::cerr << "Server has no trajectories\n";
+            return 1;
+        }
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<uint32_t> pick(0, static_cast<uint32_t>(s.trajectories - 1));
+        std::vector<uint32_t> handles(std::min<uint64_t>(256, s.trajectories));
+        for (auto& h : handles) h = pick(rng);
+        sample = client.fetch(handles);
+    }
+
+    static const char* names[3] = {"rangeQuery", "kNearestNeighbors", "findSimilar"};
+    std::vector<std::vector<double>> latencies[3];
+    for (auto& l : latencies) l.resize(clients);
+    std::atomic<size_t> failures{0};
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+
+    std::vector<std::thread> workers;
+    for (size_t c = 0; c < clients; ++c) {
+        workers.emplace_back([&, c]() {
+            QueryClient client(socketPath);
+            std::mt19937 rng(static_cast<uint32_t>(c) + 1);
+            std::discrete_distribution<int> type({mix[0], mix[1], mix[2]});
+            std::uniform_int_distribution<size_t> pick(0, sample.size() - 1);
+            size_t sink = 0;
+            auto count = [&](const ResultHandle&, Trajectory&& t) { sink += t.getPoints().size(); };
+
+            while (std::chrono::steady_clock::now() < deadline) {
+                int q = type(rng);
+                const Trajectory& traj = sample[pick(rng)];
+                auto start = std::chrono::steady_clock::now();
+                try {
+                    if (q == 0) {
+                        // The trajectory's box grown by 0.01 degrees and one hour
+                        BoundingBox3D b = traj.getBoundingBox();
+                        BoundingBox3D box(b.getMinX() - 0.01f, b.getMinY() - 0.01f, b.getMinT() - 3600,
+                                          b.getMaxX() + 0.01f, b.getMaxY() + 0.01f, b.getMaxT() + 3600);
+                        if (points) client.rangeQuery(box, count);
+                        else sink += client.rangeQuery(box).size();
+                    } else if (q == 1) {
+                        if (points) client.kNearestNeighbors(traj.getId(), 10, count);
+                        else sink += client.kNearestNeighbors(traj.getId(), 10).size();
+                    } else {
+                        if (points) client.findSimilar(traj.getId(), 0.01f, count);
+                        else sink += client.findSimilar(traj.getId(), 0.01f).size();
+                    }
+                } catch (const std::exception&) {
+                    ++failures;
+                    continue;
+                }
+                latencies[q][c].push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            }
+            (void)sink;
+        });
+    }
+    for (auto& w : workers) w.join();
+
+    std::cout << clients << " clients, " << seconds << " s, " << (points ? "streamed points" : "handles") << "\n";
+    std::cout << std::left << std::setw(20) << "Type" << std::setw(10) << "Count" << std::setw(12) << "Q/s"
+              << std::setw(12) << "p50(ms)" << std::setw(12) << "p95(ms)" << "p99(ms)\n";
+    for (int q = 0; q < 3; ++q) {
+        std::vector<double> all;
+        for (const auto& l : latencies[q]) all.insert(all.end(), l.begin(), l.end());
+        if (all.empty()) continue;
+        std::sort(all.begin(), all.end());
+        auto percentile = [&](double p) { return all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))] * 1e3; };
+        std::cout << std::setw(20) << names[q] << std::setw(10) << all.size() << std::setw(12) << all.size() / seconds
+                  << std::setw(12) << percentile(0.50) << std::setw(12) << percentile(0.95) << percentile(0.99) << "\n";
+    }
+    if (failures) std::cout << failures << " requests failed\n";
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "protocol.h"
+#include <cerrno>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace protocol {
+
+// ---------------- Writer / Reader ----------------
+Writer& Writer::putString(const std::string& s) {
+    put(static_cast<uint32_t>(s.size()));
+    bytes.insert(bytes.end(), s.begin(), s.end());
+    return *this;
+}
+
+Writer& Writer::putBox(const BoundingBox3D& box) {
+    return put(box.getMinX()).put(box.getMinY()).put(box.getMinT())
+          .put(box.getMaxX()).put(box.getMaxY()).put(box.getMaxT());
+}
+
+std::string Reader::getString() {
+    uint32_t n = get<uint32_t>();
+    need(n);
+    std::string s(reinterpret_cast<const char*>(bytes.data() + pos), n);
+    pos += n;
+    return s;
+}
+
+BoundingBox3D Reader::getBox() {
+    float minX = get<float>(), minY = get<float>();
+    int64_t minT = get<int64_t>();
+    float maxX = get<float>(), maxY = get<float>();
+    int64_t maxT = get<int64_t>();
+    return BoundingBox3D(minX, minY, minT, maxX, maxY, maxT);
+}
+
+// ---------------- Framing ----------------
+static void writeAll(int fd, const uint8_t* data, size_t n) {
+    while (n > 0) {
+        ssize_t written = ::send(fd, data, n, MSG_NOSIGNAL);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("protocol: send failed");
+        }
+        data += written;
+        n -= static_cast<size_t>(written);
+    }
+}
+
+// False if the stream ended before the first byte
+static bool readAll(int fd, uint8_t* data, size_t n) {
+    size_t done = 0;
+    while (done < n) {
+        ssize_t got = ::recv(fd, data + done, n - done, 0);
+        if (got < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error("protocol: receive failed");
+        }
+        if (got == 0) {
+            if (done == 0) return false;
+            throw std::runtime_error("protocol: connection closed inside a frame");
+        }
+        done += static_cast<size_t>(got);
+    }
+    return true;
+}
+
+void sendFrame(int fd, MessageType type, const std::vector<uint8_t>& payload) {
+    // Header and payload in one send when small, so a reply is not split into two packets
+    uint8_t header[5];
+    uint32_t length = static_cast<uint32_t>(payload.size());
+    std::memcpy(header, &length, sizeof(length));
+    header[4] = static_cast<uint8_t>(type);
+    if (payload.size() <= 4096) {
+        uint8_t buffer[5 + 4096];
+        std::memcpy(buffer, header, sizeof(header));
+        if (!payload.empty()) std::memcpy(buffer + sizeof(header), payload.data(), payload.size());
+        writeAll(fd, buffer, sizeof(header) + payload.size());
+    } else {
+        writeAll(fd, header, sizeof(header));
+        writeAll(fd, payload.data(), payload.size());
+    }
+}
+
+bool receiveFrame(int fd, MessageType& type, std::vector<uint8_t>& payload) {
+    uint8_t header[5];
+    if (!readAll(fd, header, sizeof(header))) return false;
+    uint32_t length;
+    std::memcpy(&length, header, sizeof(length));
+    if (length > kMaxFrameBytes) throw std::runtime_error("protocol: frame too large");
+    type = static_cast<MessageType>(header[4]);
+    payload.resize(length);
+    if (length > 0 && !readAll(fd, payload.data(), length))
+        throw std::runtime_error("protocol: connection closed inside a frame");
+    return true;
+}
+
+} // namespace protocol
@@ -0,0 +1,121 @@
+/*
+ * protocol.h
+ * ------------
+ * Binary protocol between QueryServer and QueryClient over a Unix domain socket.
+ *
+ * Every message is one frame:
+ *   uint32 payload length | uint8 message type | payload
+ * Integers and floats are in the native byte order (both ends run on the same
+ * machine); strings are a uint32 length followed by the bytes.
+ *
+ * Requests (client -> server), one response sequence each, in order:
+ *   Range    box (float minX, minY, int64 minT, float maxX, maxY, int64 maxT), uint8 reply
+ *   KNN      string trajId, uint32 k, uint8 reply
+ *   Similar  string trajId, float threshold, uint8 reply
+ *   Fetch    uint32 count, count x uint32 handle          -> streamed trajectories
+ *   Stats                                                  -> Stats
+ *   Shutdown                                               -> End, then the server stops
+ *
+ * Replies:
+ *   Handles     uint32 count, count x (uint32 handle, string trajId, float distance)
+ *   Trajectory  uint32 handle, float distance, string trajId, uint32 n, n x (float x, float y, int64 t)
+ *   End         uint32 number of Trajectory frames sent before it
+ *   Error       string message
+ *   Stats       uint64 trajectories, uint64 requests, uint64 connections
+ *
+ * A query with reply = Handles gets one Handles frame; with reply = Points it gets
+ * one Trajectory frame per match followed by End, so the client can consume
+ * points while the server is still sending. Handles stay valid for the life of
+ * the server; distance is the kNN distance (0 for other queries). A reply byte
+ * other than Handles / Points gets an Error.
+ *
+ * A client connecting while all server workers hold connections gets one Error
+ * frame ("server busy") and is disconnected.
+ */
+
+#ifndef SERVICE_PROTOCOL_H
+#define SERVICE_PROTOCOL_H
+
+#include "../api/include/bbox3D.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace protocol {
+
+constexpr uint32_t kMaxFrameBytes = 256u << 20; // larger frames are rejected as corrupt
+
+enum class MessageType : uint8_t {
+    // Requests
+    Range = 1,
+    KNN = 2,
+    Similar = 3,
+    Fetch = 4,
+    Stats = 5,
+    Shutdown = 6,
+    // Replies
+    Handles = 64,
+    Trajectory = 65,
+    End = 66,
+    Error = 67,
+    StatsReply = 68,
+};
+
+enum class ReplyMode : uint8_t { Handles = 0, Points = 1 };
+
+// Appends fields to a payload
+class Writer {
+private:
+    std::vector<uint8_t> bytes;
+
+public:
+    template <typename T>
+    Writer& put(const T& value) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+        bytes.insert(bytes.end(), p, p + sizeof(T));
+        return *this;
+    }
+    Writer& putString(const std::string& s);
+    Writer& putBox(const BoundingBox3D& box);
+
+    const std::vector<uint8_t>& data() const { return bytes; }
+    void clear() { bytes.clear(); }
+};
+
+// Reads fields of a received payload; throws std::runtime_error past the end
+class Reader {
+private:
+    const std::vector<uint8_t>& bytes;
+    size_t pos = 0;
+
+    void need(size_t n) const {
+        if (bytes.size() - pos < n) throw std::runtime_error("protocol: truncated message");
+    }
+
+public:
+    explicit Reader(const std::vector<uint8_t>& payload) : bytes(payload) {}
+
+    template <typename T>
+    T get() {
+        need(sizeof(T));
+        T value;
+        std::memcpy(&value, bytes.data() + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+    std::string getString();
+    BoundingBox3D getBox();
+    bool done() const { return pos == bytes.size(); }
+};
+
+// ---------------- Framing ----------------
+// Both throw std::runtime_error on socket errors; receiveFrame returns false on a clean
+// end of stream before the first byte of a frame
+void sendFrame(int fd, MessageType type, const std::vector<uint8_t>& payload);
+bool receiveFrame(int fd, MessageType& type, std::vector<uint8_t>& payload);
+
+} // namespace protocol
+
+#endif // SERVICE_PROTOCOL_H
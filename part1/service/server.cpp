@@ -0,0 +1,236 @@
+#include "server.h"
+#include "../api/include/RTreeNode.h"
+#include <iostream>
+#include <stdexcept>
+#include <cerrno>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using protocol::MessageType;
+using protocol::ReplyMode;
+
+// Reply byte of a query; unknown values throw like any other malformed request
+static ReplyMode readReplyMode(protocol::Reader& in) {
+    uint8_t mode = in.get<uint8_t>();
+    if (mode > static_cast<uint8_t>(ReplyMode::Points))
+        throw std::runtime_error("unknown reply mode " + std::to_string(mode));
+    return static_cast<ReplyMode>(mode);
+}
+
+// Handle table in leaf order
+static void collectTrajectories(const RTreeNode& node, std::vector<std::shared_ptr<Trajectory>>& out) {
+    if (node.isLeafNode()) {
+        for (const auto& [_, traj] : node.getLeafEntries()) out.push_back(traj);
+    } else {
+        for (const auto& [_, child] : node.getChildEntries()) collectTrajectories(*child, out);
+    }
+}
+
+// ---------------- Constructors ----------------
+QueryServer::QueryServer(const RTree& tree, const std::string& socketPath, size_t numThreads)
+    : tree(tree), socketPath(socketPath), pool(numThreads) {
+    if (auto root = tree.getRoot()) collectTrajectories(*root, byHandle);
+    handleOf.reserve(byHandle.size());
+    handleById.reserve(byHandle.size());
+    for (uint32_t h = 0; h < byHandle.size(); ++h) {
+        handleOf.emplace(byHandle[h].get(), h);
+        handleById.emplace(byHandle[h]->getId(), h);
+    }
+
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) throw std::invalid_argument("QueryServer socket path too long");
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) throw std::runtime_error("QueryServer cannot create a socket");
+    ::unlink(socketPath.c_str());
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(listenFd, 128) != 0) {
+        ::close(listenFd);
+        throw std::runtime_error("QueryServer cannot listen on " + socketPath);
+    }
+}
+
+QueryServer::~QueryServer() {
+    stop();
+    ::close(listenFd);
+    ::unlink(socketPath.c_str());
+}
+
+// ---------------- Serving ----------------
+void QueryServer::run() {
+    while (!stopping) {
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            break; // listening socket shut down by stop()
+        }
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            if (stopping) {
+                ::close(fd);
+                break;
+            }
+            if (connections.size() >= pool.size()) {
+                refuse(fd); // every worker is held by a connection; queueing would wait on idle clients
+                continue;
+            }
+            connections.insert(fd);
+        }
+        ++connectionCount;
+        pool.submit([this, fd]() { serve(fd); });
+    }
+}
+
+void QueryServer::refuse(int fd) {
+    try {
+        protocol::Writer out;
+        out.putString("server busy: " + std::to_string(pool.size()) + " clients connected");
+        protocol::sendFrame(fd, MessageType::Error, out.data());
+    } catch (const std::exception&) {
+        // the client already went away
+    }
+    ::close(fd);
+}
+
+size_t QueryServer::openConnections() const {
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    return connections.size();
+}
+
+void QueryServer::stop() {
+    std::lock_guard<std::mutex> lock(connectionsMutex);
+    if (stopping.exchange(true)) return;
+    ::shutdown(listenFd, SHUT_RDWR);
+    for (int fd : connections) ::shutdown(fd, SHUT_RDWR); // blocked reads return end of stream
+}
+
+void QueryServer::serve(int fd) {
+    bool shutdownRequested = false;
+    try {
+        MessageType type;
+        std::vector<uint8_t> payload;
+        while (!stopping && protocol::receiveFrame(fd, type, payload)) {
+            ++requests;
+            if (!handle(fd, type, payload)) {
+                shutdownRequested = true;
+                break;
+            }
+        }
+    } catch (const std::exception& e) {
+        if (!stopping) std::cerr << "[QueryServer] Closing connection: " << e.what() << "\n";
+    }
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        connections.erase(fd);
+    }
+    ::close(fd);
+    if (shutdownRequested) stop();
+}
+
+bool QueryServer::handle(int fd, MessageType type, const std::vector<uint8_t>& payload) {
+    protocol::Reader in(payload);
+    protocol::Writer out;
+    auto fail = [&](const std::string& message) {
+        out.clear();
+        protocol::sendFrame(fd, MessageType::Error, out.putString(message).data());
+    };
+    auto lookup = [&](const std::string& trajId, uint32_t& h) {
+        auto it = handleById.find(trajId);
+        if (it == handleById.end()) {
+            fail("unknown trajectory " + trajId);
+            return false;
+        }
+        h = it->second;
+        return true;
+    };
+
+    try {
+        std::vector<std::pair<uint32_t, float>> matches;
+        switch (type) {
+        case MessageType::Range: {
+            BoundingBox3D box = in.getBox();
+            auto mode = readReplyMode(in);
+            std::vector<const Trajectory*> results;
+            tree.rangeQuery(box, results);
+            matches.reserve(results.size());
+            for (const Trajectory* t : results) matches.emplace_back(handleOf.at(t), 0.0f);
+            reply(fd, mode, matches);
+            return true;
+        }
+        case MessageType::KNN: {
+            std::string trajId = in.getString();
+            uint32_t k = in.get<uint32_t>();
+            auto mode = readReplyMode(in);
+            uint32_t q;
+            if (!lookup(trajId, q)) return true;
+            ApproximateKNNResult result = tree.approximateKNearestNeighbors(*byHandle[q], k);
+            for (size_t i = 0; i < result.trajectories.size(); ++i)
+                matches.emplace_back(handleOf.at(result.trajectories[i].get()), result.distances[i]);
+            reply(fd, mode, matches);
+            return true;
+        }
+        case MessageType::Similar: {
+            std::string trajId = in.getString();
+            float threshold = in.get<float>();
+            auto mode = readReplyMode(in);
+            uint32_t q;
+            if (!lookup(trajId, q)) return true;
+            if (auto root = tree.getRoot())
+                root->findSimilar(*byHandle[q], threshold, [&](const std::shared_ptr<Trajectory>& t) {
+                    matches.emplace_back(handleOf.at(t.get()), 0.0f);
+                });
+            reply(fd, mode, matches);
+            return true;
+        }
+        case MessageType::Fetch: {
+            uint32_t count = in.get<uint32_t>();
+            for (uint32_t i = 0; i < count; ++i) {
+                uint32_t h = in.get<uint32_t>();
+                if (h >= byHandle.size()) {
+                    fail("unknown handle " + std::to_string(h));
+                    return true;
+                }
+                matches.emplace_back(h, 0.0f);
+            }
+            reply(fd, ReplyMode::Points, matches);
+            return true;
+        }
+        case MessageType::Stats:
+            out.put<uint64_t>(byHandle.size()).put<uint64_t>(requests.load()).put<uint64_t>(connectionCount.load());
+            protocol::sendFrame(fd, MessageType::StatsReply, out.data());
+            return true;
+        case MessageType::Shutdown:
+            protocol::sendFrame(fd, MessageType::End, out.put<uint32_t>(0).data());
+            return false;
+        default:
+            fail("unknown request type " + std::to_string(static_cast<int>(type)));
+            return true;
+        }
+    } catch (const std::runtime_error& e) {
+        fail(e.what()); // malformed request; the connection stays usable
+        return true;
+    }
+}
+
+void QueryServer::reply(int fd, ReplyMode mode, const std::vector<std::pair<uint32_t, float>>& matches) {
+    protocol::Writer out;
+    if (mode == ReplyMode::Handles) {
+        out.put(static_cast<uint32_t>(matches.size()));
+        for (const auto& [h, distance] : matches) out.put(h).putString(byHandle[h]->getId()).put(distance);
+        protocol::sendFrame(fd, MessageType::Handles, out.data());
+        return;
+    }
+    for (const auto& [h, distance] : matches) sendTrajectory(fd, h, distance, out);
+    out.clear();
+    protocol::sendFrame(fd, MessageType::End, out.put(static_cast<uint32_t>(matches.size())).data());
+}
+
+void QueryServer::sendTrajectory(int fd, uint32_t handle, float distance, protocol::Writer& out) {
+    const Trajectory& traj = *byHandle[handle];
+    out.clear();
+    out.put(handle).put(distance).putString(traj.getId()).put(static_cast<uint32_t>(traj.getPoints().size()));
+    for (const auto& p : traj.getPoints()) out.put(p.getX()).put(p.getY()).put(p.getT());
+    protocol::sendFrame(fd, MessageType::Trajectory, out.data());
+}
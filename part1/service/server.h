@@ -0,0 +1,74 @@
+/*
+ * server.h
+ * ----------
+ * Defines QueryServer, which keeps a loaded RTree in memory and answers range,
+ * kNN and similarity requests from local clients (see protocol.h).
+ *
+ * - Every trajectory gets a handle (its position in a table built once at
+ *   startup); queries reply with handles or stream the matching points
+ * - Each client connection is served by one ThreadPool worker until it
+ *   disconnects, so numThreads bounds the clients served at once; a client
+ *   beyond that gets an Error frame and is disconnected instead of queueing
+ *   behind connections that may stay idle
+ * - The tree is only read and must not be modified while serving; RTree keeps
+ *   its caches current on every modification, so queries never write and
+ *   workers can share it
+ */
+
+#ifndef SERVICE_SERVER_H
+#define SERVICE_SERVER_H
+
+#include "protocol.h"
+#include "../api/include/RTree.h"
+#include "../api/include/threadPool.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+class QueryServer {
+private:
+    const RTree& tree;
+    std::string socketPath;
+    std::vector<std::shared_ptr<Trajectory>> byHandle;         // handle -> trajectory
+    std::unordered_map<const Trajectory*, uint32_t> handleOf;
+    std::unordered_map<std::string, uint32_t> handleById;
+
+    int listenFd = -1;
+    std::atomic<bool> stopping{false};
+    mutable std::mutex connectionsMutex;
+    std::unordered_set<int> connections;                        // open client sockets
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> connectionCount{0};
+    ThreadPool pool;                                            // last member: joined first
+
+    void serve(int fd);
+    void refuse(int fd); // "server busy" Error frame, then close
+    // Handles one request; false once the client asked the server to shut down
+    bool handle(int fd, protocol::MessageType type, const std::vector<uint8_t>& payload);
+    // Handles frame or streamed Trajectory frames + End for (handle, distance) matches
+    void reply(int fd, protocol::ReplyMode mode, const std::vector<std::pair<uint32_t, float>>& matches);
+    void sendTrajectory(int fd, uint32_t handle, float distance, protocol::Writer& writer);
+
+public:
+    // ---------------- Constructors ----------------
+    // Indexes the tree's trajectories and starts listening on socketPath (replacing a stale socket file).
+    // numThreads = 0 uses all hardware threads.
+    QueryServer(const RTree& tree, const std::string& socketPath, size_t numThreads = 0);
+    ~QueryServer();   // stops, joins the workers and removes the socket file
+
+    // ---------------- Serving ----------------
+    void run();       // accepts clients until stop() or a Shutdown request
+    void stop();      // thread-safe; closes the listening socket and open connections
+
+    // ---------------- Info ----------------
+    size_t trajectoryCount() const { return byHandle.size(); }
+    uint64_t requestCount() const { return requests.load(); }
+    uint64_t clientCount() const { return connectionCount.load(); }   // accepted since startup
+    size_t openConnections() const;                                    // currently being served
+};
+
+#endif // SERVICE_SERVER_H
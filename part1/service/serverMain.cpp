@@ -0,0 +1,56 @@
+#include "server.h"
+#include "../api/include/RTree.h"
+#include <iostream>
+#include <filesystem>
+#include <chrono>
+#include <thread>
+#include <csignal>
+#include <pthread.h>
+namespace fs = std::filesystem;
+
+// Usage:
+//   ./server [socketPath] [threads] [parquetDir]
+// Loads the Parquet trajectories once, bulk-loads the RTree and serves queries until
+// SIGINT/SIGTERM or a client's Shutdown request.
+int main(int argc, char* argv[]) {
+    std::string socketPath = argc > 1 ? argv[1] : "/tmp/rtree.sock";
+    size_t numThreads = argc > 2 ? std::stoul(argv[2]) : 0;
+    std::string parquetDir = argc > 3 ? argv[3] : "../preprocessing/trajectories_grouped.parquet";
+
+    // Signals are taken by a dedicated thread (sigwait), so stop() never runs in a handler
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    RTree rtree(8);
+    std::vector<Trajectory> trajectories;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const auto& entry : fs::directory_iterator(parquetDir)) {
+        if (entry.is_regular_file() && entry.path().extension() == ".parquet") {
+            auto partial = rtree.loadFromParquet(entry.path().string());
+            trajectories.insert(trajectories.end(), partial.begin(), partial.end());
+        }
+    }
+    auto summaries = RTree::precomputeSummaries(trajectories);
+    rtree.bulkLoad(trajectories, summaries);
+    std::chrono::duration<double> loadTime = std::chrono::high_resolution_clock::now() - start;
+
+    QueryServer server(rtree, socketPath, numThreads);
+    std::cout << "Serving " << server.trajectoryCount() << " trajectories on " << socketPath
+              << " (loaded in " << loadTime.count() << " s)\n";
+
+    std::thread signalWaiter([&]() {
+        int received = 0;
+        sigwait(&signals, &received);
+        server.stop();
+    });
+    server.run();
+
+    // A Shutdown request ended run(); wake the signal thread so it can be joined
+    pthread_kill(signalWaiter.native_handle(), SIGTERM);
+    signalWaiter.join();
+    std::cout << "Served " << server.requestCount() << " requests from " << server.clientCount() << " clients\n";
+    return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * testHelpers.h
+ * ---------------
+ * Synthetic trajectories and result helpers shared by the tests.
+ *
+ * Trips are random walks starting in a small square at (-75.3, 39.8) (around
+ * Philadelphia, like the taxi data) at a random time after kTripEpoch; TripShape
+ * sets how long and how far they go. With the same rng state a shape always
+ * yields the same trips.
+ *
+ * Header-only; include it from a test's translation unit.
+ */
+
+#ifndef TEST_HELPERS_H
+#define TEST_HELPERS_H
+
+#include "../api/include/trajectory.h"
+#include "../api/include/point3D.h"
+#include "../api/include/bbox3D.h"
+#include <vector>
+#include <set>
+#include <string>
+#include <memory>
+#include <random>
+#include <cstdint>
+
+const int64_t kTripEpoch = 1500000000;
+
+struct TripShape {
+    double days = 1.0;       // start times spread over [kTripEpoch, kTripEpoch + days)
+    int minPoints = 8;       // lengths uniform in [minPoints, maxPoints]
+    int maxPoints = 8;
+    int64_t interval = 60;   // seconds between points
+    float step = 0.002f;     // largest move per point and axis (degrees)
+    float extent = 0.2f;     // side of the square holding the start positions (degrees)
+};
+
+// "<vehicle>_<trip>", the ID format vehicleIdOf splits
+inline std::string tripId(size_t vehicle, size_t trip) {
+    return std::to_string(vehicle) + "_" + std::to_string(trip);
+}
+
+inline Trajectory makeTrip(const std::string& id, std::mt19937& rng, const TripShape& shape = {}) {
+    std::uniform_real_distribution<float> pos(0.0f, 1.0f), step(-shape.step, shape.step);
+    Trajectory t(id);
+    float x = -75.3f + shape.extent * pos(rng), y = 39.8f + shape.extent * pos(rng);
+    int64_t ts = kTripEpoch + static_cast<int64_t>(shape.days * 86400.0 * pos(rng));
+    int points = shape.minPoints;
+    if (shape.maxPoints > shape.minPoints) points = std::uniform_int_distribution<int>(shape.minPoints, shape.maxPoints)(rng);
+    for (int j = 0; j < points; ++j, ts += shape.interval) {
+        t.addPoint(Point3D(x, y, ts));
+        x += step(rng);
+        y += step(rng);
+    }
+    t.precomputeCentroidAndBoundingBox();
+    return t;
+}
+
+// count trips with IDs tripId(i % vehicles, i)
+inline std::vector<Trajectory> makeTrips(size_t count, std::mt19937& rng, const TripShape& shape = {},
+                                         size_t vehicles = 200) {
+    std::vector<Trajectory> trips;
+    trips.reserve(count);
+    for (size_t i = 0; i < count; ++i) trips.push_back(makeTrip(tripId(i % vehicles, i), rng, shape));
+    return trips;
+}
+
+// ------------------ Result IDs ------------------
+inline std::multiset<std::string> ids(const std::vector<Trajectory>& trajs) {
+    std::multiset<std::string> out;
+    for (const auto& t : trajs) out.insert(t.getId());
+    return out;
+}
+
+inline std::multiset<std::string> ids(const std::vector<const Trajectory*>& trajs) {
+    std::multiset<std::string> out;
+    for (const Trajectory* t : trajs) out.insert(t->getId());
+    return out;
+}
+
+inline std::multiset<std::string> ids(const std::vector<std::shared_ptr<Trajectory>>& trajs) {
+    std::multiset<std::string> out;
+    for (const auto& t : trajs) out.insert(t->getId());
+    return out;
+}
+
+inline std::multiset<std::string> ids(const std::vector<std::shared_ptr<const Trajectory>>& trajs) {
+    std::multiset<std::string> out;
+    for (const auto& t : trajs) out.insert(t->getId());
+    return out;
+}
+
+// IDs of the trajectories whose box intersects box
+inline std::multiset<std::string> bruteForce(const std::vector<Trajectory>& trajs, const BoundingBox3D& box) {
+    std::multiset<std::string> out;
+    for (const auto& t : trajs)
+        if (box.intersects(t.getBoundingBox())) out.insert(t.getId());
+    return out;
+}
+
+#endif // TEST_HELPERS_H
@@ -43,10 +43,19 @@ int main() {
     assert(bb2.contains(inside));
     assert(!bb2.contains(outside));
 
+    // -------------------- Test contains(BoundingBox3D) --------------------
+    assert(bb2.contains(bb3));
+    assert(bb2.contains(bb2));
+    assert(!bb2.contains(bb4)); // overlaps but sticks out
+    assert(!bb3.contains(bb2));
+
     // -------------------- Test volume --------------------
     float vol = bb2.volume();
     std::cout << "BoundingBox3D volume: " << vol << "\n";
     assert(vol > 0.0f);
+    assert(bb2.overlapVolume(bb2) == vol);
+    assert(bb2.overlapVolume(bb5) == 0.0f);
+    std::cout << "Overlap volume with bb4: " << bb2.overlapVolume(bb4) << "\n";
 
     // -------------------- Test distance calculations --------------------
     float dist2 = bb2.spatialDistanceSquared(bb5);
@@ -0,0 +1,96 @@
+#include "../api/include/columnarScan.h"
+#include "../api/include/trajectory.h"
+#include "../api/include/bbox3D.h"
+#include "../api/include/point3D.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+// ------------------ Helper Functions ------------------
+std::vector<Trajectory> makeTrajectories(int count) {
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < count; ++i) {
+        Trajectory t("veh" + std::to_string(i % 7) + "_" + std::to_string(i));
+        for (int j = 0; j < 6; ++j) {
+            float x = -75.3f + 0.001f * ((i * 37) % 200) + 0.0005f * j;
+            float y = 39.9f + 0.001f * ((i * 11) % 150) - 0.0003f * j;
+            t.addPoint(Point3D(x, y, 1500000000 + i * 5 + j * 5));
+        }
+        t.precomputeCentroidAndBoundingBox();
+        trajs.push_back(t);
+    }
+    return trajs;
+}
+
+// ------------------ Range Query Test ------------------
+void testColumnarRangeQuery(const std::vector<Trajectory>& trajs, const ColumnarScan& scan) {
+    std::cout << "\n=== testColumnarRangeQuery ===\n";
+    BoundingBox3D queryBox(-75.2f, 39.95f, 1500002000, -75.15f, 40.0f, 1500010000);
+
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < trajs.size(); ++i)
+        if (trajs[i].getBoundingBox().intersects(queryBox)) expected.push_back(i);
+
+    for (size_t threads : {1, 3, 8}) {
+        auto result = scan.rangeQuery(queryBox, threads);
+        std::sort(result.begin(), result.end());
+        std::cout << "Threads " << threads << ": " << result.size() << " hits\n";
+        assert(result == expected);
+    }
+}
+
+// ------------------ kNN Test ------------------
+void testColumnarKNN(const std::vector<Trajectory>& trajs, const ColumnarScan& scan) {
+    std::cout << "\n=== testColumnarKNN ===\n";
+    const Trajectory& query = trajs[42];
+    size_t k = 10;
+
+    std::vector<std::pair<float, size_t>> all;
+    for (size_t i = 0; i < trajs.size(); ++i)
+        if (i != 42) all.emplace_back(query.approximateDistance(trajs[i], 1e-5f), i);
+    std::sort(all.begin(), all.end());
+
+    for (size_t threads : {1, 4}) {
+        auto result = scan.kNearest(query, k, 1e-5f, 42, threads);
+        assert(result.size() == k);
+        for (size_t i = 0; i < k; ++i) {
+            // Ties may swap order, distances must match exactly
+            assert(scan.approximateDistance(query, result[i], 1e-5f) == all[i].first);
+            assert(result[i] != 42);
+        }
+    }
+    std::cout << "kNN distances match brute force\n";
+}
+
+// ------------------ Distance Threshold Test ------------------
+void testColumnarWithinDistance(const std::vector<Trajectory>& trajs, const ColumnarScan& scan) {
+    std::cout << "\n=== testColumnarWithinDistance ===\n";
+    const Trajectory& query = trajs[7];
+    float threshold = 0.01f;
+
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < trajs.size(); ++i)
+        if (i != 7 && query.approximateDistance(trajs[i], 1e-5f) <= threshold) expected.push_back(i);
+
+    auto result = scan.withinDistance(query, threshold, 1e-5f, 7, 4);
+    std::sort(result.begin(), result.end());
+    std::cout << "Within " << threshold << ": " << result.size() << " candidates\n";
+    assert(result == expected);
+}
+
+// ------------------ Main ------------------
+int main() {
+    auto trajs = makeTrajectories(3000);
+    ColumnarScan scan(trajs);
+    assert(scan.size() == trajs.size());
+    std::cout << "Columnar memory: " << scan.memoryUsage() << " bytes\n";
+
+    testColumnarRangeQuery(trajs, scan);
+    testColumnarKNN(trajs, scan);
+    testColumnarWithinDistance(trajs, scan);
+
+    std::cout << "\n=== All ColumnarScan tests completed successfully ===\n";
+    return 0;
+}
@@ -0,0 +1,129 @@
+#include "../api/include/compressedTrajectory.h"
+#include "../api/include/trajectory.h"
+#include "../api/include/point3D.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <random>
+#include <chrono>
+
+// ------------------ Helper Functions ------------------
+// 1 Hz GPS-like trace with small steps and occasional sampling gaps
+Trajectory makeTrace(const std::string& id, size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> step(0.0f, 0.00005f);
+    std::uniform_int_distribution<int> gap(0, 50);
+
+    Trajectory t(id);
+    float x = -75.16f, y = 39.95f;
+    int64_t ts = 1500000000;
+    for (size_t i = 0; i < n; ++i) {
+        t.addPoint(Point3D(x, y, ts));
+        x += step(rng);
+        y += step(rng);
+        ts += gap(rng) == 0 ? 30 : 1;
+    }
+    t.precomputeCentroidAndBoundingBox();
+    return t;
+}
+
+// ------------------ Round Trip Test ------------------
+void testRoundTrip() {
+    std::cout << "\n=== testRoundTrip ===\n";
+    for (size_t n : {size_t(1), size_t(2), size_t(127), size_t(128), size_t(129), size_t(1000)}) {
+        Trajectory original = makeTrace("rt_" + std::to_string(n), n, static_cast<unsigned>(n));
+        CompressedTrajectory c(original);
+
+        assert(c.size() == n);
+        assert(c.blockCount() == (n + CompressedTrajectory::kBlockSize - 1) / CompressedTrajectory::kBlockSize);
+        assert(c.getBoundingBox() == original.getBoundingBox());
+        assert(c.decodePoints() == original.getPoints()); // exact for |coord| >= 1
+
+        Trajectory decoded = c.decode();
+        assert(decoded == original);
+        assert(decoded.getBoundingBox() == original.getBoundingBox());
+
+        std::cout << n << " points -> " << c.memoryUsage() << " B (raw "
+                  << n * sizeof(Point3D) << " B)\n";
+    }
+}
+
+// ------------------ Random Access Test ------------------
+void testRandomAccess() {
+    std::cout << "\n=== testRandomAccess ===\n";
+    Trajectory original = makeTrace("ra", 1000, 3);
+    CompressedTrajectory c(original);
+    for (size_t i : {size_t(0), size_t(127), size_t(128), size_t(500), size_t(999)})
+        assert(c.pointAt(i) == original.getPoints()[i]);
+
+    std::vector<Point3D> block;
+    c.decodeBlock(2, block);
+    assert(block.size() == CompressedTrajectory::kBlockSize);
+    assert(block.front() == original.getPoints()[256]);
+    std::cout << "Block and point access match the original\n";
+}
+
+// ------------------ Compression Ratio Test ------------------
+void testCompressionRatio() {
+    std::cout << "\n=== testCompressionRatio ===\n";
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 200; ++i) trajs.push_back(makeTrace("cr_" + std::to_string(i), 600, 100 + i));
+
+    size_t raw = 0, compressed = 0, points = 0;
+    std::vector<CompressedTrajectory> encoded;
+    for (const auto& t : trajs) {
+        encoded.emplace_back(t);
+        raw += t.getPoints().size() * sizeof(Point3D);
+        compressed += encoded.back().memoryUsage();
+    }
+
+    std::vector<Point3D> buffer;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (const auto& c : encoded) {
+        buffer.clear();
+        for (size_t b = 0; b < c.blockCount(); ++b) c.decodeBlock(b, buffer);
+        points += buffer.size();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    std::cout << "Raw: " << raw << " B, compressed: " << compressed << " B ("
+              << static_cast<double>(raw) / compressed << "x)\n";
+    std::cout << "Decode: " << points / seconds / 1e6 << " M points/s\n";
+    assert(compressed * 2 < raw);
+}
+
+// ------------------ Store Test ------------------
+void testStoreHotSet() {
+    std::cout << "\n=== testStoreHotSet ===\n";
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 10; ++i) trajs.push_back(makeTrace("st_" + std::to_string(i), 300, i));
+
+    CompressedTrajectoryStore store(trajs, 3);
+    assert(store.size() == 10);
+
+    auto a = store.get(0);
+    auto b = store.get(0);
+    assert(a == b && *a == trajs[0]);   // second access served from the hot set
+    assert(store.hitCount() == 1 && store.missCount() == 1);
+
+    for (size_t i = 1; i < 5; ++i) store.get(i); // evicts index 0
+    store.get(0);
+    assert(store.missCount() == 6);
+    assert(store.hotBytes() <= 3 * 300 * sizeof(Point3D));
+
+    assert(store.get("st_7") && store.get("st_7")->getId() == "st_7");
+    assert(!store.get("missing"));
+    std::cout << "Compressed: " << store.compressedBytes() << " B, hot: " << store.hotBytes() << " B\n";
+}
+
+// ------------------ Main ------------------
+int main() {
+    testRoundTrip();
+    testRandomAccess();
+    testCompressionRatio();
+    testStoreHotSet();
+
+    std::cout << "\n=== All CompressedTrajectory tests completed successfully ===\n";
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "../api/include/concurrentRTree.h"
+#include "testHelpers.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <set>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+// ------------------ Helper Functions ------------------
+// One day, 8 points a minute apart
+const TripShape kShape{1.0, 8, 8, 60, 0.001f};
+
+const BoundingBox3D kAll(-76.0f, 39.0f, 1400000000, -74.0f, 41.0f, 1600000000);
+const BoundingBox3D kPart(-75.25f, 39.85f, 1500010000, -75.15f, 39.95f, 1500050000);
+
+// ------------------ Insert / Remove / Update ------------------
+void testModifications() {
+    std::cout << "\n=== testModifications ===\n";
+    std::mt19937 rng(1);
+    std::vector<Trajectory> trajs;
+    ConcurrentRTree tree(6);
+    for (int i = 0; i < 1500; ++i) {
+        trajs.push_back(makeTrip("t" + std::to_string(i), rng, kShape));
+        tree.insert(trajs.back());
+    }
+    assert(tree.size() == 1500);
+    assert(ids(tree.rangeQuery(kPart)) == bruteForce(trajs, kPart));
+
+    // Snapshots are isolated from later writes
+    auto before = tree.snapshot();
+    for (int i = 0; i < 500; ++i) assert(tree.remove("t" + std::to_string(i)));
+    assert(!tree.remove("t0"));
+    trajs.erase(trajs.begin(), trajs.begin() + 500);
+    for (int i = 0; i < 100; ++i) {
+        trajs[i] = makeTrip(trajs[i].getId(), rng, kShape);
+        assert(tree.update(trajs[i]));
+    }
+    assert(!tree.update(makeTrip("fresh", rng, kShape)));
+    assert(tree.remove("fresh"));
+
+    assert(before.size() == 1500 && before.rangeQuery(kAll).size() == 1500);
+    assert(tree.size() == 1000 && tree.snapshot().version() > before.version());
+    assert(ids(tree.rangeQuery(kPart)) == bruteForce(trajs, kPart));
+    assert(ids(tree.rangeQuery(kAll)) == bruteForce(trajs, kAll));
+    std::cout << "Height after 1500 inserts / 500 removals: " << tree.snapshot().height() << "\n";
+}
+
+// ------------------ Bulk Load and kNN ------------------
+void testBulkLoadAndKNN() {
+    std::cout << "\n=== testBulkLoadAndKNN ===\n";
+    std::mt19937 rng(2);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 2000; ++i) trajs.push_back(makeTrip("b" + std::to_string(i), rng, kShape));
+
+    ConcurrentRTree tree(8);
+    tree.bulkLoad(trajs);
+    assert(tree.size() == trajs.size());
+    assert(ids(tree.rangeQuery(kPart)) == bruteForce(trajs, kPart));
+
+    // Same distances as a brute-force kNN
+    const Trajectory& query = trajs[42];
+    std::vector<float> expected;
+    for (const auto& t : trajs)
+        if (t.getId() != query.getId()) expected.push_back(query.spatioTemporalDistanceTo(t, 1e-5f));
+    std::sort(expected.begin(), expected.end());
+    auto got = tree.kNearestNeighbors(query, 5);
+    assert(got.size() == 5);
+    for (size_t i = 0; i < got.size(); ++i) assert(query.spatioTemporalDistanceTo(*got[i], 1e-5f) == expected[i]);
+
+    // Removal still works on the bulk-loaded tree
+    assert(tree.remove("b7") && tree.size() == trajs.size() - 1);
+}
+
+// ------------------ Readers During Writes ------------------
+void testConcurrentReaders() {
+    std::cout << "\n=== testConcurrentReaders ===\n";
+    std::mt19937 rng(3);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 3000; ++i) trajs.push_back(makeTrip("c" + std::to_string(i), rng, kShape));
+    ConcurrentRTree tree(8);
+    tree.bulkLoad(trajs);
+
+    std::atomic<bool> done{false};
+    std::atomic<size_t> queries{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 4; ++r) {
+        readers.emplace_back([&]() {
+            uint64_t lastVersion = 0;
+            while (!done.load()) {
+                auto snap = tree.snapshot();
+                assert(snap.version() >= lastVersion);   // versions never go back
+                lastVersion = snap.version();
+                assert(snap.rangeQuery(kAll).size() == snap.size()); // each snapshot is internally consistent
+                snap.rangeQuery(kPart);
+                queries += 2;
+            }
+        });
+    }
+
+    // Writer: move existing trips, add new ones, remove old ones
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < 2000; ++i) {
+        if (i % 2 == 0) tree.update(makeTrip("c" + std::to_string(i), rng, kShape));
+        else tree.insert(makeTrip("n" + std::to_string(i), rng, kShape));
+        if (i % 4 == 1) tree.remove("c" + std::to_string(i));
+    }
+    done = true;
+    for (auto& r : readers) r.join();
+    double seconds = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+    assert(tree.size() == 3000 + 1000 - 500);
+    std::cout << "2000 writes with 4 readers: " << queries.load() << " queries in " << seconds << " s\n";
+}
+
+// ------------------ Main ------------------
+int main() {
+    testModifications();
+    testBulkLoadAndKNN();
+    testConcurrentReaders();
+
+    std::cout << "\n=== All ConcurrentRTree tests completed successfully ===\n";
+    return 0;
+}
@@ -0,0 +1,169 @@
+#include "../api/include/csvIngest.h"
+#include "../api/include/trajectory.h"
+#include <iostream>
+#include <fstream>
+#include <cassert>
+#include <vector>
+#include <string>
+#include <random>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <cstdio>
+
+// ------------------ Helper Functions ------------------
+void writeFile(const std::string& path, const std::string& content) {
+    std::ofstream out(path, std::ios::binary);
+    out << content;
+}
+
+int64_t epochOf(int year, int month, int day, int hour, int minute, int second) {
+    std::tm tm = {};
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = hour;
+    tm.tm_min = minute;
+    tm.tm_sec = second;
+    return static_cast<int64_t>(timegm(&tm));
+}
+
+// ------------------ Parsers ------------------
+void testParseDouble() {
+    std::cout << "\n=== testParseDouble ===\n";
+    const char* samples[] = {"39.9526", "-75.16522", "0", "-0.5", "+12.25", "1e3", "3.25E-2", "40.00000000000000000001",
+                             "12345678901234567890.5", ".5", "7."};
+    for (const char* s : samples) {
+        double value;
+        assert(csvIngest::parseDouble(s, s + std::strlen(s), value));
+        assert(value == std::strtod(s, nullptr));
+    }
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> u(-180.0, 180.0);
+    for (int i = 0; i < 10000; ++i) {
+        char buf[32];
+        int n = std::snprintf(buf, sizeof(buf), "%.*f", 1 + i % 9, u(rng));
+        double value;
+        assert(csvIngest::parseDouble(buf, buf + n, value) && value == std::strtod(buf, nullptr));
+    }
+    const char* bad[] = {"", "-", "abc", "1.2.3", "4e", "12x", "1 2"};
+    for (const char* s : bad) {
+        double value;
+        assert(!csvIngest::parseDouble(s, s + std::strlen(s), value));
+    }
+}
+
+void testParseTimestamp() {
+    std::cout << "\n=== testParseTimestamp ===\n";
+    auto parse = [](const char* s, int64_t& t) { return csvIngest::parseTimestamp(s, s + std::strlen(s), t); };
+    int64_t t;
+    assert(parse("2017-06-01 08:30:15", t) && t == epochOf(2017, 6, 1, 8, 30, 15));
+    assert(parse("2016-02-29T23:59:59", t) && t == epochOf(2016, 2, 29, 23, 59, 59));
+    assert(parse("1970-01-01 00:00:00", t) && t == 0);
+    assert(parse("1969-12-31 23:59:59", t) && t == -1);
+    for (const char* s : {"2017-02-29 00:00:00", "2017-13-01 00:00:00", "2017-06-01 24:00:00", "2017-06-01",
+                          "2017/06/01 08:30:15", "2017-06-01 08:30:1x", ""})
+        assert(!parse(s, t));
+}
+
+// ------------------ Load ------------------
+void testLoadSmall() {
+    std::cout << "\n=== testLoadSmall ===\n";
+    // Driver and trip strings are unordered; ranks follow string order as in preprocess.py
+    writeFile("/tmp/test_csvingest_summary.csv",
+              "trip_id,driver_id,distance\r\n"
+              "tripB,drvZ,1.0\r\n"
+              "tripA,drvY,2.0\r\n"
+              "\"tripC\",drvY,3.0\r\n");
+    writeFile("/tmp/test_csvingest_points.csv",
+              "latitude,longitude,timestamp,trip_id\r\n"
+              "39.95,-75.16,2017-06-01 08:00:20,tripA\r\n"
+              "39.96,-75.17,2017-06-01 08:00:10,tripB\r\n"
+              "\"39.97\",\"-75.18\",\"2017-06-01 08:00:00\",\"tripA\"\r\n"
+              "39.90,-75.10,2017-06-01 08:00:00,tripUnknown\r\n"
+              "39.91,-75.11,2017-06-01 8:00:00,tripB\r\n"
+              ",-75.12,2017-06-01 08:00:30,tripB\r\n"
+              "39.92,-75.13,2017-06-01 08:00:40,tripC\r\n");
+
+    CsvIngestStats stats;
+    TrajectoryColumns c = csvIngest::load("/tmp/test_csvingest_summary.csv", "/tmp/test_csvingest_points.csv", 2, &stats);
+    assert(stats.summaryTrips == 3 && stats.vehicles == 2);
+    assert(stats.rowsRead == 7 && stats.rowsKept == 4 && stats.unknownTripRows == 1 && stats.malformedRows == 2);
+
+    // tripA=1, tripB=2, tripC=3; drvY=1, drvZ=2 -> order (1,1), (1,3), (2,2)
+    assert(c.rows() == 4 && c.trips() == 3);
+    assert((c.tripStart == std::vector<size_t>{0, 2, 3, 4}));
+    assert((c.vehicleId == std::vector<int32_t>{1, 1, 1, 2}));
+    assert((c.tripId == std::vector<int32_t>{1, 1, 3, 2}));
+    int64_t base = epochOf(2017, 6, 1, 8, 0, 0);
+    assert((c.t == std::vector<int64_t>{base, base + 20, base + 40, base + 10}));
+    assert(c.x[0] == -75.18f && c.y[0] == 39.97f && c.x[1] == -75.16f && c.y[1] == 39.95f);
+
+    auto trajectories = c.toTrajectories();
+    assert(trajectories.size() == 3);
+    assert(trajectories[0].getId() == "1_1" && trajectories[1].getId() == "1_3" && trajectories[2].getId() == "2_2");
+    assert(trajectories[0].getPoints().size() == 2 && trajectories[0].getPoints()[0].getT() == base);
+    assert(trajectories[0].getBoundingBox().getMinX() == -75.18f);
+
+    bool threw = false;
+    try {
+        csvIngest::load("/tmp/test_csvingest_points.csv", "/tmp/test_csvingest_points.csv");
+    } catch (const std::runtime_error&) {
+        threw = true; // no driver_id column
+    }
+    assert(threw);
+}
+
+void testThreadCountsAgree() {
+    std::cout << "\n=== testThreadCountsAgree ===\n";
+    std::mt19937 rng(11);
+    std::string summary = "trip_id,driver_id\n";
+    for (int i = 0; i < 300; ++i) summary += "trip" + std::to_string(rng() % 100000) + ",d" + std::to_string(i % 37) + "\n";
+    writeFile("/tmp/test_csvingest_summary.csv", summary);
+
+    std::vector<std::string> trips;
+    for (size_t p = 0; (p = summary.find('\n', p)) != std::string::npos && p + 1 < summary.size(); ++p)
+        trips.push_back(summary.substr(p + 1, summary.find(',', p) - p - 1));
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::string points = "trip_id,timestamp,latitude,longitude\n";
+    for (int i = 0; i < 20000; ++i) {
+        char line[128];
+        std::time_t t = 1496300000 + static_cast<std::time_t>(u(rng) * 86400 * 30);
+        std::tm tm;
+        gmtime_r(&t, &tm);
+        char stamp[32];
+        std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &tm);
+        std::snprintf(line, sizeof(line), "%s,%s,%.6f,%.6f\n", trips[rng() % trips.size()].c_str(), stamp,
+                      39.8 + 0.3 * u(rng), -75.3 + 0.3 * u(rng));
+        points += line;
+    }
+    writeFile("/tmp/test_csvingest_points.csv", points);
+
+    CsvIngestStats one, four;
+    auto a = csvIngest::load("/tmp/test_csvingest_summary.csv", "/tmp/test_csvingest_points.csv", 1, &one);
+    auto b = csvIngest::load("/tmp/test_csvingest_summary.csv", "/tmp/test_csvingest_points.csv", 4, &four);
+    assert(one.rowsKept == 20000 && four.rowsKept == 20000);
+    assert(a.vehicleId == b.vehicleId && a.tripId == b.tripId && a.tripStart == b.tripStart);
+    assert(a.x == b.x && a.y == b.y && a.t == b.t);
+    for (size_t i = 0; i + 1 < a.trips(); ++i) {
+        size_t s = a.tripStart[i], e = a.tripStart[i + 1];
+        assert(e > s && std::is_sorted(a.t.begin() + s, a.t.begin() + e));
+        size_t n = a.tripStart[i + 1];
+        assert(std::make_pair(a.vehicleId[s], a.tripId[s]) < std::make_pair(a.vehicleId[n], a.tripId[n]));
+    }
+    std::cout << a.trips() << " trips, parse " << four.parseSeconds << " s on 4 threads\n";
+    std::remove("/tmp/test_csvingest_summary.csv");
+    std::remove("/tmp/test_csvingest_points.csv");
+}
+
+// ------------------ Main ------------------
+int main() {
+    testParseDouble();
+    testParseTimestamp();
+    testLoadSmall();
+    testThreadCountsAgree();
+
+    std::cout << "\n=== All CSV ingest tests completed successfully ===\n";
+    return 0;
+}
@@ -8,6 +8,8 @@
 #include <iostream>
 #include <vector>
 #include <filesystem>
+#include <fstream>
+#include <cassert>
 
 namespace fs = std::filesystem;
 
@@ -87,6 +89,199 @@ void runSimilarityQueries(Evaluation& eval, const std::vector<Trajectory>& traje
     }
 }
 
+// ---------------- Run Approximate kNN Curve ----------------
+void runApproximateKNNCurve(Evaluation& eval, const std::vector<Trajectory>& trajectories) {
+    std::cout << "\n=== Approximate kNN Curve ===\n";
+    std::vector<std::string> ids;
+    for (size_t i = 0; i < trajectories.size() && ids.size() < 20; i += std::max<size_t>(1, trajectories.size() / 20))
+        ids.push_back(trajectories[i].getId());
+
+    std::vector<ApproximateKNNOptions> settings;
+    for (float eps : {0.0f, 0.1f, 0.5f, 1.0f, 2.0f}) {
+        ApproximateKNNOptions o;
+        o.epsilon = eps;
+        settings.push_back(o);
+    }
+    for (size_t cap : {10, 20, 50}) {
+        ApproximateKNNOptions o;
+        o.maxRefinements = cap;
+        settings.push_back(o);
+    }
+
+    for (const auto& s : eval.runApproximateKNNCurve(ids, 10, settings)) {
+        std::cout << "eps=" << s.options.epsilon << " maxRefinements=" << s.options.maxRefinements
+                  << " recall=" << s.meanRecall << " latency=" << s.meanLatency
+                  << " (exact " << s.exactMeanLatency << ")\n";
+        if (s.options.epsilon == 0.0f && s.options.maxRefinements == 0) assert(s.meanRecall == 1.0);
+    }
+}
+
+// ---------------- Run Compression Benchmark ----------------
+void runCompressionBenchmark(Evaluation& eval) {
+    std::cout << "\n=== Compression Benchmark ===\n";
+    CompressionStats cs = eval.runCompressionBenchmark();
+    std::cout << "Compressed points: " << cs.rawPointBytes << " B -> " << cs.compressedBytes << " B ("
+              << cs.ratio << "x, " << cs.bytesPerPoint << " B/point), decode "
+              << cs.decodeThroughput / 1e6 << " M points/s\n";
+}
+
+// ---------------- Run Similarity Join ----------------
+void runSimilarityJoin(Evaluation& eval) {
+    std::cout << "\n=== Similarity Join ===\n";
+    for (size_t threads : {1, 4}) {
+        auto report = eval.runSimilarityJoin(0.001f, threads, threads == 1);
+        std::cout << "threads=" << threads << " pairs=" << report.join.pairs
+                  << " join=" << report.joinTime << "s bulkLoad=" << report.bulkLoadTime
+                  << "s findSimilar x n ~ " << report.perQueryEstimate << "s\n";
+    }
+}
+
+// ---------------- Run Aggregate Queries ----------------
+void runAggregateQueries(Evaluation& eval) {
+    std::cout << "\n=== Aggregate Queries ===\n";
+    std::vector<WorkloadQuery> windows;
+    for (const std::string city : {"Philadelphia", "Atlanta", "Memphis"})
+        windows.push_back({"rangeQuery", city, "2017-01-01T00:00:00Z", "2018-01-01T00:00:00Z"});
+
+    for (const auto& s : eval.runAggregateQueries(windows)) {
+        std::cout << s.city << ": count=" << s.aggregate.count << " vehicles~" << s.aggregate.distinctVehicles
+                  << " (exact " << s.exactVehicles << ") aggregate=" << s.aggregateTime
+                  << "s rangeQuery=" << s.rangeTime << "s\n";
+        assert(s.aggregate.count == s.rangeCount);
+    }
+}
+
+// ---------------- Run Density Grid ----------------
+void runDensityGrid(Evaluation& eval) {
+    std::cout << "\n=== Density Grid ===\n";
+    for (int64_t bucket : {int64_t(0), int64_t(30 * 86400)}) {
+        auto s = eval.runDensityGrid("Philadelphia", "2017-01-01T00:00:00Z", "2018-01-01T00:00:00Z", 512, bucket, 0, bucket == 0);
+        std::cout << "512x512 buckets=" << s.buckets << ": " << s.points << " points, grid=" << s.gridTime
+                  << "s, rangeQuery+binning=" << s.baselineTime << "s\n";
+        assert(s.matchesBaseline);
+    }
+}
+
+// ---------------- Run Batch Range Query ----------------
+void runBatchRangeQuery(Evaluation& eval) {
+    std::cout << "\n=== Batch Range Query ===\n";
+    auto s = eval.runBatchRangeQuery("Philadelphia", "2017-01-01T00:00:00Z", "2018-01-01T00:00:00Z", 32, 0);
+    std::cout << s.tiles << " tiles, " << s.results << " results: batch=" << s.batchTime
+              << "s, rangeQuery loop=" << s.loopTime << "s\n";
+    assert(s.matchesLoop);
+}
+
+// ---------------- Run Query Planner ----------------
+void runQueryPlanner(Evaluation& eval) {
+    std::cout << "\n=== Query Planner ===\n";
+    // The note.txt examples, the last one spanning the whole dataset, plus city windows
+    std::vector<WorkloadQuery> windows = {
+        {"rangeQuery", "All", "2017-07-15T09:00:00Z", "2017-09-20T17:00:00Z"},
+        {"rangeQuery", "All", "2018-08-15T14:30:00Z", "2025-02-03T09:45:00Z"},
+        {"rangeQuery", "All", "2018-03-01T08:00:00Z", "2018-03-01T09:00:00Z"},
+        {"rangeQuery", "Philadelphia", "2017-12-03T14:30:00Z", "2018-04-05T19:00:00Z"},
+        {"rangeQuery", "Atlanta", "2018-06-10T08:00:00Z", "2018-06-10T12:30:00Z"},
+    };
+    for (const auto& s : eval.runQueryPlanner(windows)) {
+        std::cout << s.city << " [" << s.startTime << " - " << s.endTime << "]: "
+                  << QueryPlanner::strategyName(s.plan.strategy) << " rows~" << s.plan.estimatedRows
+                  << " (actual " << s.actualRows << ") index=" << s.seconds[0] << "s scan=" << s.seconds[1]
+                  << "s time=" << s.seconds[2] << "s" << (s.choseFastest ? "" : " (not the fastest)") << "\n";
+    }
+}
+
+// ---------------- Run Concurrent Ingest ----------------
+void runConcurrentIngest(Evaluation& eval) {
+    std::cout << "\n=== Concurrent Ingest ===\n";
+    auto s = eval.runConcurrentIngest(4, 1000.0, 2.0);
+    std::cout << "readers=" << s.readers << " idle=" << s.idleQps << " q/s, during ingest=" << s.ingestQps
+              << " q/s, " << s.updates << " updates (" << s.meanUpdateLatency * 1e6 << " us each)\n";
+    assert(s.updates > 0);
+}
+
+// ---------------- Run Paged R-Tree ----------------
+void runPagedRTree(Evaluation& eval) {
+    std::cout << "\n=== Paged R-Tree ===\n";
+    for (const auto& s : eval.runPagedRTree("Philadelphia", "2017-01-01T00:00:00Z", "2018-01-01T00:00:00Z", 8,
+                                            {64, 1024, 16384})) {
+        std::cout << (s.policy == EvictionPolicy::LRU ? "LRU" : "Clock") << " pool=" << s.poolPages
+                  << " faults/query=" << s.faultsPerQuery << " bytes/query=" << s.bytesPerQuery
+                  << " heap hit rate=" << s.heapHitRate << " latency=" << s.meanLatency << "s\n";
+        assert(s.matchesRTree);
+    }
+}
+
+// ---------------- Run Sharded R-Tree ----------------
+void runShardedRTree(Evaluation& eval, const std::vector<Trajectory>& trajectories) {
+    std::cout << "\n=== Sharded R-Tree ===\n";
+    std::vector<std::string> knnIds;
+    for (size_t i = 0; i < trajectories.size() && knnIds.size() < 20; i += trajectories.size() / 20 + 1)
+        knnIds.push_back(trajectories[i].getId());
+    for (const auto& s : eval.runShardedRTree("Philadelphia", "2017-01-01T00:00:00Z", "2018-01-01T00:00:00Z", knnIds, 10,
+                                              {4, 16, 32}, 0)) {
+        std::cout << (s.scheme == ShardingScheme::SpatialTiles ? "SpatialTiles" : "VehicleHash") << " shards=" << s.shards
+                  << " range=" << s.rangeLatency << "s (single " << s.singleRangeLatency << "s) kNN=" << s.knnLatency
+                  << "s (single " << s.singleKnnLatency << "s)\n";
+        assert(s.matchesRTree);
+    }
+}
+
+// ---------------- Run Query Deadlines ----------------
+void runQueryDeadlines(Evaluation& eval, const std::vector<Trajectory>& trajectories) {
+    std::cout << "\n=== Query Deadlines ===\n";
+    std::vector<std::string> ids;
+    for (size_t i = 0; i < trajectories.size() && ids.size() < 50; i += trajectories.size() / 50 + 1)
+        ids.push_back(trajectories[i].getId());
+    auto statsList = eval.runQueryDeadlines("Philadelphia", "2017-01-01T00:00:00Z", "2018-01-01T00:00:00Z", 8, ids,
+                                            0.01f, {0.0, 0.05, 0.005});
+    for (const auto& s : statsList) {
+        std::cout << "deadline=" << s.deadline << "s completed=" << s.completed << "/" << s.queries
+                  << " results=" << s.resultFraction << " p99=" << s.p99Latency << "s\n";
+        assert(s.resultFraction <= 1.0);
+    }
+    assert(statsList[0].completed == statsList[0].queries && statsList[0].resultFraction == 1.0);
+}
+
+// ---------------- Run Lazy Parquet Store ----------------
+void runLazyParquetStore(Evaluation& eval, const std::string& parquetDir) {
+    std::cout << "\n=== Lazy Parquet Store ===\n";
+    for (const auto& s : eval.runLazyParquetStore(parquetDir, "Philadelphia", "2017-01-01T00:00:00Z",
+                                                  "2018-01-01T00:00:00Z", 8, {0, 100000, 10000000})) {
+        std::cout << "cache=" << s.cachePoints << " points open=" << s.openTime << "s memory=" << s.memoryBytes
+                  << " row groups/query=" << s.rowGroupsPerQuery << " hit rate=" << s.hitRate
+                  << " latency=" << s.meanLatency << "s\n";
+        assert(s.matchesRTree);
+    }
+}
+
+// ---------------- Run Workload Replay ----------------
+void runWorkloadReplay(Evaluation& eval, const std::vector<Trajectory>& trajectories) {
+    std::cout << "\n=== Workload Replay Tests ===\n";
+    std::string workloadFile = "results/test_workload.csv";
+    {
+        std::ofstream out(workloadFile);
+        out << "type,city,startTime,endTime,trajId,k,threshold\n";
+        out << "rangeQuery,Philadelphia,2017-01-01T00:00:00Z,2017-06-01T00:00:00Z,,,\n";
+        out << "rangeQuery,Atlanta,2017-06-01T00:00:00Z,2018-01-01T00:00:00Z,,,\n";
+        out << "kNearestNeighbors,,,," << trajectories[1].getId() << ",5,\n";
+        out << "findSimilar,,,," << trajectories[1].getId() << ",,0.01\n";
+    }
+
+    auto workload = Evaluation::loadWorkload(workloadFile);
+    assert(workload.size() == 4);
+    assert(workload[2].k == 5);
+
+    for (size_t threads : {1, 4}) {
+        auto statsList = eval.runWorkload(workload, threads, true);
+        for (const auto& ws : statsList) {
+            std::cout << "Workload " << ws.type << " threads=" << threads
+                      << " count=" << ws.count << " p50=" << ws.p50Latency
+                      << " p99=" << ws.p99Latency << "\n";
+            assert(ws.p50Latency <= ws.p95Latency && ws.p95Latency <= ws.p99Latency);
+        }
+    }
+}
+
 // ---------------- Main ----------------
 int main() {
     std::cout << "=== Evaluation Test on Real Parquet Data ===\n";
@@ -110,9 +305,7 @@ int main() {
     // -----------------------------
     // Step 2: Precompute centroids & bounding boxes
     // -----------------------------
-    for (auto& traj : trajectories) {
-    traj.precomputeCentroidAndBoundingBox();
-    }
+    auto summaries = RTree::precomputeSummaries(trajectories);
 
     // -----------------------------
     // Step 3: Keep a copy for linear scan
@@ -123,17 +316,30 @@ int main() {
     // Step 4: Bulk-load into RTree
     // -----------------------------
 
-    rtree.bulkLoad(trajectories);   // consumes trajectories
+    rtree.bulkLoad(trajectories, summaries);   // consumes trajectories
     std::cout << "Bulk-load completed.\n";
 
     // -----------------------------
     // Step 5: Initialize Evaluation AFTER bulkLoad
     // -----------------------------
-    Evaluation eval(rtree, trajectoriesCopy, trajectoriesCopy, "results");
+    Evaluation eval(rtree, trajectoriesCopy, trajectoriesCopy, "results", summaries);
     // Run controlled tests
     runRangeQueries(eval);
     runKNNQueries(eval, trajectories);
     runSimilarityQueries(eval, trajectories);
+    runWorkloadReplay(eval, trajectoriesCopy);
+    runApproximateKNNCurve(eval, trajectoriesCopy);
+    runCompressionBenchmark(eval);
+    runSimilarityJoin(eval);
+    runAggregateQueries(eval);
+    runDensityGrid(eval);
+    runBatchRangeQuery(eval);
+    runQueryPlanner(eval);
+    runConcurrentIngest(eval);
+    runPagedRTree(eval);
+    runShardedRTree(eval, trajectoriesCopy);
+    runQueryDeadlines(eval, trajectoriesCopy);
+    runLazyParquetStore(eval, parquetDir);
 
     std::cout << "\n=== Evaluation on Parquet Data Completed ===\n";
     return 0;
@@ -0,0 +1,173 @@
+#include "../api/include/lazyParquetStore.h"
+#include "../api/include/csvIngest.h"
+#include "../api/include/RTree.h"
+#include "../api/include/trajectory.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <set>
+#include <random>
+#include <algorithm>
+#include <filesystem>
+namespace fs = std::filesystem;
+
+// ------------------ Helper Functions ------------------
+// 600 trips of 20-60 points in the grouped layout, sorted by (vehicle, trip, t)
+TrajectoryColumns makeColumns(unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> pos(0.0f, 1.0f), step(-0.002f, 0.002f);
+    TrajectoryColumns c;
+    for (int32_t vehicle = 1; vehicle <= 30; ++vehicle) {
+        for (int32_t trip = 1; trip <= 20; ++trip) {
+            c.tripStart.push_back(c.rows());
+            float x = -75.3f + 0.2f * pos(rng), y = 39.8f + 0.2f * pos(rng);
+            int64_t t = 1500000000 + static_cast<int64_t>(5 * 86400.0 * pos(rng));
+            int points = 20 + static_cast<int>(rng() % 41);
+            for (int j = 0; j < points; ++j, t += 30) {
+                c.vehicleId.push_back(vehicle);
+                c.tripId.push_back(vehicle * 100 + trip);
+                c.x.push_back(x);
+                c.y.push_back(y);
+                c.t.push_back(t);
+                x += step(rng);
+                y += step(rng);
+            }
+        }
+    }
+    c.tripStart.push_back(c.rows());
+    return c;
+}
+
+std::multiset<std::string> idsOf(const std::vector<LazyParquetStore::TrajectoryPtr>& trajs) {
+    std::multiset<std::string> ids;
+    for (const auto& t : trajs) ids.insert(t->getId());
+    return ids;
+}
+
+std::multiset<std::string> idsOf(const std::vector<Trajectory>& trajs) {
+    std::multiset<std::string> ids;
+    for (const auto& t : trajs) ids.insert(t.getId());
+    return ids;
+}
+
+std::vector<BoundingBox3D> makeBoxes(size_t count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    std::vector<BoundingBox3D> boxes;
+    for (size_t i = 0; i < count; ++i) {
+        float x = -75.3f + 0.2f * u(rng), y = 39.8f + 0.2f * u(rng);
+        int64_t t = 1500000000 + static_cast<int64_t>(4 * 86400.0 * u(rng));
+        boxes.emplace_back(x, y, t, x + 0.04f, y + 0.04f, t + 86400);
+    }
+    return boxes;
+}
+
+// ------------------ Store ------------------
+void testMatchesLoadedTree(const std::string& dir, const RTree& tree, const std::vector<Trajectory>& loaded) {
+    std::cout << "\n=== testMatchesLoadedTree ===\n";
+    LazyParquetStore store(dir);
+    assert(store.size() == loaded.size() && store.fileCount() > 1 && store.rowGroupCount() > store.fileCount());
+
+    for (const auto& box : makeBoxes(50, 3)) {
+        LazyStoreStats io;
+        auto lazy = store.rangeQuery(box, &io);
+        auto expected = tree.rangeQuery(box);
+        assert(idsOf(lazy) == idsOf(expected));
+        assert(store.rangeCount(box) == expected.size());
+        assert(io.rowGroupsRead <= store.rowGroupCount());
+
+        // Same points as the fully loaded trajectories
+        for (const auto& t : lazy) {
+            auto it = std::find_if(expected.begin(), expected.end(), [&](const Trajectory& e) { return e.getId() == t->getId(); });
+            assert(it != expected.end() && it->getPoints() == t->getPoints());
+            assert(t->getBoundingBox() == it->getBoundingBox());
+        }
+    }
+    assert(store.validationReport().invalidPoints == 0);
+    std::cout << store.size() << " trips in " << store.rowGroupCount() << " row groups, opened in "
+              << store.openTime() << " s\n";
+}
+
+void testCacheBound(const std::string& dir) {
+    std::cout << "\n=== testCacheBound ===\n";
+    LazyParquetOptions options;
+    options.cachePoints = 2000;
+    LazyParquetStore store(dir, options);
+    auto boxes = makeBoxes(40, 7);
+
+    for (const auto& box : boxes) {
+        store.rangeQuery(box);
+        assert(store.cachedPoints() <= options.cachePoints);
+    }
+    LazyStoreStats first = store.stats();
+    assert(first.cacheMisses > 0 && first.trajectoriesLoaded == first.cacheMisses);
+
+    // Repeating the last query hits the cache and reads nothing, if its trips fit in the budget
+    size_t lastPoints = 0;
+    for (const auto& t : store.rangeQuery(boxes.back())) lastPoints += t->getPoints().size();
+    store.resetStats();
+    LazyStoreStats io;
+    auto again = store.rangeQuery(boxes.back(), &io);
+    if (lastPoints <= options.cachePoints) assert(io.rowGroupsRead == 0 && io.cacheHits == again.size());
+
+    // Uncached store always decodes
+    LazyParquetOptions none;
+    none.cachePoints = 0;
+    LazyParquetStore uncached(dir, none);
+    uncached.rangeQuery(boxes[0]);
+    uncached.rangeQuery(boxes[0]);
+    assert(uncached.cachedPoints() == 0 && uncached.stats().cacheHits == 0);
+    std::cout << "cache " << store.cachedTrajectories() << " trips, " << store.cachedPoints() << " points\n";
+}
+
+void testRegion(const std::string& dir, const RTree& tree) {
+    std::cout << "\n=== testRegion ===\n";
+    BoundingBox3D region(-75.3f, 39.8f, 1500000000, -75.2f, 39.9f, 1500000000 + 2 * 86400);
+    LazyParquetOptions options;
+    options.region = region;
+    LazyParquetStore store(dir, options);
+    assert(store.size() == tree.rangeQuery(region).size());
+
+    // Inside the region the answers are complete
+    BoundingBox3D inner(-75.28f, 39.82f, 1500000000 + 3600, -75.22f, 39.88f, 1500000000 + 86400);
+    assert(idsOf(store.rangeQuery(inner)) == idsOf(tree.rangeQuery(inner)));
+    std::cout << store.size() << " trips indexed, " << store.prunedRowGroupCount() << " row groups pruned\n";
+}
+
+void testErrors() {
+    std::cout << "\n=== testErrors ===\n";
+    bool threw = false;
+    try {
+        LazyParquetStore store("/tmp/test_lazyparquetstore_missing");
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    assert(threw);
+}
+
+// ------------------ Main ------------------
+int main() {
+    const std::string dir = "/tmp/test_lazyparquetstore";
+    fs::remove_all(dir);
+    TrajectoryColumns columns = makeColumns(5);
+    columns.writeParquet(dir, 8000, 1000); // several files of several row groups
+
+    RTree tree(8);
+    std::vector<Trajectory> loaded;
+    for (const auto& entry : fs::directory_iterator(dir)) {
+        auto partial = tree.loadFromParquet(entry.path().string());
+        loaded.insert(loaded.end(), partial.begin(), partial.end());
+    }
+    RTree::precomputeSummaries(loaded);
+    std::vector<Trajectory> copy = loaded;
+    tree.bulkLoad(copy);
+
+    testMatchesLoadedTree(dir, tree, loaded);
+    testCacheBound(dir);
+    testRegion(dir, tree);
+    testErrors();
+
+    fs::remove_all(dir);
+    std::cout << "\n=== All lazy Parquet store tests completed successfully ===\n";
+    return 0;
+}
@@ -0,0 +1,166 @@
+#include "../api/include/pagedRTree.h"
+#include "../api/include/bufferPool.h"
+#include "../api/include/RTree.h"
+#include "testHelpers.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <set>
+#include <map>
+#include <random>
+#include <fstream>
+#include <filesystem>
+#include <cmath>
+
+namespace fs = std::filesystem;
+
+// ------------------ Helper Functions ------------------
+// Trips of 2..60 points, 30 s apart, within one week; long ones span heap pages
+const TripShape kShape{7.0, 2, 60, 30, 0.001f};
+const TripShape kLongShape{7.0, 2, 1200, 30, 0.001f};
+
+std::map<std::string, const Trajectory*> byId(const std::vector<Trajectory>& trajs) {
+    std::map<std::string, const Trajectory*> out;
+    for (const auto& t : trajs) out[t.getId()] = &t;
+    return out;
+}
+
+// ------------------ Buffer pool ------------------
+void testBufferPool() {
+    std::cout << "\n=== testBufferPool ===\n";
+    const std::string path = (fs::temp_directory_path() / "test_bufferpool.bin").string();
+    {
+        std::ofstream out(path, std::ios::binary);
+        for (uint8_t p = 0; p < 8; ++p) out << std::string(64, static_cast<char>('a' + p));
+    }
+
+    // 0,1,2,0,3,0 with three frames: LRU keeps page 0, Clock gives it no second chance
+    // because the sweep clears every reference bit before evicting
+    for (EvictionPolicy policy : {EvictionPolicy::LRU, EvictionPolicy::Clock}) {
+        BufferPool pool(path, 64, 3, policy);
+        assert(pool.pageCount() == 8);
+        PageIOStats io;
+        for (uint64_t p : {0, 1, 2, 0, 3, 0}) {
+            BufferPool::Page page = pool.fetch(p, &io);
+            assert(page->size() == 64 && (*page)[10] == 'a' + p);
+        }
+        assert(io.requests == 6 && io.bytesRead == io.faults * 64);
+        assert(io.faults == (policy == EvictionPolicy::LRU ? 4u : 5u));
+        assert(pool.stats().faults == io.faults && pool.residentPages() == 3);
+    }
+
+    // No frames: every fetch reads the file
+    BufferPool uncached(path, 64, 0);
+    for (int i = 0; i < 5; ++i) uncached.fetch(1);
+    assert(uncached.stats().faults == 5 && uncached.residentPages() == 0);
+
+    bool threw = false;
+    try { uncached.fetch(8); } catch (const std::out_of_range&) { threw = true; }
+    assert(threw);
+    fs::remove(path);
+}
+
+// ------------------ Paged tree against the in-memory tree ------------------
+void testAgainstRTree() {
+    std::cout << "\n=== testAgainstRTree ===\n";
+    std::mt19937 rng(1);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 20000; ++i) trajs.push_back(makeTrip("v" + std::to_string(i % 900) + "_" + std::to_string(i), rng, kShape));
+    for (int i = 0; i < 20; ++i) trajs.push_back(makeTrip("long_" + std::to_string(i), rng, kLongShape)); // span heap pages
+
+    const std::string base = (fs::temp_directory_path() / "test_pagedrtree").string();
+    PagedRTree::create(base, trajs);
+    std::vector<Trajectory> copy = trajs;
+    RTree tree(8);
+    tree.bulkLoad(copy);
+    auto expected = byId(trajs);
+
+    for (EvictionPolicy policy : {EvictionPolicy::LRU, EvictionPolicy::Clock}) {
+        PagedRTree paged(base, {16, 64, policy});
+        assert(paged.size() == trajs.size() && paged.getFanout() == (4096 - 8) / 40);
+        std::cout << paged.nodePageCount() << " node pages, " << paged.heapPageCount() << " heap pages, height "
+                  << paged.getHeight() << "\n";
+
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        PageIOStats total;
+        for (int q = 0; q < 40; ++q) {
+            float x = -75.3f + 0.2f * u(rng), y = 39.8f + 0.2f * u(rng), w = 0.05f * u(rng);
+            int64_t t0 = 1500000000 + static_cast<int64_t>(7 * 86400.0 * u(rng));
+            BoundingBox3D box(x, y, t0, x + w, y + w, t0 + static_cast<int64_t>(86400 * u(rng)));
+
+            PagedQueryStats io;
+            auto results = paged.rangeQuery(box, &io);
+            std::multiset<std::string> got, want;
+            for (const auto& t : results) {
+                got.insert(t.getId());
+                assert(t.getPoints() == expected.at(t.getId())->getPoints());
+            }
+            for (const auto& t : tree.rangeQuery(box)) want.insert(t.getId());
+            assert(got == want && io.payloadsLoaded == results.size());
+            assert(paged.rangeCount(box) == results.size());
+            total += io.heap;
+
+            // Snapshot at a timestamp inside the window
+            int64_t t = box.getMinT() + (box.getMaxT() - box.getMinT()) / 2;
+            std::map<std::string, std::pair<float, float>> snapshot;
+            for (const auto& p : paged.snapshotQuery(box, t)) snapshot[p.id] = {p.x, p.y};
+            auto reference = tree.snapshotQuery(box, t);
+            assert(snapshot.size() == reference.size());
+            for (const auto& p : reference) {
+                auto [sx, sy] = snapshot.at(p.id());
+                assert(std::fabs(sx - p.x) < 1e-6f && std::fabs(sy - p.y) < 1e-6f);
+            }
+        }
+        std::cout << "heap hit rate " << total.hitRate() << ", " << total.bytesRead << " heap bytes read\n";
+    }
+
+    // Warm pools answer a repeated query without faults; the index-only count never reads the heap
+    PagedRTree paged(base, {4096, 4096, EvictionPolicy::LRU});
+    BoundingBox3D box(-75.25f, 39.85f, 1500000000, -75.15f, 39.95f, 1500300000);
+    PagedQueryStats cold, warm, countOnly;
+    size_t n = paged.rangeQuery(box, &cold).size();
+    assert(n > 0 && cold.pageFaults() > 0 && cold.bytesRead() == cold.pageFaults() * 4096);
+    assert(paged.rangeQuery(box, &warm).size() == n && warm.pageFaults() == 0 && warm.heap.requests > 0);
+    assert(paged.rangeCount(box, &countOnly) == n && countOnly.heap.requests == 0);
+    assert(paged.indexStats().faults == cold.index.faults && paged.heapStats().faults == cold.heap.faults);
+    std::cout << n << " results: cold " << cold.pageFaults() << " faults, warm hit rate " << warm.heap.hitRate() << "\n";
+
+    fs::remove(base + ".idx");
+    fs::remove(base + ".heap");
+}
+
+// ------------------ Edge cases ------------------
+void testEdgeCases() {
+    std::cout << "\n=== testEdgeCases ===\n";
+    const std::string base = (fs::temp_directory_path() / "test_pagedrtree_edge").string();
+
+    PagedRTree::create(base, {});
+    PagedRTree empty(base);
+    assert(empty.size() == 0 && empty.getHeight() == 0);
+    assert(empty.rangeQuery(BoundingBox3D(-180.0f, -90.0f, 0, 180.0f, 90.0f, INT64_MAX)).empty());
+
+    // Smallest page that holds two entries: every node is a pair
+    std::mt19937 rng(2);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 33; ++i) trajs.push_back(makeTrip("e" + std::to_string(i), rng, kShape));
+    PagedRTree::create(base, trajs, 8 + 2 * 40);
+    PagedRTree tiny(base, {0, 0, EvictionPolicy::Clock});
+    assert(tiny.getFanout() == 2 && tiny.getHeight() == 6);
+    assert(tiny.rangeQuery(BoundingBox3D(-180.0f, -90.0f, 0, 180.0f, 90.0f, INT64_MAX)).size() == 33);
+
+    bool threw = false;
+    try { PagedRTree::create(base, trajs, 64); } catch (const std::invalid_argument&) { threw = true; }
+    assert(threw);
+    fs::remove(base + ".idx");
+    fs::remove(base + ".heap");
+}
+
+// ------------------ Main ------------------
+int main() {
+    testBufferPool();
+    testAgainstRTree();
+    testEdgeCases();
+
+    std::cout << "\n=== All PagedRTree tests completed successfully ===\n";
+    return 0;
+}
@@ -2,6 +2,9 @@
 #include <iostream>
 #include <cassert>
 #include <cmath>
+#include <vector>
+#include <cstring>
+#include <type_traits>
 
 
 int main() {
@@ -28,9 +31,10 @@ int main() {
     p3.print();
 
     // -------------------- Test Move Constructor --------------------
+    // Moves are plain copies: the source keeps its value
     Point3D p4(std::move(p3));
     assert(p4.getX() == 12.5f && p4.getY() == -45.3f && p4.getT() == timestamp);
-    assert(p3.getX() == 0.0f && p3.getY() == 0.0f && p3.getT() == 0);
+    assert(p3 == p4);
     p4.print();
     p3.print();
 
@@ -44,10 +48,17 @@ int main() {
     Point3D p6;
     p6 = std::move(p5);
     assert(p6 == p2);
-    assert(p5.getX() == 0.0f && p5.getY() == 0.0f && p5.getT() == 0);
+    assert(p5 == p2);
     p6.print();
     p5.print();
 
+    // -------------------- Test Trivially Copyable --------------------
+    static_assert(std::is_trivially_copyable<Point3D>::value, "Point3D must be trivially copyable");
+    std::vector<Point3D> source = {p2, Point3D(-75.1f, 39.9f, timestamp), Point3D(1.0f, 2.0f, 3)};
+    std::vector<Point3D> raw(source.size());
+    std::memcpy(raw.data(), source.data(), source.size() * sizeof(Point3D));
+    assert(raw == source);
+
     // -------------------- Test Comparison Operators --------------------
     Point3D p7(12.5f, -45.3f, timestamp);
     assert(p2 == p7);
@@ -69,24 +80,26 @@ int main() {
     assert(j["t"] == timestamp);
     std::cout << "JSON: " << j.dump() << "\n";
 
-    // -------------------- Edge Case Tests (Validation Warnings) --------------------
+    // -------------------- Edge Case Tests (Batch Validation) --------------------
     std::cout << "\n--- Edge Case Tests ---\n";
 
-    // Latitude out of range
-    Point3D invalidLat(0.0f, 100.0f, timestamp);  // Should trigger warning
-    invalidLat.print();
-
-    // Longitude out of range
-    Point3D invalidLon(200.0f, 0.0f, timestamp);  // Should trigger warning
-    invalidLon.print();
-
-    // Timestamp zero
-    Point3D zeroTime(0.0f, 0.0f, 0);              // Should trigger warning
-    zeroTime.print();
-
-    // Multiple invalids together
-    Point3D allInvalid(300.0f, -120.0f, 0);      // Should trigger multiple warnings
-    allInvalid.print();
+    Point3D invalidLat(0.0f, 100.0f, timestamp);  // Latitude out of range
+    Point3D invalidLon(200.0f, 0.0f, timestamp);  // Longitude out of range
+    Point3D zeroTime(0.0f, 0.0f, 0);              // Timestamp zero
+    Point3D allInvalid(300.0f, -120.0f, 0);      // Multiple invalids together
+    assert(p2.isValid());
+    assert(!invalidLat.isValid() && !invalidLon.isValid() && !zeroTime.isValid() && !allInvalid.isValid());
+
+    std::vector<Point3D> batch = {p2, invalidLat, invalidLon, zeroTime, allInvalid, p7};
+    PointValidationReport report = Point3D::validate(batch);
+    assert(report.points == 6);
+    assert(report.invalidPoints == 4);
+    assert(report.latitudeOutOfRange == 2);
+    assert(report.longitudeOutOfRange == 2);
+    assert(report.zeroTimestamps == 2);
+    report += Point3D::validate(batch.data(), 1);
+    assert(report.points == 7 && report.invalidPoints == 4);
+    report.print(std::cout, "edge cases");
 
     std::cout << "\nAll Point3D tests (including edge cases) passed successfully!\n";
     return 0;
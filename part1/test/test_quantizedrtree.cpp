@@ -0,0 +1,119 @@
+#include "../api/include/quantizedRTree.h"
+#include "../api/include/RTree.h"
+#include "../api/include/trajectory.h"
+#include "../api/include/bbox3D.h"
+#include "../api/include/point3D.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <algorithm>
+#include <random>
+
+// ------------------ Helper Functions ------------------
+std::vector<Trajectory> makeTrajectories(int count) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> lon(-75.3f, -74.9f), lat(39.8f, 40.1f);
+    std::uniform_int_distribution<int64_t> start(1500000000, 1520000000);
+
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < count; ++i) {
+        Trajectory t("q_" + std::to_string(i));
+        float x = lon(rng), y = lat(rng);
+        int64_t t0 = start(rng);
+        for (int j = 0; j < 8; ++j)
+            t.addPoint(Point3D(x + 0.0007f * j, y - 0.0004f * j, t0 + j * 30));
+        trajs.push_back(t);
+    }
+    return trajs;
+}
+
+std::vector<std::string> sortedIds(const std::vector<Trajectory>& trajs) {
+    std::vector<std::string> ids;
+    for (const auto& t : trajs) ids.push_back(t.getId());
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+// Random query boxes, including ones that touch entry boxes exactly
+std::vector<BoundingBox3D> makeQueries(const std::vector<Trajectory>& trajs, int count) {
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<float> lon(-75.3f, -74.9f), lat(39.8f, 40.1f), size(0.001f, 0.08f);
+    std::uniform_int_distribution<int64_t> start(1500000000, 1520000000), span(60, 2000000);
+
+    std::vector<BoundingBox3D> queries;
+    for (int i = 0; i < count; ++i) {
+        float x = lon(rng), y = lat(rng);
+        int64_t t = start(rng);
+        queries.emplace_back(x, y, t, x + size(rng), y + size(rng), t + span(rng));
+    }
+    for (int i = 0; i < 20; ++i) {
+        BoundingBox3D b = trajs[i * 13].getBoundingBox();
+        queries.emplace_back(b.getMaxX(), b.getMaxY(), b.getMaxT(), b.getMaxX() + 0.01f, b.getMaxY() + 0.01f, b.getMaxT() + 100);
+    }
+    return queries;
+}
+
+// ------------------ Equivalence Test ------------------
+void testQuantizedMatchesFullPrecision(int bits) {
+    std::cout << "\n=== testQuantizedMatchesFullPrecision (" << bits << "-bit) ===\n";
+    auto trajs = makeTrajectories(5000);
+    auto queries = makeQueries(trajs, 200);
+
+    RTree tree(16);
+    tree.bulkLoad(trajs);
+
+    std::vector<std::vector<std::string>> expected;
+    for (const auto& q : queries) expected.push_back(sortedIds(tree.rangeQuery(q)));
+
+    tree.buildQuantizedIndex(bits);
+    auto snapshot = tree.getQuantizedIndex();
+    assert(snapshot && snapshot->bits() == bits);
+    assert(snapshot->trajectoryCount() == 5000);
+
+    size_t total = 0;
+    for (size_t i = 0; i < queries.size(); ++i) {
+        auto got = sortedIds(tree.rangeQuery(queries[i]));
+        assert(got == expected[i]);
+        total += got.size();
+    }
+
+    MemoryReport report = tree.memoryUsage();
+    std::cout << "Queries: " << queries.size() << ", total hits: " << total << "\n";
+    std::cout << "Full-precision nodes + entries: " << report.nodeBytes + report.entryVectorBytes
+              << " B, quantized snapshot: " << snapshot->memoryUsage() << " B\n";
+    assert(snapshot->memoryUsage() < report.nodeBytes + report.entryVectorBytes);
+}
+
+// ------------------ Invalidation Test ------------------
+void testQuantizedDroppedOnInsert() {
+    std::cout << "\n=== testQuantizedDroppedOnInsert ===\n";
+    auto trajs = makeTrajectories(200);
+    RTree tree(8);
+    for (const auto& t : trajs) tree.insert(t);
+
+    tree.buildQuantizedIndex(16);
+    assert(tree.getQuantizedIndex());
+
+    Trajectory extra("extra");
+    extra.addPoint(Point3D(-75.0f, 40.0f, 1510000000));
+    extra.addPoint(Point3D(-74.99f, 40.01f, 1510000100));
+    tree.insert(extra);
+    assert(!tree.getQuantizedIndex());
+    assert(tree.getTotalEntries() == 201);
+
+    // Rebuilt snapshot includes the new trajectory
+    tree.buildQuantizedIndex(16);
+    auto hits = tree.getQuantizedIndex()->rangeQuery(extra.getBoundingBox());
+    assert(std::any_of(hits.begin(), hits.end(), [](const auto& t) { return t->getId() == "extra"; }));
+    std::cout << "Snapshot dropped after insert and rebuilt with the new trajectory\n";
+}
+
+// ------------------ Main ------------------
+int main() {
+    testQuantizedMatchesFullPrecision(8);
+    testQuantizedMatchesFullPrecision(16);
+    testQuantizedDroppedOnInsert();
+
+    std::cout << "\n=== All QuantizedRTree tests completed successfully ===\n";
+    return 0;
+}
@@ -0,0 +1,152 @@
+#include "../api/include/RTree.h"
+#include "../api/include/queryControl.h"
+#include "../api/include/threadPool.h"
+#include "testHelpers.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <set>
+#include <random>
+#include <thread>
+#include <future>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+
+// ------------------ Helper Functions ------------------
+// 12 points a minute apart within five days, 200 vehicles
+const TripShape kShape{5.0, 12, 12, 60, 0.002f};
+
+bool isSubset(const std::multiset<std::string>& part, const std::multiset<std::string>& whole) {
+    return std::includes(whole.begin(), whole.end(), part.begin(), part.end());
+}
+
+// ------------------ Controlled queries ------------------
+void testUncontrolledMatchesPlain(const RTree& tree, const std::vector<Trajectory>& trips) {
+    std::cout << "\n=== testUncontrolledMatchesPlain ===\n";
+    BoundingBox3D box(-75.25f, 39.85f, 1500000000, -75.15f, 39.95f, 1500000000 + 2 * 86400);
+    auto range = tree.rangeQuery(box, QueryControl{});
+    assert(range.complete && range.stopReason == QueryStopReason::None && range.nodesVisited > 0);
+    assert(ids(range.results) == ids(tree.rangeQuery(box)));
+
+    // Time-only window goes through the temporal index
+    BoundingBox3D window(-180.0f, -90.0f, 1500000000 + 86400, 180.0f, 90.0f, 1500000000 + 86400 + 3600);
+    assert(ids(tree.rangeQuery(window, QueryControl{}).results) == ids(tree.rangeQuery(window)));
+
+    for (size_t i = 0; i < 20; ++i) {
+        auto similar = tree.findSimilar(trips[i], 0.02f, QueryControl{});
+        assert(similar.complete && ids(similar.results) == ids(tree.findSimilar(trips[i], 0.02f)));
+    }
+    std::cout << range.results.size() << " range matches, " << range.nodesVisited << " nodes\n";
+}
+
+void testStoppedBeforeStart(const RTree& tree, const std::vector<Trajectory>& trips) {
+    std::cout << "\n=== testStoppedBeforeStart ===\n";
+    BoundingBox3D everything(-180.0f, -90.0f, 0, 180.0f, 90.0f, 4000000000LL);
+
+    QueryControl cancelled;
+    cancelled.token.cancel();
+    auto a = tree.rangeQuery(everything, cancelled);
+    assert(!a.complete && a.stopReason == QueryStopReason::Cancelled && a.results.empty());
+
+    auto b = tree.findSimilar(trips[0], 1.0f, QueryControl::withTimeout(-1.0));
+    assert(!b.complete && b.stopReason == QueryStopReason::DeadlineExceeded && b.results.empty());
+
+    // Timeouts past the clock's range mean no deadline instead of overflowing into the past
+    for (double huge : {1e300, std::numeric_limits<double>::infinity(), std::numeric_limits<double>::quiet_NaN()})
+        assert(QueryControl::withTimeout(huge).deadline == QueryControl::Clock::time_point::max());
+    QueryControl expired = QueryControl::withTimeout(-std::numeric_limits<double>::infinity());
+    assert(expired.deadline <= QueryControl::Clock::now());
+    assert(tree.rangeQuery(everything, QueryControl::withTimeout(1e300)).complete);
+
+    // Copies share the flag
+    CancellationToken token;
+    QueryControl control;
+    control.token = token;
+    token.cancel();
+    assert(control.token.isCancelled());
+}
+
+void testPartialResults(const RTree& tree, const std::vector<Trajectory>& trips) {
+    std::cout << "\n=== testPartialResults ===\n";
+    // A query over the whole tree with a very short deadline stops early; what it returns is still correct
+    BoundingBox3D box(-75.3f, 39.8f, 1500000000, -75.1f, 40.0f, 1500000000 + 4 * 86400);
+    auto full = ids(tree.rangeQuery(box));
+    auto cut = tree.rangeQuery(box, QueryControl::withTimeout(0.00002));
+    assert(isSubset(ids(cut.results), full));
+    assert(cut.complete || cut.stopReason == QueryStopReason::DeadlineExceeded);
+    if (!cut.complete) assert(cut.results.size() < full.size());
+    std::cout << (cut.complete ? "completed" : "cut off") << " with " << cut.results.size() << " of " << full.size()
+              << " matches after " << cut.nodesVisited << " nodes\n";
+}
+
+// ------------------ Async queries ------------------
+void testQueuedPastDeadline(const RTree& tree) {
+    std::cout << "\n=== testQueuedPastDeadline ===\n";
+    ThreadPool pool(1);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    pool.submit([released]() { released.wait(); });
+
+    BoundingBox3D everything(-180.0f, -90.0f, 0, 180.0f, 90.0f, 4000000000LL);
+    auto late = tree.rangeQueryAsync(everything, QueryControl::withTimeout(0.01), pool);
+    QueryControl cancellable;
+    auto cancelled = tree.rangeQueryAsync(everything, cancellable, pool);
+    cancellable.token.cancel();
+    auto normal = tree.rangeQueryAsync(everything, QueryControl{}, pool);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    release.set_value();
+
+    auto a = late.get();
+    assert(!a.complete && a.stopReason == QueryStopReason::DeadlineExceeded && a.results.empty());
+    auto b = cancelled.get();
+    assert(!b.complete && b.stopReason == QueryStopReason::Cancelled && b.results.empty());
+    auto c = normal.get();
+    assert(c.complete && c.results.size() == tree.getTotalEntries());
+}
+
+void testConcurrentAsync(RTree& tree, const std::vector<Trajectory>& trips) {
+    std::cout << "\n=== testConcurrentAsync ===\n";
+    // A modification makes the next async call resolve the lazy caches again before threads read them
+    Trajectory extra("extra_1");
+    for (const auto& p : trips[0].getPoints()) extra.addPoint(p);
+    extra.precomputeCentroidAndBoundingBox();
+    tree.insert(extra);
+
+    std::mt19937 rng(9);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    std::vector<BoundingBox3D> boxes;
+    std::vector<std::future<PartialResult<std::vector<Trajectory>>>> ranges, similar;
+    for (int i = 0; i < 64; ++i) {
+        float x = -75.3f + 0.2f * u(rng), y = 39.8f + 0.2f * u(rng);
+        boxes.emplace_back(x, y, 1500000000, x + 0.03f, y + 0.03f, 1500000000 + 5 * 86400);
+        ranges.push_back(tree.rangeQueryAsync(boxes.back()));
+        similar.push_back(tree.findSimilarAsync(trips[i], 0.02f));
+    }
+    for (int i = 0; i < 64; ++i) {
+        auto r = ranges[i].get();
+        assert(r.complete && ids(r.results) == ids(tree.rangeQuery(boxes[i])));
+        auto s = similar[i].get();
+        assert(s.complete && ids(s.results) == ids(tree.findSimilar(trips[i], 0.02f)));
+    }
+    std::cout << "128 async queries on " << RTree::sharedExecutor().size() << " workers\n";
+}
+
+// ------------------ Main ------------------
+int main() {
+    std::mt19937 rng(5);
+    std::vector<Trajectory> trips = makeTrips(4000, rng, kShape);
+    std::vector<Trajectory> copy = trips;
+    RTree tree(8);
+    tree.bulkLoad(copy);
+
+    testUncontrolledMatchesPlain(tree, trips);
+    testStoppedBeforeStart(tree, trips);
+    testPartialResults(tree, trips);
+    testQueuedPastDeadline(tree);
+    testConcurrentAsync(tree, trips);
+
+    std::cout << "\n=== All query control tests completed successfully ===\n";
+    return 0;
+}
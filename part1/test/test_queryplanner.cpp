@@ -0,0 +1,124 @@
+#include "../api/include/queryPlanner.h"
+#include "../api/include/RTree.h"
+#include "testHelpers.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <set>
+#include <random>
+#include <cstdio>
+
+// ------------------ Helper Functions ------------------
+// Short trips spread over two years, like the taxi data
+const TripShape kShape{2 * 365.0, 8, 8, 120, 0.001f};
+
+const int64_t kStart = kTripEpoch;
+const BoundingBox3D kTight(-75.22f, 39.88f, kStart + 86400 * 100, -75.21f, 39.89f, kStart + 86400 * 130);
+const BoundingBox3D kWide(-1000.0f, -1000.0f, kStart - 86400, 1000.0f, 1000.0f, kStart + 3 * 365 * 86400);
+const BoundingBox3D kTimeOnly(-1000.0f, -1000.0f, kStart + 86400 * 300, 1000.0f, 1000.0f, kStart + 86400 * 300 + 3600);
+const BoundingBox3D kOutside(10.0f, 10.0f, kStart, 11.0f, 11.0f, kStart + 86400);
+
+// ------------------ Strategies agree ------------------
+void testStrategiesAgree(const RTree& tree, const std::vector<Trajectory>& trajs, const QueryPlanner& planner) {
+    std::cout << "\n=== testStrategiesAgree ===\n";
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    std::vector<BoundingBox3D> queries = {kTight, kWide, kTimeOnly, kOutside};
+    for (int i = 0; i < 20; ++i) {
+        float x = -75.3f + 0.2f * u(rng), y = 39.8f + 0.2f * u(rng), w = 0.1f * u(rng);
+        int64_t t = kStart + static_cast<int64_t>(700 * 86400.0 * u(rng));
+        queries.emplace_back(x, y, t, x + w, y + w, t + static_cast<int64_t>(90 * 86400.0 * u(rng)));
+    }
+    for (const auto& q : queries) {
+        auto expected = bruteForce(trajs, q);
+        for (size_t s = 0; s < QueryPlanner::kStrategies; ++s) {
+            auto got = planner.executeWith(static_cast<QueryPlanner::Strategy>(s), q);
+            assert(got.size() == expected.size());
+            assert(ids(got) == expected);
+        }
+        assert(ids(planner.execute(q)) == expected);
+    }
+    assert(planner.calibrationLog().size() == queries.size());
+}
+
+// ------------------ Estimates ------------------
+void testEstimates(const std::vector<Trajectory>& trajs, const QueryPlanner& planner) {
+    std::cout << "\n=== testEstimates ===\n";
+    // Empty and full
+    assert(planner.plan(kOutside).estimatedRows == 0.0);
+    assert(planner.plan(kWide).estimatedRows == static_cast<double>(trajs.size()));
+
+    // Medium windows are estimated within a small factor on uniform data
+    std::mt19937 rng(6);
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    double qerror = 0.0;
+    int n = 0;
+    for (int i = 0; i < 50; ++i) {
+        float x = -75.3f + 0.15f * u(rng), y = 39.8f + 0.15f * u(rng);
+        int64_t t = kStart + static_cast<int64_t>(600 * 86400.0 * u(rng));
+        BoundingBox3D q(x, y, t, x + 0.05f, y + 0.05f, t + 60 * 86400);
+        double est = std::max(planner.plan(q).estimatedRows, 1.0);
+        double actual = std::max<double>(bruteForce(trajs, q).size(), 1.0);
+        qerror += std::max(est, actual) / std::min(est, actual);
+        ++n;
+    }
+    std::cout << "Mean q-error over " << n << " windows: " << qerror / n << "\n";
+    assert(qerror / n < 1.5);
+}
+
+// ------------------ Plan choices ------------------
+void testPlanChoices(const QueryPlanner& planner) {
+    std::cout << "\n=== testPlanChoices ===\n";
+    auto show = [](const char* name, const QueryPlanner::Plan& p) {
+        std::cout << name << ": " << QueryPlanner::strategyName(p.strategy) << " (rows~" << p.estimatedRows
+                  << ", leaves~" << p.estimatedLeaves << ", time candidates~" << p.timeCandidates << ")\n";
+    };
+    auto tight = planner.plan(kTight), wide = planner.plan(kWide), timeOnly = planner.plan(kTimeOnly);
+    show("tight", tight);
+    show("wide", wide);
+    show("time-only", timeOnly);
+    assert(tight.strategy == QueryPlanner::Strategy::IndexTraversal);
+    assert(wide.strategy == QueryPlanner::Strategy::ColumnarScan);
+    assert(timeOnly.strategy == QueryPlanner::Strategy::TimeIndex);
+    // Time-index candidates are the same window without its spatial bounds, never fewer than the rows
+    assert(tight.timeCandidates >= tight.estimatedRows && timeOnly.timeCandidates >= timeOnly.estimatedRows);
+    assert(planner.plan(kOutside).timeCandidates > 0.0); // inside the data's time range
+}
+
+// ------------------ Calibration ------------------
+void testCalibration(QueryPlanner& planner) {
+    std::cout << "\n=== testCalibration ===\n";
+    planner.calibrate({kTight, kWide, kTimeOnly});
+    const auto& c = planner.getCosts();
+    std::cout << "Calibrated costs (ns/entry): index=" << c.indexEntry * 1e9 << " scan=" << c.scanEntry * 1e9
+              << " time=" << c.timeCandidate * 1e9 << "\n";
+    assert(c.indexEntry > 0.0 && c.scanEntry > 0.0 && c.timeCandidate > 0.0);
+
+    std::cout << "Mean q-error of the log: " << planner.meanQError() << "\n";
+    const std::string path = "query_plan_log_test.csv";
+    planner.saveCalibrationLog(path);
+    std::remove(path.c_str());
+    planner.clearCalibrationLog();
+    assert(planner.calibrationLog().empty() && planner.meanQError() == 0.0);
+}
+
+// ------------------ Main ------------------
+int main() {
+    std::mt19937 rng(4);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 20000; ++i) trajs.push_back(makeTrip("p" + std::to_string(i), rng, kShape));
+    std::vector<Trajectory> copy = trajs;
+    RTree tree(8);
+    tree.bulkLoad(copy);
+
+    QueryPlanner planner(tree, trajs);
+    std::cout << "Planner memory: " << planner.memoryUsage() << " bytes\n";
+
+    testStrategiesAgree(tree, trajs, planner);
+    testEstimates(trajs, planner);
+    testPlanChoices(planner);
+    testCalibration(planner);
+
+    std::cout << "\n=== All QueryPlanner tests completed successfully ===\n";
+    return 0;
+}
@@ -12,6 +12,12 @@
 #include <sstream>
 #include <algorithm>
 #include <filesystem>
+#include <cmath>
+#include <set>
+#include <random>
+#include <numeric>
+#include <tuple>
+#include <thread>
 
 namespace fs = std::filesystem;
 
@@ -85,6 +91,131 @@ void testRTreeUpdateRemove() {
     std::cout << "Total Entries :"<< tree.getTotalEntries() << "\n";
 }
 
+// ------------------ Tree Maintenance Tests ------------------
+// Four-point walk in [0, 100]^2 over t in [1000, 1090]
+Trajectory makeWalk(const std::string& id, std::mt19937& rng) {
+    std::uniform_real_distribution<float> pos(0.0f, 100.0f), step(-2.0f, 2.0f);
+    Trajectory t(id);
+    float x = pos(rng), y = pos(rng);
+    for (int j = 0; j < 4; ++j, x += step(rng), y += step(rng)) t.addPoint(Point3D(x, y, 1000 + 30 * j));
+    return t;
+}
+
+std::set<std::string> idSet(const std::vector<Trajectory>& trajs) {
+    std::set<std::string> ids;
+    for (const auto& t : trajs) ids.insert(t.getId());
+    return ids;
+}
+
+// Spatial boxes over the whole time range, so the tree (not the temporal index) answers
+void checkAgainstBruteForce(const RTree& tree, const std::vector<Trajectory>& live, std::mt19937& rng) {
+    std::uniform_real_distribution<float> pos(-5.0f, 105.0f), size(1.0f, 30.0f);
+    assert(tree.getTotalEntries() == live.size());
+    for (int q = 0; q < 40; ++q) {
+        float x = pos(rng), y = pos(rng);
+        BoundingBox3D box(x, y, 1000, x + size(rng), y + size(rng), 1090);
+        std::set<std::string> expected;
+        for (const auto& t : live)
+            if (t.getBoundingBox().intersects(box)) expected.insert(t.getId());
+        assert(idSet(tree.rangeQuery(box)) == expected);
+    }
+}
+
+// Inserts must grow the boxes of every ancestor, and removals that dissolve nodes must keep their orphans
+void testRTreeInsertRemoveMaintenance() {
+    std::cout << "\n=== testRTreeInsertRemoveMaintenance ===\n";
+    std::mt19937 rng(17);
+    RTree tree(4);
+    std::vector<Trajectory> live;
+    for (int i = 0; i < 400; ++i) {
+        Trajectory t = makeWalk("walk_" + std::to_string(i), rng);
+        tree.insert(t);
+        assert(idSet(tree.rangeQuery(t.getBoundingBox())).count(t.getId())); // reachable right away
+        live.push_back(t);
+    }
+    checkAgainstBruteForce(tree, live, rng);
+
+    std::shuffle(live.begin(), live.end(), rng);
+    while (!live.empty()) {
+        assert(tree.remove(live.back().getId()));
+        live.pop_back();
+        assert(tree.getTotalEntries() == live.size());
+        if (live.size() % 50 == 0) checkAgainstBruteForce(tree, live, rng);
+    }
+    std::cout << "400 inserts and removals match brute force, height " << tree.getHeight() << "\n";
+}
+
+// Updates replaced in place must refresh the leaf entry box and every ancestor's box
+void testRTreeUpdateThenRangeQuery() {
+    std::cout << "\n=== testRTreeUpdateThenRangeQuery ===\n";
+    std::mt19937 rng(23);
+    RTree tree(4);
+    std::vector<Trajectory> live;
+    for (int i = 0; i < 200; ++i) {
+        live.push_back(makeWalk("walk_" + std::to_string(i), rng));
+        tree.insert(live.back());
+    }
+
+    std::uniform_int_distribution<size_t> pick(0, live.size() - 1);
+    for (int u = 0; u < 100; ++u) {
+        // Grow the trajectory past its old box, usually still inside its leaf (updated in place)
+        Trajectory& t = live[pick(rng)];
+        const Point3D& last = t.getPoints().back();
+        Point3D grown(last.getX() + 4.0f, last.getY() + 4.0f, last.getT() + 30);
+        t.addPoint(grown);
+        assert(tree.update(t));
+
+        BoundingBox3D around(grown.getX() - 0.01f, grown.getY() - 0.01f, 1000,
+                             grown.getX() + 0.01f, grown.getY() + 0.01f, 2000);
+        assert(idSet(tree.rangeQuery(around)).count(t.getId()));
+    }
+    checkAgainstBruteForce(tree, live, rng);
+    std::cout << "100 updates found by range queries\n";
+}
+
+// Modifications refresh every cache before returning, so concurrent queries only read the tree
+// (run under -fsanitize=thread to check)
+void testRTreeConcurrentReads() {
+    std::cout << "\n=== testRTreeConcurrentReads ===\n";
+    std::mt19937 rng(29);
+    RTree tree(4);
+    std::vector<Trajectory> live;
+    for (int i = 0; i < 300; ++i) {
+        live.push_back(makeWalk("walk_" + std::to_string(i), rng));
+        tree.insert(live.back());
+    }
+    for (int i = 0; i < 60; ++i) assert(tree.remove("walk_" + std::to_string(5 * i)));
+    Trajectory moved = makeWalk("walk_1", rng);
+    assert(tree.update(moved));
+
+    std::vector<BoundingBox3D> boxes;
+    for (int q = 0; q < 20; ++q) {
+        float x = 100.0f * q / 20;
+        boxes.emplace_back(x, x / 2, 1000, x + 15.0f, x / 2 + 15.0f, 1090);
+    }
+    moved.getBoundingBox(); // the query object is shared by the threads too
+
+    auto runAll = [&]() {
+        std::vector<size_t> counts;
+        for (const auto& box : boxes) {
+            counts.push_back(tree.rangeQuery(box).size());
+            counts.push_back(tree.aggregateQuery(box).count);
+        }
+        counts.push_back(tree.findSimilar(moved, 5.0f).size());
+        counts.push_back(tree.kNearestNeighbors(moved, 5).size());
+        return counts;
+    };
+
+    // Readers start right after the last modification, before any query has touched the tree
+    std::vector<std::thread> readers;
+    std::vector<std::vector<size_t>> got(4);
+    for (size_t r = 0; r < got.size(); ++r) readers.emplace_back([&, r]() { got[r] = runAll(); });
+    for (auto& reader : readers) reader.join();
+    const std::vector<size_t> expected = runAll();
+    for (const auto& counts : got) assert(counts == expected);
+    std::cout << got.size() << " readers matched the sequential answers\n";
+}
+
 // ------------------ kNN and Similarity Test ------------------
 void testRTreeKNNAndSimilarity() {
     std::cout << "\n=== testRTreeKNNAndSimilarity ===\n";
@@ -118,16 +249,38 @@ void testRTreeBulkLoadSynthetic() {
         trajs.push_back(t);
     }
 
-    RTree tree(3);
-    tree.bulkLoad(trajs);
-    std::cout << "Tree height after synthetic bulk load: " << tree.getHeight() << "\n";
-    std::cout << "Total entries: " << tree.getTotalEntries() << "\n";
-
-    auto summaries = tree.computeSummaries(trajs);
+    auto summaries = RTree::computeSummaries(trajs, 4);
+    assert(summaries.size() == trajs.size());
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        const auto& s = summaries[i];
+        assert(s.index == i && s.pointCount == trajs[i].getPoints().size());
+        assert(s.bbox == trajs[i].computeBoundingBox() && s.length == trajs[i].length() &&
+               s.duration == trajs[i].duration());
+    }
     for (const auto& s : summaries)
-        std::cout << "Summary: id=" << s.id 
+        std::cout << "Summary: id=" << trajs[s.index].getId() 
                   << ", centroid=(" << s.centroidX << "," 
                   << s.centroidY << "," << s.centroidT << ")\n";
+
+    // Summaries stay valid for a copy of the vector and give bulkLoad the same boxes
+    std::vector<Trajectory> copy = trajs;
+    RTree tree(3), fromSummaries(3);
+    tree.bulkLoad(trajs);
+    fromSummaries.bulkLoad(copy, summaries);
+    std::cout << "Tree height after synthetic bulk load: " << tree.getHeight() << "\n";
+    std::cout << "Total entries: " << tree.getTotalEntries() << "\n";
+    assert(fromSummaries.getTotalEntries() == tree.getTotalEntries());
+    BoundingBox3D box(2, -2, 1000, 6, 4, 1020);
+    assert(fromSummaries.rangeQuery(box).size() == tree.rangeQuery(box).size());
+
+    bool threw = false;
+    try {
+        std::vector<Trajectory> one(1, Trajectory("bulk_x"));
+        fromSummaries.bulkLoad(one, summaries);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
 }
 
 // ------------------ Bulk Load Real Parquet Test ------------------
@@ -203,6 +356,413 @@ void testRTreeStress() {
     std::cout << "Range query returned " << results.size() << " trajectories\n";
 }
 
+// ------------------ Memory Usage Test ------------------
+void testRTreeMemoryUsage() {
+    std::cout << "\n=== testRTreeMemoryUsage ===\n";
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 500; ++i) {
+        Trajectory t("memory_trajectory_" + std::to_string(i));
+        for (int j = 0; j < 10; ++j)
+            t.addPoint(Point3D(-75.0f + 0.01f * (i % 50) + 0.001f * j, 40.0f + 0.01f * (i / 50),
+                               1500000000 + i * 60 + j * 5));
+        trajs.push_back(t);
+    }
+
+    RTree tree(8);
+    tree.bulkLoad(trajs);
+    MemoryReport report = tree.memoryUsage();
+    report.print(std::cout);
+
+    assert(report.trajectoryCount == 500);
+    assert(report.pointCount == 5000);
+    assert(report.pointBytes >= 5000 * sizeof(Point3D));
+    assert(report.idStringBytes > 0); // IDs longer than the inline string buffer
+    assert(report.levels.size() == static_cast<size_t>(tree.getHeight()));
+    assert(report.levels.front().nodes == 1);
+    assert(report.total() > report.pointBytes);
+    for (const auto& level : report.levels)
+        assert(level.fillFactor > 0.0 && level.overlapRatio >= 0.0);
+}
+
+// ------------------ Approximate kNN Test ------------------
+void testRTreeApproximateKNN() {
+    std::cout << "\n=== testRTreeApproximateKNN ===\n";
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 400; ++i) {
+        Trajectory t("approx_" + std::to_string(i));
+        float x = -75.3f + 0.0011f * ((i * 53) % 300), y = 39.8f + 0.0013f * ((i * 29) % 200);
+        for (int j = 0; j < 6; ++j)
+            t.addPoint(Point3D(x + 0.008f * j * ((i % 3) - 1), y + 0.006f * j * ((i % 5) - 2), 1500000000 + i * 10 + j));
+        t.precomputeCentroidAndBoundingBox();
+        trajs.push_back(t);
+    }
+    Trajectory query = trajs[123];
+    const size_t k = 10;
+
+    // Brute-force distances, nearest first (query itself excluded)
+    std::vector<float> truth;
+    for (const auto& t : trajs)
+        if (t.getId() != query.getId()) truth.push_back(query.spatioTemporalDistanceTo(t, 1e-5f));
+    std::sort(truth.begin(), truth.end());
+
+    RTree tree(8);
+    tree.bulkLoad(trajs);
+
+    // epsilon = 0 without budgets is exact
+    ApproximateKNNResult exact = tree.approximateKNearestNeighbors(query, k);
+    assert(exact.trajectories.size() == k && !exact.budgetExhausted);
+    assert(exact.achievedEpsilon == 0.0f);
+    for (size_t i = 0; i < k; ++i) assert(exact.distances[i] == truth[i]);
+
+    // epsilon bound holds at every rank (on distances, i.e. squared values within (1+eps)^2)
+    for (float eps : {0.25f, 1.0f}) {
+        ApproximateKNNOptions options;
+        options.epsilon = eps;
+        ApproximateKNNResult approx = tree.approximateKNearestNeighbors(query, k, options);
+        assert(approx.trajectories.size() == k);
+        assert(approx.achievedEpsilon <= eps + 1e-6f);
+        for (size_t i = 0; i < k; ++i)
+            assert(approx.distances[i] <= truth[i] * (1 + eps) * (1 + eps) * 1.0001f);
+        std::cout << "eps=" << eps << " refinements=" << approx.refinements << " (exact: " << exact.refinements << ")\n";
+    }
+
+    // Refinement budget stops early and reports a bound consistent with the truth
+    ApproximateKNNOptions budget;
+    budget.maxRefinements = k + 2;
+    ApproximateKNNResult capped = tree.approximateKNearestNeighbors(query, k, budget);
+    assert(capped.refinements <= k + 2);
+    if (std::isfinite(capped.achievedEpsilon))
+        for (size_t i = 0; i < capped.distances.size(); ++i)
+            assert(capped.distances[i] <= truth[i] * (1 + capped.achievedEpsilon) * (1 + capped.achievedEpsilon) * 1.0001f);
+    std::cout << "Budgeted: " << capped.trajectories.size() << " results, achieved eps=" << capped.achievedEpsilon << "\n";
+}
+
+// ------------------ Similarity Join Test ------------------
+std::vector<Trajectory> makeJoinTrajectories(const std::string& prefix, int count, int seed) {
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < count; ++i) {
+        Trajectory t(prefix + std::to_string(i));
+        float x = -75.2f + 0.0005f * ((i * 37 + seed) % 30), y = 39.9f + 0.0005f * ((i * 17 + seed) % 20);
+        int64_t t0 = 1500000000 + ((i * 7 + seed) % 4) * 30;
+        for (int j = 0; j < 5; ++j)
+            t.addPoint(Point3D(x + 0.0003f * j, y + 0.0002f * j, t0 + j));
+        t.precomputeCentroidAndBoundingBox();
+        trajs.push_back(t);
+    }
+    return trajs;
+}
+
+// Brute-force form of the join predicate documented in RTree.h: box distance, approximate distance,
+// then similarity
+bool joinMatch(const Trajectory& a, const Trajectory& b, float d) {
+    return a.getBoundingBox().distanceSquaredTo(b.getBoundingBox()) <= d * d &&
+           a.approximateDistance(b, 1e-5f) <= d && a.similarityTo(b) <= d;
+}
+
+void testRTreeSimilarityJoin() {
+    std::cout << "\n=== testRTreeSimilarityJoin ===\n";
+    const float d = 0.002f;
+    auto trajs = makeJoinTrajectories("join_", 600, 0);
+    auto others = makeJoinTrajectories("other_", 300, 11);
+
+    std::set<std::pair<std::string, std::string>> expectedSelf, expectedCross;
+    for (size_t i = 0; i < trajs.size(); ++i) {
+        for (size_t j = i + 1; j < trajs.size(); ++j)
+            if (joinMatch(trajs[i], trajs[j], d))
+                expectedSelf.insert(std::minmax(trajs[i].getId(), trajs[j].getId()));
+        for (const auto& o : others)
+            if (joinMatch(trajs[i], o, d)) expectedCross.insert({trajs[i].getId(), o.getId()});
+    }
+
+    RTree tree(8), otherTree(8);
+    std::vector<Trajectory> copy = trajs, otherCopy = others;
+    tree.bulkLoad(copy);
+    otherTree.bulkLoad(otherCopy);
+
+    for (size_t threads : {1, 4}) {
+        std::set<std::pair<std::string, std::string>> self, cross;
+        auto stats = tree.similarityJoin(d, [&](const Trajectory& a, const Trajectory& b, float) {
+            assert(a.getId() != b.getId());
+            assert(self.insert(std::minmax(a.getId(), b.getId())).second); // each pair once
+        }, threads);
+        tree.similarityJoin(otherTree, d, [&](const Trajectory& a, const Trajectory& b, float) {
+            cross.insert({a.getId(), b.getId()});
+        }, threads);
+
+        std::cout << "Threads " << threads << ": " << stats.pairs << " self pairs, " << cross.size()
+                  << " cross pairs, " << stats.nodePairs << " node pairs, " << stats.tasks << " tasks\n";
+        assert(stats.pairs == self.size());
+        assert(self == expectedSelf);
+        assert(cross == expectedCross);
+    }
+    assert(!expectedSelf.empty() && !expectedCross.empty());
+
+    // findSimilar uses a different predicate: its matches are join pairs once the box test is applied
+    size_t boxFiltered = 0;
+    for (const auto& t : trajs) {
+        for (const auto& s : tree.findSimilar(t, d)) {
+            if (s.getId() == t.getId()) continue;
+            if (t.getBoundingBox().distanceSquaredTo(s.getBoundingBox()) > d * d) { ++boxFiltered; continue; }
+            assert(expectedSelf.count(std::minmax(t.getId(), s.getId())));
+        }
+    }
+    std::cout << boxFiltered << " findSimilar matches outside the join's box distance\n";
+}
+
+// ------------------ Aggregate Query Test ------------------
+Trajectory makeVehicleTrip(int vehicle, int trip, std::mt19937& rng) {
+    std::uniform_real_distribution<float> pos(0.0f, 1.0f), step(-0.002f, 0.002f);
+    Trajectory t("v" + std::to_string(vehicle) + "_" + std::to_string(trip));
+    float x = -75.3f + 0.2f * pos(rng), y = 39.8f + 0.2f * pos(rng);
+    int64_t ts = 1500000000 + static_cast<int64_t>(86400 * pos(rng));
+    for (int j = 0; j < 10; ++j, ts += 60) {
+        t.addPoint(Point3D(x, y, ts));
+        x += step(rng);
+        y += step(rng);
+    }
+    t.precomputeCentroidAndBoundingBox();
+    return t;
+}
+
+// Compare aggregateQuery against a materialized rangeQuery
+void checkAggregate(const RTree& tree, const BoundingBox3D& box) {
+    auto agg = tree.aggregateQuery(box);
+    auto matches = tree.rangeQuery(box);
+
+    size_t points = 0;
+    double length = 0.0, duration = 0.0;
+    std::set<std::string> vehicles;
+    for (const auto& t : matches) {
+        points += t.getPoints().size();
+        length += t.length();
+        duration += static_cast<double>(t.duration());
+        vehicles.insert(vehicleIdOf(t.getId()));
+    }
+
+    assert(agg.count == matches.size());
+    assert(agg.points == points);
+    assert(std::abs(agg.totalLength - length) <= 1e-6 * std::max(1.0, length));
+    assert(agg.totalDuration == duration);
+    assert(std::abs(agg.distinctVehicles - vehicles.size()) <= 0.25 * vehicles.size() + 1);
+    std::cout << "count=" << agg.count << " vehicles~" << agg.distinctVehicles << " (exact " << vehicles.size()
+              << "), nodes=" << agg.nodesVisited << ", boundary trajectories=" << agg.trajectoriesRead << "\n";
+}
+
+void testRTreeAggregateQuery() {
+    std::cout << "\n=== testRTreeAggregateQuery ===\n";
+    std::mt19937 rng(5);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 3000; ++i) trajs.push_back(makeVehicleTrip(i % 400, i, rng));
+
+    RTree tree(8);
+    tree.bulkLoad(trajs);
+
+    BoundingBox3D all(-76.0f, 39.0f, 1400000000, -74.0f, 41.0f, 1600000000);
+    BoundingBox3D half(-75.3f, 39.8f, 1500000000, -75.2f, 40.0f, 1500043200);
+    BoundingBox3D small(-75.25f, 39.85f, 1500010000, -75.2f, 39.9f, 1500030000);
+    checkAggregate(tree, all);
+    checkAggregate(tree, half);
+    checkAggregate(tree, small);
+
+    // Whole tree is answered from the root aggregate
+    auto whole = tree.aggregateQuery(all);
+    assert(whole.count == trajs.size() && whole.trajectoriesRead == 0 && whole.nodesVisited == 1);
+
+    // Aggregates follow inserts, updates and removals
+    for (int i = 3000; i < 3300; ++i) tree.insert(makeVehicleTrip(i % 450, i, rng));
+    for (int i = 0; i < 300; i += 3) assert(tree.remove("v" + std::to_string(i % 400) + "_" + std::to_string(i)));
+    Trajectory moved = makeVehicleTrip(1, 1, rng);
+    assert(tree.update(moved));
+    assert(tree.aggregateQuery(all).count == 3200);
+    checkAggregate(tree, all);
+    checkAggregate(tree, half);
+    checkAggregate(tree, small);
+}
+
+// ------------------ Density Grid Test ------------------
+// Bin every point of every trajectory with the grid's cell formula
+std::vector<uint32_t> bruteForceDensity(const std::vector<Trajectory>& trajs, const BoundingBox3D& box,
+                                        size_t cellsX, size_t cellsY, int64_t bucketSeconds, size_t buckets) {
+    std::vector<uint32_t> counts(buckets * cellsX * cellsY, 0);
+    float perX = cellsX / (box.getMaxX() - box.getMinX()), perY = cellsY / (box.getMaxY() - box.getMinY());
+    for (const auto& traj : trajs) {
+        for (const auto& p : traj.getPoints()) {
+            if (!box.contains(p, 0.0f)) continue;
+            size_t cx = std::min<size_t>(static_cast<size_t>(std::max(0.0f, (p.getX() - box.getMinX()) * perX)), cellsX - 1);
+            size_t cy = std::min<size_t>(static_cast<size_t>(std::max(0.0f, (p.getY() - box.getMinY()) * perY)), cellsY - 1);
+            size_t b = bucketSeconds > 0 ? static_cast<size_t>((p.getT() - box.getMinT()) / bucketSeconds) : 0;
+            ++counts[(b * cellsY + cy) * cellsX + cx];
+        }
+    }
+    return counts;
+}
+
+void testRTreeDensityGrid() {
+    std::cout << "\n=== testRTreeDensityGrid ===\n";
+    std::mt19937 rng(9);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 3000; ++i) trajs.push_back(makeVehicleTrip(i % 400, i, rng));
+    std::vector<Trajectory> copy = trajs;
+    RTree tree(8);
+    tree.bulkLoad(copy);
+
+    BoundingBox3D all(-75.3f, 39.8f, 1500000000, -75.1f, 40.0f, 1500086400 + 600);
+    BoundingBox3D part(-75.27f, 39.83f, 1500020000, -75.15f, 39.93f, 1500060000);
+    struct Case { BoundingBox3D box; size_t cx, cy; int64_t bucket; };
+    for (const auto& c : {Case{all, 4, 4, 0}, Case{all, 128, 96, 3600}, Case{part, 100, 37, 0}, Case{part, 512, 512, 7200}}) {
+        for (size_t threads : {1, 4}) {
+            auto grid = tree.densityGrid(c.box, c.cx, c.cy, c.bucket, threads);
+            auto expected = bruteForceDensity(trajs, c.box, c.cx, c.cy, c.bucket, grid.buckets);
+            assert(grid.counts == expected);
+            if (threads == 1)
+                std::cout << c.cx << "x" << c.cy << " buckets=" << grid.buckets << ": " << grid.total() << " points, "
+                          << grid.aggregatedNodes << " subtrees from aggregates, "
+                          << grid.binnedTrajectories << " trajectories binned\n";
+        }
+    }
+    assert(tree.densityGrid(all, 4, 4).aggregatedNodes > 0);
+    auto coarse = bruteForceDensity(trajs, all, 4, 4, 0, 1);
+    assert(tree.densityGrid(all, 4, 4).total() == std::accumulate(coarse.begin(), coarse.end(), uint64_t(0)));
+
+    // Counts follow updates
+    Trajectory moved = makeVehicleTrip(7, 7, rng);
+    assert(tree.update(moved));
+    trajs[7] = moved;
+    assert(tree.densityGrid(all, 64, 64, 0, 2).counts == bruteForceDensity(trajs, all, 64, 64, 0, 1));
+}
+
+// ------------------ Snapshot Query Test ------------------
+void testRTreeSnapshotQuery() {
+    std::cout << "\n=== testRTreeSnapshotQuery ===\n";
+    std::mt19937 rng(21);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 10000; ++i) trajs.push_back(makeVehicleTrip(i % 300, i, rng));
+    std::vector<Trajectory> copy = trajs;
+    RTree tree(8);
+    tree.bulkLoad(copy);
+
+    BoundingBox3D area(-75.26f, 39.84f, 0, -75.16f, 39.95f, 0); // time bounds ignored
+    std::vector<int64_t> times = {1500050000, 1500000030, 1500043210, 1500050000, 1400000000};
+
+    // Brute force: positionAt on every trajectory
+    auto expected = [&](int64_t t) {
+        std::set<std::tuple<std::string, float, float>> out;
+        for (const auto& traj : trajs) {
+            auto p = traj.positionAt(t);
+            if (p && p->getX() >= area.getMinX() && p->getX() <= area.getMaxX() &&
+                p->getY() >= area.getMinY() && p->getY() <= area.getMaxY())
+                out.insert({traj.getId(), p->getX(), p->getY()});
+        }
+        return out;
+    };
+
+    auto batch = tree.snapshotQuery(area, times);
+    assert(batch.size() == times.size());
+    for (size_t i = 0; i < times.size(); ++i) {
+        std::set<std::tuple<std::string, float, float>> got;
+        for (const auto& pos : batch[i]) got.insert({pos.id(), pos.x, pos.y});
+        assert(got.size() == batch[i].size()); // each trajectory at most once per timestamp
+        assert(got == expected(times[i]));
+        std::cout << "t=" << times[i] << ": " << batch[i].size() << " vehicles in the area\n";
+    }
+    assert(batch[4].empty() && !batch[0].empty());
+
+    auto single = tree.snapshotQuery(area, times[2]);
+    assert(single.size() == batch[2].size());
+}
+
+// ------------------ Continuous kNN Test ------------------
+void testRTreeContinuousKNN() {
+    std::cout << "\n=== testRTreeContinuousKNN ===\n";
+    // Vehicles moving during the same two hours
+    std::mt19937 rng(33);
+    std::uniform_real_distribution<float> pos(0.0f, 1.0f), step(-0.001f, 0.001f);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 800; ++i) {
+        Trajectory t("v" + std::to_string(i) + "_0");
+        float x = -75.2f + 0.05f * pos(rng), y = 39.9f + 0.05f * pos(rng);
+        int64_t ts = 1500000000 + static_cast<int64_t>(3600 * pos(rng));
+        for (int j = 0; j < 60; ++j, ts += 30 + (j % 3) * 10) {
+            t.addPoint(Point3D(x, y, ts));
+            x += step(rng);
+            y += step(rng);
+        }
+        t.precomputeCentroidAndBoundingBox();
+        trajs.push_back(t);
+    }
+    std::vector<Trajectory> copy = trajs;
+    RTree tree(8);
+    tree.bulkLoad(copy);
+
+    const Trajectory& query = trajs[17];
+    const size_t k = 5;
+    auto result = tree.continuousKNearestNeighbors(query, k, {300, 0.001f});
+    assert(result.steps == query.getPoints().size());
+    assert(result.intervals.front().start == query.getPoints().front().getT());
+    assert(result.intervals.back().end == query.getPoints().back().getT());
+
+    // Brute force per query timestamp, compared with the interval covering it
+    size_t interval = 0;
+    for (const auto& qp : query.getPoints()) {
+        std::vector<std::pair<float, std::string>> all;
+        for (const auto& traj : trajs) {
+            if (traj.getId() == query.getId()) continue;
+            auto p = traj.positionAt(qp.getT());
+            if (!p) continue;
+            float dx = p->getX() - qp.getX(), dy = p->getY() - qp.getY();
+            all.emplace_back(dx * dx + dy * dy, traj.getId());
+        }
+        std::sort(all.begin(), all.end());
+        std::set<std::string> expected;
+        for (size_t n = 0; n < std::min(k, all.size()); ++n) expected.insert(all[n].second);
+
+        while (result.intervals[interval].end < qp.getT()) ++interval;
+        std::set<std::string> got;
+        for (const Trajectory* t : result.intervals[interval].neighbors) got.insert(t->getId());
+        assert(got == expected);
+    }
+    std::cout << result.steps << " steps, " << result.intervals.size() << " intervals, "
+              << result.searches << " searches, " << result.candidates << " candidates fetched\n";
+    assert(result.searches < result.steps);
+}
+
+// ------------------ Batch Range Query Test ------------------
+void testRTreeBatchRangeQuery() {
+    std::cout << "\n=== testRTreeBatchRangeQuery ===\n";
+    std::mt19937 rng(31);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 5000; ++i) trajs.push_back(makeVehicleTrip(i % 200, i, rng));
+    RTree tree(8);
+    tree.bulkLoad(trajs);
+
+    // 16 x 16 map tiles over the data plus a few odd boxes (empty, degenerate, outside)
+    std::vector<BoundingBox3D> queries;
+    for (int ty = 0; ty < 16; ++ty)
+        for (int tx = 0; tx < 16; ++tx)
+            queries.emplace_back(-75.3f + 0.0125f * tx, 39.8f + 0.0125f * ty, 1500020000,
+                                 -75.3f + 0.0125f * (tx + 1), 39.8f + 0.0125f * (ty + 1), 1500060000);
+    queries.emplace_back(-75.2f, 39.9f, 1500030000, -75.2f, 39.9f, 1500030000);
+    queries.emplace_back(10.0f, 10.0f, 0, 11.0f, 11.0f, 1);
+    queries.emplace_back(-76.0f, 39.0f, 1400000000, -74.0f, 41.0f, 1600000000);
+    std::shuffle(queries.begin(), queries.end(), rng);
+
+    for (size_t threads : {1, 3}) {
+        auto batch = tree.batchRangeQuery(queries, threads);
+        assert(batch.size() == queries.size());
+        size_t total = 0;
+        for (size_t i = 0; i < queries.size(); ++i) {
+            std::multiset<std::string> got, expected;
+            for (const auto& traj : batch[i]) got.insert(traj->getId());
+            for (const auto& traj : tree.rangeQuery(queries[i])) expected.insert(traj.getId());
+            assert(got == expected);
+            total += got.size();
+        }
+        std::cout << threads << " thread(s): " << total << " results over " << queries.size() << " queries\n";
+    }
+    assert(tree.batchRangeQuery({}).empty());
+    assert(RTree(8).batchRangeQuery(queries).size() == queries.size());
+}
+
 // ------------------ ISO 8601 Range Query Examples ------------------
 void testRTreeISOQueries() {
     std::cout << "\n=== testRTreeISOQueries ===\n";
@@ -241,11 +801,22 @@ void testRTreeISOQueries() {
 int main() {
    // testRTreeBasicInsert();
     testRTreeUpdateRemove();
+    testRTreeInsertRemoveMaintenance();
+    testRTreeUpdateThenRangeQuery();
+    testRTreeConcurrentReads();
   //  testRTreeKNNAndSimilarity();
   //  testRTreeBulkLoadSynthetic();
  //   testRTreeBulkLoadParquet();
   //  testRTreeStress();
    // testRTreeISOQueries();
+    testRTreeMemoryUsage();
+    testRTreeApproximateKNN();
+    testRTreeSimilarityJoin();
+    testRTreeAggregateQuery();
+    testRTreeDensityGrid();
+    testRTreeSnapshotQuery();
+    testRTreeContinuousKNN();
+    testRTreeBatchRangeQuery();
 
     std::cout << "\n=== All RTree tests completed successfully ===\n";
     return 0;
@@ -0,0 +1,178 @@
+#include "../service/server.h"
+#include "../service/client.h"
+#include "../service/protocol.h"
+#include "../api/include/RTree.h"
+#include "testHelpers.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <set>
+#include <map>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+// ------------------ Helper Functions ------------------
+// 15 points a minute apart within five days
+const TripShape kShape{5.0, 15, 15, 60, 0.002f};
+
+std::multiset<std::string> ids(const std::vector<ResultHandle>& handles) {
+    std::multiset<std::string> out;
+    for (const auto& h : handles) out.insert(h.trajId);
+    return out;
+}
+
+int connectRaw(const std::string& socketPath) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, socketPath.c_str());
+    assert(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0);
+    return fd;
+}
+
+std::string receiveError(int fd) {
+    protocol::MessageType type;
+    std::vector<uint8_t> payload;
+    assert(protocol::receiveFrame(fd, type, payload) && type == protocol::MessageType::Error);
+    return protocol::Reader(payload).getString();
+}
+
+// Closed sockets are released by the server asynchronously
+void waitForConnections(const QueryServer& server, size_t open) {
+    while (server.openConnections() != open) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+}
+
+// ------------------ Server and clients ------------------
+void testService() {
+    std::cout << "\n=== testService ===\n";
+    std::mt19937 rng(1);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 5000; ++i) trajs.push_back(makeTrip(tripId(i % 300, i), rng, kShape));
+    std::map<std::string, Trajectory> byId;
+    for (const auto& t : trajs) byId.emplace(t.getId(), t);
+    RTree tree(8);
+    tree.bulkLoad(trajs);
+
+    const std::string socketPath = (fs::temp_directory_path() / "test_service.sock").string();
+    QueryServer server(tree, socketPath, 4);
+    std::thread runner([&]() { server.run(); });
+
+    QueryClient client(socketPath);
+    assert(client.stats().trajectories == 5000);
+
+    // Range: handles and streamed points agree with the tree
+    BoundingBox3D box(-75.25f, 39.85f, 1500000000 + 86400, -75.15f, 39.95f, 1500000000 + 3 * 86400);
+    auto handles = client.rangeQuery(box);
+    auto expected = ids(tree.rangeQuery(box));
+    assert(!handles.empty() && ids(handles) == expected);
+
+    std::multiset<std::string> streamed;
+    size_t count = client.rangeQuery(box, [&](const ResultHandle& match, Trajectory&& t) {
+        assert(match.trajId == t.getId() && t.getPoints() == byId.at(t.getId()).getPoints());
+        streamed.insert(t.getId());
+    });
+    assert(count == handles.size() && streamed == expected);
+
+    // Handles fetch the same trajectories later, in request order
+    std::vector<uint32_t> some = {handles[0].handle, handles.back().handle, handles[0].handle};
+    auto fetched = client.fetch(some);
+    assert(fetched.size() == 3 && fetched[0].getId() == handles[0].trajId && fetched[1].getId() == handles.back().trajId);
+
+    // kNN and similarity
+    const Trajectory& query = byId.begin()->second;
+    auto knn = client.kNearestNeighbors(query.getId(), 10);
+    auto knnExpected = tree.approximateKNearestNeighbors(query, 10);
+    assert(knn.size() == 10);
+    for (size_t i = 0; i < knn.size(); ++i) assert(knn[i].distance == knnExpected.distances[i]);
+    std::vector<float> streamedDistances;
+    client.kNearestNeighbors(query.getId(), 10, [&](const ResultHandle& m, Trajectory&&) {
+        streamedDistances.push_back(m.distance);
+    });
+    assert(streamedDistances == knnExpected.distances);
+
+    auto similar = client.findSimilar(query.getId(), 0.02f);
+    assert(ids(similar) == ids(tree.findSimilar(query, 0.02f)));
+
+    // Errors are reported and leave the connection usable
+    bool threw = false;
+    try { client.kNearestNeighbors("nobody_1", 5); } catch (const std::runtime_error&) { threw = true; }
+    assert(threw);
+    threw = false;
+    try { client.fetch({999999}); } catch (const std::runtime_error&) { threw = true; }
+    assert(threw);
+    assert(client.rangeQuery(box).size() == handles.size());
+
+    // A truncated request or an unknown reply mode gets an Error frame
+    {
+        int fd = connectRaw(socketPath);
+        protocol::sendFrame(fd, protocol::MessageType::Range, {1, 2, 3});
+        receiveError(fd);
+        protocol::Writer request;
+        protocol::sendFrame(fd, protocol::MessageType::Range, request.putBox(box).put<uint8_t>(7).data());
+        assert(receiveError(fd) == "unknown reply mode 7");
+        request.clear();
+        protocol::sendFrame(fd, protocol::MessageType::KNN, request.putString(query.getId()).put<uint32_t>(5).put<uint8_t>(2).data());
+        assert(receiveError(fd) == "unknown reply mode 2");
+        ::close(fd);
+    }
+    waitForConnections(server, 1);
+
+    // Clients beyond the worker count are refused instead of queueing behind idle connections
+    {
+        std::vector<int> held;
+        for (int c = 0; c < 3; ++c) held.push_back(connectRaw(socketPath));
+        waitForConnections(server, 4);
+        int extra = connectRaw(socketPath);
+        assert(receiveError(extra).rfind("server busy", 0) == 0);
+        ::close(extra);
+        QueryClient refused(socketPath);
+        threw = false;
+        try { refused.stats(); } catch (const std::runtime_error&) { threw = true; }
+        assert(threw);
+        for (int fd : held) ::close(fd);
+    }
+    waitForConnections(server, 1);
+
+    // Concurrent clients filling the remaining workers
+    std::atomic<size_t> mismatches{0};
+    std::vector<std::thread> clients;
+    for (int c = 0; c < 3; ++c) {
+        clients.emplace_back([&, c]() {
+            QueryClient own(socketPath);
+            std::mt19937 local(c);
+            std::uniform_real_distribution<float> u(0.0f, 1.0f);
+            for (int q = 0; q < 40; ++q) {
+                float x = -75.3f + 0.2f * u(local), y = 39.8f + 0.2f * u(local);
+                BoundingBox3D b(x, y, 1500000000, x + 0.02f, y + 0.02f, 1500000000 + 5 * 86400);
+                if (own.rangeQuery(b).size() != tree.rangeQuery(b).size()) ++mismatches;
+            }
+        });
+    }
+    for (auto& t : clients) t.join();
+    assert(mismatches == 0);
+
+    ServerStats stats = client.stats();
+    std::cout << stats.requests << " requests from " << stats.connections << " connections\n";
+    assert(stats.connections == 8); // refused clients are not counted
+
+    client.shutdownServer();
+    runner.join();
+    assert(server.clientCount() == 8);
+}
+
+// ------------------ Main ------------------
+int main() {
+    testService();
+
+    std::cout << "\n=== All service tests completed successfully ===\n";
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include "../api/include/shardedRTree.h"
+#include "../api/include/threadPool.h"
+#include "../api/include/RTree.h"
+#include "testHelpers.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <set>
+#include <random>
+#include <chrono>
+#include <stdexcept>
+
+// ------------------ Helper Functions ------------------
+// 12 points a minute apart within a month, over a wider area
+const TripShape kShape{30.0, 12, 12, 60, 0.002f, 0.3f};
+
+// ------------------ Thread pool ------------------
+void testThreadPool() {
+    std::cout << "\n=== testThreadPool ===\n";
+    ThreadPool pool(3);
+    assert(pool.size() == 3);
+    std::vector<std::future<int>> squares;
+    for (int i = 0; i < 100; ++i) squares.push_back(pool.submit([i]() { return i * i; }));
+    for (int i = 0; i < 100; ++i) assert(squares[i].get() == i * i);
+
+    auto failing = pool.submit([]() -> int { throw std::runtime_error("task failed"); });
+    bool threw = false;
+    try { failing.get(); } catch (const std::runtime_error&) { threw = true; }
+    assert(threw);
+}
+
+// ------------------ Sharded tree against one RTree ------------------
+void testAgainstRTree(ShardingScheme scheme) {
+    std::cout << "\n=== testAgainstRTree (" << (scheme == ShardingScheme::SpatialTiles ? "spatial tiles" : "vehicle hash")
+              << ") ===\n";
+    std::mt19937 rng(1);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 20000; ++i) trajs.push_back(makeTrip(tripId(i % 1500, i), rng, kShape));
+    std::vector<Trajectory> copy = trajs;
+
+    RTree single(8);
+    single.bulkLoad(copy);
+    copy = trajs;
+    ShardedRTree sharded(9, scheme, 4);
+    sharded.bulkLoad(copy);
+    assert(sharded.size() == 20000 && copy.empty());
+    size_t total = 0;
+    for (size_t s = 0; s < sharded.shardCount(); ++s) total += sharded.shardSize(s);
+    assert(total == 20000);
+
+    // Same modifications on both
+    for (int i = 20000; i < 20500; ++i) {
+        Trajectory t = makeTrip(tripId(i % 1500, i), rng, kShape);
+        single.insert(t);
+        sharded.insert(t);
+    }
+    for (int i = 0; i < 300; ++i) {
+        std::string id = std::to_string(i % 1500) + "_" + std::to_string(i);
+        assert(single.remove(id) && sharded.remove(id));
+    }
+    assert(!sharded.remove("nobody_1"));
+    for (int i = 300; i < 600; ++i) {
+        Trajectory t = makeTrip(tripId(i % 1500, i), rng, kShape);
+        single.update(t);
+        sharded.update(t);
+    }
+    assert(sharded.size() == single.getTotalEntries());
+
+    // Range queries, narrow to whole map
+    std::uniform_real_distribution<float> u(0.0f, 1.0f);
+    for (int q = 0; q < 30; ++q) {
+        float x = -75.3f + 0.3f * u(rng), y = 39.8f + 0.3f * u(rng), w = q < 25 ? 0.03f * u(rng) : 1.0f;
+        int64_t t0 = 1500000000 + static_cast<int64_t>(30 * 86400.0 * u(rng));
+        BoundingBox3D box(x - w, y - w, t0, x + w, y + w, t0 + 86400 * 3);
+        auto expected = ids(single.rangeQuery(box));
+        assert(ids(sharded.rangeQuery(box)) == expected);
+        std::vector<const Trajectory*> pointers;
+        sharded.rangeQuery(box, pointers);
+        assert(pointers.size() == expected.size());
+    }
+
+    // Exact kNN: same distances at every rank as the single tree
+    auto all = single.getAllLeafTrajectories();
+    size_t pruned = 0;
+    for (size_t q = 0; q < all.size(); q += all.size() / 20) {
+        auto want = single.approximateKNearestNeighbors(all[q], 10);
+        auto got = sharded.kNearestNeighbors(all[q], 10);
+        assert(got.distances == want.distances);
+        assert(got.shardsSearched + got.shardsPruned == sharded.shardCount());
+        pruned += got.shardsPruned;
+    }
+    std::cout << "kNN skipped " << pruned << " shard searches over 20 queries\n";
+
+    // Similarity: every answer passes the test, and everything a leaf-level search must find is found
+    const float threshold = 0.01f;
+    for (size_t q = 0; q < all.size(); q += all.size() / 10) {
+        const Trajectory& query = all[q];
+        auto found = ids(sharded.findSimilar(query, threshold));
+        assert(found.count(query.getId()) == 1);
+        for (const auto& t : all) {
+            bool similar = query.approximateDistance(t, 1e-5f) <= threshold && query.similarityTo(t) <= threshold;
+            if (found.count(t.getId())) assert(similar);
+            else assert(!similar || !query.getBoundingBox().intersects(t.getBoundingBox()));
+        }
+    }
+}
+
+// ------------------ Timing ------------------
+void testWideQueryLatency() {
+    std::cout << "\n=== testWideQueryLatency ===\n";
+    std::mt19937 rng(3);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 200000; ++i) trajs.push_back(makeTrip(tripId(i % 5000, i), rng, kShape));
+    std::vector<Trajectory> copy = trajs;
+    RTree single(8);
+    single.bulkLoad(copy);
+
+    using Clock = std::chrono::high_resolution_clock;
+    BoundingBox3D wide(-75.3f, 39.8f, 1500000000, -75.0f, 40.1f, 1500000000 + 20 * 86400);
+    auto start = Clock::now();
+    size_t expected = 0;
+    for (int i = 0; i < 5; ++i) expected = single.rangeQuery(wide).size();
+    double singleTime = std::chrono::duration<double>(Clock::now() - start).count() / 5;
+
+    for (size_t shards : {4, 16}) {
+        copy = trajs;
+        ShardedRTree sharded(shards, ShardingScheme::VehicleHash, shards);
+        sharded.bulkLoad(copy);
+        start = Clock::now();
+        for (int i = 0; i < 5; ++i) assert(sharded.rangeQuery(wide).size() == expected);
+        double shardedTime = std::chrono::duration<double>(Clock::now() - start).count() / 5;
+        std::cout << shards << " shards: " << shardedTime * 1e3 << " ms vs single tree " << singleTime * 1e3
+                  << " ms (" << expected << " results)\n";
+    }
+}
+
+// ------------------ Main ------------------
+int main() {
+    testThreadPool();
+    testAgainstRTree(ShardingScheme::SpatialTiles);
+    testAgainstRTree(ShardingScheme::VehicleHash);
+    testWideQueryLatency();
+
+    std::cout << "\n=== All ShardedRTree tests completed successfully ===\n";
+    return 0;
+}
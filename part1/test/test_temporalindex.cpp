@@ -0,0 +1,163 @@
+#include "../api/include/temporalIndex.h"
+#include "../api/include/RTree.h"
+#include "testHelpers.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <set>
+#include <map>
+#include <random>
+#include <chrono>
+
+// ------------------ Helper Functions ------------------
+// Trips of 2..40 points, a minute apart, starting somewhere in one year
+const TripShape kShape{365.0, 2, 40, 60, 0.001f};
+
+// Range query answered from the temporal index
+std::vector<const Trajectory*> temporalRange(const RTree& tree, const BoundingBox3D& box) {
+    std::vector<const Trajectory*> out;
+    tree.temporalRangeQuery(box, out);
+    return out;
+}
+
+std::multiset<std::string> bruteForce(const std::map<std::string, std::shared_ptr<Trajectory>>& live, int64_t t0, int64_t t1) {
+    std::multiset<std::string> out;
+    for (const auto& [id, t] : live) {
+        BoundingBox3D box = t->getBoundingBox();
+        if (box.getMinT() <= t1 && box.getMaxT() >= t0) out.insert(id);
+    }
+    return out;
+}
+
+// ------------------ Index on its own ------------------
+void testIndexModifications() {
+    std::cout << "\n=== testIndexModifications ===\n";
+    std::mt19937 rng(1);
+    std::map<std::string, std::shared_ptr<Trajectory>> live;
+    std::vector<std::shared_ptr<Trajectory>> initial;
+    for (int i = 0; i < 3000; ++i) {
+        auto t = std::make_shared<Trajectory>(makeTrip("a" + std::to_string(i), rng, kShape));
+        live[t->getId()] = t;
+        initial.push_back(t);
+    }
+    TemporalIndex index;
+    index.build(initial);
+    assert(index.size() == 3000 && index.deltaSize() == 0);
+
+    std::uniform_int_distribution<int> op(0, 9), pick(0, 2999);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    size_t maxDelta = 0;
+    for (int step = 0; step < 4000; ++step) {
+        int o = op(rng);
+        if (o < 4) {                                   // insert
+            auto t = std::make_shared<Trajectory>(makeTrip("b" + std::to_string(step), rng, kShape));
+            live[t->getId()] = t;
+            index.insert(t);
+        } else if (o < 7) {                            // remove
+            std::string id = "a" + std::to_string(pick(rng));
+            assert(index.remove(id) == (live.erase(id) == 1));
+        } else {                                       // change in place, then refresh
+            std::string id = "a" + std::to_string(pick(rng));
+            auto it = live.find(id);
+            if (it == live.end()) { assert(!index.refresh(id)); continue; }
+            *it->second = makeTrip(id, rng, kShape);
+            assert(index.refresh(id));
+        }
+        maxDelta = std::max(maxDelta, index.deltaSize());
+
+        if (step % 200 == 0) {
+            int64_t t0 = 1500000000 + static_cast<int64_t>(365 * 86400.0 * u(rng));
+            int64_t t1 = t0 + static_cast<int64_t>(86400 * 10 * u(rng));
+            assert(ids(index.query(t0, t1)) == bruteForce(live, t0, t1));
+            assert(ids(index.stabbingQuery(t0)) == bruteForce(live, t0, t0));
+        }
+    }
+    assert(index.size() == live.size());
+    assert(ids(index.query(0, INT64_MAX)) == bruteForce(live, 0, INT64_MAX));
+    assert(index.query(0, 1000).empty());
+    std::cout << live.size() << " live entries, largest delta run " << maxDelta
+              << ", tombstones now " << index.tombstoneCount() << "\n";
+
+    // Early stop once the limit is exceeded
+    std::vector<std::shared_ptr<Trajectory>> out;
+    assert(!index.query(0, INT64_MAX, out, 10) && out.size() == 11);
+    out.clear();
+    assert(index.query(0, INT64_MAX, out, live.size()) && out.size() == live.size());
+}
+
+// ------------------ Kept in sync by RTree ------------------
+void testRTreeIntegration() {
+    std::cout << "\n=== testRTreeIntegration ===\n";
+    std::mt19937 rng(2);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 5000; ++i) trajs.push_back(makeTrip("r" + std::to_string(i), rng, kShape));
+    std::vector<Trajectory> copy = trajs;
+    RTree tree(8);
+    tree.bulkLoad(copy);
+    assert(tree.getTemporalIndex().size() == 5000);
+
+    for (int i = 0; i < 500; ++i) tree.insert(makeTrip("n" + std::to_string(i), rng, kShape));
+    for (int i = 0; i < 300; ++i) assert(tree.remove("r" + std::to_string(i)));
+    for (int i = 300; i < 600; ++i) tree.update(makeTrip("r" + std::to_string(i), rng, kShape));
+    assert(tree.getTemporalIndex().size() == tree.getTotalEntries());
+
+    // Every trajectory in the tree, by ID, to check query answers
+    std::map<std::string, std::shared_ptr<Trajectory>> live;
+    for (const auto& t : tree.getAllLeafTrajectories()) live[t.getId()] = std::make_shared<Trajectory>(t);
+
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    for (int q = 0; q < 30; ++q) {
+        int64_t t0 = 1500000000 + static_cast<int64_t>(365 * 86400.0 * u(rng));
+        int64_t t1 = t0 + static_cast<int64_t>(q < 15 ? 3600 * u(rng) : 86400 * 60 * u(rng));
+        BoundingBox3D timeOnly(-1000.0f, -1000.0f, t0, 1000.0f, 1000.0f, t1);
+        assert(ids(temporalRange(tree, timeOnly)) == bruteForce(live, t0, t1));
+        assert(ids(tree.rangeQuery(timeOnly)) == bruteForce(live, t0, t1));
+
+        // With a spatial constraint, candidates are also tested against the box
+        BoundingBox3D box(-75.25f, 39.85f, t0, -75.15f, 39.95f, t1);
+        std::multiset<std::string> expected;
+        for (const auto& [id, t] : live)
+            if (box.intersects(t->getBoundingBox())) expected.insert(id);
+        assert(ids(temporalRange(tree, box)) == expected);
+        assert(ids(tree.rangeQuery(box)) == expected);
+    }
+}
+
+// ------------------ Timing ------------------
+void testTimeOnlySpeed() {
+    std::cout << "\n=== testTimeOnlySpeed ===\n";
+    std::mt19937 rng(3);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 50000; ++i) trajs.push_back(makeTrip("s" + std::to_string(i), rng, kShape));
+    RTree tree(8);
+    tree.bulkLoad(trajs);
+
+    using Clock = std::chrono::high_resolution_clock;
+    const int64_t t0 = 1500000000 + 200 * 86400;
+    size_t viaIndex = 0, viaTree = 0;
+    auto start = Clock::now();
+    for (int i = 0; i < 200; ++i)
+        viaIndex += temporalRange(tree, BoundingBox3D(-1000.0f, -1000.0f, t0 + i * 600, 1000.0f, 1000.0f, t0 + i * 600 + 1800)).size();
+    double indexTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    start = Clock::now();
+    for (int i = 0; i < 200; ++i) {
+        std::vector<Trajectory> results;
+        tree.getRoot()->rangeQuery(BoundingBox3D(-1000.0f, -1000.0f, t0 + i * 600, 1000.0f, 1000.0f, t0 + i * 600 + 1800), results);
+        viaTree += results.size();
+    }
+    double treeTime = std::chrono::duration<double>(Clock::now() - start).count();
+    assert(viaIndex == viaTree);
+    std::cout << "200 half-hour windows: temporal index " << indexTime << " s, 3D traversal " << treeTime
+              << " s (" << viaIndex << " results)\n";
+}
+
+// ------------------ Main ------------------
+int main() {
+    testIndexModifications();
+    testRTreeIntegration();
+    testTimeOnlySpeed();
+
+    std::cout << "\n=== All TemporalIndex tests completed successfully ===\n";
+    return 0;
+}
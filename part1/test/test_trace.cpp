@@ -0,0 +1,91 @@
+#include "../../common/trace.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <cassert>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdio>
+
+// ------------------ Helper Functions ------------------
+std::string readFile(const std::string& path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+size_t countOf(const std::string& text, const std::string& needle) {
+    size_t count = 0;
+    for (size_t p = text.find(needle); p != std::string::npos; p = text.find(needle, p + 1)) ++count;
+    return count;
+}
+
+// ------------------ Tracing ------------------
+void testInactiveRecordsNothing() {
+    std::cout << "\n=== testInactiveRecordsNothing ===\n";
+    assert(!trace::isActive());
+    {
+        TRACE_SCOPE("ignored");
+    }
+    trace::start("/tmp/test_trace_empty.json", "empty");
+    assert(trace::isActive());
+    assert(trace::stop() == 0); // the span above ran before the session
+    assert(!trace::isActive() && trace::stop() == 0);
+    std::remove("/tmp/test_trace_empty.json");
+}
+
+void testSessionWritesSpans() {
+    std::cout << "\n=== testSessionWritesSpans ===\n";
+    const std::string path = "/tmp/test_trace.json";
+    {
+        trace::Session session(path.c_str(), "trace \"test\"");
+        trace::setThreadName("main");
+        trace::Span outer("outer", "test");
+        outer.setArg("items", 42);
+        {
+            TRACE_SCOPE_CAT("test", "inner");
+        }
+        std::vector<std::thread> workers;
+        for (int w = 0; w < 3; ++w)
+            workers.emplace_back([w]() {
+                trace::setThreadName("worker " + std::to_string(w));
+                for (int i = 0; i < 10; ++i) {
+                    trace::Span span(std::string("task ") + std::to_string(i), "work");
+                }
+            });
+        for (auto& w : workers) w.join();
+        outer.end();
+        outer.end(); // recorded once
+    }
+
+    std::string json = readFile(path);
+    assert(json.rfind("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", 0) == 0);
+    assert(json.find("]}") != std::string::npos);
+    assert(countOf(json, "\"ph\":\"X\"") == 32);
+    assert(countOf(json, "\"name\":\"outer\"") == 1 && json.find("\"args\":{\"items\":42}") != std::string::npos);
+    assert(countOf(json, "\"name\":\"task 9\"") == 3);
+    assert(countOf(json, "\"name\":\"thread_name\"") == 4);
+    assert(json.find("trace \\\"test\\\"") != std::string::npos); // escaped process name
+    std::remove(path.c_str());
+    std::cout << json.size() << " bytes of trace JSON\n";
+}
+
+void testSessionWithoutPath() {
+    std::cout << "\n=== testSessionWithoutPath ===\n";
+    trace::Session session(nullptr);
+    assert(!trace::isActive());
+    trace::Session empty("");
+    assert(!trace::isActive());
+}
+
+// ------------------ Main ------------------
+int main() {
+    testInactiveRecordsNothing();
+    testSessionWritesSpans();
+    testSessionWithoutPath();
+
+    std::cout << "\n=== All trace tests completed successfully ===\n";
+    return 0;
+}
@@ -81,6 +81,34 @@ int main() {
     std::cout << "Spatio-temporal distance after deleting points from traj1: " << stDist_after_delete << "\n";
     std::cout << "Approximate distance after deleting points from traj1: " << approxDist_after_delete << "\n";
 
+    // -------------------- Interpolated Position --------------------
+    std::cout << "\n--- Position at time t (traj2) ---\n";
+    auto mid = traj2.positionAt(1060);            // halfway between (0,0,1000) and (4,5,1120)
+    assert(mid && std::fabs(mid->getX() - 2.0f) < 1e-5f && std::fabs(mid->getY() - 2.5f) < 1e-5f && mid->getT() == 1060);
+    assert(traj2.positionAt(1120) == traj2.getPointAt(1)); // exact sample
+    assert(traj2.positionAt(1200) == traj2.getPointAt(2)); // last sample
+    assert(!traj2.positionAt(999) && !traj2.positionAt(1201));
+    assert(!Trajectory("empty").positionAt(1000));
+
+    // Cursor form: same positions for a forward sweep, and a step back restarts the search
+    size_t cursor = 0;
+    for (int64_t t = 990; t <= 1210; t += 5) assert(traj2.positionAt(t, cursor) == traj2.positionAt(t));
+    assert(traj2.positionAt(1060, cursor) == mid && cursor == 1);
+    std::cout << "Position at 1060: (" << mid->getX() << ", " << mid->getY() << ")\n";
+
+    // -------------------- One-Pass Summary --------------------
+    std::cout << "\n--- Summary (exact time centroid) ---\n";
+    Trajectory epoch("epoch");
+    for (int64_t i = 0; i < 1000; ++i) epoch.addPoint(Point3D(-75.0f + 1e-4f * i, 39.9f, 1500000000 + 2 * i + 1));
+    TrajectorySummary summary = epoch.precomputeCentroidAndBoundingBox();
+    assert(summary.index == 0 && summary.pointCount == 1000);
+    assert(summary.centroidT == 1500001000.0);    // mean of 1500000001, ..., 1500001999
+    assert(epoch.getCentroidT() == summary.centroidT);
+    assert(summary.bbox == epoch.computeBoundingBox() && epoch.getBoundingBox() == summary.bbox);
+    assert(summary.length == epoch.length() && summary.duration == epoch.duration());
+    assert(Trajectory("none").summarize().pointCount == 0);
+    std::cout << "Centroid t = " << std::fixed << summary.centroidT << "\n";
+
     std::cout << "\nAll Trajectory tests (including dynamic expansion, updates, deletions, and distances) passed successfully!\n";
     return 0;
 }
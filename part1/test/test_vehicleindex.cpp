@@ -0,0 +1,127 @@
+#include "../api/include/vehicleIndex.h"
+#include "../api/include/nodeAggregate.h"
+#include "../api/include/RTree.h"
+#include "testHelpers.h"
+#include <iostream>
+#include <cassert>
+#include <vector>
+#include <set>
+#include <random>
+
+// ------------------ Helper Functions ------------------
+// One day, 10 points a minute apart
+const TripShape kShape{1.0, 10, 10, 60, 0.002f};
+
+std::set<std::string> vehiclesOf(const std::vector<Trajectory>& trajs) {
+    std::set<std::string> out;
+    for (const auto& t : trajs) out.insert(vehicleIdOf(t.getId()));
+    return out;
+}
+
+// ------------------ Bitmap ------------------
+void testBitmap() {
+    std::cout << "\n=== testBitmap ===\n";
+    VehicleBitmap a(100), b;
+    for (uint32_t v : {0u, 63u, 64u, 99u, 63u}) a.set(v);
+    assert(a.count() == 4 && a.test(64) && !a.test(65) && !a.test(5000));
+    b.set(200);          // grows on demand
+    b.set(0);
+    a.merge(b);
+    assert(a.count() == 5 && a.test(200));
+    assert((a.ordinals() == std::vector<uint32_t>{0, 63, 64, 99, 200}));
+    a.clear();
+    assert(a.count() == 0);
+}
+
+// ------------------ Index on its own ------------------
+void testIndex() {
+    std::cout << "\n=== testIndex ===\n";
+    std::mt19937 rng(1);
+    std::vector<std::shared_ptr<Trajectory>> trajs;
+    for (int i = 0; i < 300; ++i) trajs.push_back(std::make_shared<Trajectory>(makeTrip(tripId(i % 40, i), rng, kShape)));
+
+    VehicleIndex index;
+    index.build(trajs);
+    assert(index.size() == 300 && index.vehicleCount() == 40);
+    assert(index.trajectoriesOf("7").size() == 8 && index.trajectoriesOf("nobody").empty());
+    assert(index.vehicleName(index.vehicleOf(trajs[45].get())) == "5");
+
+    assert(index.remove("7_7") && !index.remove("7_7") && !index.remove("nobody_1"));
+    assert(index.trajectoriesOf("7").size() == 7 && index.size() == 299);
+    assert(index.vehicleOf(trajs[7].get()) == VehicleIndex::npos);
+
+    auto extra = std::make_shared<Trajectory>(makeTrip(tripId(99, 1), rng, kShape));
+    index.insert(extra);
+    assert(index.vehicleCount() == 41 && index.vehicleName(index.vehicleOf(extra.get())) == "99");
+
+    VehicleBitmap bitmap = index.makeBitmap();
+    bitmap.set(index.ordinal("3"));
+    bitmap.set(index.ordinal("99"));
+    assert((index.vehicleNames(bitmap) == std::vector<std::string>{"3", "99"}));
+}
+
+// ------------------ RTree queries ------------------
+void testRTreeVehicleQueries() {
+    std::cout << "\n=== testRTreeVehicleQueries ===\n";
+    std::mt19937 rng(2);
+    std::vector<Trajectory> trajs;
+    for (int i = 0; i < 6000; ++i) trajs.push_back(makeTrip(tripId(i % 500, i), rng, kShape));
+    RTree tree(8);
+    tree.bulkLoad(trajs);
+
+    // Modifications keep the index in sync
+    for (int i = 6000; i < 6500; ++i) tree.insert(makeTrip(tripId(i % 700, i), rng, kShape));
+    for (int i = 0; i < 400; ++i) assert(tree.remove(std::to_string(i % 500) + "_" + std::to_string(i)));
+    for (int i = 400; i < 800; ++i) tree.update(makeTrip(tripId(i % 500, i), rng, kShape));
+    assert(tree.getVehicleIndex().size() == tree.getTotalEntries());
+
+    std::vector<BoundingBox3D> boxes = {
+        BoundingBox3D(-75.25f, 39.85f, 1500010000, -75.15f, 39.95f, 1500050000),
+        BoundingBox3D(-75.3f, 39.8f, 1500000000, -75.28f, 39.82f, 1500086400),
+        BoundingBox3D(-76.0f, 39.0f, 1400000000, -74.0f, 41.0f, 1600000000),
+        BoundingBox3D(10.0f, 10.0f, 0, 11.0f, 11.0f, 1),
+    };
+    for (const auto& box : boxes) {
+        auto results = tree.rangeQuery(box);
+        size_t matches = 0;
+        VehicleBitmap bitmap = tree.rangeQueryVehicles(box, &matches);
+        auto names = tree.getVehicleIndex().vehicleNames(bitmap);
+        assert(matches == results.size());
+        assert(std::set<std::string>(names.begin(), names.end()) == vehiclesOf(results));
+
+        // Groups partition the result by vehicle
+        size_t grouped = 0;
+        std::set<std::string> seen;
+        for (const auto& g : tree.rangeQueryByVehicle(box)) {
+            assert(!g.trajectories.empty() && seen.insert(g.vehicleId).second);
+            for (const Trajectory* t : g.trajectories) assert(vehicleIdOf(t->getId()) == g.vehicleId);
+            grouped += g.trajectories.size();
+        }
+        assert(grouped == results.size() && seen.size() == bitmap.count());
+        std::cout << results.size() << " trajectories from " << bitmap.count() << " vehicles\n";
+    }
+
+    // Similarity search
+    auto all = tree.getAllLeafTrajectories();
+    for (size_t q = 0; q < all.size(); q += all.size() / 5) {
+        const Trajectory& query = all[q];
+        std::vector<Trajectory> similar = tree.findSimilar(query, 0.05f), others;
+        for (const auto& t : similar)
+            if (t.getId() != query.getId()) others.push_back(t);
+        size_t matches = 0;
+        VehicleBitmap bitmap = tree.findSimilarVehicles(query, 0.05f, false, &matches);
+        assert(matches == similar.size() && bitmap.count() == vehiclesOf(similar).size());
+        assert(tree.findSimilarVehicles(query, 0.05f, true, &matches).count() == vehiclesOf(others).size());
+        assert(matches == others.size());
+    }
+}
+
+// ------------------ Main ------------------
+int main() {
+    testBitmap();
+    testIndex();
+    testRTreeVehicleQueries();
+
+    std::cout << "\n=== All VehicleIndex tests completed successfully ===\n";
+    return 0;
+}
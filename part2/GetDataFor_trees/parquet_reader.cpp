@@ -1,4 +1,5 @@
 #include "parquet_reader.h"
+#include "../../common/trace.h"
 #include <arrow/api.h>
 #include <arrow/io/api.h>
 #include <parquet/arrow/reader.h>
@@ -8,6 +9,7 @@
 #include <filesystem>
 
 bool ParquetReader::loadFromParquet(const std::string& filename) {
+    TRACE_SCOPE_CAT("load", "ParquetReader::loadFromParquet");
     try {
         std::cout << "Loading parquet file: " << filename << std::endl;
         
@@ -26,7 +28,9 @@ bool ParquetReader::loadFromParquet(const std::string& filename) {
         std::unique_ptr<parquet::arrow::FileReader> reader = std::move(reader_result).ValueOrDie();
 
         std::shared_ptr<arrow::Table> table;
+        trace::Span readSpan("read table", "load");
         auto status = reader->ReadTable(&table);
+        readSpan.end();
         if (!status.ok()) {
             std::cout << "Error reading table: " << status.message() << std::endl;
             return false;
@@ -44,6 +48,7 @@ bool ParquetReader::loadFromParquet(const std::string& filename) {
 }
 
 bool ParquetReader::loadFromParquetDirectory(const std::string& directory) {
+    TRACE_SCOPE_CAT("load", "ParquetReader::loadFromParquetDirectory");
     try {
         std::cout << "Loading parquet files from directory: " << directory << std::endl;
         
@@ -70,7 +75,9 @@ bool ParquetReader::loadFromParquetDirectory(const std::string& directory) {
                 std::unique_ptr<parquet::arrow::FileReader> reader = std::move(reader_result).ValueOrDie();
 
                 std::shared_ptr<arrow::Table> table;
+                trace::Span readSpan("read table", "load");
                 auto status = reader->ReadTable(&table);
+                readSpan.end();
                 if (!status.ok()) {
                     std::cout << "  Skipping file, read error: " << status.message() << std::endl;
                     continue;
@@ -87,7 +94,9 @@ bool ParquetReader::loadFromParquetDirectory(const std::string& directory) {
             return false;
         }
         
+        trace::Span concatSpan("concatenate tables", "load");
         auto result = arrow::ConcatenateTables(tables);
+        concatSpan.end();
         if (!result.ok()) {
             std::cout << "Error concatenating tables: " << result.status().message() << std::endl;
             return false;
@@ -107,6 +116,8 @@ bool ParquetReader::loadFromParquetDirectory(const std::string& directory) {
 }
 
 void ParquetReader::processArrowTable(std::shared_ptr<arrow::Table> table) {
+    trace::Span span("ParquetReader::processArrowTable", "load");
+    span.setArg("rows", table ? table->num_rows() : 0);
     try {
         int vehicleIdCol = -1, tripIdCol = -1, timestampCol = -1;
         
@@ -5,11 +5,14 @@
 #include <algorithm>
 #include <cmath>       
 #include <vector>      
+#include <cstdlib>
 #include "/home/alex/desktop/Multidimensional-Data-Structures/part2/part2.2/segment_tree.h"
 #include "/home/alex/desktop/Multidimensional-Data-Structures/part2/part2.2/segment_tree.cpp"
 #include "parquet_reader.h"
 
 int main() {
+    // TRACE_FILE=<path> writes a Chrome trace of the run
+    trace::Session session(std::getenv("TRACE_FILE"), "segment tree with parquet");
     std::cout << "Segment Tree Build Test with Full Dataset" << std::endl;
     std::cout << "==========================================" << std::endl;
     
@@ -6,6 +6,7 @@
 #include <fstream>
 #include <vector>
 #include <tuple>
+#include <cstdlib>
 using namespace std;
 
 /**
@@ -13,6 +14,8 @@ using namespace std;
  * Tests basic functionality with manually verified expected results
  */
 int main() {
+    // TRACE_FILE=<path> writes a Chrome trace of the run
+    trace::Session session(getenv("TRACE_FILE"), "segment tree test");
     cout << "Testing Segment Tree with Detailed Comments" << endl;
     cout << "===========================================" << endl;
     
@@ -1,5 +1,6 @@
 // segment_tree.cpp - Implementation of Trip Counting Segment Tree
 #include "segment_tree.h"
+#include "../../common/trace.h"
 #include <algorithm>
 #include <iostream>
 
@@ -10,6 +11,8 @@
 SegmentTree::SegmentTree(const std::vector<long long>& timestamps, 
                         const std::vector<std::tuple<long, long long, long long>>& tripData) 
     : trips(tripData) {
+    trace::Span span("SegmentTree build", "build");
+    span.setArg("trips", static_cast<int64_t>(tripData.size()));
     
     if (timestamps.empty()) {
         throw std::invalid_argument("Timestamps cannot be empty");
@@ -18,12 +21,15 @@ SegmentTree::SegmentTree(const std::vector<long long>& timestamps,
     // Sort timestamps and remove duplicates to create discrete time points
     // This ensures our segment tree covers only relevant time points
     std::vector<long long> sortedTimestamps = timestamps;
+    trace::Span sortSpan("sort timestamps", "build");
     std::sort(sortedTimestamps.begin(), sortedTimestamps.end());
     sortedTimestamps.erase(std::unique(sortedTimestamps.begin(), sortedTimestamps.end()), 
                           sortedTimestamps.end());
+    sortSpan.end();
     
     // Build tree using indices into the sorted timestamp array
     // Tree will have sortedTimestamps.size() leaf nodes
+    TRACE_SCOPE_CAT("build", "build nodes");
     root = buildTree(sortedTimestamps, 0, sortedTimestamps.size() - 1);
 }
 
@@ -186,6 +192,7 @@ int SegmentTree::queryHelper(Node* node, long long queryStart, long long queryEn
  * Returns count of trips active during the specified time range
  */
 int SegmentTree::query(long long queryStart, long long queryEnd) {
+    TRACE_SCOPE_CAT("query", "SegmentTree query");
     // Validate input
     if (queryStart > queryEnd) return 0;
     
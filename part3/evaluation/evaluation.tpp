@@ -25,6 +25,7 @@ Purpose:
 #include <fstream>
 #include <iostream>
 #include <filesystem>
+#include "../../common/trace.h"
 
 namespace fs = std::filesystem;
 using namespace std;
@@ -44,14 +45,18 @@ void Evaluation::evaluate2D(Func hullFunc,
 
     for (int n : sizes) {
         vector<double> times, mems;
+        trace::Span sizeSpan(algName + " n=" + to_string(n), "evaluation");
 
         // Repeat experiment multiple times for statistics
         for (int run = 0; run < numRuns; run++) {
             vector<Point> points = generateRandom2D(n);
 
+            trace::Span hullSpan(algName, "hull");
+            hullSpan.setArg("n", n);
             auto start = high_resolution_clock::now();
             auto hull = hullFunc(points);
             auto end = high_resolution_clock::now();
+            hullSpan.end();
 
             // Time in microseconds
             double time_us = duration_cast<microseconds>(end - start).count();
@@ -107,6 +112,7 @@ void Evaluation::evaluate3D(Func hullFunc,
         }
 
         vector<double> times, mems;
+        trace::Span sizeSpan(algName + " n=" + to_string(n), "evaluation");
 
         for (int run = 0; run < runs; run++) {
             // Generate points
@@ -114,9 +120,12 @@ void Evaluation::evaluate3D(Func hullFunc,
                 ? generateRandomSphere3D(n, 1.0)
                 : generateRandom3D(n);
 
+            trace::Span hullSpan(algName, "hull");
+            hullSpan.setArg("n", n);
             auto start = high_resolution_clock::now();
             auto hullOutput = hullFunc(points);
             auto end = high_resolution_clock::now();
+            hullSpan.end();
 
             double time_us = duration_cast<microseconds>(end - start).count();
 
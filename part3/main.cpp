@@ -10,10 +10,15 @@ Purpose:
 
 #include "evaluation/evaluation.h"  // Evaluation class for running experiments
 #include "allAlgorithms.h"          // Implementations of convex hull algorithms
+#include "../common/trace.h"            // Optional timeline of the run
 #include <iostream>
 #include <vector>
+#include <cstdlib>
 
 int main() {
+    // TRACE_FILE=<path> writes a Chrome trace of the run
+    trace::Session session(std::getenv("TRACE_FILE"), "convex hull experiments");
+
     // -----------------------------
     // Number of repetitions per input size
     int numRuns = 5;